@@ -0,0 +1,103 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Adler-32 checksum algorithm (RFC 1950).
+ */
+
+#include "adler32.h"
+
+#include <cfg/macros.h> //MIN()
+#include <cpu/attr.h>   //CPU_REG_BITS
+
+/** Largest prime smaller than 65536 */
+#define ADLER32_BASE 65521U
+
+/*
+ * The modulo is computed only once per block: ADLER32_NMAX is the largest
+ * number of octets that can be added without overflowing the accumulators,
+ * 5552 with 32 bit sums. On 64 bit CPUs the reduction is deferred for a much
+ * longer run.
+ */
+#if CPU_REG_BITS >= 64
+	typedef uint64_t adler_sum_t;
+	#define ADLER32_NMAX  (1UL << 24)
+#else
+	typedef uint32_t adler_sum_t;
+	#define ADLER32_NMAX  5552
+#endif
+
+void adler32_init(Adler32 *ad)
+{
+	ad->a = 1;
+	ad->b = 0;
+}
+
+void adler32_update(Adler32 *ad, const void *_buf, size_t len)
+{
+	const uint8_t *buf = (const uint8_t *)_buf;
+	adler_sum_t a = ad->a;
+	adler_sum_t b = ad->b;
+
+	while (len)
+	{
+		size_t tlen = MIN(len, (size_t)ADLER32_NMAX);
+		len -= tlen;
+
+		for (; tlen >= 8; tlen -= 8)
+		{
+			a += buf[0]; b += a;
+			a += buf[1]; b += a;
+			a += buf[2]; b += a;
+			a += buf[3]; b += a;
+			a += buf[4]; b += a;
+			a += buf[5]; b += a;
+			a += buf[6]; b += a;
+			a += buf[7]; b += a;
+			buf += 8;
+		}
+		while (tlen--)
+		{
+			a += *buf++;
+			b += a;
+		}
+		a %= ADLER32_BASE;
+		b %= ADLER32_BASE;
+	}
+
+	ad->a = a;
+	ad->b = b;
+}
+
+uint32_t adler32_final(Adler32 *ad)
+{
+	return ad->b << 16 | ad->a;
+}
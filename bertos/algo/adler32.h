@@ -0,0 +1,60 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Adler-32 checksum algorithm (RFC 1950).
+ *
+ * Adler-32 is slightly weaker than Fletcher-32 on short messages, but it
+ * works on single octets, so it needs no padding and it is the checksum
+ * used by zlib streams.
+ *
+ * $WIZ$ module_name = "adler32"
+ */
+
+#ifndef ALGO_ADLER32_H
+#define ALGO_ADLER32_H
+
+#include <cfg/compiler.h>
+
+typedef struct Adler32
+{
+	uint32_t a, b;
+} Adler32;
+
+void adler32_init(Adler32 *ad);
+void adler32_update(Adler32 *ad, const void *_buf, size_t len);
+uint32_t adler32_final(Adler32 *ad);
+
+int adler32_testSetup(void);
+int adler32_testTearDown(void);
+int adler32_testRun(void);
+
+#endif /* ALGO_ADLER32_H */
@@ -0,0 +1,137 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Adler-32 and Fletcher-32 cross check and throughput benchmark.
+ */
+
+#include "adler32.h"
+#include "fletcher32.h"
+
+#include <cfg/test.h>
+#include <cfg/debug.h>
+#include <cfg/macros.h>
+
+#include <drv/timer.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t buf[70000];
+
+/* RFC 1950 reference implementation */
+static uint32_t adler32_ref(const uint8_t *data, size_t len)
+{
+	uint32_t a = 1, b = 0;
+
+	while (len--)
+	{
+		a = (a + *data++) % 65521;
+		b = (b + a) % 65521;
+	}
+	return b << 16 | a;
+}
+
+int adler32_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+	return 0;
+}
+
+int adler32_testTearDown(void)
+{
+	return 0;
+}
+
+static void adler32_benchmark(void)
+{
+	enum { CYCLES = 64 };
+	Adler32 ad;
+	Fletcher32 f;
+	ticks_t t;
+
+	adler32_init(&ad);
+	t = timer_clock();
+	for (int i = 0; i < CYCLES; i++)
+		adler32_update(&ad, buf, sizeof(buf));
+	t = timer_clock() - t;
+	kprintf("adler32: %lu KiB/s [%08lX]\n",
+		(unsigned long)((uint64_t)sizeof(buf) * CYCLES * 1000000 / 1024 / MAX(ticks_to_us(t), (utime_t)1)),
+		(unsigned long)adler32_final(&ad));
+
+	fletcher32_init(&f);
+	t = timer_clock();
+	for (int i = 0; i < CYCLES; i++)
+		fletcher32_update(&f, buf, sizeof(buf));
+	t = timer_clock() - t;
+	kprintf("fletcher32: %lu KiB/s [%08lX]\n",
+		(unsigned long)((uint64_t)sizeof(buf) * CYCLES * 1000000 / 1024 / MAX(ticks_to_us(t), (utime_t)1)),
+		(unsigned long)fletcher32_final(&f));
+}
+
+int adler32_testRun(void)
+{
+	Adler32 ad;
+
+	adler32_init(&ad);
+	adler32_update(&ad, "Wikipedia", 9);
+	ASSERT(adler32_final(&ad) == 0x11E60398UL);
+
+	/* Worst case for overflow: long runs of 0xff */
+	memset(buf, 0xff, sizeof(buf));
+	adler32_init(&ad);
+	adler32_update(&ad, buf, sizeof(buf));
+	ASSERT(adler32_final(&ad) == adler32_ref(buf, sizeof(buf)));
+
+	for (size_t i = 0; i < sizeof(buf); i++)
+		buf[i] = rand();
+
+	/* Split the buffer in random chunks */
+	for (int run = 0; run < 16; run++)
+	{
+		size_t off = 0;
+
+		adler32_init(&ad);
+		while (off < sizeof(buf))
+		{
+			size_t len = MIN((size_t)(rand() % 9000), sizeof(buf) - off);
+			adler32_update(&ad, buf + off, len);
+			off += len;
+		}
+		ASSERT(adler32_final(&ad) == adler32_ref(buf, sizeof(buf)));
+	}
+
+	adler32_benchmark();
+	return 0;
+}
+
+TEST_MAIN(adler32);
@@ -0,0 +1,64 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief CRC-32 (IEEE 802.3) implementation.
+ */
+
+#include "crc32.h"
+#include "crc_engine.h"
+
+#include "cfg/cfg_crc32.h"
+
+#include <cfg/compiler.h>
+
+STATIC_ASSERT(CONFIG_CRC32_SLICES == 1 || CONFIG_CRC32_SLICES == 4 || CONFIG_CRC32_SLICES == 8);
+
+static CRC_ENGINE_TABLE(crc32_tab, CONFIG_CRC32_SLICES);
+static CrcEngine crc32_engine;
+static bool crc32_ready;
+
+uint32_t crc32(uint32_t crc, const void *buf, size_t len)
+{
+	/*
+	 * Generating the tables twice from concurrent processes is harmless:
+	 * both write the same values, and crc32() is marked as ready only
+	 * when the tables are complete.
+	 */
+	if (UNLIKELY(!crc32_ready))
+	{
+		crcengine_init(&crc32_engine, CRC32_MODEL, crc32_tab, CONFIG_CRC32_SLICES);
+		MEMORY_BARRIER;
+		crc32_ready = true;
+	}
+
+	return crcengine_update(&crc32_engine, crc, buf, len);
+}
@@ -0,0 +1,71 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief CRC-32 (IEEE 802.3) as used by Ethernet, zlib and PNG.
+ *
+ * The lookup tables are generated by the CRC engine on first use, so they
+ * live in RAM and their number can be tuned with CONFIG_CRC32_SLICES.
+ *
+ * As for crc_ccitt(), the final complement is left to the caller:
+ * \code
+ * uint32_t crc = crc32(CRC32_INIT_VAL, buf, len) ^ CRC32_INIT_VAL;
+ * \endcode
+ *
+ * $WIZ$ module_name = "crc32"
+ * $WIZ$ module_depends = "crc_engine"
+ * $WIZ$ module_configuration = "bertos/cfg/cfg_crc32.h"
+ */
+
+#ifndef ALGO_CRC32_H
+#define ALGO_CRC32_H
+
+#include <cfg/compiler.h>
+
+EXTERN_C_BEGIN
+
+/** CRC-32 init value */
+#define CRC32_INIT_VAL ((uint32_t)0xFFFFFFFFUL)
+
+/**
+ * This function implements the CRC-32 calculation on a buffer.
+ *
+ * \param crc  Current CRC-32 value.
+ * \param buf  The buffer to perform CRC calculation on.
+ * \param len  The length of the Buffer.
+ *
+ * \return The updated CRC-32 value.
+ */
+uint32_t crc32(uint32_t crc, const void *buf, size_t len);
+
+EXTERN_C_END
+
+#endif /* ALGO_CRC32_H */
@@ -0,0 +1,203 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Generic table driven CRC engine.
+ *
+ * Reflected CRCs are kept right aligned in the 32 bit register, while
+ * normal (MSB first) CRCs are kept left aligned: this way the same
+ * table layout and the same inner loops work for every width.
+ */
+
+#include "crc_engine.h"
+
+#include <cfg/debug.h>
+
+#include <cpu/byteorder.h>
+
+static uint32_t crc_reflect(uint32_t val, uint8_t width)
+{
+	uint32_t res = 0;
+
+	for (uint8_t i = 0; i < width; i++)
+	{
+		res = (res << 1) | (val & 1);
+		val >>= 1;
+	}
+	return res;
+}
+
+void crcengine_init(CrcEngine *e, uint8_t width, uint32_t poly, bool reflect, uint32_t (*tab)[256], uint8_t slices)
+{
+	ASSERT(width >= 8 && width <= 32);
+	ASSERT(slices == 1 || slices == 4 || slices == 8);
+
+	e->tab = tab;
+	e->width = width;
+	e->slices = slices;
+	e->reflect = reflect;
+
+	if (reflect)
+		poly = crc_reflect(poly, width);
+	else
+		poly <<= 32 - width;
+
+	for (int i = 0; i < 256; i++)
+	{
+		uint32_t c;
+
+		if (reflect)
+		{
+			c = i;
+			for (int bit = 0; bit < 8; bit++)
+				c = (c & 1) ? (c >> 1) ^ poly : c >> 1;
+		}
+		else
+		{
+			c = (uint32_t)i << 24;
+			for (int bit = 0; bit < 8; bit++)
+				c = (c & 0x80000000UL) ? (c << 1) ^ poly : c << 1;
+		}
+		tab[0][i] = c;
+	}
+
+	/* Table k gives the contribution of an octet followed by k zero octets */
+	for (int k = 1; k < slices; k++)
+		for (int i = 0; i < 256; i++)
+		{
+			uint32_t c = tab[k - 1][i];
+
+			if (reflect)
+				tab[k][i] = (c >> 8) ^ tab[0][c & 0xff];
+			else
+				tab[k][i] = (c << 8) ^ tab[0][c >> 24];
+		}
+}
+
+static uint32_t crc_updateReflected(const CrcEngine *e, uint32_t crc, const uint8_t *buf, size_t len)
+{
+	uint32_t (*tab)[256] = e->tab;
+
+	if (e->slices > 1)
+	{
+		/* Align to a word boundary before reading whole words */
+		while (len && ((uintptr_t)buf & 3))
+		{
+			crc = (crc >> 8) ^ tab[0][(crc ^ *buf++) & 0xff];
+			len--;
+		}
+
+		const uint32_t *w = (const uint32_t *)(const void *)buf;
+
+		if (e->slices == 8)
+		{
+			for (; len >= 8; len -= 8)
+			{
+				uint32_t one = le32_to_cpu(*w++) ^ crc;
+				uint32_t two = le32_to_cpu(*w++);
+
+				crc = tab[7][one & 0xff] ^ tab[6][(one >> 8) & 0xff]
+					^ tab[5][(one >> 16) & 0xff] ^ tab[4][one >> 24]
+					^ tab[3][two & 0xff] ^ tab[2][(two >> 8) & 0xff]
+					^ tab[1][(two >> 16) & 0xff] ^ tab[0][two >> 24];
+			}
+		}
+
+		for (; len >= 4; len -= 4)
+		{
+			crc ^= le32_to_cpu(*w++);
+			crc = tab[3][crc & 0xff] ^ tab[2][(crc >> 8) & 0xff]
+				^ tab[1][(crc >> 16) & 0xff] ^ tab[0][crc >> 24];
+		}
+		buf = (const uint8_t *)w;
+	}
+
+	while (len--)
+		crc = (crc >> 8) ^ tab[0][(crc ^ *buf++) & 0xff];
+
+	return crc;
+}
+
+static uint32_t crc_updateNormal(const CrcEngine *e, uint32_t crc, const uint8_t *buf, size_t len)
+{
+	uint32_t (*tab)[256] = e->tab;
+
+	if (e->slices > 1)
+	{
+		while (len && ((uintptr_t)buf & 3))
+		{
+			crc = (crc << 8) ^ tab[0][(crc >> 24) ^ *buf++];
+			len--;
+		}
+
+		const uint32_t *w = (const uint32_t *)(const void *)buf;
+
+		if (e->slices == 8)
+		{
+			for (; len >= 8; len -= 8)
+			{
+				uint32_t one = be32_to_cpu(*w++) ^ crc;
+				uint32_t two = be32_to_cpu(*w++);
+
+				crc = tab[7][one >> 24] ^ tab[6][(one >> 16) & 0xff]
+					^ tab[5][(one >> 8) & 0xff] ^ tab[4][one & 0xff]
+					^ tab[3][two >> 24] ^ tab[2][(two >> 16) & 0xff]
+					^ tab[1][(two >> 8) & 0xff] ^ tab[0][two & 0xff];
+			}
+		}
+
+		for (; len >= 4; len -= 4)
+		{
+			crc ^= be32_to_cpu(*w++);
+			crc = tab[3][crc >> 24] ^ tab[2][(crc >> 16) & 0xff]
+				^ tab[1][(crc >> 8) & 0xff] ^ tab[0][crc & 0xff];
+		}
+		buf = (const uint8_t *)w;
+	}
+
+	while (len--)
+		crc = (crc << 8) ^ tab[0][(crc >> 24) ^ *buf++];
+
+	return crc;
+}
+
+uint32_t crcengine_update(const CrcEngine *e, uint32_t crc, const void *buf, size_t len)
+{
+	uint8_t shift = 32 - e->width;
+
+	ASSERT(e->tab);
+
+	if (e->reflect)
+		return crc_updateReflected(e, crc & (0xFFFFFFFFUL >> shift), (const uint8_t *)buf, len);
+
+	crc = crc_updateNormal(e, crc << shift, (const uint8_t *)buf, len);
+	return crc >> shift;
+}
@@ -0,0 +1,135 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Generic table driven CRC engine.
+ *
+ * This module computes any CRC up to 32 bits wide, given its polynomial
+ * and bit order. Lookup tables are generated at runtime by crcengine_init()
+ * into a buffer supplied by the caller, so the memory cost is only paid by
+ * the applications that really need it.
+ *
+ * crc16(), crc_ccitt() and crc8() are not built on the engine: their
+ * tables are constant and live in program memory on Harvard CPUs, and
+ * the byte-wise updcrc16() and updcrc_ccitt() are inlined in the callers.
+ * Moving them here would cost 1KiB of RAM per model on the 8 bit targets
+ * that use them most. Only crc32() uses the engine. For the same reason
+ * the XMODEM protocol keeps updcrc16(): it gets one octet at a time from
+ * the serial port, so slicing would not help. The PocketBus protocol
+ * checks its frames with a rotating hash, not a CRC, and is left as is.
+ *
+ * On 32 bit CPUs the engine can use more than one table to process 4 or 8
+ * octets per iteration (the so called "slicing-by-4" and "slicing-by-8"
+ * algorithms). Each additional slice costs 1KiB of RAM; on 8 and 16 bit
+ * CPUs a single slice is usually the best choice.
+ *
+ * The init value and the final xor are left to the caller, exactly as in
+ * crc16() and crc_ccitt(), so that the engine can be used as a drop-in
+ * replacement for those functions:
+ * \code
+ * static CRC_ENGINE_TABLE(ccitt_tab, 8);
+ * static CrcEngine ccitt;
+ *
+ * crcengine_init(&ccitt, CRC_CCITT_MODEL, ccitt_tab, 8);
+ * crc = crcengine_update(&ccitt, CRC_CCITT_INIT_VAL, buf, len);
+ * \endcode
+ *
+ * $WIZ$ module_name = "crc_engine"
+ */
+
+#ifndef ALGO_CRC_ENGINE_H
+#define ALGO_CRC_ENGINE_H
+
+#include <cfg/compiler.h>
+
+EXTERN_C_BEGIN
+
+/**
+ * \name Predefined CRC models.
+ *
+ * Each model expands to the width, polynomial (in normal, MSB first,
+ * notation) and bit order arguments of crcengine_init().
+ * \{
+ */
+/// CRC-16 used by XMODEM, same as crc16().
+#define CRC16_MODEL      16, 0x1021, false
+/// CRC-CCITT used by HDLC and AX.25, same as crc_ccitt().
+#define CRC_CCITT_MODEL  16, 0x1021, true
+/// CRC-8 used by Dallas/Maxim 1-wire devices, same as crc8().
+#define CRC8_MODEL        8, 0x31, true
+/// CRC-32 used by Ethernet, zlib and PNG, same as crc32().
+#define CRC32_MODEL      32, 0x04C11DB7UL, true
+/* \} */
+
+/**
+ * Declare the lookup table storage for an engine using \a slices slices.
+ */
+#define CRC_ENGINE_TABLE(name, slices)  uint32_t name[(slices)][256]
+
+/**
+ * CRC engine context.
+ */
+typedef struct CrcEngine
+{
+	uint32_t (*tab)[256]; ///< Lookup tables, one for each slice.
+	uint8_t width;        ///< CRC width in bits.
+	uint8_t slices;       ///< Number of lookup tables: 1, 4 or 8.
+	bool reflect;         ///< True if octets are processed LSB first.
+} CrcEngine;
+
+/**
+ * Initialize a CRC engine and generate its lookup tables.
+ *
+ * \param e       CRC engine context.
+ * \param width   CRC width in bits, from 8 to 32.
+ * \param poly    Generator polynomial in normal (MSB first) notation,
+ *                without the implicit x^width term.
+ * \param reflect True for LSB first (reflected) CRCs.
+ * \param tab     Storage for the lookup tables, see CRC_ENGINE_TABLE().
+ * \param slices  Number of tables in \a tab: 1, 4 or 8.
+ */
+void crcengine_init(CrcEngine *e, uint8_t width, uint32_t poly, bool reflect, uint32_t (*tab)[256], uint8_t slices);
+
+/**
+ * Update a CRC value with the content of a buffer.
+ *
+ * \param e   CRC engine context.
+ * \param crc Current CRC value.
+ * \param buf The buffer to perform CRC calculation on.
+ * \param len The length of the buffer.
+ *
+ * \return The updated CRC value.
+ */
+uint32_t crcengine_update(const CrcEngine *e, uint32_t crc, const void *buf, size_t len);
+
+EXTERN_C_END
+
+#endif /* ALGO_CRC_ENGINE_H */
@@ -38,14 +38,24 @@
 
 #include "crc_ccitt.h"
 #include "crc.h"
+#include "crc8.h"
+#include "crc32.h"
+#include "crc_engine.h"
 
 #include <cfg/debug.h>
 #include <cfg/test.h>
 
+#include <drv/timer.h>
+
+#include <stdlib.h> // rand()
+
+static CRC_ENGINE_TABLE(tab, 8);
+static uint8_t bench_buf[4096 + 8];
 
 int crc_testSetup(void)
 {
 	kdbg_init();
+	timer_init();
 	return 0;
 }
 
@@ -54,6 +64,106 @@ int crc_testTearDown(void)
 	return 0;
 }
 
+/*
+ * Bit at a time reference CRC, written independently of the engine
+ * and of the table driven implementations.
+ */
+static uint32_t crc_bitwise(uint8_t width, uint32_t poly, bool reflect, uint32_t crc, const uint8_t *buf, size_t len)
+{
+	uint32_t top = 1UL << (width - 1);
+	uint32_t mask = top | (top - 1);
+	uint32_t rpoly = 0;
+
+	for (int i = 0; i < width; i++)
+		if (poly & (1UL << i))
+			rpoly |= top >> i;
+
+	while (len--)
+	{
+		uint8_t c = *buf++;
+
+		for (int i = 0; i < 8; i++)
+		{
+			bool in = reflect ? (c >> i) & 1 : (c >> (7 - i)) & 1;
+
+			if (reflect)
+			{
+				bool out = crc & 1;
+				crc >>= 1;
+				if (out ^ in)
+					crc ^= rpoly;
+			}
+			else
+			{
+				bool out = (crc & top) != 0;
+				crc = (crc << 1) & mask;
+				if (out ^ in)
+					crc ^= poly;
+			}
+		}
+	}
+	return crc;
+}
+
+/*
+ * Check the engine with the published check value ("123456789") of each
+ * model, then against the bitwise reference for every combination of
+ * misaligned start and odd length, which exercises the slicing paths.
+ */
+static void crc_engineModel(CrcEngine *e, uint8_t width, uint32_t poly, bool reflect,
+	uint8_t slices, uint32_t init, uint32_t xorout, uint32_t check)
+{
+	crcengine_init(e, width, poly, reflect, tab, slices);
+	ASSERT((crcengine_update(e, init, "123456789", 9) ^ xorout) == check);
+
+	for (size_t off = 0; off < 8; off++)
+		for (size_t len = 0; len < 64; len++)
+			ASSERT(crcengine_update(e, init, bench_buf + off, len)
+				== crc_bitwise(width, poly, reflect, init, bench_buf + off, len));
+}
+
+static void crc_engineCheck(CrcEngine *e, uint8_t slices)
+{
+	crc_engineModel(e, CRC16_MODEL, slices, CRC16_INIT_VAL, 0, 0x31C3);
+	crc_engineModel(e, CRC_CCITT_MODEL, slices, CRC_CCITT_INIT_VAL, 0, 0x6F91);
+	crc_engineModel(e, CRC8_MODEL, slices, CRC8INIT, 0, 0xA1);
+	crc_engineModel(e, CRC32_MODEL, slices, CRC32_INIT_VAL, 0xFFFFFFFFUL, 0xCBF43926UL);
+}
+
+static void crc_engineBenchmark(CrcEngine *e, uint8_t slices)
+{
+	enum { CYCLES = 2048 };
+	uint32_t crc = CRC_CCITT_INIT_VAL;
+	ticks_t t;
+
+	if (slices == 1)
+	{
+		t = timer_clock();
+		for (int i = 0; i < CYCLES; i++)
+			crc = crc_ccitt(crc, bench_buf, sizeof(bench_buf));
+		t = timer_clock() - t;
+		kprintf("crc_ccitt: %lu KiB/s\n",
+			(unsigned long)((uint64_t)sizeof(bench_buf) * CYCLES * 1000000 / 1024 / MAX(ticks_to_us(t), (utime_t)1)));
+	}
+
+	crcengine_init(e, CRC_CCITT_MODEL, tab, slices);
+	t = timer_clock();
+	for (int i = 0; i < CYCLES; i++)
+		crc = crcengine_update(e, crc, bench_buf, sizeof(bench_buf));
+	t = timer_clock() - t;
+	kprintf("crc_engine CRC-CCITT, %d slices: %lu KiB/s\n", slices,
+		(unsigned long)((uint64_t)sizeof(bench_buf) * CYCLES * 1000000 / 1024 / MAX(ticks_to_us(t), (utime_t)1)));
+
+	crcengine_init(e, CRC32_MODEL, tab, slices);
+	t = timer_clock();
+	for (int i = 0; i < CYCLES; i++)
+		crc = crcengine_update(e, crc, bench_buf, sizeof(bench_buf));
+	t = timer_clock() - t;
+	kprintf("crc_engine CRC-32, %d slices: %lu KiB/s [%08lX]\n", slices,
+		(unsigned long)((uint64_t)sizeof(bench_buf) * CYCLES * 1000000 / 1024 / MAX(ticks_to_us(t), (utime_t)1)),
+		(unsigned long)crc);
+}
+
 int crc_testRun(void)
 {
 	char vector[9] = "123456789";
@@ -69,6 +179,24 @@ int crc_testRun(void)
 	kprintf("crc16 [%04X]\n", crc);
 	ASSERT(crc == 0x31C3);
 
+	ASSERT(crc8((uint8_t *)vector, sizeof(vector)) == 0xA1);
+
+	uint32_t crc32_val = crc32(CRC32_INIT_VAL, vector, sizeof(vector)) ^ CRC32_INIT_VAL;
+	kprintf("crc32 [%08lX]\n", (unsigned long)crc32_val);
+	ASSERT(crc32_val == 0xCBF43926UL);
+
+	for (size_t i = 0; i < sizeof(bench_buf); i++)
+		bench_buf[i] = rand();
+
+	static const uint8_t slices[] = { 1, 4, 8 };
+	for (unsigned s = 0; s < countof(slices); s++)
+	{
+		CrcEngine e;
+
+		crc_engineCheck(&e, slices[s]);
+		crc_engineBenchmark(&e, slices[s]);
+	}
+
 	return  0;
 }
 
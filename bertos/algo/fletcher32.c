@@ -38,6 +38,31 @@
 #include "fletcher32.h"
 
 #include <cfg/macros.h> //MIN()
+#include <cpu/attr.h>   //CPU_REG_BITS
+
+/*
+ * Sums are reduced modulo 65535 only once per block: the block length is
+ * the largest number of 16 bit words that can be added without overflowing
+ * the accumulators, starting from fully reduced sums.
+ * On 64 bit CPUs the accumulators are as wide as a register, so the
+ * reduction is deferred for a much longer run.
+ */
+#if CPU_REG_BITS >= 64
+	typedef uint64_t fletcher_sum_t;
+	#define FLETCHER32_NMAX  (1UL << 20)
+#else
+	typedef uint32_t fletcher_sum_t;
+	#define FLETCHER32_NMAX  360
+#endif
+
+#define FLETCHER32_WORD(b, i)  ((fletcher_sum_t)((b)[2 * (i)] | (b)[2 * (i) + 1] << 8))
+
+INLINE fletcher_sum_t fletcher32_reduce(fletcher_sum_t sum)
+{
+	while (sum > 0xffff)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return sum;
+}
 
 void fletcher32_init(Fletcher32 *f)
 {
@@ -48,41 +73,56 @@ void fletcher32_init(Fletcher32 *f)
 
 void fletcher32_update(Fletcher32 *f, const void *_buf, size_t len)
 {
-	uint16_t data = 0;
 	const uint8_t *buf = (const uint8_t *)_buf;
-	uint8_t last = buf[len-1];
+	fletcher_sum_t sum1 = f->sum1;
+	fletcher_sum_t sum2 = f->sum2;
 
-	if (f->carry != -1 && len)
+	if (!len)
+		return;
+
+	if (f->carry != -1)
 	{
-		data = f->carry | *buf++ << 8;
+		sum1 += f->carry | *buf++ << 8;
+		sum2 += sum1;
+		sum1 = fletcher32_reduce(sum1);
+		sum2 = fletcher32_reduce(sum2);
 		f->carry = -1;
-		++len;
-	}
-	else if (len > 1)
-	{
-		data = buf[0] | buf[1] << 8;
-		buf += 2;
+		--len;
 	}
 
 	if (len & 1)
-		f->carry = last;
+		f->carry = buf[len - 1];
 
 	size_t l = len / 2;
 	while (l)
 	{
-		size_t tlen = MIN(l, (size_t)360);
+		size_t tlen = MIN(l, (size_t)FLETCHER32_NMAX);
 		l -= tlen;
-		do
+
+		for (; tlen >= 4; tlen -= 4)
 		{
-			f->sum1 += data;
-			f->sum2 += f->sum1;
-			data = buf[0] | buf[1] << 8;
+			sum1 += FLETCHER32_WORD(buf, 0);
+			sum2 += sum1;
+			sum1 += FLETCHER32_WORD(buf, 1);
+			sum2 += sum1;
+			sum1 += FLETCHER32_WORD(buf, 2);
+			sum2 += sum1;
+			sum1 += FLETCHER32_WORD(buf, 3);
+			sum2 += sum1;
+			buf += 8;
+		}
+		while (tlen--)
+		{
+			sum1 += FLETCHER32_WORD(buf, 0);
+			sum2 += sum1;
 			buf += 2;
 		}
-		while (--tlen);
-		f->sum1 = (f->sum1 & 0xffff) + (f->sum1 >> 16);
-		f->sum2 = (f->sum2 & 0xffff) + (f->sum2 >> 16);
+		sum1 = fletcher32_reduce(sum1);
+		sum2 = fletcher32_reduce(sum2);
 	}
+
+	f->sum1 = sum1;
+	f->sum2 = sum2;
 }
 
 uint32_t fletcher32_final(Fletcher32 *f)
@@ -95,13 +135,11 @@ uint32_t fletcher32_final(Fletcher32 *f)
 	{
 		sum1 += f->carry;
 		sum2 += sum1;
-		sum1 = (sum1 & 0xffff) + (sum1 >> 16);
-		sum2 = (sum2 & 0xffff) + (sum2 >> 16);
 	}
 
-	/* Second reduction step to reduce sums to 16 bits */
-	sum1 = (sum1 & 0xffff) + (sum1 >> 16);
-	sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+	/* Reduce sums to 16 bits */
+	sum1 = fletcher32_reduce(sum1);
+	sum2 = fletcher32_reduce(sum2);
 
 	return sum2 << 16 | sum1;
 }
@@ -39,6 +39,7 @@
 
 #include <cfg/test.h>
 #include <cfg/debug.h>
+#include <cfg/macros.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -538,6 +539,20 @@ int fletcher32_testRun(void)
 	free(start);
 	kprintf("ft1 %04lX, ft2 %04lX\n", ft1, ft2);
 	ASSERT(ft1 == ft2);
+
+	/* Worst case for overflow: long runs of 0xff, with odd sized chunks */
+	enum { LONG_LEN = 70001 };
+	b = malloc(LONG_LEN);
+	ASSERT(b);
+	memset(b, 0xff, LONG_LEN);
+	fletcher32_init(&ft);
+	for (size_t off = 0; off < LONG_LEN; off += 777)
+		fletcher32_update(&ft, b + off, MIN((size_t)777, LONG_LEN - off));
+	ft1 = fletcher32_final(&ft);
+	ft2 = fletcher32_b(b, LONG_LEN);
+	free(b);
+	kprintf("ft1 %04lX, ft2 %04lX\n", ft1, ft2);
+	ASSERT(ft1 == ft2);
 	return 0;
 }
 
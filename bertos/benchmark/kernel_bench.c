@@ -0,0 +1,343 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Kernel primitives microbenchmark suite.
+ *
+ * Every benchmark is played by a measuring process A and, when needed, a
+ * partner process B, created afresh on static stacks. A loops until the
+ * stop timer fires, then tells B to quit with one last operation.
+ */
+
+#include "kernel_bench.h"
+
+#include "cfg/cfg_kernel_bench.h"
+#include <cfg/debug.h>
+
+#include <cpu/irq.h>
+
+#include <drv/timer.h>
+
+#include <kern/proc.h>
+#include <kern/signal.h>
+#include <kern/sem.h>
+#include <kern/msg.h>
+
+#include <mware/event.h>
+
+#define BENCH_STACK_SIZE  KERN_MINSTACKSIZE
+
+static PROC_DEFINE_STACK(a_stack, BENCH_STACK_SIZE);
+static PROC_DEFINE_STACK(b_stack, BENCH_STACK_SIZE);
+
+typedef struct KernelBench
+{
+	const char *name;
+	void (*a)(void);      /* Measuring process */
+	void (*b)(void);      /* Partner process, or NULL */
+	void (*setup)(void);  /* Called once both processes exist, or NULL */
+	bool fpu;             /* The processes have their own FPU control words */
+} KernelBench;
+
+static const KernelBench *cur;
+static Process *main_proc, *proc_a, *proc_b;
+static int done;
+
+static Timer stop_timer;
+static volatile bool stop;  /* Time is over, set by stop_timer */
+static volatile bool quit;  /* B must exit, set by A */
+
+/* Result of the current benchmark, set by A */
+static uint32_t bench_ops;
+static uint32_t bench_time;  /* [hpticks] */
+
+static void bench_end(uint32_t start, uint32_t ops)
+{
+	bench_time = timer_hpclock() - start;
+	bench_ops = ops;
+	quit = true;
+}
+
+/* Two ready processes passing the CPU to each other: 2 switches per loop */
+static void yield_a(void)
+{
+	uint32_t start = timer_hpclock(), n = 0;
+
+	while (!stop)
+	{
+		proc_yield();
+		n++;
+	}
+	bench_end(start, n * 2);
+}
+
+static void yield_b(void)
+{
+	while (!quit)
+		proc_yield();
+}
+
+/* Signal ping-pong: 2 wakeups per loop */
+static void signal_a(void)
+{
+	uint32_t start = timer_hpclock(), n = 0;
+
+	while (!stop)
+	{
+		sig_send(proc_b, SIG_USER0);
+		sig_wait(SIG_USER1);
+		n++;
+	}
+	bench_end(start, n * 2);
+	sig_send(proc_b, SIG_USER0);
+}
+
+static void signal_b(void)
+{
+	for (;;)
+	{
+		sig_wait(SIG_USER0);
+		if (quit)
+			break;
+		sig_send(proc_a, SIG_USER1);
+	}
+}
+
+/*
+ * Both processes yield while holding the semaphore, so the other one is
+ * always waiting for it when it is released: 2 handoffs per loop.
+ */
+static Semaphore sem;
+
+static void sem_setup(void)
+{
+	sem_init(&sem);
+}
+
+static void sem_a(void)
+{
+	uint32_t start = timer_hpclock(), n = 0;
+
+	while (!stop)
+	{
+		sem_obtain(&sem);
+		proc_yield();
+		sem_release(&sem);
+		n++;
+	}
+	bench_end(start, n * 2);
+}
+
+static void sem_b(void)
+{
+	while (!quit)
+	{
+		sem_obtain(&sem);
+		proc_yield();
+		sem_release(&sem);
+	}
+}
+
+/* A message sent to B and replied back to A */
+static MsgPort port_a, port_b;
+static Msg msg;
+
+static void msg_setup(void)
+{
+	msg_initPort(&port_a, event_createSignal(proc_a, SIG_USER1));
+	msg_initPort(&port_b, event_createSignal(proc_b, SIG_USER0));
+	msg.replyPort = &port_a;
+}
+
+static void msg_a(void)
+{
+	uint32_t start = timer_hpclock(), n = 0;
+
+	while (!stop)
+	{
+		msg_put(&port_b, &msg);
+		sig_wait(SIG_USER1);
+		msg_get(&port_a);
+		n++;
+	}
+	bench_end(start, n);
+	msg_put(&port_b, &msg);
+}
+
+static void msg_b(void)
+{
+	for (;;)
+	{
+		sig_wait(SIG_USER0);
+		Msg *m = msg_get(&port_b);
+		if (quit)
+			break;
+		msg_reply(m);
+	}
+}
+
+/* B selects on two events, A waits for an acknowledge: 2 wakeups per loop */
+static Event evs[2], ack;
+
+static void event_setup(void)
+{
+	event_initGeneric(&evs[0]);
+	event_initGeneric(&evs[1]);
+	event_initGeneric(&ack);
+}
+
+static void event_a(void)
+{
+	uint32_t start = timer_hpclock(), n = 0;
+
+	while (!stop)
+	{
+		event_do(&evs[n & 1]);
+		event_wait(&ack);
+		n++;
+	}
+	bench_end(start, n * 2);
+	event_do(&evs[0]);
+}
+
+static void event_b(void)
+{
+	Event *list[] = { &evs[0], &evs[1] };
+
+	for (;;)
+	{
+		event_select(list, countof(list), 0);
+		if (quit)
+			break;
+		event_do(&ack);
+	}
+}
+
+/* Latency from the timer interrupt to the process waiting the timer */
+static uint32_t timer_fired;
+
+static void timer_expired(UNUSED_ARG(void *, arg))
+{
+	timer_fired = timer_hpclock();
+	sig_post(proc_a, SIG_USER0);
+}
+
+static void timer_a(void)
+{
+	uint32_t latency = 0, n = 0;
+	Timer t;
+
+	timer_setSoftint(&t, timer_expired, 0);
+	while (!stop)
+	{
+		timer_setDelay(&t, 1);
+		timer_add(&t);
+		sig_wait(SIG_USER0);
+		latency += timer_hpclock() - timer_fired;
+		n++;
+	}
+	bench_time = latency;
+	bench_ops = n;
+}
+
+static const KernelBench benches[] =
+{
+	{ "yield",             yield_a,  yield_b,  NULL,        false },
+#if CONFIG_KERN_FPU_CTRL
+	{ "yield fpu ctrl",    yield_a,  yield_b,  NULL,        true  },
+#endif
+	{ "signal wake",       signal_a, signal_b, NULL,        false },
+	{ "sem handoff",       sem_a,    sem_b,    sem_setup,   false },
+	{ "msg round trip",    msg_a,    msg_b,    msg_setup,   false },
+	{ "event wake",        event_a,  event_b,  event_setup, false },
+	{ "timer wakeup",      timer_a,  NULL,     NULL,        false },
+};
+
+static void bench_stop(UNUSED_ARG(void *, arg))
+{
+	stop = true;
+}
+
+static void bench_proc(void)
+{
+	if (cur->fpu)
+		proc_useFpuCtrl();
+
+	if (proc_currentUserData())
+		cur->b();
+	else
+		cur->a();
+
+	ATOMIC(done++);
+	sig_send(main_proc, SIG_USER2);
+}
+
+static void bench_run(const KernelBench *b, KernelBenchResult *res)
+{
+	int procs = b->b ? 2 : 1;
+
+	cur = b;
+	stop = quit = false;
+	done = 0;
+
+	proc_forbid();
+	proc_a = proc_new(bench_proc, NULL, sizeof(a_stack), a_stack);
+	proc_b = b->b ? proc_new(bench_proc, (iptr_t)1, sizeof(b_stack), b_stack) : NULL;
+	if (b->setup)
+		b->setup();
+
+	timer_setSoftint(&stop_timer, bench_stop, 0);
+	timer_setDelay(&stop_timer, ms_to_ticks(CONFIG_KERNEL_BENCH_TIME));
+	timer_add(&stop_timer);
+	proc_permit();
+
+	while (done < procs)
+		sig_wait(SIG_USER2);
+
+	res->name = b->name;
+	res->ops = bench_ops;
+	res->ns = bench_ops ? (uint32_t)((uint64_t)bench_time * 1000000000UL
+		/ TIMER_HW_HPTICKS_PER_SEC / bench_ops) : 0;
+
+	kprintf("%-18s %9lu ops %8lu ns\n", res->name,
+		(unsigned long)res->ops, (unsigned long)res->ns);
+}
+
+int kernel_bench(KernelBenchResult *res)
+{
+	STATIC_ASSERT(countof(benches) <= KERNEL_BENCH_MAX);
+
+	main_proc = proc_current();
+	for (unsigned i = 0; i < countof(benches); i++)
+		bench_run(&benches[i], &res[i]);
+
+	return countof(benches);
+}
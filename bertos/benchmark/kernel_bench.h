@@ -0,0 +1,87 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Kernel primitives microbenchmark suite.
+ *
+ * Each benchmark runs a couple of processes exchanging a kernel primitive
+ * for CONFIG_KERNEL_BENCH_TIME and reports the average cost of one
+ * operation in nanoseconds:
+ *  - yield: a proc_yield() between two ready processes (one switch);
+ *  - yield fpu ctrl: the same between two processes with their own FPU
+ *    control words;
+ *  - signal wake: a sig_send() to a waiting process, until it runs;
+ *  - sem handoff: a sem_release() passing the semaphore to a waiter;
+ *  - msg round trip: msg_put() to a port and msg_reply() back;
+ *  - event_select wake: an event_do() on one of the events waited by
+ *    event_select(), until the waiter runs;
+ *  - timer wakeup: from the expiry of a timer in the timer interrupt to
+ *    the process waiting for it.
+ *
+ * Only the hpclock is needed, so the suite runs under the emulator too.
+ *
+ * $WIZ$ module_name = "kernel_bench"
+ * $WIZ$ module_depends = "kern", "signal", "msg", "semaphores", "event", "timer"
+ * $WIZ$ module_configuration = "bertos/cfg/cfg_kernel_bench.h"
+ */
+
+#ifndef BENCHMARK_KERNEL_BENCH_H
+#define BENCHMARK_KERNEL_BENCH_H
+
+#include <cfg/compiler.h>
+
+/** Result of a benchmark. */
+typedef struct KernelBenchResult
+{
+	const char *name;  ///< Name of the benchmark.
+	uint32_t ops;      ///< Operations done.
+	uint32_t ns;       ///< Average time of an operation [ns].
+} KernelBenchResult;
+
+/** Max number of results returned by kernel_bench(). */
+#define KERNEL_BENCH_MAX  7
+
+/**
+ * Run the benchmark suite and print a report on the debug console.
+ *
+ * The kernel and the timer must be initialized. The calling process
+ * sleeps while the benchmarks run.
+ *
+ * \param res Array of KERNEL_BENCH_MAX results, filled in order.
+ * \return The number of benchmarks run.
+ */
+int kernel_bench(KernelBenchResult *res);
+
+int kernel_bench_testRun(void);
+int kernel_bench_testSetup(void);
+int kernel_bench_testTearDown(void);
+
+#endif /* BENCHMARK_KERNEL_BENCH_H */
@@ -0,0 +1,175 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Kernel microbenchmark suite test.
+ *
+ * Two processes with their own FPU control words, using different rounding
+ * modes, and a plain one yield to each other: each of the first two must
+ * always compute with its own rounding mode, and the plain one with the
+ * power-on control words. Then the whole suite is run and every benchmark
+ * must report some operations.
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: echo  "#undef CONFIG_KERN_PRI" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN_PRI 1" >> $cfgdir/cfg_proc.h
+ * $test$: echo  "#undef CONFIG_KERN_PREEMPT" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN_PREEMPT 1" >> $cfgdir/cfg_proc.h
+ * $test$: echo  "#undef CONFIG_KERN_FPU_CTRL" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN_FPU_CTRL 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_kernel_bench.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERNEL_BENCH_TIME" >> $cfgdir/cfg_kernel_bench.h
+ * $test$: echo "#define CONFIG_KERNEL_BENCH_TIME 200" >> $cfgdir/cfg_kernel_bench.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include "kernel_bench.h"
+
+#include <cfg/debug.h>
+#include <cfg/test.h>
+
+#include <cpu/fpu.h>
+
+#include <drv/timer.h>
+
+#include <kern/proc.h>
+#include <kern/signal.h>
+
+#define ROUNDS  1000
+
+/* SSE rounding control: round down and round up */
+static const uint32_t rounding[] = { 0x2000, 0x4000 };
+
+static PROC_DEFINE_STACK(fpu_stack[countof(rounding)], KERN_MINSTACKSIZE);
+static PROC_DEFINE_STACK(plain_stack, KERN_MINSTACKSIZE);
+
+static Process *main_proc;
+static volatile float one = 1, three = 3;
+static float third[countof(rounding)];
+static int errors, finished;
+
+static void fpu_proc(void)
+{
+	ssize_t n = (ssize_t)proc_currentUserData();
+	CpuFpuCtrl ctx = CPU_FPU_CTRL_INIT;
+
+	proc_useFpuCtrl();
+	ctx.mxcsr |= rounding[n];
+	cpu_fpuCtrlRestore(&ctx);
+
+	third[n] = one / three;
+	for (int i = 0; i < ROUNDS; i++)
+	{
+		proc_yield();
+		if (one / three != third[n])
+			errors++;
+	}
+
+	ATOMIC(finished++);
+	sig_send(main_proc, SIG_USER0);
+}
+
+static void plain_proc(void)
+{
+	static const CpuFpuCtrl init = CPU_FPU_CTRL_INIT;
+	CpuFpuCtrl ctx;
+
+	for (int i = 0; i < ROUNDS; i++)
+	{
+		proc_yield();
+		cpu_fpuCtrlSave(&ctx);
+		if (ctx.mxcsr != init.mxcsr || ctx.fcw != init.fcw)
+			errors++;
+	}
+
+	ATOMIC(finished++);
+	sig_send(main_proc, SIG_USER0);
+}
+
+static int check_fpu(void)
+{
+	finished = 0;
+	for (unsigned i = 0; i < countof(rounding); i++)
+		proc_new(fpu_proc, (iptr_t)(ssize_t)i, sizeof(fpu_stack[i]), fpu_stack[i]);
+	proc_new(plain_proc, NULL, sizeof(plain_stack), plain_stack);
+
+	while (finished < (int)countof(rounding) + 1)
+		sig_wait(SIG_USER0);
+
+	kprintf("FPU control words: %d errors\n", errors);
+	return (errors || third[0] == third[1]) ? -1 : 0;
+}
+
+int kernel_bench_testRun(void)
+{
+	KernelBenchResult res[KERNEL_BENCH_MAX];
+	int n;
+
+	if (check_fpu())
+	{
+		kprintf("FPU control words not preserved\n");
+		return -1;
+	}
+
+	n = kernel_bench(res);
+	for (int i = 0; i < n; i++)
+		if (!res[i].ops || !res[i].ns)
+		{
+			kprintf("%s: no result\n", res[i].name);
+			return -1;
+		}
+	return 0;
+}
+
+int kernel_bench_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+	proc_init();
+	main_proc = proc_current();
+	return 0;
+}
+
+int kernel_bench_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(kernel_bench);
+
+#include "kernel_bench.c"
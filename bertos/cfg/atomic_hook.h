@@ -0,0 +1,72 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Hooks run inside every ATOMIC() section.
+ *
+ * cpu/irq.h expands ATOMIC_HOOK_BEGIN right after disabling the
+ * interrupts and ATOMIC_HOOK_END right before restoring them, at the
+ * start and at the end of a block: the begin hook may declare variables
+ * for the end one. With
+ * CONFIG_KERN_IRQSTAT they measure the section, see kern/irqstat.h,
+ * otherwise they are empty.
+ */
+
+#ifndef CFG_ATOMIC_HOOK_H
+#define CFG_ATOMIC_HOOK_H
+
+#include "cfg/cfg_proc.h"
+
+#include <cfg/compiler.h>
+
+#ifndef CONFIG_KERN_IRQSTAT
+	#define CONFIG_KERN_IRQSTAT 0
+#endif
+
+#if CONFIG_KERN_IRQSTAT
+	struct IrqStat;
+
+	/* From kern/irqstat.h */
+	uint32_t irqstat_now(void);
+	void irqstat_recordMasked(struct IrqStat **site, const char *name, uint16_t line, uint32_t start);
+
+	#define ATOMIC_HOOK_BEGIN \
+		static struct IrqStat *__irqstat_site; \
+		uint32_t __irqstat_start = irqstat_now();
+
+	#define ATOMIC_HOOK_END \
+		irqstat_recordMasked(&__irqstat_site, __func__, __LINE__, __irqstat_start);
+#else
+	#define ATOMIC_HOOK_BEGIN  /* Nothing */
+	#define ATOMIC_HOOK_END    /* Nothing */
+#endif
+
+#endif /* CFG_ATOMIC_HOOK_H */
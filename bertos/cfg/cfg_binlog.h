@@ -0,0 +1,71 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Deferred binary log configuration.
+ */
+
+#ifndef CFG_BINLOG_H
+#define CFG_BINLOG_H
+
+/**
+ * Route the LOG_* macros through the binary log instead of kprintf().
+ * $WIZ$ type = "boolean"
+ */
+#define CONFIG_BINLOG 0
+
+/**
+ * Size of the ring buffer in words, must be a power of 2.
+ * A record takes a word plus a word for each argument.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 16
+ */
+#define CONFIG_BINLOG_SIZE 512
+
+/**
+ * Interval between two runs of the drain process [ms].
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 1
+ */
+#define CONFIG_BINLOG_PERIOD 50
+
+/**
+ * Priority of the drain process. Keep it low, so that printing the
+ * records does not delay the processes producing them.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ conditional_deps = "CONFIG_KERN_PRI"
+ */
+#define CONFIG_BINLOG_PRI -10
+
+#endif /* CFG_BINLOG_H */
@@ -56,6 +56,16 @@
  */
 #define CONFIG_GFX_VCOORDS  1
 
+/**
+ * Track the area of a bitmap modified by drawing operations.
+ *
+ * Windows are then recomposed and LCD drivers refreshed only where
+ * the bitmap has actually changed. Code that writes the raster
+ * directly must then call gfx_markDirty() on the area it touches.
+ * $WIZ$ type = "boolean"
+ */
+#define CONFIG_GFX_DIRTY  0
+
 /**
  * Select bitmap pixel format.
  * $WIZ$ type = "enum"
@@ -118,6 +118,24 @@
  */
 #define CONFIG_KISS_DEFAULT_HWARE 0
 
+/**
+ * Number of modem ports served by a KISS context.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 1
+ * $WIZ$ max = 16
+ */
+#define CONFIG_KISS_PORTS 1
+
+/**
+ * Number of frames from the host that can wait for the radio channel,
+ * including the one being received.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 1
+ */
+#define CONFIG_KISS_TXQUEUE_LEN 2
+
 
 
 #endif /* CFG_KISS_H */
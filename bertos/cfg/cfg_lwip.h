@@ -1061,7 +1061,32 @@
  * sys_mbox_new() when tcpip_init is called.
  */
 #ifndef TCPIP_MBOX_SIZE
-#define TCPIP_MBOX_SIZE                 0
+#define TCPIP_MBOX_SIZE                 16
+#endif
+
+/**
+ * TCPIP_MSG_BATCH: The maximum number of queued messages handled by the
+ * tcpip thread in a row, before looking at its timeouts again.
+ */
+#ifndef TCPIP_MSG_BATCH
+#define TCPIP_MSG_BATCH                 8
+#endif
+
+/**
+ * SYS_MBOX_SIZE: The largest mailbox, in messages. Mailboxes are created
+ * with this size when lwIP asks for size 0, and their storage is
+ * statically allocated.
+ */
+#ifndef SYS_MBOX_SIZE
+#define SYS_MBOX_SIZE                   16
+#endif
+
+/**
+ * SYS_THREAD_STACKS: Memory reserved to the stacks of the lwIP threads
+ * when the kernel heap is disabled.
+ */
+#ifndef SYS_THREAD_STACKS
+#define SYS_THREAD_STACKS               (TCPIP_THREAD_STACKSIZE + DEFAULT_THREAD_STACKSIZE)
 #endif
 
 /**
@@ -44,4 +44,37 @@
  */
 #define CONFIG_KERN_MONITOR 0
 
+/**
+ * Period of the monitor process [ms].
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 1
+ */
+#define CONFIG_KERN_MONITOR_PERIOD 500
+
+/**
+ * Stack words checked by the monitor process at each run.
+ *
+ * The scheduler is disabled while they are checked, so this bounds the
+ * latency added by the monitor.
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 1
+ */
+#define CONFIG_KERN_MONITOR_SCAN 64
+
+/**
+ * Free stack below which the monitor raises an alert [bytes].
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 0
+ */
+#define CONFIG_KERN_MONITOR_MARGIN 32
+
+/**
+ * Sample the stack pointer of each process when it gets the CPU.
+ *
+ * The stack watermarks follow the processes between two runs of the
+ * monitor, at the cost of a few instructions per context switch.
+ * $WIZ$ type = "boolean"
+ */
+#define CONFIG_KERN_MONITOR_SAMPLE_SP 0
+
 #endif /*  CFG_MONITOR_H */
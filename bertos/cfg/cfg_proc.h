@@ -80,6 +80,67 @@
  */
 #define CONFIG_KERN_PRI_INHERIT 0
 
+/**
+ * Immediate priority-ceiling protocol for the semaphores initialized
+ * with sem_initCeiling().
+ *
+ * The owner of such a semaphore runs at the ceiling priority while it
+ * holds it: locking and unlocking take constant time and nested locks
+ * can not deadlock. Needs CONFIG_KERN_PRI.
+ *
+ * $WIZ$ type = "boolean"
+ */
+#define CONFIG_KERN_PRI_CEILING 0
+
+/**
+ * Earliest deadline first scheduling class, see kern/edf.h.
+ *
+ * Processes with a period and a CPU budget run before the ones of the
+ * priority class, the one with the earliest deadline first.
+ * Needs CONFIG_KERN_PRI, budgets are enforced only with CONFIG_KERN_PREEMPT.
+ *
+ * $WIZ$ type = "boolean"
+ * $WIZ$ conditional_deps = "timer"
+ */
+#define CONFIG_KERN_EDF 0
+
+/**
+ * Preserve the FPU control words (rounding mode, precision, exception
+ * masks) of the processes that call proc_useFpuCtrl().
+ *
+ * The other processes run with the power-on control words, so switching
+ * between two of them costs nothing. The FPU data registers are not saved.
+ *
+ * $WIZ$ type = "boolean"
+ */
+#define CONFIG_KERN_FPU_CTRL 0
+
+/**
+ * Per-process CPU time, context switch and dispatch latency accounting.
+ *
+ * Adds a couple of timer reads to every context switch.
+ * $WIZ$ type = "boolean"
+ * $WIZ$ conditional_deps = "timer"
+ */
+#define CONFIG_KERN_ACCOUNTING 0
+
+/**
+ * Interrupt statistics: run time of the interrupt handlers and time spent
+ * with interrupts masked by ATOMIC(), see kern/irqstat.h.
+ *
+ * $WIZ$ type = "boolean"
+ * $WIZ$ conditional_deps = "timer"
+ */
+#define CONFIG_KERN_IRQSTAT 0
+
+/**
+ * Max number of interrupt handlers and ATOMIC() sections tracked.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 1
+ */
+#define CONFIG_KERN_IRQSTAT_SITES 32
+
 /**
  * Dynamic memory allocation for processes.
  * $WIZ$ type = "boolean"
@@ -0,0 +1,65 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Protothreads module configuration.
+ */
+
+#ifndef CFG_PT_H
+#define CFG_PT_H
+
+/**
+ * Stack size of the process running the protothreads.
+ *
+ * All the protothreads share this stack, each one using it only while
+ * it runs.
+ *
+ * $WIZ$ type = "int"
+ */
+#define CONFIG_PT_STACK KERN_MINSTACKSIZE
+
+/**
+ * Priority of the process running the protothreads.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ conditional_deps = "CONFIG_KERN_PRI"
+ */
+#define CONFIG_PT_PRI 0
+
+/**
+ * Interval in ms between two checks of the PT_WAIT_UNTIL() conditions.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 1
+ */
+#define CONFIG_PT_POLL 10
+
+#endif /* CFG_PT_H */
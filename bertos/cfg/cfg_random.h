@@ -62,4 +62,22 @@
  */
 #define RANDOM_SECURITY_LEVEL          RANDOM_SECURITY_MINIMUM
 
+/**
+ * Use the ChaCha20 generator instead of the default PRNG of the
+ * selected security level.
+ *
+ * $WIZ$ type = "boolean"
+ */
+#define CONFIG_RANDOM_CHACHA20         0
+
+/**
+ * Size in bytes of the keystream buffer used to serve small requests.
+ * The PRNG is invoked (and possibly reseeded) only once per buffer refill;
+ * set to 0 to call the PRNG on every request.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 0
+ */
+#define CONFIG_RANDOM_BUFFER_LEN       64
+
 #endif /* CFG_RANDOM_H */
@@ -45,12 +45,33 @@
 #define CONFIG_RTASK_POOL_SIZE 8
 
 /**
- * Stack size of the rtask process.
+ * Stack size of the rtask processes.
  *
  * $WIZ$ type = "int"
  */
 #define CONFIG_RTASK_STACK KERN_MINSTACKSIZE
 
+/**
+ * Number of worker processes running the tasks.
+ *
+ * A slow task only delays the others when all the workers are busy.
+ * Each worker needs a stack of CONFIG_RTASK_STACK bytes.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 1
+ */
+#define CONFIG_RTASK_WORKERS 1
+
+/**
+ * Priority of the rtask dispatcher process.
+ *
+ * Keep it above the priority of the tasks, so that they are started on
+ * time. Used only with CONFIG_KERN_PRI.
+ *
+ * $WIZ$ type = "int"
+ */
+#define CONFIG_RTASK_PRI 1
+
 /**
  * Module logging level.
  *
@@ -66,5 +66,34 @@
  */
 #define CONFIG_SYSLOG_BUFSIZE 256
 
+/**
+ * Size of the queue holding the messages not sent yet.
+ * Messages that do not fit are dropped.
+ *
+ * $WIZ$ type = "int"; min = 2
+ */
+#define CONFIG_SYSLOG_QUEUE   1024
+
+/**
+ * Max datagram length, must be greater than the message length.
+ *
+ * $WIZ$ type = "int"
+ */
+#define CONFIG_SYSLOG_DATAGRAM 512
+
+/**
+ * Send several messages in each datagram, one per line.
+ *
+ * $WIZ$ type = "boolean"
+ */
+#define CONFIG_SYSLOG_COALESCE 1
+
+/**
+ * Max datagrams sent each second, 0 for no limit.
+ *
+ * $WIZ$ type = "int"; min = 0
+ */
+#define CONFIG_SYSLOG_RATE    0
+
 
 #endif /* CFG_SYSLOG_H */
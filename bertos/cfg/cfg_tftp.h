@@ -54,4 +54,29 @@
  */
 #define TFTP_LOG_FORMAT   LOG_FMT_VERBOSE
 
+/**
+ * Largest data block accepted with the blksize option (RFC 2348).
+ *
+ * Every session keeps a receive buffer of this size. The default fits
+ * a block in a single Ethernet frame; use 512 to refuse larger blocks.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 512
+ * $WIZ$ max = 65464
+ */
+#define CONFIG_TFTP_BLKSIZE      1428
+
+/**
+ * Largest number of blocks accepted with the windowsize option (RFC 7440).
+ *
+ * The client sends this many blocks before waiting for an ACK; they are
+ * queued in the lwIP socket meanwhile, so keep it below the UDP receive
+ * mailbox size. Use 1 for the lock-step transfers of RFC 1350.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 1
+ * $WIZ$ max = 65535
+ */
+#define CONFIG_TFTP_WINDOWSIZE   4
+
 #endif /* CFG_TFTP_H */
@@ -94,6 +94,10 @@
  * must be defined before including the log module. Otherwise the log module
  * will use the default settings.
  *
+ * With CONFIG_BINLOG enabled in cfg_binlog.h the messages are not formatted
+ * by the caller: they are stored in a ring buffer and printed later, see
+ * mware/binlog.h for the restrictions on the arguments.
+ *
  * \author Daniele Basile <asterix@develer.com>
  *
  * $WIZ$
@@ -146,11 +150,15 @@
 /** \} */
 
 #include "cfg/cfg_syslog.h"
+#include "cfg/cfg_binlog.h"
 
 /* For backward compatibility */
 #ifndef CONFIG_SYSLOG_NET
 	#define CONFIG_SYSLOG_NET 0
 #endif
+#ifndef CONFIG_BINLOG
+	#define CONFIG_BINLOG 0
+#endif
 
 #if (CONFIG_SYSLOG_NET && (!defined(ARCH_NIGHTTEST) || !(ARCH & ARCH_NIGHTTEST)))
 	#include <net/syslog.h>
@@ -163,6 +171,18 @@
 		#error No LOG_FORMAT defined
 	#endif
 
+#elif CONFIG_BINLOG
+	#include <mware/binlog.h>
+
+	/* The line number and the level are folded in the format string */
+	#if LOG_FORMAT == LOG_FMT_VERBOSE
+		#define LOG_PRINT(str_level, str,...)    BINLOG("%s():" PP_STRINGIZE(__LINE__) ":" str_level ": " str, __func__, ## __VA_ARGS__)
+	#elif LOG_FORMAT == LOG_FMT_TERSE
+		#define LOG_PRINT(str_level, str,...)    BINLOG(str_level ": " str, ## __VA_ARGS__)
+	#else
+		#error No LOG_FORMAT defined
+	#endif
+
 #else
 	#if LOG_FORMAT == LOG_FMT_VERBOSE
 		#define LOG_PRINT(str_level, str,...)    kprintf("%s():%d:%s: " str, __func__, __LINE__, str_level, ## __VA_ARGS__)
@@ -0,0 +1,95 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief FPU control words of the CPU.
+ *
+ * The kernel keeps a copy of the control words (rounding mode, precision,
+ * exception masks) for the processes that call proc_useFpuCtrl(), and
+ * loads them when one of those processes takes the CPU. The other
+ * processes get the power-on control words, CPU_FPU_CTRL_INIT.
+ *
+ * This is not a full floating point context switch: there is no first-use
+ * trap and the data registers are never saved by the kernel. They are
+ * caller-saved, and asm_switch_context() is called like a normal function,
+ * so the compiler has already spilled them on a voluntary switch. On
+ * preemption they must be saved by the interrupt entry code of the port,
+ * as the emulator does with the signal frame.
+ */
+
+#ifndef CPU_FPU_H
+#define CPU_FPU_H
+
+#include <cpu/detect.h>
+
+#include <cfg/compiler.h>
+
+#if CPU_X86
+	/*
+	 * The x87 and SSE data registers are caller-saved, while the
+	 * control words (rounding mode, precision and exception masks)
+	 * are preserved across calls.
+	 */
+	#define CPU_HAS_FPU  1
+
+	typedef struct CpuFpuCtrl
+	{
+		uint32_t mxcsr;  /**< SSE control and status register */
+		uint16_t fcw;    /**< x87 control word */
+	} CpuFpuCtrl;
+
+	/** Power-on state of the floating point unit. */
+	#define CPU_FPU_CTRL_INIT  { 0x1F80, 0x037F }
+
+	INLINE void cpu_fpuCtrlSave(CpuFpuCtrl *ctx)
+	{
+		asm volatile("stmxcsr %0\n\tfnstcw %1" : "=m" (ctx->mxcsr), "=m" (ctx->fcw));
+	}
+
+	INLINE void cpu_fpuCtrlRestore(const CpuFpuCtrl *ctx)
+	{
+		asm volatile("ldmxcsr %0\n\tfldcw %1" : : "m" (ctx->mxcsr), "m" (ctx->fcw));
+	}
+#else
+	#define CPU_HAS_FPU  0
+
+	typedef struct CpuFpuCtrl
+	{
+		uint8_t dummy;
+	} CpuFpuCtrl;
+
+	#define CPU_FPU_CTRL_INIT  { 0 }
+
+	#define cpu_fpuCtrlSave(ctx)     ((void)(ctx))
+	#define cpu_fpuCtrlRestore(ctx)  ((void)(ctx))
+#endif
+
+#endif /* CPU_FPU_H */
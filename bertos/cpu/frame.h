@@ -250,6 +250,20 @@
 	 */
 	#define CPU_IDLE NOP
 
+#elif CPU_X86_64
+
+	/*
+	 * The x86_64 ABI wants the stack aligned to 16 bytes before a call,
+	 * that is 8 bytes off at function entry: push a fake return address
+	 * on an aligned stack.
+	 */
+	#define CPU_PUSH_CALL_FRAME(sp, func) \
+		do { \
+			(sp) = (cpu_stack_t *)((uintptr_t)(sp) & ~(uintptr_t)15); \
+			CPU_PUSH_WORD((sp), 0); \
+			CPU_PUSH_WORD((sp), (cpu_stack_t)(func)); \
+		} while (0)
+
 #elif CPU_PPC
 
 	#define CPU_PUSH_CALL_FRAME(sp, func) \
@@ -47,6 +47,7 @@
 #include <kern/proc.h> /* proc_needPreempt() / proc_preempt() */
 
 #include <cfg/compiler.h> /* for uintXX_t */
+#include <cfg/atomic_hook.h> /* ATOMIC_HOOK_BEGIN / ATOMIC_HOOK_END */
 #include "cfg/cfg_proc.h" /* CONFIG_KERN_PREEMPT */
 
 #if CPU_I196
@@ -61,6 +62,18 @@
 		#define IRQ_ENABLE              FIXME
 		#define IRQ_SAVE_DISABLE(x)     FIXME
 		#define IRQ_RESTORE(x)          FIXME
+	#elif OS_POSIX && !OS_QT
+		/*
+		 * Emulated interrupts are signals: sleep until the next one.
+		 * sigsuspend() unblocks them and sleeps atomically, then blocks
+		 * them again, so a signal raised just before can't be missed.
+		 */
+		#define IRQ_WAIT \
+		do { \
+			sigset_t sigs__; \
+			sigemptyset(&sigs__); \
+			sigsuspend(&sigs__); \
+		} while (0)
 	#endif /* OS_EMBEDDED */
 
 #elif CPU_CM3
@@ -613,13 +626,20 @@
 /**
  * Execute \a CODE atomically with respect to interrupts.
  *
+ * With CONFIG_KERN_IRQSTAT enabled the time spent with interrupts masked
+ * is accounted to the calling function, see cfg/atomic_hook.h.
+ *
  * \see IRQ_SAVE_DISABLE IRQ_RESTORE
  */
 #define ATOMIC(CODE) \
 	do { \
 		cpu_flags_t __flags; \
 		IRQ_SAVE_DISABLE(__flags); \
-		CODE; \
+		{ \
+			ATOMIC_HOOK_BEGIN \
+			CODE; \
+			ATOMIC_HOOK_END \
+		} \
 		IRQ_RESTORE(__flags); \
 	} while (0)
 
@@ -125,6 +125,48 @@ INLINE bool eth_addrCmp(const uint8_t *addr1, const uint8_t *addr2)
 			(addr1[5] ^ addr2[5]));
 }
 
+/**
+ * \name Descriptor ring interface.
+ *
+ * Drivers with a DMA engine can exchange frames with the network stack
+ * without copying them: the stack lends its buffers to the driver, and the
+ * driver gives them back once the DMA is done with them.
+ *
+ * On the receive side the stack posts empty buffers with eth_rxPost(). The
+ * driver fills them with the incoming frames and eth_rxCollect() returns
+ * them in arrival order, as many as are ready. A frame longer than one
+ * buffer spans several descriptors; the last one has ETH_BUF_EOF set.
+ *
+ * On the transmit side eth_txPost() queues a frame described by a list of
+ * buffers, and eth_txCollect() returns the descriptors whose data has been
+ * sent, so that the stack can release the buffers.
+ *
+ * This interface is available when CONFIG_ETH_RING is set and replaces the
+ * copying one (eth_putFrame(), eth_getFrame() and friends).
+ * \{
+ */
+#define ETH_BUF_EOF  BV(0) ///< Last buffer of a frame.
+
+/**
+ * Buffer descriptor shared by the stack and a ring based driver.
+ */
+typedef struct EthBuf
+{
+	uint8_t *data;  ///< Buffer memory.
+	uint16_t len;   ///< Buffer size when posted, data length when collected.
+	uint16_t flags; ///< ETH_BUF_* flags.
+	void *ctx;      ///< Owner cookie, never touched by the driver.
+} EthBuf;
+
+bool eth_rxPost(const EthBuf *buf);
+size_t eth_rxCollect(EthBuf *bufs, size_t max);
+void eth_rxWait(void);
+
+bool eth_txPost(const EthBuf *bufs, size_t cnt);
+size_t eth_txCollect(EthBuf *bufs, size_t max);
+void eth_txWait(void);
+/* \} */
+
 ssize_t eth_putFrame(const uint8_t *buf, size_t len);
 void eth_sendFrame(void);
 
@@ -94,6 +94,19 @@ volatile bool lwip_kdebug = false;
 
 void PGM_FUNC(kvprintf)(const char * PGM_ATTR fmt, va_list ap);
 
+/*
+ * Tell if the scheduler is up: kdebug is used before proc_init() and
+ * there is no process to yield to yet.
+ */
+INLINE bool kdbg_kernelRunning(void)
+{
+#if CONFIG_KERN
+	return proc_current() != NULL;
+#else
+	return true;
+#endif
+}
+
 /**
  * Output one character to the debug console
  */
@@ -111,7 +124,7 @@ static void __raw_putchar(char c, UNUSED_ARG(void *, unused))
 
 	KDBG_WRITE_CHAR(c);
 #if !CONFIG_KERN_LOGGER && !(ARCH & ARCH_BOOT)
-	if (!IRQ_RUNNING() && !lwip_kdebug)
+	if (!IRQ_RUNNING() && !lwip_kdebug && kdbg_kernelRunning())
 		cpu_relax();
 #endif
 }
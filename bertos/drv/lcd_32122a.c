@@ -265,6 +265,18 @@ static void lcd_32122_writeRaster(const uint8_t *raster)
 	}
 }
 
+/*
+ * Write the columns [xmin, xmax) of a page to the chip driving them.
+ */
+static void lcd_32122_writeColumns(const uint8_t *raster, uint8_t page,
+		uint8_t xmin, uint8_t xmax, uint8_t chip)
+{
+	lcd_32122_cmd(LCD_CMD_PAGEADDR | page, chip);
+	lcd_32122_cmd(LCD_CMD_COLADDR | xmin, chip);
+	while (xmin < xmax)
+		lcd_32122_write(raster[xmin++], chip);
+}
+
 #if CONFIG_LCD_SOFTINT_REFRESH
 
 static void lcd_32122_refreshSoftint(void)
@@ -297,6 +309,34 @@ void lcd_32122_blitBitmap(const Bitmap *bm)
 }
 
 
+/**
+ * Update only the pages and columns of the LCD display modified
+ * in the provided bitmap since the last flush.
+ */
+void lcd_32122_flushBitmap(Bitmap *bm)
+{
+	Rect r;
+	uint8_t page;
+
+	if (!gfx_dirtyRect(bm, &r))
+		return;
+
+	for (page = r.ymin / 8; page < (r.ymax + 7) / 8; ++page)
+	{
+		const uint8_t *raster = bm->raster + page * LCD_WIDTH;
+
+		/* Left half is driven by E1, right half by E2 */
+		if (r.xmin < LCD_PAGESIZE)
+			lcd_32122_writeColumns(raster, page,
+				r.xmin, MIN(r.xmax, LCD_PAGESIZE), LCDF_E1);
+		if (r.xmax > LCD_PAGESIZE)
+			lcd_32122_writeColumns(raster + LCD_PAGESIZE, page,
+				MAX(r.xmin - LCD_PAGESIZE, 0), r.xmax - LCD_PAGESIZE, LCDF_E2);
+	}
+	gfx_clearDirty(bm);
+}
+
+
 /**
  * Initialize LCD subsystem.
  *
@@ -57,5 +57,6 @@
 void lcd_32122_init(void);
 void lcd_32122_setPwm(int duty);
 void lcd_32122_blitBitmap(const Bitmap *bm);
+void lcd_32122_flushBitmap(Bitmap *bm);
 
 #endif /* DRV_LCD_32122A_H */
@@ -53,7 +53,8 @@
 EmulLCD::EmulLCD(QWidget *parent) :
 	QFrame(parent),
 	fg_color(LCD_FG_COLOR),
-	bg_brush(QColor(LCD_BG_COLOR))
+	bg_brush(QColor(LCD_BG_COLOR)),
+	bytes_transferred(0)
 {
 	// Optimized rendering: we repaint everything anyway
 	setAttribute(Qt::WA_NoSystemBackground);
@@ -119,30 +120,47 @@ void EmulLCD::paintEvent(QPaintEvent * /*event*/)
 
 void EmulLCD::writeRaster(uint8_t *new_raster)
 {
-#if CONFIG_BITMAP_FMT == BITMAP_FMT_PLANAR_H_MSB
+	Rect r = { 0, 0, WIDTH, HEIGHT };
 
-	// Straight copy
-	//memcpy(raster, new_raster, sizeof(raster));
+	writeRaster(new_raster, &r);
+}
+
+/**
+ * Update the display contents only inside rectangle \a r.
+ *
+ * The transfer is accounted the same way a real controller would
+ * receive it: whole bytes of the source raster covering the area.
+ */
+void EmulLCD::writeRaster(uint8_t *new_raster, const Rect *r)
+{
+#if CONFIG_BITMAP_FMT == BITMAP_FMT_PLANAR_H_MSB
 
 	// Inverting copy
-	for (int i = 0; i < (int)sizeof(raster); ++i)
-		raster[i] = ~new_raster[i];
+	int stride = (WIDTH + 7) / 8;
+	for (int y = r->ymin; y < r->ymax; ++y)
+		for (int xbyte = r->xmin / 8; xbyte < (r->xmax + 7) / 8; ++xbyte)
+		{
+			raster[y * stride + xbyte] = ~new_raster[y * stride + xbyte];
+			++bytes_transferred;
+		}
 
 #elif CONFIG_BITMAP_FMT == BITMAP_FMT_PLANAR_V_LSB
 
 	// Rotation + inversion
-	for (int y = 0; y < HEIGHT; ++y)
+	for (int y = r->ymin; y < r->ymax; ++y)
 	{
-		for (int xbyte = 0; xbyte < WIDTH/8; ++xbyte)
+		for (int x = r->xmin; x < r->xmax; ++x)
 		{
-			uint8_t v = 0;
-			for (int xbit = 0; xbit < 8; ++xbit)
-				v |= (new_raster[(xbyte * 8 + xbit) + (y / 8) * WIDTH] & (1 << (y%8)) )
-					? (1 << (7 - xbit)) : 0;
+			uint8_t *p = &raster[y * ((WIDTH + 7) / 8) + x / 8];
+			uint8_t bit = 1 << (7 - x % 8);
 
-			raster[y * ((WIDTH + 7) / 8) + xbyte] = v;
+			if (new_raster[x + (y / 8) * WIDTH] & (1 << (y % 8)))
+				*p |= bit;
+			else
+				*p &= ~bit;
 		}
 	}
+	bytes_transferred += (r->xmax - r->xmin) * ((r->ymax + 7) / 8 - r->ymin / 8);
 #else
 	#error Unsupported bitmap format
 #endif
@@ -183,5 +201,21 @@ DECLARE_WALL(wall_after_raster, WALL_SIZE)
 	emul->emulLCD->writeRaster(bm->raster);
 }
 
+/*extern "C"*/ void lcd_gfx_qt_flushBitmap(Bitmap *bm)
+{
+	Rect r;
+
+	if (!gfx_dirtyRect(bm, &r))
+		return;
+
+	emul->emulLCD->writeRaster(bm->raster, &r);
+	gfx_clearDirty(bm);
+}
+
+/*extern "C"*/ unsigned long lcd_gfx_qt_bytesTransferred(void)
+{
+	return emul->emulLCD->bytesTransferred();
+}
+
 #include "lcd_gfx_qt_moc.cpp"
 
@@ -77,6 +77,10 @@ protected:
 // Operations
 public:
 	void writeRaster(uint8_t *raster);
+	void writeRaster(uint8_t *raster, const Rect *r);
+
+	/// Bytes of raster transferred to the display so far
+	unsigned long bytesTransferred() const { return bytes_transferred; }
 
 // Implementation
 protected:
@@ -89,10 +93,15 @@ protected:
 
 	/// Pixel storage
 	unsigned char raster[(WIDTH + 7 / 8) * HEIGHT];
+
+	/// Statistics for partial refresh
+	unsigned long bytes_transferred;
 };
 
 
 void lcd_gfx_qt_init(Bitmap *lcd_bitmap);
 void lcd_gfx_qt_blitBitmap(const Bitmap *bm);
+void lcd_gfx_qt_flushBitmap(Bitmap *bm);
+unsigned long lcd_gfx_qt_bytesTransferred(void);
 
 #endif // DRV_LCD_GFX_QT_H
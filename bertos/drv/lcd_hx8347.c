@@ -249,6 +249,33 @@ void lcd_hx8347_blitBitmap(const Bitmap *bm)
 	}
 }
 
+/*
+ * Refresh on screen only the area of a bitmap modified since
+ * the last flush.
+ */
+void lcd_hx8347_flushBitmap(Bitmap *bm)
+{
+	Rect r;
+	int x, y;
+
+	if (!gfx_dirtyRect(bm, &r))
+		return;
+
+	lcd_setWindow(r.xmin, r.ymin, RECT_WIDTH(&r), RECT_HEIGHT(&r));
+	hx8347_cmd(0x22);
+
+	for (y = r.ymin; y < r.ymax; y++)
+	{
+		const uint8_t *row = bm->raster + (y / 8) * bm->width;
+		uint8_t mask = 1 << (y % 8);
+
+		for (x = r.xmin; x < r.xmax; x++)
+			lcd_row[x - r.xmin] = (row[x] & mask) ? 0x0000 : 0xFFFF;
+		bufferWrite(lcd_row, RECT_WIDTH(&r));
+	}
+	gfx_clearDirty(bm);
+}
+
 /*
  * Blit a 24 bit color raw raster directly on screen
  */
@@ -53,6 +53,7 @@ void lcd_hx8347_init(void);
 void lcd_hx8347_on(void);
 void lcd_hx8347_off(void);
 void lcd_hx8347_blitBitmap(const Bitmap *bm);
+void lcd_hx8347_flushBitmap(Bitmap *bm);
 void lcd_hx8347_blitBitmap24(int x, int y, int width, int height, const char *bmp);
 
 #endif /* LCD_HX8347_H */
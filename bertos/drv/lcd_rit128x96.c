@@ -200,6 +200,35 @@ void rit128x96_blitBitmap(const Bitmap *bm)
 	}
 }
 
+/* Refresh on screen only the area of a bitmap modified since the last flush */
+void rit128x96_flushBitmap(Bitmap *bm)
+{
+	uint8_t lcd_row[bm->width / 2];
+	Rect r;
+	int i, y;
+
+	if (!gfx_dirtyRect(bm, &r))
+		return;
+
+	/* Two pixels per byte: align the columns to even boundaries */
+	r.xmin &= ~1;
+	r.xmax = (r.xmax + 1) & ~1;
+
+	lcd_start_blit(r.xmin, r.ymin, RECT_WIDTH(&r), RECT_HEIGHT(&r));
+	LCD_SET_DATA();
+	for (y = r.ymin; y < r.ymax; y++)
+	{
+		const uint8_t *row = bm->raster + (y / 8) * bm->width;
+		uint8_t mask = 1 << (y % 8);
+
+		for (i = r.xmin; i < r.xmax; i += 2)
+			lcd_row[(i - r.xmin) / 2] = ((row[i] & mask) ? 0xf0 : 0)
+				| ((row[i + 1] & mask) ? 0x0f : 0);
+		lcd_dataWrite(lcd_row, RECT_WIDTH(&r) / 2);
+	}
+	gfx_clearDirty(bm);
+}
+
 /* Initialize the OLED display */
 void rit128x96_init(void)
 {
@@ -53,6 +53,8 @@
 #include <cpu/power.h> // cpu_relax()
 
 #include <kern/proc_p.h> // proc_decQuantun()
+#include <kern/trace.h>
+#include <kern/irqstat.h>
 
 /*
  * Include platform-specific binding code if we're hosted.
@@ -109,6 +111,11 @@
 /// Master system clock (1 tick accuracy)
 volatile ticks_t _clock;
 
+#if !OS_HOSTED
+/// Last value returned by timer_hpclock().
+uint32_t _hpclock_last;
+#endif
+
 
 #if CONFIG_TIMER_EVENTS
 
@@ -203,6 +210,7 @@ INLINE void timer_poll(List *queue)
 		DB(timer->magic = TIMER_MAGIC_INACTIVE;)
 
 		/* Execute the associated event */
+		trace_event(TRACE_TIMER, (uintptr_t)timer);
 		event_do(&timer->expire);
 	}
 }
@@ -369,6 +377,8 @@ DEFINE_TIMER_ISR
 		return;
 
 	TIMER_STROBE_ON;
+	IRQSTAT_BEGIN();
+	trace_event(TRACE_IRQ_ENTER, TRACE_IRQ_TIMER);
 
 	/* Update the master ms counter */
 	++_clock;
@@ -376,6 +386,9 @@ DEFINE_TIMER_ISR
 	/* Update the current task's quantum (if enabled). */
 	proc_decQuantum();
 
+	/* Charge and release the jobs of the EDF processes (if enabled). */
+	edf_tick();
+
 	#if CONFIG_TIMER_EVENTS
 		timer_poll(&timers_queue);
 	#endif
@@ -383,6 +396,8 @@ DEFINE_TIMER_ISR
 	/* Perform hw IRQ handling */
 	timer_hw_irq();
 
+	trace_event(TRACE_IRQ_EXIT, TRACE_IRQ_TIMER);
+	IRQSTAT_END("timer");
 	TIMER_STROBE_OFF;
 }
 
@@ -153,6 +153,41 @@ INLINE ticks_t timer_clock_unlocked(void)
 	return _clock;
 }
 
+/**
+ * Return a free running timestamp in hpticks (TIMER_HW_HPTICKS_PER_SEC).
+ *
+ * The counter is 32 bit wide whatever the size of hptime_t and it wraps
+ * around, so only the difference of two close timestamps is meaningful.
+ * Call it with the timer interrupt disabled.
+ *
+ * With interrupts disabled the hardware counter may have already wrapped
+ * while the tick ISR is still pending, so that _clock lags by one tick.
+ * The last timestamp is kept to detect this case, so the returned
+ * value never goes backwards between two close calls. Only a value at
+ * most one tick behind the last one is corrected: after 2^31 hpticks the
+ * counter seems to go backwards as well, and is returned as it is.
+ *
+ * \note This is a macro because not every CPU port provides
+ *       timer_hw_hpread().
+ */
+#if OS_HOSTED
+	#define timer_hpclock()  ((uint32_t)hptime_get())
+#else
+	#define timer_hpclock()  timer_hpclockFix((uint32_t)_clock * TIMER_HW_CNT + timer_hw_hpread(), TIMER_HW_CNT)
+
+	/* Add the tick still pending in the timer ISR, see timer_hpclock() */
+	INLINE uint32_t timer_hpclockFix(uint32_t now, uint32_t tick)
+	{
+		extern uint32_t _hpclock_last;
+
+		/* 1 to tick hpticks behind the last timestamp */
+		if (_hpclock_last - now - 1 < tick)
+			now += tick;
+		_hpclock_last = now;
+		return now;
+	}
+#endif
+
 
 /** Convert \a ms [ms] to ticks. */
 INLINE ticks_t ms_to_ticks(mtime_t ms)
@@ -0,0 +1,279 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Ethernet driver for the emulator (implementation).
+ *
+ * The receive ring holds, in order, the buffers already filled and not yet
+ * collected by the stack, followed by the empty ones still available for
+ * incoming frames. The SIGIO handler moves buffers from the second group
+ * to the first one; frames arriving when no buffer is available are
+ * dropped, as a real MAC would do.
+ *
+ * Transmission is synchronous: a frame is on the wire as soon as
+ * eth_txPost() returns, so its descriptors are immediately ready to be
+ * collected.
+ */
+
+#include "eth_emul.h"
+
+#include "cfg/cfg_eth.h"
+
+#define LOG_LEVEL  ETH_LOG_LEVEL
+#define LOG_FORMAT ETH_LOG_FORMAT
+
+#include <cfg/log.h>
+#include <cfg/debug.h>
+#include <cfg/macros.h>
+
+#include <drv/eth.h>
+
+#include <cpu/irq.h>
+
+#include <mware/event.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#if !CONFIG_ETH_RING
+	#error "The emulated Ethernet driver requires CONFIG_ETH_RING"
+#endif
+
+static int wire_fd = -1;
+
+static EthBuf rx_ring[CONFIG_ETH_RXBUFS];
+static size_t rx_tail;   ///< First filled buffer.
+static size_t rx_ready;  ///< Filled buffers.
+static size_t rx_empty;  ///< Empty buffers, after the filled ones.
+
+static EthBuf tx_ring[CONFIG_ETH_TXBUFS];
+static size_t tx_tail;
+static size_t tx_cnt;
+
+static Event recv_wait;
+
+/*
+ * Receive "interrupt": drain the wire into the posted buffers.
+ */
+static void eth_emulIsr(UNUSED_ARG(int, signum))
+{
+	struct iovec iov[CONFIG_ETH_RXBUFS];
+	struct msghdr msg;
+	bool received = false;
+
+	for (;;)
+	{
+		size_t fill = (rx_tail + rx_ready) % CONFIG_ETH_RXBUFS;
+		ssize_t len;
+		size_t i;
+
+		for (i = 0; i < rx_empty; i++)
+		{
+			EthBuf *buf = &rx_ring[(fill + i) % CONFIG_ETH_RXBUFS];
+
+			iov[i].iov_base = buf->data;
+			iov[i].iov_len = buf->len;
+		}
+
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = rx_empty;
+
+		len = recvmsg(wire_fd, &msg, MSG_DONTWAIT);
+		if (len < 0)
+			break;
+
+		if (len == 0 || (msg.msg_flags & MSG_TRUNC))
+		{
+			LOG_INFO("eth: frame dropped, %d buffers available\n", (int)rx_empty);
+			continue;
+		}
+
+		for (i = 0; len > 0; i++)
+		{
+			EthBuf *buf = &rx_ring[(fill + i) % CONFIG_ETH_RXBUFS];
+
+			buf->len = MIN(len, (ssize_t)buf->len);
+			len -= buf->len;
+			buf->flags = len ? 0 : ETH_BUF_EOF;
+		}
+		rx_ready += i;
+		rx_empty -= i;
+		received = true;
+	}
+
+	if (received)
+		event_do(&recv_wait);
+}
+
+bool eth_rxPost(const EthBuf *buf)
+{
+	cpu_flags_t flags;
+	bool ok;
+
+	IRQ_SAVE_DISABLE(flags);
+	ok = rx_ready + rx_empty < CONFIG_ETH_RXBUFS;
+	if (ok)
+	{
+		EthBuf *slot = &rx_ring[(rx_tail + rx_ready + rx_empty) % CONFIG_ETH_RXBUFS];
+
+		*slot = *buf;
+		slot->flags = 0;
+		rx_empty++;
+	}
+	IRQ_RESTORE(flags);
+
+	return ok;
+}
+
+size_t eth_rxCollect(EthBuf *bufs, size_t max)
+{
+	cpu_flags_t flags;
+	size_t n;
+
+	IRQ_SAVE_DISABLE(flags);
+	n = MIN(max, rx_ready);
+	for (size_t i = 0; i < n; i++)
+		bufs[i] = rx_ring[(rx_tail + i) % CONFIG_ETH_RXBUFS];
+	rx_tail = (rx_tail + n) % CONFIG_ETH_RXBUFS;
+	rx_ready -= n;
+	IRQ_RESTORE(flags);
+
+	return n;
+}
+
+void eth_rxWait(void)
+{
+	while (!ACCESS_SAFE(rx_ready))
+		event_wait(&recv_wait);
+}
+
+bool eth_txPost(const EthBuf *bufs, size_t cnt)
+{
+	struct iovec iov[CONFIG_ETH_TXBUFS];
+	struct msghdr msg;
+	cpu_flags_t flags;
+
+	ASSERT(cnt > 0);
+	ASSERT(bufs[cnt - 1].flags & ETH_BUF_EOF);
+
+	IRQ_SAVE_DISABLE(flags);
+	if (cnt > CONFIG_ETH_TXBUFS - tx_cnt)
+	{
+		IRQ_RESTORE(flags);
+		return false;
+	}
+	for (size_t i = 0; i < cnt; i++)
+	{
+		tx_ring[(tx_tail + tx_cnt + i) % CONFIG_ETH_TXBUFS] = bufs[i];
+		iov[i].iov_base = bufs[i].data;
+		iov[i].iov_len = bufs[i].len;
+	}
+	tx_cnt += cnt;
+	IRQ_RESTORE(flags);
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = cnt;
+
+	while (sendmsg(wire_fd, &msg, MSG_NOSIGNAL) < 0)
+	{
+		if (errno != EINTR)
+		{
+			LOG_WARN("eth: send error %d\n", errno);
+			break;
+		}
+	}
+
+	return true;
+}
+
+size_t eth_txCollect(EthBuf *bufs, size_t max)
+{
+	cpu_flags_t flags;
+	size_t n;
+
+	IRQ_SAVE_DISABLE(flags);
+	n = MIN(max, tx_cnt);
+	for (size_t i = 0; i < n; i++)
+		bufs[i] = tx_ring[(tx_tail + i) % CONFIG_ETH_TXBUFS];
+	tx_tail = (tx_tail + n) % CONFIG_ETH_TXBUFS;
+	tx_cnt -= n;
+	IRQ_RESTORE(flags);
+
+	return n;
+}
+
+void eth_txWait(void)
+{
+	/* Frames are sent synchronously, the ring is freed by eth_txCollect() */
+}
+
+int eth_emulWire(int fd[2])
+{
+	return socketpair(AF_UNIX, SOCK_DGRAM, 0, fd);
+}
+
+void eth_emulConnect(int fd)
+{
+	wire_fd = fd;
+}
+
+int eth_init(void)
+{
+	struct sigaction sa;
+
+	ASSERT(wire_fd >= 0);
+
+	rx_tail = rx_ready = rx_empty = 0;
+	tx_tail = tx_cnt = 0;
+	event_initGeneric(&recv_wait);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = eth_emulIsr;
+	sigfillset(&sa.sa_mask);
+	sa.sa_flags = SA_RESTART;
+	sigaction(SIGIO, &sa, NULL);
+
+	if (fcntl(wire_fd, F_SETOWN, getpid()) < 0
+		|| fcntl(wire_fd, F_SETFL, fcntl(wire_fd, F_GETFL) | O_ASYNC) < 0)
+	{
+		LOG_ERR("eth: unable to set up the wire\n");
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Ethernet driver for the emulator.
+ *
+ * The emulated interface sends and receives frames through a UNIX domain
+ * datagram socket, one frame per datagram. Two emulated nodes, usually two
+ * processes, talk to each other through the two ends of a virtual wire
+ * created by eth_emulWire():
+ * \code
+ * int wire[2];
+ *
+ * eth_emulWire(wire);
+ * if (fork() == 0)
+ * 	eth_emulConnect(wire[1]);
+ * else
+ * 	eth_emulConnect(wire[0]);
+ * \endcode
+ *
+ * Incoming datagrams raise SIGIO, which plays the role of the receive
+ * interrupt: the handler copies them straight into the buffers posted with
+ * eth_rxPost(), like the DMA engine of a real MAC. Only the descriptor ring
+ * interface of drv/eth.h is implemented, so CONFIG_ETH_RING must be set.
+ */
+
+#ifndef EMUL_ETH_EMUL_H
+#define EMUL_ETH_EMUL_H
+
+#include <cfg/compiler.h>
+
+/**
+ * Create a virtual wire, returning its two ends in \a fd.
+ *
+ * \return 0 on success, -1 on error.
+ */
+int eth_emulWire(int fd[2]);
+
+/**
+ * Attach the emulated interface to the socket \a fd.
+ *
+ * Must be called before eth_init().
+ */
+void eth_emulConnect(int fd);
+
+#endif /* EMUL_ETH_EMUL_H */
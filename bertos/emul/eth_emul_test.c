@@ -0,0 +1,280 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Emulated Ethernet test and TCP throughput benchmark.
+ *
+ * Two nodes, the test process and a forked copy, run their own lwIP stack
+ * and talk through a virtual wire. Node 1 checks the data it receives
+ * from node 0 and acknowledges each block; node 0 measures the throughput.
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_eth.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_ETH_RING" >> $cfgdir/cfg_eth.h
+ * $test$: echo "#define CONFIG_ETH_RING 1" >> $cfgdir/cfg_eth.h
+ * $test$: echo  "#undef CONFIG_ETH_RXBUFS" >> $cfgdir/cfg_eth.h
+ * $test$: echo "#define CONFIG_ETH_RXBUFS 32" >> $cfgdir/cfg_eth.h
+ * $test$: cp bertos/cfg/cfg_lwip.h $cfgdir/
+ * $test$: echo  "#undef LWIP_SO_RCVTIMEO" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_SO_RCVTIMEO 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef TCP_MSS" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define TCP_MSS 1460" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef PBUF_POOL_BUFSIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define PBUF_POOL_BUFSIZE 768" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef PBUF_POOL_SIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define PBUF_POOL_SIZE 64" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEM_SIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEM_SIZE 32768" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef TCP_SND_BUF" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define TCP_SND_BUF (4 * TCP_MSS)" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef LWIP_SOCKET" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_SOCKET 0" >> $cfgdir/cfg_lwip.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include <cfg/compiler.h>
+#include <cfg/test.h>
+#include <cfg/debug.h>
+
+#include <emul/eth_emul.h>
+
+#include <drv/timer.h>
+
+#include <kern/proc.h>
+
+#include <netif/ethernetif.h>
+
+#include <lwip/tcpip.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/* lwIP and the drivers are not in the test sources list */
+#include "net/lwip.c"
+#include "hw/hw_eth.c"
+/* The driver uses the host sockets, which clash with the lwIP ones */
+#undef LOG_LEVEL
+#undef LOG_FORMAT
+#include "eth_emul.c"
+
+#define TEST_PORT    5001
+#define BLOCK_LEN    (64 * 1024UL)
+#define BENCH_TIME   1000 /* ms */
+
+static struct netif netif;
+static pid_t peer;
+static uint8_t block[BLOCK_LEN];
+
+INLINE uint8_t pattern(uint32_t off)
+{
+	return off % 251;
+}
+
+/*
+ * Node 1: receive blocks made of a 4 octets length and the pattern,
+ * answering each one with 'K' if its content was right.
+ */
+static int node_sink(void)
+{
+	struct netconn *server, *conn;
+	struct netbuf *buf;
+	uint32_t len = 0, off = 0;
+	uint8_t hdr = 0;
+	bool ok = true;
+
+	server = netconn_new(NETCONN_TCP);
+	netconn_bind(server, IP_ADDR_ANY, TEST_PORT);
+	netconn_listen(server);
+	server->recv_timeout = 10000;
+
+	conn = netconn_accept(server);
+	if (!conn)
+		return -1;
+	conn->recv_timeout = 10000;
+
+	while ((buf = netconn_recv(conn)) != NULL)
+	{
+		do
+		{
+			uint8_t *data;
+			u16_t n;
+
+			netbuf_data(buf, (void **)&data, &n);
+			for (u16_t i = 0; i < n; i++)
+			{
+				if (hdr < sizeof(len))
+				{
+					len = (len << 8) | data[i];
+					if (++hdr == sizeof(len) && len == 0)
+						goto done;
+					continue;
+				}
+				if (data[i] != pattern(off))
+					ok = false;
+				if (++off == len)
+				{
+					netconn_write(conn, ok ? "K" : "E", 1, NETCONN_COPY);
+					len = off = hdr = 0;
+				}
+			}
+		}
+		while (netbuf_next(buf) >= 0);
+		netbuf_delete(buf);
+	}
+	ok = false;
+done:
+	netconn_close(conn);
+	netconn_delete(conn);
+	netconn_delete(server);
+	return ok ? 0 : -1;
+}
+
+static bool send_block(struct netconn *conn, uint32_t len)
+{
+	uint8_t hdr[4] = { len >> 24, len >> 16, len >> 8, len };
+	struct netbuf *buf;
+	char *ack;
+	u16_t n;
+	bool ok;
+
+	if (netconn_write(conn, hdr, sizeof(hdr), NETCONN_COPY) != ERR_OK)
+		return false;
+	if (len == 0)
+		return true;
+	if (netconn_write(conn, block, len, NETCONN_NOCOPY) != ERR_OK)
+		return false;
+
+	buf = netconn_recv(conn);
+	if (!buf)
+		return false;
+	netbuf_data(buf, (void **)&ack, &n);
+	ok = n == 1 && *ack == 'K';
+	netbuf_delete(buf);
+	return ok;
+}
+
+int eth_emul_testRun(void)
+{
+	struct netconn *conn;
+	struct ip_addr addr;
+	unsigned long bytes = 0;
+	ticks_t start, elapsed;
+	int status;
+
+	IP4_ADDR(&addr, 10, 0, 0, 2);
+	conn = netconn_new(NETCONN_TCP);
+	conn->recv_timeout = 5000;
+	if (netconn_connect(conn, &addr, TEST_PORT) != ERR_OK)
+		goto error;
+	/* Don't hold the tail of each block waiting for a delayed ACK */
+	tcp_nagle_disable(conn->pcb.tcp);
+
+	/* Odd sizes, to end frames at every offset of the receive buffers */
+	for (uint32_t len = 1; len < 5000; len += 997)
+		if (!send_block(conn, len))
+			goto error;
+
+	start = timer_clock();
+	while ((elapsed = timer_clock() - start) < ms_to_ticks(BENCH_TIME))
+	{
+		if (!send_block(conn, BLOCK_LEN))
+			goto error;
+		bytes += BLOCK_LEN;
+	}
+	kprintf("TCP throughput: %lu KiB/s\n",
+		bytes * 1000 / 1024 / ticks_to_ms(elapsed));
+
+	if (!send_block(conn, 0))
+		goto error;
+	netconn_close(conn);
+	netconn_delete(conn);
+
+	if (waitpid(peer, &status, 0) != peer || !WIFEXITED(status) || WEXITSTATUS(status))
+		return -1;
+	return 0;
+
+error:
+	kprintf("TCP transfer failed\n");
+	return -1;
+}
+
+int eth_emul_testSetup(void)
+{
+	struct ip_addr addr, netmask, gw;
+	int wire[2], node;
+
+	kdbg_init();
+	if (eth_emulWire(wire) < 0)
+		return -1;
+
+	/* Fork before starting the timer, which is not inherited */
+	peer = fork();
+	if (peer < 0)
+		return -1;
+	node = peer ? 0 : 1;
+	close(wire[!node]);
+	eth_emulConnect(wire[node]);
+	mac_addr[5] = node;
+
+	timer_init();
+	proc_init();
+
+	tcpip_init(NULL, NULL);
+	IP4_ADDR(&addr, 10, 0, 0, node + 1);
+	IP4_ADDR(&netmask, 255, 255, 255, 0);
+	IP4_ADDR(&gw, 10, 0, 0, 254);
+	netif_add(&netif, &addr, &netmask, &gw, NULL, ethernetif_init, tcpip_input);
+	netif_set_default(&netif);
+	netif_set_up(&netif);
+
+	if (node == 1)
+		_exit(node_sink() ? 1 : 0);
+
+	for (size_t i = 0; i < sizeof(block); i++)
+		block[i] = pattern(i);
+	return 0;
+}
+
+int eth_emul_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(eth_emul);
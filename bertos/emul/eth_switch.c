@@ -0,0 +1,258 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Virtual Ethernet switch for emulated nodes (implementation).
+ *
+ * Each port has a queue of frames waiting to be delivered to its node,
+ * ordered by delivery time: a frame leaves the port after the previous
+ * one has been "transmitted" at the port bandwidth, and reaches the node
+ * after the link latency. A full queue drops the incoming frames, and so
+ * does the loss probability of the link.
+ *
+ * Frames are delivered without blocking: if the socket of a node is full
+ * the frame stays at the head of the queue until the node reads some.
+ */
+
+#include "eth_switch.h"
+
+#include <cfg/debug.h>
+#include <cfg/macros.h>
+
+#include <drv/eth.h>
+
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+/* Check that the parent is still alive at least this often, in us */
+#define SWITCH_POLL_US  100000
+
+typedef struct SwitchFrame
+{
+	uint64_t due;     ///< Delivery time, in us.
+	uint16_t len;
+	uint8_t data[ETH_FRAME_LEN];
+} SwitchFrame;
+
+typedef struct SwitchPort
+{
+	int fd;
+	bool known;                   ///< True if the node address was learnt.
+	uint8_t mac[ETH_ADDR_LEN];    ///< Address of the node.
+	uint64_t busy;                ///< End of the last transmission, in us.
+	SwitchFrame queue[ETH_SWITCH_QUEUE];
+	size_t head;
+	size_t cnt;
+} SwitchPort;
+
+static SwitchPort sw_ports[ETH_SWITCH_PORTS];
+static int sw_nodes;
+static EthSwitchLink sw_link;
+static unsigned int sw_seed = 1;
+
+static uint64_t sw_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sw_enqueue(SwitchPort *port, const uint8_t *data, size_t len, uint64_t now)
+{
+	SwitchFrame *frame;
+	uint64_t start;
+
+	if (sw_link.loss && (uint32_t)(rand_r(&sw_seed) % 1000000) < sw_link.loss)
+		return;
+	if (port->cnt == ETH_SWITCH_QUEUE)
+		return;
+
+	start = MAX(now, port->busy);
+	port->busy = start;
+	if (sw_link.bandwidth)
+		port->busy += (uint64_t)len * 8 * 1000000 / sw_link.bandwidth;
+
+	frame = &port->queue[(port->head + port->cnt) % ETH_SWITCH_QUEUE];
+	frame->due = port->busy + sw_link.latency;
+	frame->len = len;
+	memcpy(frame->data, data, len);
+	port->cnt++;
+}
+
+static void sw_forward(int in, const uint8_t *data, size_t len, uint64_t now)
+{
+	const uint8_t *dst = data;
+	int out = -1;
+
+	if (len < ETH_HEAD_LEN)
+		return;
+
+	/* Learn the address of the sender */
+	memcpy(sw_ports[in].mac, data + ETH_ADDR_LEN, ETH_ADDR_LEN);
+	sw_ports[in].known = true;
+
+	if (!eth_addrIsMcast(dst))
+		for (int i = 0; i < sw_nodes; i++)
+			if (sw_ports[i].known && !eth_addrCmp(sw_ports[i].mac, dst))
+				out = i;
+
+	if (out >= 0)
+	{
+		if (out != in)
+			sw_enqueue(&sw_ports[out], data, len, now);
+		return;
+	}
+
+	/* Broadcast or unknown destination: flood */
+	for (int i = 0; i < sw_nodes; i++)
+		if (i != in)
+			sw_enqueue(&sw_ports[i], data, len, now);
+}
+
+/*
+ * Deliver the frames due on \a port, returning the time of the next one.
+ */
+static uint64_t sw_deliver(SwitchPort *port, uint64_t now, bool *full)
+{
+	*full = false;
+	while (port->cnt)
+	{
+		SwitchFrame *frame = &port->queue[port->head];
+
+		if (frame->due > now)
+			return frame->due;
+		if (send(port->fd, frame->data, frame->len, MSG_DONTWAIT | MSG_NOSIGNAL) < 0
+			&& (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			*full = true;
+			return now + SWITCH_POLL_US;
+		}
+		port->head = (port->head + 1) % ETH_SWITCH_QUEUE;
+		port->cnt--;
+	}
+	return now + SWITCH_POLL_US;
+}
+
+static NORETURN void sw_run(pid_t parent)
+{
+	static uint8_t buf[ETH_FRAME_LEN];
+
+	for (;;)
+	{
+		uint64_t now = sw_now(), next = now + SWITCH_POLL_US;
+		fd_set rd, wr;
+		struct timeval tv;
+		int maxfd = 0;
+
+		if (getppid() != parent)
+			_exit(0);
+
+		FD_ZERO(&rd);
+		FD_ZERO(&wr);
+		for (int i = 0; i < sw_nodes; i++)
+		{
+			bool full;
+
+			next = MIN(next, sw_deliver(&sw_ports[i], now, &full));
+			FD_SET(sw_ports[i].fd, &rd);
+			if (full)
+				FD_SET(sw_ports[i].fd, &wr);
+			maxfd = MAX(maxfd, sw_ports[i].fd);
+		}
+
+		tv.tv_sec = (next - now) / 1000000;
+		tv.tv_usec = (next - now) % 1000000;
+		if (select(maxfd + 1, &rd, &wr, NULL, &tv) <= 0)
+			continue;
+
+		now = sw_now();
+		for (int i = 0; i < sw_nodes; i++)
+		{
+			ssize_t len;
+
+			if (!FD_ISSET(sw_ports[i].fd, &rd))
+				continue;
+			while ((len = recv(sw_ports[i].fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+				sw_forward(i, buf, len, now);
+		}
+	}
+}
+
+pid_t eth_switchStart(const EthSwitchLink *link, int *fd, int nodes)
+{
+	int pair[ETH_SWITCH_PORTS][2];
+	pid_t parent = getpid(), pid;
+	int i;
+
+	ASSERT(nodes > 0 && nodes <= ETH_SWITCH_PORTS);
+
+	for (i = 0; i < nodes; i++)
+		if (socketpair(AF_UNIX, SOCK_DGRAM, 0, pair[i]) < 0)
+			break;
+
+	pid = (i == nodes) ? fork() : -1;
+	if (pid == 0)
+	{
+		memset(sw_ports, 0, sizeof(sw_ports));
+		for (i = 0; i < nodes; i++)
+		{
+			close(pair[i][0]);
+			sw_ports[i].fd = pair[i][1];
+		}
+		sw_nodes = nodes;
+		sw_link = *link;
+		sw_run(parent);
+	}
+
+	while (i-- > 0)
+	{
+		close(pair[i][1]);
+		if (pid < 0)
+			close(pair[i][0]);
+		else
+			fd[i] = pair[i][0];
+	}
+	return pid;
+}
+
+void eth_switchStop(pid_t pid)
+{
+	kill(pid, SIGTERM);
+	waitpid(pid, NULL, 0);
+}
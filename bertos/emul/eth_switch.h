@@ -0,0 +1,98 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Virtual Ethernet switch for emulated nodes.
+ *
+ * The switch runs in its own host process and connects up to
+ * ETH_SWITCH_PORTS emulated nodes, each one attached to a port with
+ * eth_emulConnect(). It learns the MAC addresses behind each port like a
+ * real switch, and floods broadcast frames and unknown destinations.
+ *
+ * Every port forwards frames to its node with the latency, bandwidth and
+ * loss described by an EthSwitchLink, so that network code can be measured
+ * under realistic conditions without a board:
+ * \code
+ * EthSwitchLink link = { 1000, 10000000, 0 }; // 1ms, 10Mbit/s, no loss
+ * int fd[2];
+ * pid_t sw = eth_switchStart(&link, fd, 2);
+ *
+ * if (fork() == 0)
+ * 	eth_emulConnect(fd[1]);
+ * else
+ * 	eth_emulConnect(fd[0]);
+ * ...
+ * eth_switchStop(sw);
+ * \endcode
+ *
+ * The switch exits by itself when the process that started it terminates.
+ */
+
+#ifndef EMUL_ETH_SWITCH_H
+#define EMUL_ETH_SWITCH_H
+
+#include <cfg/compiler.h>
+
+#include <sys/types.h>
+
+/// Maximum number of nodes connected to a switch.
+#define ETH_SWITCH_PORTS  8
+
+/// Frames queued on each port, waiting to be delivered.
+#define ETH_SWITCH_QUEUE  64
+
+/**
+ * Characteristics of the link between the switch and each node.
+ */
+typedef struct EthSwitchLink
+{
+	uint32_t latency;   ///< Delivery delay, in microseconds.
+	uint32_t bandwidth; ///< Bits per second, 0 for no limit.
+	uint32_t loss;      ///< Lost frames, in parts per million.
+} EthSwitchLink;
+
+/**
+ * Start a switch connecting \a nodes emulated nodes.
+ *
+ * \param link Characteristics of every port.
+ * \param fd   Filled with the socket of each node.
+ * \param nodes Number of nodes, up to ETH_SWITCH_PORTS.
+ *
+ * \return The pid of the switch process, -1 on error.
+ */
+pid_t eth_switchStart(const EthSwitchLink *link, int *fd, int nodes);
+
+/**
+ * Stop the switch \a pid.
+ */
+void eth_switchStop(pid_t pid);
+
+#endif /* EMUL_ETH_SWITCH_H */
@@ -0,0 +1,596 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Network benchmarks over the emulated switch.
+ *
+ * For each link profile the test starts a switch and two emulated nodes,
+ * a server and a client, in their own processes. The client measures TCP
+ * and UDP throughput, TCP connection rate and round trip times.
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_eth.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_ETH_RING" >> $cfgdir/cfg_eth.h
+ * $test$: echo "#define CONFIG_ETH_RING 1" >> $cfgdir/cfg_eth.h
+ * $test$: echo  "#undef CONFIG_ETH_RXBUFS" >> $cfgdir/cfg_eth.h
+ * $test$: echo "#define CONFIG_ETH_RXBUFS 32" >> $cfgdir/cfg_eth.h
+ * $test$: cp bertos/cfg/cfg_lwip.h $cfgdir/
+ * $test$: echo  "#undef LWIP_SO_RCVTIMEO" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_SO_RCVTIMEO 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef LWIP_SOCKET" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_SOCKET 0" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef TCP_MSS" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define TCP_MSS 1460" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef TCP_SND_BUF" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define TCP_SND_BUF (4 * TCP_MSS)" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef PBUF_POOL_SIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define PBUF_POOL_SIZE 64" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEM_SIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEM_SIZE 32768" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_NETCONN" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_NETCONN 8" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_NETBUF" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_NETBUF 16" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_TCP_PCB" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_TCP_PCB 16" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_TCPIP_MSG_INPKT" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_TCPIP_MSG_INPKT 32" >> $cfgdir/cfg_lwip.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include <cfg/compiler.h>
+#include <cfg/test.h>
+#include <cfg/debug.h>
+
+#include <emul/eth_emul.h>
+#include <emul/eth_switch.h>
+
+#include <drv/timer.h>
+
+#include <kern/proc.h>
+
+#include <os/hptime.h>
+
+#include <netif/ethernetif.h>
+
+#include <lwip/tcpip.h>
+
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/* lwIP and the drivers are not in the test sources list */
+#include "net/lwip.c"
+#include "hw/hw_eth.c"
+/* The drivers use the host sockets, which clash with the lwIP ones */
+#undef LOG_LEVEL
+#undef LOG_FORMAT
+#include "eth_emul.c"
+#include "eth_switch.c"
+
+#define TCP_PORT     5001
+#define UDP_PORT     5002
+#define BLOCK_LEN    (16 * 1024UL)
+#define UDP_LEN      1024
+#define UDP_BURST    8
+#define PINGS        100
+#define BENCH_TIME   500 /* ms */
+
+/* TCP service modes, chosen by the first octet sent by the client */
+#define MODE_SINK    'S' /* Count the data, answer 'K' every BLOCK_LEN */
+#define MODE_ECHO    'E' /* Send back the data */
+#define MODE_CLOSE   'C' /* Close the connection */
+
+/* UDP datagram types */
+#define UDP_DATA     'D' /* Counted */
+#define UDP_SYNC     'S' /* Answered with the octets counted so far */
+#define UDP_RESET    'R' /* Reset the counter, answered like UDP_SYNC */
+#define UDP_PING     'P' /* Sent back */
+
+typedef struct BenchProfile
+{
+	const char *name;
+	EthSwitchLink link;
+	bool tcp;           ///< Run the TCP benchmarks too.
+} BenchProfile;
+
+static const BenchProfile profiles[] =
+{
+	{ "local",            { 0, 0, 0 },             true },
+	{ "100Mbit/s 100us",  { 100, 100000000, 0 },   true },
+	{ "2Mbit/s 5ms",      { 5000, 2000000, 0 },    true },
+	/* Lost segments stall lwIP for its whole retransmission timeout */
+	{ "10Mbit/s 1% loss", { 500, 10000000, 10000 }, false },
+};
+
+static struct netif netif;
+static pid_t orchestrator;
+static uint8_t payload[BLOCK_LEN];
+
+static PROC_DEFINE_STACK(tcp_stack, KERN_MINSTACKSIZE * 2);
+static PROC_DEFINE_STACK(udp_stack, KERN_MINSTACKSIZE * 2);
+
+static struct ip_addr server_addr;
+
+/*
+ * Bring up BeRTOS and lwIP on node \a node, attached to port fd[node].
+ */
+static void node_start(int node, int *fd)
+{
+	struct ip_addr addr, netmask, gw;
+
+	close(fd[!node]);
+	eth_emulConnect(fd[node]);
+	mac_addr[5] = node;
+
+	timer_init();
+	proc_init();
+
+	tcpip_init(NULL, NULL);
+	IP4_ADDR(&addr, 10, 0, 0, node + 1);
+	IP4_ADDR(&netmask, 255, 255, 255, 0);
+	IP4_ADDR(&gw, 10, 0, 0, 254);
+	netif_add(&netif, &addr, &netmask, &gw, NULL, ethernetif_init, tcpip_input);
+	netif_set_default(&netif);
+	netif_set_up(&netif);
+}
+
+static void tcp_serve(struct netconn *conn)
+{
+	struct netbuf *buf;
+	unsigned long count = 0;
+	int mode = 0;
+
+	while ((buf = netconn_recv(conn)) != NULL)
+	{
+		do
+		{
+			uint8_t *data;
+			u16_t n;
+
+			netbuf_data(buf, (void **)&data, &n);
+			if (!mode && n)
+			{
+				mode = *data++;
+				n--;
+			}
+
+			if (mode == MODE_CLOSE)
+				break;
+			else if (mode == MODE_ECHO)
+				netconn_write(conn, data, n, NETCONN_COPY);
+			else
+			{
+				count += n;
+				for (; count >= BLOCK_LEN; count -= BLOCK_LEN)
+					netconn_write(conn, "K", 1, NETCONN_COPY);
+			}
+		}
+		while (netbuf_next(buf) >= 0);
+		netbuf_delete(buf);
+
+		if (mode == MODE_CLOSE)
+			break;
+	}
+}
+
+static NORETURN void tcp_service(void)
+{
+	struct netconn *server, *conn;
+
+	server = netconn_new(NETCONN_TCP);
+	netconn_bind(server, IP_ADDR_ANY, TCP_PORT);
+	netconn_listen(server);
+
+	for (;;)
+	{
+		conn = netconn_accept(server);
+		if (!conn)
+			continue;
+		conn->recv_timeout = 5000;
+		tcp_nagle_disable(conn->pcb.tcp);
+		tcp_serve(conn);
+		netconn_close(conn);
+		netconn_delete(conn);
+	}
+}
+
+static void udp_reply(struct netconn *conn, struct netbuf *to, uint32_t val)
+{
+	struct netbuf *buf = netbuf_new();
+	uint8_t *data;
+
+	if (!buf)
+		return;
+	data = netbuf_alloc(buf, 4);
+	if (data)
+	{
+		data[0] = val >> 24;
+		data[1] = val >> 16;
+		data[2] = val >> 8;
+		data[3] = val;
+		netconn_sendto(conn, buf, netbuf_fromaddr(to), netbuf_fromport(to));
+	}
+	netbuf_delete(buf);
+}
+
+static NORETURN void udp_service(void)
+{
+	struct netconn *conn;
+	struct netbuf *buf;
+	uint32_t count = 0;
+
+	conn = netconn_new(NETCONN_UDP);
+	netconn_bind(conn, IP_ADDR_ANY, UDP_PORT);
+
+	for (;;)
+	{
+		struct ip_addr addr;
+		uint8_t *data;
+		u16_t n;
+
+		buf = netconn_recv(conn);
+		if (!buf)
+			continue;
+		netbuf_data(buf, (void **)&data, &n);
+
+		switch (n ? *data : 0)
+		{
+		case UDP_DATA:
+			count += netbuf_len(buf);
+			break;
+		case UDP_RESET:
+			count = 0;
+			/* Fall through */
+		case UDP_SYNC:
+			udp_reply(conn, buf, count);
+			break;
+		case UDP_PING:
+			/* The source address is overwritten by the new headers */
+			addr = *netbuf_fromaddr(buf);
+			netconn_sendto(conn, buf, &addr, netbuf_fromport(buf));
+			break;
+		}
+		netbuf_delete(buf);
+	}
+}
+
+static NORETURN void node_server(int *fd)
+{
+	node_start(1, fd);
+	proc_new(tcp_service, NULL, sizeof(tcp_stack), tcp_stack);
+	proc_new(udp_service, NULL, sizeof(udp_stack), udp_stack);
+
+	/* Don't outlive the test */
+	while (getppid() == orchestrator)
+		timer_delay(100);
+	_exit(0);
+}
+
+static struct netconn *tcp_open(int mode)
+{
+	struct netconn *conn = netconn_new(NETCONN_TCP);
+	char m = mode;
+
+	if (!conn)
+		return NULL;
+	conn->recv_timeout = 5000;
+	if (netconn_connect(conn, &server_addr, TCP_PORT) != ERR_OK
+		|| netconn_write(conn, &m, 1, NETCONN_COPY) != ERR_OK)
+	{
+		netconn_delete(conn);
+		return NULL;
+	}
+	tcp_nagle_disable(conn->pcb.tcp);
+	return conn;
+}
+
+static void tcp_release(struct netconn *conn)
+{
+	netconn_close(conn);
+	netconn_delete(conn);
+}
+
+/* Wait for \a len octets, returning false on timeout or close */
+static bool tcp_wait(struct netconn *conn, size_t len)
+{
+	while (len)
+	{
+		struct netbuf *buf = netconn_recv(conn);
+
+		if (!buf)
+			return false;
+		len -= MIN(len, (size_t)netbuf_len(buf));
+		netbuf_delete(buf);
+	}
+	return true;
+}
+
+/* TCP throughput, in KiB/s */
+static long bench_tcpThroughput(void)
+{
+	struct netconn *conn = tcp_open(MODE_SINK);
+	unsigned long bytes = 0;
+	ticks_t start, elapsed;
+
+	if (!conn)
+		return -1;
+	start = timer_clock();
+	while ((elapsed = timer_clock() - start) < ms_to_ticks(BENCH_TIME))
+	{
+		if (netconn_write(conn, payload, BLOCK_LEN, NETCONN_NOCOPY) != ERR_OK
+			|| !tcp_wait(conn, 1))
+		{
+			tcp_release(conn);
+			return -1;
+		}
+		bytes += BLOCK_LEN;
+	}
+	tcp_release(conn);
+	return bytes * 1000 / 1024 / ticks_to_ms(elapsed);
+}
+
+/* TCP round trip of one octet, in us */
+static long bench_tcpLatency(void)
+{
+	struct netconn *conn = tcp_open(MODE_ECHO);
+	hptime_t start;
+
+	if (!conn)
+		return -1;
+	start = hptime_get();
+	for (int i = 0; i < PINGS; i++)
+	{
+		if (netconn_write(conn, payload, 1, NETCONN_COPY) != ERR_OK
+			|| !tcp_wait(conn, 1))
+		{
+			tcp_release(conn);
+			return -1;
+		}
+	}
+	start = hptime_get() - start;
+	tcp_release(conn);
+	return start / HPTIME_TICKS_PER_MICRO / PINGS;
+}
+
+/* TCP connections opened and closed each second */
+static long bench_tcpConnections(void)
+{
+	unsigned long count = 0;
+	ticks_t start, elapsed;
+
+	start = timer_clock();
+	while ((elapsed = timer_clock() - start) < ms_to_ticks(BENCH_TIME))
+	{
+		struct netconn *conn = tcp_open(MODE_CLOSE);
+
+		if (!conn)
+			return -1;
+		/* The server closes first */
+		tcp_wait(conn, 1);
+		tcp_release(conn);
+		count++;
+	}
+	return count * 1000 / ticks_to_ms(elapsed);
+}
+
+static bool udp_post(struct netconn *conn, int type, size_t len)
+{
+	struct netbuf *buf = netbuf_new();
+	err_t err;
+
+	if (!buf)
+		return false;
+	payload[0] = type;
+	netbuf_ref(buf, payload, len);
+	err = netconn_send(conn, buf);
+	netbuf_delete(buf);
+	return err == ERR_OK;
+}
+
+/* Send \a type and wait for the answer, up to \a tries times */
+static bool udp_call(struct netconn *conn, int type, uint32_t *val)
+{
+	for (int i = 0; i < 10; i++)
+	{
+		struct netbuf *buf;
+		uint8_t data[4];
+
+		if (!udp_post(conn, type, 1))
+			return false;
+		buf = netconn_recv(conn);
+		if (!buf)
+			continue;
+		if (val && netbuf_copy(buf, data, sizeof(data)) == sizeof(data))
+			*val = (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16
+				| (uint32_t)data[2] << 8 | data[3];
+		netbuf_delete(buf);
+		return true;
+	}
+	return false;
+}
+
+/*
+ * UDP throughput, in KiB/s, and the percentage of datagrams lost.
+ *
+ * Datagrams are sent in bursts, each one followed by a sync that lets the
+ * server catch up.
+ */
+static long bench_udpThroughput(struct netconn *conn, long *loss)
+{
+	unsigned long sent = 0;
+	uint32_t received = 0;
+	ticks_t start, elapsed;
+
+	if (!udp_call(conn, UDP_RESET, NULL))
+		return -1;
+
+	start = timer_clock();
+	while ((elapsed = timer_clock() - start) < ms_to_ticks(BENCH_TIME))
+	{
+		for (int i = 0; i < UDP_BURST; i++)
+			if (udp_post(conn, UDP_DATA, UDP_LEN))
+				sent += UDP_LEN;
+		udp_call(conn, UDP_SYNC, &received);
+	}
+	if (!udp_call(conn, UDP_SYNC, &received) || !sent)
+		return -1;
+
+	*loss = 100 - received * 100UL / sent;
+	return received * 1000UL / 1024 / ticks_to_ms(elapsed);
+}
+
+/* UDP round trip: minimum, average and maximum in us */
+static bool bench_udpLatency(struct netconn *conn, long *min, long *avg, long *max)
+{
+	hptime_t total = 0;
+	int replies = 0;
+
+	*min = LONG_MAX;
+	*max = 0;
+	for (int i = 0; i < PINGS; i++)
+	{
+		hptime_t start = hptime_get(), rtt;
+
+		if (!udp_call(conn, UDP_PING, NULL))
+			continue;
+		rtt = (hptime_get() - start) / HPTIME_TICKS_PER_MICRO;
+		*min = MIN(*min, (long)rtt);
+		*max = MAX(*max, (long)rtt);
+		total += rtt;
+		replies++;
+	}
+	if (!replies)
+		return false;
+	*avg = total / replies;
+	return true;
+}
+
+static NORETURN void node_client(int *fd, const BenchProfile *prof)
+{
+	struct netconn *udp;
+	long tcp = 0, tcp_rtt = 0, conns = 0;
+	long udp_rate, loss, min, avg, max;
+
+	node_start(0, fd);
+
+	for (size_t i = 0; i < sizeof(payload); i++)
+		payload[i] = i;
+
+	IP4_ADDR(&server_addr, 10, 0, 0, 2);
+	udp = netconn_new(NETCONN_UDP);
+	udp->recv_timeout = 100;
+	netconn_connect(udp, &server_addr, UDP_PORT);
+
+	/* The UDP latency comes first, it also resolves the server address */
+	if (!bench_udpLatency(udp, &min, &avg, &max))
+		goto error;
+	if ((udp_rate = bench_udpThroughput(udp, &loss)) < 0)
+		goto error;
+	if (prof->tcp
+		&& ((tcp = bench_tcpThroughput()) < 0
+		|| (tcp_rtt = bench_tcpLatency()) < 0
+		|| (conns = bench_tcpConnections()) < 0))
+		goto error;
+
+	kprintf("%s:\n", prof->name);
+	kprintf("  UDP %ld KiB/s, %ld%% lost, RTT min/avg/max %ld/%ld/%ld us\n",
+		udp_rate, loss, min, avg, max);
+	if (prof->tcp)
+		kprintf("  TCP %ld KiB/s, RTT %ld us, %ld connections/s\n",
+			tcp, tcp_rtt, conns);
+	_exit(0);
+
+error:
+	kprintf("%s: benchmark failed\n", prof->name);
+	_exit(1);
+}
+
+static int bench_profile(const BenchProfile *prof)
+{
+	int fd[2], status = -1;
+	pid_t sw, server, client;
+
+	sw = eth_switchStart(&prof->link, fd, 2);
+	if (sw < 0)
+		return -1;
+
+	server = fork();
+	if (server == 0)
+		node_server(fd);
+	client = fork();
+	if (client == 0)
+		node_client(fd, prof);
+
+	if (client > 0)
+		waitpid(client, &status, 0);
+	if (server > 0)
+	{
+		kill(server, SIGKILL);
+		waitpid(server, NULL, 0);
+	}
+	eth_switchStop(sw);
+	close(fd[0]);
+	close(fd[1]);
+
+	return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : -1;
+}
+
+int eth_switch_testRun(void)
+{
+	for (size_t i = 0; i < countof(profiles); i++)
+		if (bench_profile(&profiles[i]) < 0)
+			return -1;
+	return 0;
+}
+
+int eth_switch_testSetup(void)
+{
+	kdbg_init();
+	orchestrator = getpid();
+	return 0;
+}
+
+int eth_switch_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(eth_switch);
@@ -42,7 +42,7 @@
 #include "gfx_p.h"
 
 #include "cfg/cfg_gfx.h"  /* CONFIG_GFX_CLIPPING */
-#include <cfg/macros.h>   /* MIN() */
+#include <cfg/macros.h>   /* MIN(), MAX() */
 #include <cfg/debug.h>    /* ASSERT() */
 
 #include <cpu/attr.h>     /* CPU_HARVARD */
@@ -85,6 +85,10 @@ void gfx_bitmapInit(Bitmap *bm, uint8_t *raster, coord_t w, coord_t h)
 	bm->cr.xmax = w;
 	bm->cr.ymax = h;
 #endif /* CONFIG_GFX_CLIPPING */
+
+	/* The display does not match the raster yet */
+	gfx_clearDirty(bm);
+	gfx_markDirty(bm, 0, 0, w, h);
 }
 
 
@@ -97,9 +101,50 @@ void gfx_bitmapInit(Bitmap *bm, uint8_t *raster, coord_t w, coord_t h)
 void gfx_bitmapClear(Bitmap *bm)
 {
 	memset(bm->raster, 0, RAST_SIZE(bm->width, bm->height));
+	gfx_markDirty(bm, 0, 0, bm->width, bm->height);
 }
 
 
+#if CONFIG_GFX_DIRTY
+
+/**
+ * Add a rectangle to the area of \a bm modified since the last refresh.
+ *
+ * Drawing primitives call this function on their own; it is only needed
+ * after writing directly into the raster.  Coordinates follow the usual
+ * convention: xmax and ymax are not included.
+ *
+ * \see gfx_dirtyRect(), gfx_clearDirty()
+ */
+void gfx_markDirty(Bitmap *bm, coord_t xmin, coord_t ymin, coord_t xmax, coord_t ymax)
+{
+	xmin = MAX(xmin, (coord_t)0);
+	ymin = MAX(ymin, (coord_t)0);
+	xmax = MIN(xmax, bm->width);
+	ymax = MIN(ymax, bm->height);
+
+	if (xmin >= xmax || ymin >= ymax)
+		return;
+
+	if (bm->dirty.xmin >= bm->dirty.xmax)
+	{
+		bm->dirty.xmin = xmin;
+		bm->dirty.ymin = ymin;
+		bm->dirty.xmax = xmax;
+		bm->dirty.ymax = ymax;
+	}
+	else
+	{
+		bm->dirty.xmin = MIN(bm->dirty.xmin, xmin);
+		bm->dirty.ymin = MIN(bm->dirty.ymin, ymin);
+		bm->dirty.xmax = MAX(bm->dirty.xmax, xmax);
+		bm->dirty.ymax = MAX(bm->dirty.ymax, ymax);
+	}
+}
+
+#endif /* CONFIG_GFX_DIRTY */
+
+
 #if CPU_HARVARD
 
 #include <avr/pgmspace.h> /* FIXME: memcpy_P() */
@@ -113,6 +158,7 @@ void gfx_bitmapClear(Bitmap *bm)
 void gfx_blit_P(Bitmap *bm, const pgm_uint8_t *raster)
 {
 	memcpy_P(bm->raster, raster, RAST_SIZE(bm->width, bm->height));
+	gfx_markDirty(bm, 0, 0, bm->width, bm->height);
 }
 #endif /* CPU_HARVARD */
 
@@ -144,6 +190,147 @@ void gfx_blit_P(Bitmap *bm, const pgm_uint8_t *raster)
 #endif /* !CONFIG_GFX_CLIPPING */
 
 
+#if CONFIG_BITMAP_FMT == BITMAP_FMT_PLANAR_V_LSB
+
+/*
+ * Apply a raster operation on a whole row of bytes.
+ *
+ * Each destination byte holds 8 vertical pixels: \a lo and \a hi point
+ * to the two source bytes that straddle them (NULL when out of the source
+ * raster), and \a shift aligns the source bits to the destination ones.
+ */
+#define BLIT_ROW(op) \
+	do { \
+		for (coord_t x = 0; x < w; ++x) \
+		{ \
+			unsigned int v = (lo ? lo[x] : 0) | (hi ? hi[x] << 8 : 0); \
+			uint8_t bits = (uint8_t)(v >> shift) & mask; \
+			op; \
+		} \
+	} while (0)
+
+/*
+ * Blit engine for vertical planar bitmaps.
+ *
+ * Pixels are moved a whole byte (8 vertical pixels) at a time: the source
+ * bits are shifted to the destination alignment and merged under the mask
+ * of the rows affected in each destination page.
+ * Coordinates must be already clipped.
+ */
+static void gfx_blitPlanarV(Bitmap *dst, coord_t dxmin, coord_t dymin, coord_t dxmax, coord_t dymax,
+		const uint8_t *raster, coord_t sx, coord_t sy, coord_t sheight, coord_t stride, uint8_t rop)
+{
+	coord_t w = dxmax - dxmin;
+	coord_t spages = (sheight + 7) / 8;
+
+	for (coord_t page = dymin / 8; page * 8 < dymax; ++page)
+	{
+		coord_t top = page * 8;
+		uint8_t *d = dst->raster + page * dst->stride + dxmin;
+
+		/* Rows of this page touched by the blit */
+		coord_t rmin = MAX(dymin, top) - top;
+		coord_t rmax = MIN(dymax, top + 8) - top;
+		uint8_t mask = (uint8_t)((0xFF << rmin) & (0xFF >> (8 - rmax)));
+
+		/* Source row matching the first row of this page (can be < 0) */
+		coord_t s0 = sy + top - dymin + 8;
+		coord_t spage = s0 / 8 - 1;
+		uint8_t shift = s0 % 8;
+
+		const uint8_t *lo = (spage >= 0 && spage < spages) ? raster + spage * stride + sx : NULL;
+		const uint8_t *hi = (shift && spage + 1 < spages) ? raster + (spage + 1) * stride + sx : NULL;
+
+		switch (rop)
+		{
+		case GFX_ROP_COPY:
+			BLIT_ROW(d[x] = (d[x] & ~mask) | bits);
+			break;
+		case GFX_ROP_OR:
+			BLIT_ROW(d[x] |= bits);
+			break;
+		case GFX_ROP_XOR:
+			BLIT_ROW(d[x] ^= bits);
+			break;
+		case GFX_ROP_ANDNOT:
+			BLIT_ROW(d[x] &= ~bits);
+			break;
+		default:
+			ASSERT(0);
+		}
+	}
+}
+
+#undef BLIT_ROW
+
+#else /* CONFIG_BITMAP_FMT != BITMAP_FMT_PLANAR_V_LSB */
+
+static void gfx_blitPixels(Bitmap *dst, coord_t dxmin, coord_t dymin, coord_t dxmax, coord_t dymax,
+		const uint8_t *raster, coord_t sxmin, coord_t symin, coord_t stride, uint8_t rop)
+{
+	coord_t dx, dy, sx, sy;
+
+	for (dx = dxmin, sx = sxmin; dx < dxmax; ++dx, ++sx)
+		for (dy = dymin, sy = symin; dy < dymax; ++dy, ++sy)
+		{
+			if (!RAST_READPIXEL(raster, sx, sy, stride))
+			{
+				if (rop == GFX_ROP_COPY)
+					BM_CLEAR(dst, dx, dy);
+			}
+			else if (rop == GFX_ROP_XOR)
+				*BM_ADDR(dst, dx, dy) ^= BM_MASK(dst, dx, dy);
+			else if (rop == GFX_ROP_ANDNOT)
+				BM_CLEAR(dst, dx, dy);
+			else
+				BM_PLOT(dst, dx, dy);
+		}
+}
+
+#endif /* CONFIG_BITMAP_FMT != BITMAP_FMT_PLANAR_V_LSB */
+
+/**
+ * Blit a raster to a Bitmap, combining it with the destination pixels.
+ *
+ * Clipping is computed once for the whole blit; on vertical planar bitmaps
+ * pixels are then moved 8 at a time, with a shift when the destination
+ * Y coordinate is not aligned to the source one.
+ *
+ * \param dst     Bitmap where the operation writes.
+ * \param dxmin   Left destination coordinate.
+ * \param dymin   Top destination coordinate.
+ * \param raster  Source raster, in the same format of the bitmap.
+ * \param sx      Starting X offset in the source raster.
+ * \param sy      Starting Y offset in the source raster.
+ * \param w       Width of the area to copy.
+ * \param h       Height of the area to copy.
+ * \param sheight Height in pixels of the whole source raster.
+ * \param stride  Bytes per row of the source raster.
+ * \param rop     Raster operation, one of GFX_ROP_*.
+ */
+void gfx_blitRasterRop(Bitmap *dst, coord_t dxmin, coord_t dymin,
+		const uint8_t *raster, coord_t sx, coord_t sy, coord_t w, coord_t h,
+		coord_t sheight, coord_t stride, uint8_t rop)
+{
+	coord_t dxmax = dxmin + w, dymax = dymin + h;
+
+	/* Perform regular clipping */
+	gfx_clip(dxmin, dxmax, sx, dst->cr.xmin, dst->cr.xmax);
+	gfx_clip(dymin, dymax, sy, dst->cr.ymin, dst->cr.ymax);
+
+	if (dxmin >= dxmax || dymin >= dymax)
+		return;
+
+	gfx_markDirty(dst, dxmin, dymin, dxmax, dymax);
+
+#if CONFIG_BITMAP_FMT == BITMAP_FMT_PLANAR_V_LSB
+	gfx_blitPlanarV(dst, dxmin, dymin, dxmax, dymax, raster, sx, sy, sheight, stride, rop);
+#else
+	(void)sheight;
+	gfx_blitPixels(dst, dxmin, dymin, dxmax, dymax, raster, sx, sy, stride, rop);
+#endif
+}
+
 /**
  * Copy a rectangular area of a bitmap on another bitmap.
  *
@@ -163,55 +350,25 @@ void gfx_blit_P(Bitmap *bm, const pgm_uint8_t *raster)
  */
 void gfx_blit(Bitmap *dst, const Rect *rect, const Bitmap *src, coord_t srcx, coord_t srcy)
 {
-	coord_t dxmin, dymin, dxmax, dymax;
-	coord_t dx, dy, sx, sy;
-
 	/*
 	 * Pre-clip coordinates inside src->width/height.
 	 */
-	dxmin = rect->xmin;
-	dymin = rect->ymin;
-	dxmax = MIN(rect->xmax, rect->xmin + src->width);
-	dymax = MIN(rect->ymax, rect->ymin + src->height);
-
-	/* Perform regular clipping */
-	gfx_clip(dxmin, dxmax, srcx, dst->cr.xmin, dst->cr.xmax);
-	gfx_clip(dymin, dymax, srcy, dst->cr.ymin, dst->cr.ymax);
-
-	//kprintf("dxmin=%d, sxmin=%d, dxmax=%d; ", dxmin, sxmin, dxmax);
-	//kprintf("dymin=%d, symin=%d, dymax=%d\n", dymin, symin, dymax);
+	coord_t w = MIN(RECT_WIDTH(rect), src->width - srcx);
+	coord_t h = MIN(RECT_HEIGHT(rect), src->height - srcy);
 
-	/* TODO: make it not as dog slow as this */
-	for (dx = dxmin, sx = srcx; dx < dxmax; ++dx, ++sx)
-		for (dy = dymin, sy = srcy; dy < dymax; ++dy, ++sy)
-			BM_DRAWPIXEL(dst, dx, dy, BM_READPIXEL(src, sx, sy));
+	gfx_blitRasterRop(dst, rect->xmin, rect->ymin, src->raster, srcx, srcy,
+			w, h, src->height, src->stride, GFX_ROP_COPY);
 }
 
 /**
  * Blit a raster to a Bitmap.
  *
- * \todo Merge this function into gfx_blit()
- *
- * \see gfx_blit()
+ * \see gfx_blitRasterRop()
  */
 void gfx_blitRaster(Bitmap *dst, coord_t dxmin, coord_t dymin,
 		const uint8_t *raster, coord_t w, coord_t h, coord_t stride)
 {
-	coord_t dxmax = dxmin + w, dymax = dymin + h;
-	coord_t sxmin = 0, symin = 0;
-	coord_t dx, dy, sx, sy;
-
-	/* Perform regular clipping */
-	gfx_clip(dxmin, dxmax, sxmin, dst->cr.xmin, dst->cr.xmax);
-	gfx_clip(dymin, dymax, symin, dst->cr.ymin, dst->cr.ymax);
-
-	//kprintf("dxmin=%d, sxmin=%d, dxmax=%d; ", dxmin, sxmin, dxmax);
-	//kprintf("dymin=%d, symin=%d, dymax=%d\n", dymin, symin, dymax);
-
-	/* TODO: make it not as dog slow as this */
-	for (dx = dxmin, sx = sxmin; dx < dxmax; ++dx, ++sx)
-		for (dy = dymin, sy = symin; dy < dymax; ++dy, ++sy)
-			BM_DRAWPIXEL(dst, dx, dy, RAST_READPIXEL(raster, sx, sy, stride));
+	gfx_blitRasterRop(dst, dxmin, dymin, raster, 0, 0, w, h, h, stride, GFX_ROP_COPY);
 }
 
 /**
@@ -0,0 +1,255 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Blit engine cross check and benchmark.
+ *
+ * $test$: cp bertos/cfg/cfg_gfx.h $cfgdir/
+ * $test$: echo "#undef CONFIG_GFX_DIRTY" >> $cfgdir/cfg_gfx.h
+ * $test$: echo "#define CONFIG_GFX_DIRTY 1" >> $cfgdir/cfg_gfx.h
+ */
+
+#include "gfx.h"
+#include "gfx_p.h"
+#include "text.h"
+#include "win.h"
+#include "font.h"
+
+#include <cfg/test.h>
+#include <cfg/debug.h>
+#include <cfg/macros.h>
+
+#include <drv/timer.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define W 128
+#define H 64
+
+static uint8_t raster[RAST_SIZE(W, H)];
+static uint8_t ref_raster[RAST_SIZE(W, H)];
+static uint8_t src_raster[RAST_SIZE(W, H)];
+static Bitmap bm, ref, src;
+
+/* Pixel by pixel reference implementation */
+static void blit_ref(Bitmap *dst, coord_t dx, coord_t dy, const Bitmap *s,
+		coord_t sx, coord_t sy, coord_t w, coord_t h, uint8_t rop)
+{
+	for (coord_t x = 0; x < w; x++)
+		for (coord_t y = 0; y < h; y++)
+		{
+			coord_t px = dx + x, py = dy + y;
+
+			if (px < dst->cr.xmin || px >= dst->cr.xmax
+				|| py < dst->cr.ymin || py >= dst->cr.ymax
+				|| sx + x >= s->width || sy + y >= s->height)
+				continue;
+
+			bool pix = BM_READPIXEL(s, sx + x, sy + y);
+			bool old = BM_READPIXEL(dst, px, py);
+
+			switch (rop)
+			{
+			case GFX_ROP_COPY:   old = pix; break;
+			case GFX_ROP_OR:     old |= pix; break;
+			case GFX_ROP_XOR:    old ^= pix; break;
+			case GFX_ROP_ANDNOT: old &= !pix; break;
+			}
+			BM_DRAWPIXEL(dst, px, py, old);
+		}
+}
+
+int bitmap_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+	gfx_bitmapInit(&bm, raster, W, H);
+	gfx_bitmapInit(&ref, ref_raster, W, H);
+	gfx_bitmapInit(&src, src_raster, W, H);
+	return 0;
+}
+
+int bitmap_testTearDown(void)
+{
+	return 0;
+}
+
+#define BENCH_TIME ms_to_ticks(200)
+
+/* Run \a op in batches until BENCH_TIME elapses, return operations per second */
+#define BENCH(op) \
+	({ \
+		ticks_t start = timer_clock(), t; \
+		unsigned long n = 0; \
+		do { \
+			for (int k = 0; k < 64; k++, n++) \
+				op; \
+			t = timer_clock() - start; \
+		} while (t < BENCH_TIME); \
+		(unsigned long)((uint64_t)n * 1000000 / ticks_to_us(t)); \
+	})
+
+static void bitmap_benchmark(void)
+{
+	static const coord_t sizes[] = { 8, 16, 64, 128 };
+
+	gfx_setClipRect(&bm, 0, 0, W, H);
+	ref.cr = bm.cr;
+	for (unsigned i = 0; i < countof(sizes); i++)
+	{
+		coord_t w = sizes[i], h = MIN(sizes[i], (coord_t)(H - 8));
+
+		/* Unaligned Y exercises the shift path */
+		kprintf("blit %dx%d: %lu blits/s (per pixel: %lu blits/s)\n", w, h,
+			BENCH(gfx_blitRasterRop(&bm, 0, n & 7, src.raster, 0, 0, w, h, src.height, src.stride, GFX_ROP_COPY)),
+			BENCH(blit_ref(&ref, 0, n & 7, &src, 0, 0, w, h, GFX_ROP_COPY)));
+	}
+
+	kprintf("text: %lu glyphs/s\n", BENCH(
+		({
+			/* 4 lines of 12 glyphs fill the display */
+			if (n % 12 == 0)
+				text_moveTo(&bm, n / 12 % 4, 0);
+			text_putchar('A' + n % 26, &bm);
+		})));
+}
+
+#define ASSERT_DIRTY(b, x1, y1, x2, y2) \
+	do { \
+		Rect d; \
+		ASSERT(gfx_dirtyRect((b), &d)); \
+		ASSERT(d.xmin == (x1) && d.ymin == (y1) && d.xmax == (x2) && d.ymax == (y2)); \
+		gfx_clearDirty(b); \
+	} while (0)
+
+static void bitmap_testDirty(void)
+{
+	static uint8_t child_raster[2][RAST_SIZE(32, 16)];
+	static uint8_t composed[RAST_SIZE(W, H)];
+	Bitmap child_bm[2];
+	Window root, child[2];
+	Rect d;
+
+	gfx_setClipRect(&bm, 0, 0, W, H);
+	gfx_clearDirty(&bm);
+	ASSERT(!gfx_dirtyRect(&bm, &d));
+
+	gfx_line(&bm, 20, 10, 3, 4);
+	ASSERT_DIRTY(&bm, 3, 4, 21, 11);
+
+	gfx_rectFill(&bm, 10, 30, -5, 10);
+	ASSERT_DIRTY(&bm, 0, 10, 10, 30);
+
+	gfx_blitRasterRop(&bm, W - 4, 60, src.raster, 0, 0, 16, 16, src.height, src.stride, GFX_ROP_XOR);
+	ASSERT_DIRTY(&bm, W - 4, 60, W, H);
+
+	text_moveTo(&bm, 1, 0);
+	text_putchar('A', &bm);
+	ASSERT_DIRTY(&bm, 0, default_font.height, default_font.widths['A' - default_font.first], 2 * default_font.height);
+
+	/* Only damaged areas are recomposed, with the same result */
+	win_create(&root, &bm);
+	for (int i = 0; i < 2; i++)
+	{
+		gfx_bitmapInit(&child_bm[i], child_raster[i], 32, 16);
+		memset(child_raster[i], i ? 0x55 : 0xff, sizeof(child_raster[i]));
+		win_create(&child[i], &child_bm[i]);
+		win_move(&child[i], 10 + i * 16, 10 + i * 4);
+		win_open(&child[i], &root);
+	}
+	win_compose(&root);
+	ASSERT_DIRTY(&bm, 10, 10, 58, 30);
+
+	gfx_rectClear(&child_bm[1], 0, 0, 4, 2);
+	win_compose(&root);
+	ASSERT_DIRTY(&bm, 26, 14, 30, 16);
+	memcpy(composed, raster, sizeof(raster));
+	gfx_markDirty(&bm, 0, 0, W, H);
+	win_compose(&root);
+	ASSERT(memcmp(composed, raster, sizeof(raster)) == 0);
+	gfx_clearDirty(&bm);
+
+	/* Raising a window exposes it entirely */
+	win_raise(&child[0]);
+	win_compose(&root);
+	ASSERT_DIRTY(&bm, 10, 10, 42, 26);
+	ASSERT(!gfx_dirtyRect(&child_bm[0], &d));
+}
+
+int bitmap_testRun(void)
+{
+	for (size_t i = 0; i < sizeof(src_raster); i++)
+		src_raster[i] = rand();
+
+	for (int run = 0; run < 20000; run++)
+	{
+		coord_t sx = rand() % W, sy = rand() % H;
+		coord_t w = rand() % (W + 1), h = rand() % (H + 1);
+		coord_t dx = rand() % (W + 32) - 16, dy = rand() % (H + 32) - 16;
+		uint8_t rop = rand() % 4;
+		coord_t cx = rand() % W, cy = rand() % H;
+
+		for (size_t i = 0; i < sizeof(raster); i++)
+			raster[i] = ref_raster[i] = rand();
+
+		gfx_setClipRect(&bm, cx, cy, cx + 1 + rand() % (W - cx), cy + 1 + rand() % (H - cy));
+		ref.cr = bm.cr;
+
+		w = MIN(w, (coord_t)(W - sx));
+		h = MIN(h, (coord_t)(H - sy));
+		gfx_blitRasterRop(&bm, dx, dy, src.raster, sx, sy, w, h, src.height, src.stride, rop);
+		blit_ref(&ref, dx, dy, &src, sx, sy, w, h, rop);
+		ASSERT(memcmp(raster, ref_raster, sizeof(raster)) == 0);
+	}
+
+	/* gfx_blit() clips to the source bitmap */
+	Rect r = { 10, 3, 10 + W, 3 + H };
+	memset(raster, 0, sizeof(raster));
+	memset(ref_raster, 0, sizeof(ref_raster));
+	gfx_setClipRect(&bm, 0, 0, W, H);
+	ref.cr = bm.cr;
+	gfx_blit(&bm, &r, &src, 5, 7);
+	blit_ref(&ref, 10, 3, &src, 5, 7, W, H, GFX_ROP_COPY);
+	ASSERT(memcmp(raster, ref_raster, sizeof(raster)) == 0);
+
+	bitmap_testDirty();
+	bitmap_benchmark();
+	return 0;
+}
+
+TEST_MAIN(bitmap);
+
+#include "bitmap.c"
+#include "line.c"
+#include "text.c"
+#include "win.c"
+#include <fonts/luBS14.c>
@@ -73,6 +73,13 @@
 #if !defined(CONFIG_GFX_TEXT) || (CONFIG_GFX_TEXT != 0 && CONFIG_GFX_TEXT != 1)
 	#error CONFIG_GFX_TEXT must be defined to either 0 or 1
 #endif
+/* Projects configured before dirty tracking was added don't use it. */
+#ifndef CONFIG_GFX_DIRTY
+	#define CONFIG_GFX_DIRTY 0
+#endif
+#if CONFIG_GFX_DIRTY != 0 && CONFIG_GFX_DIRTY != 1
+	#error CONFIG_GFX_DIRTY must be defined to either 0 or 1
+#endif
 
 EXTERN_C_BEGIN
 
@@ -159,6 +166,16 @@ typedef struct Bitmap
 	uint8_t styles;
 #endif /* CONFIG_GFX_TEXT */
 
+#if CONFIG_GFX_DIRTY
+	/**
+	 * Bounding box of the pixels modified since the last
+	 * call to gfx_clearDirty(), empty when xmin >= xmax.
+	 *
+	 * \see gfx_markDirty()
+	 */
+	Rect dirty;
+#endif /* CONFIG_GFX_DIRTY */
+
 #if CONFIG_GFX_VCOORDS
 	/**
 	 * \name Logical coordinate system
@@ -201,11 +218,23 @@ typedef struct Image
 	#error Unknown value of CONFIG_BITMAP_FMT
 #endif /* CONFIG_BITMAP_FMT */
 
+/**
+ * \name Raster operations for gfx_blitRasterRop().
+ * \{
+ */
+#define GFX_ROP_COPY    0  /**< Destination pixels are replaced by source pixels. */
+#define GFX_ROP_OR      1  /**< Source pixels set are drawn over the destination. */
+#define GFX_ROP_XOR     2  /**< Source pixels set invert the destination. */
+#define GFX_ROP_ANDNOT  3  /**< Source pixels set clear the destination. */
+/* \} */
+
 /* Function prototypes */
 void gfx_bitmapInit (Bitmap *bm, uint8_t *raster, coord_t w, coord_t h);
 void gfx_bitmapClear(Bitmap *bm);
 void gfx_blit       (Bitmap *dst, const Rect *rect, const Bitmap *src, coord_t srcx, coord_t srcy);
 void gfx_blitRaster (Bitmap *dst, coord_t dx, coord_t dy, const uint8_t *raster, coord_t w, coord_t h, coord_t stride);
+void gfx_blitRasterRop(Bitmap *dst, coord_t dx, coord_t dy, const uint8_t *raster, coord_t sx, coord_t sy,
+		coord_t w, coord_t h, coord_t sheight, coord_t stride, uint8_t rop);
 void gfx_blitImage  (Bitmap *dst, coord_t dx, coord_t dy, const Image *image);
 void gfx_line       (Bitmap *bm, coord_t x1, coord_t y1, coord_t x2, coord_t y2);
 void gfx_rectDraw   (Bitmap *bm, coord_t x1, coord_t y1, coord_t x2, coord_t y2);
@@ -228,6 +257,49 @@ INLINE void gfx_setFont(Bitmap *bm, const struct Font *font)
 }
 #endif
 
+#if CONFIG_GFX_DIRTY
+void gfx_markDirty(Bitmap *bm, coord_t xmin, coord_t ymin, coord_t xmax, coord_t ymax);
+
+/**
+ * Forget the area modified so far, usually after it has been
+ * transferred to the display.
+ */
+INLINE void gfx_clearDirty(Bitmap *bm)
+{
+	bm->dirty.xmin = bm->dirty.ymin = 0;
+	bm->dirty.xmax = bm->dirty.ymax = 0;
+}
+
+/**
+ * Get the bounding box of the area modified in \a bm.
+ *
+ * \return true if the area is not empty.
+ */
+INLINE bool gfx_dirtyRect(const Bitmap *bm, Rect *r)
+{
+	*r = bm->dirty;
+	return r->xmin < r->xmax;
+}
+#else /* !CONFIG_GFX_DIRTY */
+INLINE void gfx_markDirty(UNUSED_ARG(Bitmap *, bm), UNUSED_ARG(coord_t, xmin), UNUSED_ARG(coord_t, ymin),
+		UNUSED_ARG(coord_t, xmax), UNUSED_ARG(coord_t, ymax))
+{
+}
+
+INLINE void gfx_clearDirty(UNUSED_ARG(Bitmap *, bm))
+{
+}
+
+/* Without tracking, the whole bitmap must be refreshed every time. */
+INLINE bool gfx_dirtyRect(const Bitmap *bm, Rect *r)
+{
+	r->xmin = r->ymin = 0;
+	r->xmax = bm->width;
+	r->ymax = bm->height;
+	return true;
+}
+#endif /* !CONFIG_GFX_DIRTY */
+
 #if CONFIG_GFX_VCOORDS
 void gfx_setViewRect(Bitmap *bm, vcoord_t x1, vcoord_t y1, vcoord_t x2, vcoord_t y2);
 coord_t gfx_transformX(Bitmap *bm, vcoord_t x);
@@ -237,6 +237,7 @@ void gfx_line(Bitmap *bm, coord_t x1, coord_t y1, coord_t x2, coord_t y2)
 	}
 #endif /* CONFIG_GFX_CLIPPING */
 
+	gfx_markDirty(bm, MIN(x1, x2), MIN(y1, y2), MAX(x1, x2) + 1, MAX(y1, y2) + 1);
 	gfx_lineUnclipped(bm, x1, y1, x2, y2);
 }
 
@@ -314,6 +315,8 @@ void gfx_rectFillC(Bitmap *bm, coord_t x1, coord_t y1, coord_t x2, coord_t y2, u
 	if (y2 > bm->cr.ymax)   y2 = bm->cr.ymax;
 #endif /* CONFIG_GFX_CLIPPING */
 
+	gfx_markDirty(bm, x1, y1, x2, y2);
+
 	/* NOTE: Code paths are duplicated for efficiency */
 	if (color) /* fill */
 	{
@@ -66,16 +66,62 @@
 
 #include "win.h"
 #include <struct/list.h>
+#include <cfg/macros.h> /* MIN(), MAX() */
+
+/**
+ * Damage the area covered by window \a w in its parent.
+ */
+static void win_damage(Window *w)
+{
+	if (w->parent && w->parent->bitmap)
+		gfx_markDirty(w->parent->bitmap, w->geom.xmin, w->geom.ymin, w->geom.xmax, w->geom.ymax);
+}
 
 /**
  * Map the contents of all child-windows into the bitmap of \a w.
  *
+ * Only the damaged area of \a w is recomposed: the union of the
+ * areas modified in its own bitmap and in the bitmaps of its children
+ * since the last composition, plus the areas uncovered or exposed
+ * by moving, raising, opening or closing a child.
+ *
  * \note Recursively drawing children into their parent
  *       effectively damages the parent buffer.
  */
 void win_compose(Window *w)
 {
 	Window *child;
+	Rect damage;
+
+	/*
+	 * Recursively compose children first, and collect
+	 * the areas they modified.
+	 */
+	REVERSE_FOREACH_NODE(child, &w->children)
+	{
+		win_compose(child);
+
+		if (w->bitmap && child->bitmap && gfx_dirtyRect(child->bitmap, &damage))
+			gfx_markDirty(w->bitmap,
+				child->geom.xmin + damage.xmin, child->geom.ymin + damage.ymin,
+				MIN(child->geom.xmin + damage.xmax, child->geom.xmax),
+				MIN(child->geom.ymin + damage.ymax, child->geom.ymax));
+	}
+
+	if (!w->bitmap || !gfx_dirtyRect(w->bitmap, &damage))
+		return;
+
+#if CONFIG_GFX_CLIPPING
+	/* Restrict drawing to the damaged area */
+	Rect old_cr = w->bitmap->cr;
+
+	damage.xmin = MAX(damage.xmin, old_cr.xmin);
+	damage.ymin = MAX(damage.ymin, old_cr.ymin);
+	damage.xmax = MIN(damage.xmax, old_cr.xmax);
+	damage.ymax = MIN(damage.ymax, old_cr.ymax);
+	if (damage.xmin < damage.xmax && damage.ymin < damage.ymax)
+		w->bitmap->cr = damage;
+#endif
 
 	/*
 	 * Walk over all children, in back to front order and tell them
@@ -83,13 +129,20 @@ void win_compose(Window *w)
 	 */
 	REVERSE_FOREACH_NODE(child, &w->children)
 	{
-		/* Recursively compose child first. */
-		win_compose(child);
+		if (!child->bitmap)
+			continue;
 
-		/* Draw child into our bitmap. */
-		if (w->bitmap)
+		/* Skip children outside the damaged area */
+		if (child->geom.xmin < damage.xmax && child->geom.xmax > damage.xmin
+				&& child->geom.ymin < damage.ymax && child->geom.ymax > damage.ymin)
 			gfx_blit(w->bitmap, &child->geom, child->bitmap, 0, 0);
+
+		gfx_clearDirty(child->bitmap);
 	}
+
+#if CONFIG_GFX_CLIPPING
+	w->bitmap->cr = old_cr;
+#endif
 }
 
 /**
@@ -106,6 +159,7 @@ void win_open(Window *w, Window *parent)
 	ASSERT(!w->parent);
 	w->parent = parent;
 	ADDHEAD(&parent->children, &w->link);
+	win_damage(w);
 }
 
 /**
@@ -123,6 +177,7 @@ void win_open(Window *w, Window *parent)
 void win_close(Window *w)
 {
 	ASSERT(w->parent);
+	win_damage(w);
 	REMOVE(&w->link);
 	w->parent = NULL;
 }
@@ -137,6 +192,7 @@ void win_raise(Window *w)
 	ASSERT(w->parent);
 	REMOVE(&w->link);
 	ADDHEAD(&w->parent->children, &w->link);
+	win_damage(w);
 }
 
 /**
@@ -156,7 +212,9 @@ void win_setGeometry(Window *w, const Rect *new_geom)
 {
 	// requires C99?
 	// memcpy(&w->geom, new_geom, sizeof(w->geom));
+	win_damage(w);
 	w->geom = *new_geom;
+	win_damage(w);
 }
 
 /**
@@ -177,7 +235,7 @@ void win_move(Window *w, coord_t left, coord_t top)
 	r.xmin = left;
 	r.ymin = top;
 	r.xmax = r.xmin + RECT_WIDTH(&w->geom);
-	r.ymax = r.ymin + RECT_WIDTH(&w->geom);
+	r.ymax = r.ymin + RECT_HEIGHT(&w->geom);
 
 	win_setGeometry(w, &r);
 }
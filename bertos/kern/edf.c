@@ -0,0 +1,339 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Earliest deadline first scheduling class.
+ *
+ * The priority of an EDF process is INT_MAX minus the distance of its
+ * deadline from edf_epoch. Absolute deadlines never change their relative
+ * order, so the ready list stays sorted without any help; the epoch is
+ * moved forward, and the priorities recomputed, only when a new deadline
+ * would fall outside the range reserved to the class.
+ *
+ * The EDF processes are kept sorted by the time of their next deadline or
+ * release, so the timer tick only looks at the head of the list and its
+ * cost does not grow with the number of processes.
+ */
+
+#include "edf.h"
+
+#if CONFIG_KERN_EDF
+
+#include <cfg/debug.h>
+#include <cfg/macros.h>
+
+#include <cpu/irq.h>
+
+#include <drv/timer.h>
+
+#include <kern/proc_p.h>
+
+#include <struct/list.h>
+
+#define EDF_DONE       BV(0)  ///< Job completed, waiting for the next release.
+#define EDF_PARKED     BV(1)  ///< Sleeping in edf_waitPeriod().
+#define EDF_MISSED     BV(2)  ///< Deadline miss of the current job already counted.
+#define EDF_THROTTLED  BV(3)  ///< Budget of the current job exhausted.
+
+/* Throttled jobs run only when no other process is ready */
+#define EDF_PRI_THROTTLED  INT_MIN
+
+/* Widest distance of a deadline from the epoch */
+#define EDF_SPAN  ((ticks_t)(INT_MAX / 2))
+
+#if CONFIG_KERN_PRI_INHERIT || CONFIG_KERN_PRI_CEILING
+	#define edf_basePri(proc)  ((proc)->orig_pri)
+#else
+	#define edf_basePri(proc)  ((proc)->link.pri)
+#endif
+
+/*
+ * EDF processes, accessed with interrupts disabled: the ones with a
+ * pending deadline or release sorted by edf.event, and the ones with a
+ * late job still running, which wait for edf_waitPeriod().
+ */
+static List edf_timeline;
+static List edf_late;
+static ticks_t edf_epoch;
+
+static int edf_pri(Process *proc)
+{
+	ticks_t d;
+
+	if (proc->edf.flags & EDF_THROTTLED)
+		return EDF_PRI_THROTTLED;
+
+	/* Deadlines already expired when the epoch moved all share the top */
+	d = proc->edf.deadline - edf_epoch;
+	if (d < 0)
+		d = 0;
+	return INT_MAX - (int)d;
+}
+
+static void edf_rebase(ticks_t deadline)
+{
+	Node *node;
+
+	if (deadline - edf_epoch <= EDF_SPAN)
+		return;
+
+	edf_epoch = deadline - EDF_SPAN / 2;
+	FOREACH_NODE(node, &edf_timeline)
+	{
+		Process *proc = containerof(node, Process, edf.link);
+		proc_setPri(proc, edf_pri(proc));
+	}
+	FOREACH_NODE(node, &edf_late)
+	{
+		Process *proc = containerof(node, Process, edf.link);
+		proc_setPri(proc, edf_pri(proc));
+	}
+}
+
+/*
+ * Move \a proc to its place in the timeline, after a change of the state
+ * of its job. The next event is the deadline of a job not completed yet,
+ * or the release of the next job once the current one is done or has
+ * used up its budget.
+ */
+static void edf_queue(Process *proc)
+{
+	struct ProcEdf *edf = &proc->edf;
+	bool timed = false;
+	Node *node;
+
+	REMOVE(&edf->link);
+
+	if (!(edf->flags & (EDF_DONE | EDF_MISSED)))
+	{
+		edf->event = edf->deadline;
+		timed = true;
+	}
+	if ((edf->flags & (EDF_DONE | EDF_THROTTLED))
+			&& (!timed || edf->release - edf->event < 0))
+	{
+		edf->event = edf->release;
+		timed = true;
+	}
+
+	if (!timed)
+	{
+		ADDTAIL(&edf_late, &edf->link);
+		return;
+	}
+
+	FOREACH_NODE(node, &edf_timeline)
+		if (containerof(node, Process, edf.link)->edf.event - edf->event > 0)
+			break;
+	INSERT_BEFORE(&edf->link, node);
+}
+
+/*
+ * Start the job of \a proc due at edf.release, skipping the ones whose
+ * deadline has already expired.
+ */
+static void edf_release(Process *proc, ticks_t now)
+{
+	struct ProcEdf *edf = &proc->edf;
+
+	for (;;)
+	{
+		edf->deadline = edf->release + edf->rel_deadline;
+		edf->release += edf->period;
+		edf->stats.jobs++;
+		if (edf->deadline - now > 0)
+			break;
+		edf->stats.misses++;
+	}
+	edf->left = edf->budget;
+	edf->flags &= EDF_PARKED;
+	edf_queue(proc);
+
+	edf_rebase(edf->deadline);
+	proc_setPri(proc, edf_pri(proc));
+}
+
+/* Put a process sleeping in edf_waitPeriod() back in the ready list */
+static void edf_unpark(Process *proc)
+{
+	if (proc->edf.flags & EDF_PARKED)
+	{
+		proc->edf.flags &= ~EDF_PARKED;
+		SCHED_ENQUEUE(proc);
+	}
+}
+
+void edf_init(void)
+{
+	LIST_INIT(&edf_timeline);
+	LIST_INIT(&edf_late);
+}
+
+void edf_remove(Process *proc)
+{
+	cpu_flags_t flags;
+
+	IRQ_SAVE_DISABLE(flags);
+	if (proc->edf.period)
+	{
+		REMOVE(&proc->edf.link);
+		proc->edf.period = 0;
+	}
+	IRQ_RESTORE(flags);
+}
+
+void edf_tick(void)
+{
+	ticks_t now = timer_clock_unlocked();
+	Process *curr = current_process;
+
+	IRQ_ASSERT_DISABLED();
+
+	if (curr && curr->edf.period && curr->edf.budget
+			&& !(curr->edf.flags & (EDF_DONE | EDF_THROTTLED))
+			&& --curr->edf.left <= 0)
+	{
+		curr->edf.flags |= EDF_THROTTLED;
+		curr->edf.stats.throttles++;
+		proc_setPri(curr, EDF_PRI_THROTTLED);
+		/* The release of the next job may come before the deadline */
+		edf_queue(curr);
+	}
+
+	while (!LIST_EMPTY(&edf_timeline))
+	{
+		Process *proc = containerof(LIST_HEAD(&edf_timeline), Process, edf.link);
+		struct ProcEdf *edf = &proc->edf;
+
+		if (now - edf->event < 0)
+			break;
+
+		if (!(edf->flags & (EDF_DONE | EDF_MISSED)) && now - edf->deadline >= 0)
+		{
+			edf->flags |= EDF_MISSED;
+			edf->stats.misses++;
+		}
+
+		/*
+		 * A throttled job gets its next budget here and goes on as
+		 * the next job, since it has already missed its deadline.
+		 */
+		if ((edf->flags & (EDF_DONE | EDF_THROTTLED)) && now - edf->release >= 0)
+		{
+			edf_release(proc, now);
+			edf_unpark(proc);
+		}
+		else
+			edf_queue(proc);
+	}
+}
+
+void edf_setup(Process *proc, mtime_t period, mtime_t budget, mtime_t deadline)
+{
+	bool yield;
+
+	ASSERT(proc);
+	ASSERT(period >= 0 && budget >= 0 && deadline >= 0);
+	IRQ_ASSERT_ENABLED();
+
+	IRQ_DISABLE;
+	if (period)
+	{
+		ticks_t now = timer_clock_unlocked();
+
+		if (!proc->edf.period)
+		{
+			proc->edf.pri = edf_basePri(proc);
+			if (LIST_EMPTY(&edf_timeline) && LIST_EMPTY(&edf_late))
+				edf_epoch = now;
+			ADDTAIL(&edf_late, &proc->edf.link);
+		}
+		proc->edf.period = MAX(ms_to_ticks(period), (ticks_t)1);
+		proc->edf.budget = budget ? MAX(ms_to_ticks(budget), (ticks_t)1) : 0;
+		proc->edf.rel_deadline = deadline ? MAX(ms_to_ticks(deadline), (ticks_t)1) : proc->edf.period;
+		proc->edf.release = now;
+		edf_release(proc, now);
+	}
+	else if (proc->edf.period)
+	{
+		REMOVE(&proc->edf.link);
+		proc->edf.period = 0;
+		proc_setPri(proc, proc->edf.pri);
+	}
+	edf_unpark(proc);
+
+	yield = (proc_preemptAllowed() && prio_next() > prio_curr());
+	IRQ_ENABLE;
+
+	if (yield)
+		proc_yield();
+}
+
+void edf_waitPeriod(void)
+{
+	Process *proc = current_process;
+	ticks_t now;
+	bool yield = false;
+
+	ASSERT(proc->edf.period);
+	IRQ_ASSERT_ENABLED();
+	ASSERT(proc_preemptAllowed());
+
+	IRQ_DISABLE;
+	proc->edf.flags |= EDF_DONE;
+
+	now = timer_clock_unlocked();
+	if (now - proc->edf.release >= 0)
+	{
+		/* Late: the next job is already due */
+		edf_release(proc, now);
+		yield = prio_next() > prio_curr();
+	}
+	else
+	{
+		/* edf_tick() puts us back in the ready list at the release */
+		edf_queue(proc);
+		proc->edf.flags |= EDF_PARKED;
+		while (proc->edf.flags & EDF_PARKED)
+			proc_switch();
+	}
+	IRQ_ENABLE;
+
+	if (yield)
+		proc_yield();
+}
+
+void edf_stats(Process *proc, EdfStats *stats)
+{
+	ATOMIC(*stats = proc->edf.stats);
+}
+
+#endif /* CONFIG_KERN_EDF */
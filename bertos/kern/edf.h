@@ -0,0 +1,127 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Earliest deadline first scheduling class.
+ *
+ * A process joins this class with edf_setup(), declaring its period, the
+ * CPU time it needs each period (its budget) and its relative deadline.
+ * Every period a new job of the process is released: the job must call
+ * edf_waitPeriod() when done, before its deadline expires.
+ *
+ * The processes of this class always run before the ones of the priority
+ * class, the one with the earliest deadline first. They are ordered in the
+ * same ready list, the kernel mapping each absolute deadline on a priority
+ * above EDF_PRI_MIN: preemption, semaphores and priority inheritance work
+ * the same for both classes. Keep the priorities of the other processes
+ * below EDF_PRI_MIN, and do not call proc_setPri() on EDF processes.
+ *
+ * A job exhausting its budget is throttled: it drops below every other
+ * process until its next release, so a runaway job cannot starve the rest
+ * of the system. Budgets are charged by the system timer, one tick at a
+ * time, to the process running when the tick expires, and are enforced
+ * only with CONFIG_KERN_PREEMPT.
+ *
+ * Misses are counted when a job has not called edf_waitPeriod() by its
+ * deadline; a job completing so late that the following deadlines have
+ * also expired skips those periods, counting each as a miss.
+ *
+ * \code
+ * static void sensor(void)
+ * {
+ *     // 10 ms period, 2 ms budget, deadline at the end of the period
+ *     edf_setup(proc_current(), 10, 2, 0);
+ *     for (;;)
+ *     {
+ *         sensor_sample();
+ *         edf_waitPeriod();
+ *     }
+ * }
+ * \endcode
+ *
+ * $WIZ$ module_name = "edf"
+ * $WIZ$ module_depends = "kernel", "timer"
+ * $WIZ$ module_configuration = "bertos/cfg/cfg_proc.h"
+ */
+
+#ifndef KERN_EDF_H
+#define KERN_EDF_H
+
+#include "cfg/cfg_proc.h"
+
+#include <cfg/compiler.h>
+
+#include <kern/proc.h>
+
+#include <limits.h>
+
+/**
+ * Lowest priority used by the EDF class.
+ *
+ * Each EDF process gets a priority between this value and INT_MAX, the
+ * higher the earlier its deadline is.
+ */
+#define EDF_PRI_MIN  (INT_MAX - INT_MAX / 2)
+
+/**
+ * Move \a proc in or out of the EDF class.
+ *
+ * The first job is released immediately.
+ *
+ * \param proc      The process.
+ * \param period    Period in ms, 0 to go back to the priority class with
+ *                  the priority the process had when it joined.
+ * \param budget    CPU time granted to each job in ms, 0 for no limit.
+ * \param deadline  Deadline of each job in ms, relative to its release;
+ *                  0 for the end of the period.
+ */
+void edf_setup(struct Process *proc, mtime_t period, mtime_t budget, mtime_t deadline);
+
+/**
+ * Complete the current job and sleep until the next release.
+ *
+ * If the next release is already due, return at once.
+ */
+void edf_waitPeriod(void);
+
+/**
+ * Copy the deadline statistics of \a proc in \a stats.
+ *
+ * Statistics are kept while the process leaves and joins the class again.
+ */
+void edf_stats(struct Process *proc, EdfStats *stats);
+
+/* Test functions */
+int edf_testRun(void);
+int edf_testSetup(void);
+int edf_testTearDown(void);
+
+#endif /* KERN_EDF_H */
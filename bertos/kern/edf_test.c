@@ -0,0 +1,232 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief EDF scheduling class test.
+ *
+ * Three periodic processes run with increasing total utilization: up to
+ * 100% no deadline can be missed, while the overloaded runs must miss
+ * some; the miss ratio of each run is printed. Then a runaway EDF process
+ * must be throttled by its budget, leaving the CPU to the priority class.
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: echo  "#undef CONFIG_KERN_PRI" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN_PRI 1" >> $cfgdir/cfg_proc.h
+ * $test$: echo  "#undef CONFIG_KERN_PREEMPT" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN_PREEMPT 1" >> $cfgdir/cfg_proc.h
+ * $test$: echo  "#undef CONFIG_KERN_EDF" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN_EDF 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include <cfg/debug.h>
+#include <cfg/test.h>
+
+#include <kern/proc.h>
+#include <kern/edf.h>
+#include <kern/signal.h>
+
+#include <drv/timer.h>
+
+#include <limits.h>
+
+#define TASKS     3
+#define RUN_MS    1600
+#define CAL_TICKS 50
+
+/* Utilization of each run, in percent */
+static const int loads[] = { 50, 70, 90, 110, 130 };
+static const mtime_t periods[TASKS] = { 80, 120, 200 };
+
+static unsigned long iters_per_tick;
+static unsigned long work[TASKS];
+static int jobs[TASKS];
+static int finished;
+
+static Process *main_proc;
+static Process *task_proc[TASKS];
+static PROC_DEFINE_STACK(task_stack[TASKS], KERN_MINSTACKSIZE);
+
+static volatile bool stop;
+static PROC_DEFINE_STACK(runaway_stack, KERN_MINSTACKSIZE);
+
+/* Loop \a n times, or for \a ticks at most; return the iterations done */
+static unsigned long NOINLINE spin(unsigned long n, ticks_t ticks)
+{
+	ticks_t start = timer_clock_unlocked();
+	unsigned long i;
+
+	for (i = 0; i < n; i++)
+		if (timer_clock_unlocked() - start >= ticks)
+			break;
+	return i;
+}
+
+static void calibrate(void)
+{
+	ticks_t start = timer_clock_unlocked();
+
+	while (timer_clock_unlocked() == start)
+		;
+	iters_per_tick = spin(ULONG_MAX, CAL_TICKS) / CAL_TICKS;
+}
+
+static void task(void)
+{
+	ssize_t n = (ssize_t)proc_currentUserData();
+
+	for (;;)
+	{
+		sig_wait(SIG_USER0);
+
+		edf_setup(proc_current(), periods[n], 0, 0);
+		for (int j = 0; j < jobs[n]; j++)
+		{
+			spin(work[n], ms_to_ticks(RUN_MS));
+			edf_waitPeriod();
+		}
+		edf_setup(proc_current(), 0, 0, 0);
+
+		ATOMIC(finished++);
+		sig_send(main_proc, SIG_USER1);
+	}
+}
+
+static void runaway(void)
+{
+	edf_setup(proc_current(), 40, 8, 0);
+	while (!stop)
+		spin(1, 1);
+}
+
+static int check_load(int load)
+{
+	EdfStats before[TASKS], after[TASKS];
+	unsigned long total = 0, missed = 0;
+
+	for (int i = 0; i < TASKS; i++)
+	{
+		work[i] = iters_per_tick * ms_to_ticks(periods[i]) * load / (100 * TASKS);
+		jobs[i] = RUN_MS / periods[i];
+		edf_stats(task_proc[i], &before[i]);
+	}
+
+	finished = 0;
+	for (int i = 0; i < TASKS; i++)
+		sig_send(task_proc[i], SIG_USER0);
+	while (finished < TASKS)
+		sig_wait(SIG_USER1);
+
+	for (int i = 0; i < TASKS; i++)
+	{
+		edf_stats(task_proc[i], &after[i]);
+		total += after[i].jobs - before[i].jobs;
+		missed += after[i].misses - before[i].misses;
+	}
+	kprintf("Load %3d%%: %lu of %lu deadlines missed (%lu%%)\n",
+		load, missed, total, missed * 100 / total);
+
+	if (load <= 70 && missed)
+		return -1;
+	if (load >= 130 && !missed)
+		return -1;
+	return 0;
+}
+
+static int check_budget(void)
+{
+	Process *p;
+	EdfStats st;
+	unsigned long done;
+
+	p = proc_new(runaway, NULL, sizeof(runaway_stack), runaway_stack);
+	timer_delay(40);
+
+	/* The runaway process may take 20% of the CPU at most */
+	done = spin(ULONG_MAX, CAL_TICKS);
+	edf_stats(p, &st);
+	kprintf("Runaway: %lu jobs, %lu throttled, %lu%% of the CPU left\n",
+		(unsigned long)st.jobs, (unsigned long)st.throttles,
+		done * 100 / (iters_per_tick * CAL_TICKS));
+
+	stop = true;
+	timer_delay(100);
+
+	if (!st.throttles)
+		return -1;
+	return done * 2 >= iters_per_tick * CAL_TICKS ? 0 : -1;
+}
+
+int edf_testRun(void)
+{
+	calibrate();
+	kprintf("%lu iterations per tick\n", iters_per_tick);
+
+	for (int i = 0; i < TASKS; i++)
+		task_proc[i] = proc_new(task, (iptr_t)(ssize_t)i, sizeof(task_stack[i]), task_stack[i]);
+
+	for (unsigned i = 0; i < countof(loads); i++)
+		if (check_load(loads[i]))
+		{
+			kprintf("Unexpected misses at %d%% load\n", loads[i]);
+			return -1;
+		}
+
+	if (check_budget())
+	{
+		kprintf("Runaway process not throttled\n");
+		return -1;
+	}
+	return 0;
+}
+
+int edf_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+	proc_init();
+	main_proc = proc_current();
+	return 0;
+}
+
+int edf_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(edf);
@@ -40,8 +40,10 @@
 #include "irq.h"
 
 #include <cfg/module.h>
+#include <cfg/macros.h>
 #include <kern/proc_p.h>
 #include <kern/proc.h>
+#include <kern/irqstat.h>
 
 #include "cfg/cfg_proc.h"
 
@@ -55,7 +57,15 @@ static void (*irq_handlers[100])(void);
 /* signal handler */
 void irq_entry(int signum)
 {
+#if CONFIG_KERN_IRQSTAT
+	static IrqStat *irq_stats[countof(irq_handlers)];
+	uint32_t start = irqstat_now();
+
+	irq_handlers[signum]();
+	irqstat_record(&irq_stats[signum], IRQSTAT_ISR, "signal", signum, start);
+#else
 	irq_handlers[signum]();
+#endif
 }
 
 void irq_register(int irq, void (*callback)(void))
@@ -0,0 +1,217 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Interrupt latency statistics.
+ *
+ * The ATOMIC() sections record their statistics with interrupts still
+ * disabled, so they need no locking. The interrupt handlers may nest on
+ * some CPUs and only lock while touching their site. This module never
+ * uses ATOMIC() itself: it would measure itself recursively.
+ */
+
+#include "irqstat.h"
+
+#if CONFIG_KERN_IRQSTAT
+
+#include <cfg/debug.h>
+#include <cfg/macros.h>
+
+#include <cpu/irq.h>
+
+#include <drv/timer.h>
+
+#include <string.h>
+
+static IrqStat irqstat_pool[CONFIG_KERN_IRQSTAT_SITES];
+/* Sites left out of the pool, one for each kind */
+static IrqStat irqstat_other[] =
+{
+	{ NULL, "<other>", 0, IRQSTAT_ISR, 0, 0, { 0 } },
+	{ NULL, "<other>", 0, IRQSTAT_MASKED, 0, 0, { 0 } },
+};
+static unsigned irqstat_used;
+static IrqStat *irqstat_head;
+
+uint32_t irqstat_now(void)
+{
+#if OS_HOSTED
+	return timer_hpclock();
+#else
+	cpu_flags_t flags;
+	uint32_t now;
+
+	IRQ_SAVE_DISABLE(flags);
+	now = timer_hpclock();
+	IRQ_RESTORE(flags);
+	return now;
+#endif
+}
+
+/*
+ * Return the site of \a name and \a line, creating it if needed.
+ * Called with interrupts disabled.
+ */
+static IrqStat *irqstat_lookup(uint8_t kind, const char *name, uint16_t line)
+{
+	IrqStat *st;
+
+	for (st = irqstat_head; st; st = st->next)
+		if (st->kind == kind && st->line == line && !strcmp(st->name, name))
+			return st;
+
+	if (irqstat_used < countof(irqstat_pool))
+	{
+		st = &irqstat_pool[irqstat_used++];
+		st->name = name;
+		st->line = line;
+		st->kind = kind;
+	}
+	else
+	{
+		ASSERT(kind < countof(irqstat_other));
+		st = &irqstat_other[kind];
+		if (st->next || irqstat_head == st)
+			return st;
+	}
+
+	st->next = irqstat_head;
+	/* irqstat_report() may be walking the list */
+	MEMORY_BARRIER;
+	irqstat_head = st;
+	return st;
+}
+
+INLINE void irqstat_update(IrqStat **site, uint8_t kind, const char *name, uint16_t line, uint32_t d, int bucket)
+{
+	IrqStat *st = *site;
+
+	if (!st)
+		st = *site = irqstat_lookup(kind, name, line);
+
+	st->count++;
+	if (d > st->max)
+		st->max = d;
+	st->hist[bucket]++;
+}
+
+void irqstat_record(IrqStat **site, uint8_t kind, const char *name, uint16_t line, uint32_t start)
+{
+	uint32_t d = irqstat_now() - start;
+	uint32_t v = d;
+	int b;
+
+	for (b = 0; v > 1 && b < IRQSTAT_BUCKETS - 1; b++)
+		v >>= 1;
+
+	if (kind == IRQSTAT_MASKED)
+		irqstat_update(site, kind, name, line, d, b);
+	else
+	{
+		cpu_flags_t flags;
+
+		IRQ_SAVE_DISABLE(flags);
+		irqstat_update(site, kind, name, line, d, b);
+		IRQ_RESTORE(flags);
+	}
+}
+
+void irqstat_recordMasked(IrqStat **site, const char *name, uint16_t line, uint32_t start)
+{
+	irqstat_record(site, IRQSTAT_MASKED, name, line, start);
+}
+
+const IrqStat *irqstat_list(void)
+{
+	return irqstat_head;
+}
+
+void irqstat_reset(void)
+{
+	cpu_flags_t flags;
+
+	IRQ_SAVE_DISABLE(flags);
+	for (IrqStat *st = irqstat_head; st; st = st->next)
+	{
+		st->count = 0;
+		st->max = 0;
+		memset(st->hist, 0, sizeof(st->hist));
+	}
+	IRQ_RESTORE(flags);
+}
+
+static unsigned long irqstat_us(uint32_t hpticks)
+{
+	return (unsigned long)((uint64_t)hpticks * 1000000 / TIMER_HW_HPTICKS_PER_SEC);
+}
+
+static void irqstat_reportKind(uint8_t kind, const char *title)
+{
+	const IrqStat *sorted[CONFIG_KERN_IRQSTAT_SITES + countof(irqstat_other)];
+	int n = 0;
+
+	/* Insertion sort, longest runs first */
+	for (const IrqStat *st = irqstat_head; st; st = st->next)
+	{
+		int i;
+
+		if (st->kind != kind || !st->count)
+			continue;
+		for (i = n; i > 0 && sorted[i - 1]->max < st->max; i--)
+			sorted[i] = sorted[i - 1];
+		sorted[i] = st;
+		n++;
+	}
+
+	kprintf("%s, %lu hpticks/s, histogram log2(hpticks):count\n",
+		title, (unsigned long)TIMER_HW_HPTICKS_PER_SEC);
+	kprintf("%-10s %-10s %s\n", "Count", "Max[us]", "Site");
+	for (int i = 0; i < n; i++)
+	{
+		const IrqStat *st = sorted[i];
+
+		kprintf("%-10lu %-10lu %s", (unsigned long)st->count, irqstat_us(st->max), st->name);
+		if (st->line)
+			kprintf(":%u", st->line);
+		for (int b = 0; b < IRQSTAT_BUCKETS; b++)
+			if (st->hist[b])
+				kprintf(" %d:%lu", b, (unsigned long)st->hist[b]);
+		kputchar('\n');
+	}
+}
+
+void irqstat_report(void)
+{
+	irqstat_reportKind(IRQSTAT_ISR, "Interrupt handlers");
+	irqstat_reportKind(IRQSTAT_MASKED, "Interrupts masked");
+}
+
+#endif /* CONFIG_KERN_IRQSTAT */
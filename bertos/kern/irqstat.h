@@ -0,0 +1,172 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Interrupt latency statistics.
+ *
+ * When CONFIG_KERN_IRQSTAT is enabled the system collects, for every
+ * instrumented interrupt handler and for every ATOMIC() section, the
+ * number of runs, the longest one and a log2 histogram of the durations.
+ * The time spent with interrupts masked is the worst case latency added
+ * to every other interrupt, so irqstat_report() lists the worst
+ * offenders first:
+ * \code
+ * Interrupts masked, 1000000 hpticks/s, histogram log2(hpticks):count
+ * Count      Max[us]    Site
+ * 2311       41         timer_add:162 0:2290 1:12 4:8 5:1
+ * 35112      6          timer_clock:139 0:35111 2:1
+ * \endcode
+ *
+ * ATOMIC() sections are measured automatically and named after their
+ * function and line. Sections coming from inline functions in headers
+ * are merged by name, so each one is listed once. Interrupt handlers opt
+ * in by wrapping their body with IRQSTAT_BEGIN() and IRQSTAT_END(): the
+ * system timer is reported as "timer" and, on the emulator, the signal
+ * handlers as "signal:<number>". Sections using IRQ_SAVE_DISABLE() and
+ * IRQ_RESTORE() directly are not measured.
+ *
+ * Sites are allocated from a pool of CONFIG_KERN_IRQSTAT_SITES entries;
+ * when it is exhausted the remaining ones are accounted as "<other>",
+ * separately for the handlers and the sections.
+ * Each measurement costs two reads of the high precision timer plus a
+ * few additions, so do not leave it enabled in production builds.
+ *
+ * $WIZ$ module_name = "irqstat"
+ * $WIZ$ module_depends = "kernel", "timer"
+ */
+
+#ifndef KERN_IRQSTAT_H
+#define KERN_IRQSTAT_H
+
+#include "cfg/cfg_proc.h"
+
+#include <cfg/compiler.h>
+
+#ifndef CONFIG_KERN_IRQSTAT
+	#define CONFIG_KERN_IRQSTAT 0
+#endif
+
+/// Number of histogram buckets.
+#define IRQSTAT_BUCKETS  16
+
+/**
+ * Kind of a statistics site.
+ */
+typedef enum IrqStatKind
+{
+	IRQSTAT_ISR,    ///< Interrupt handler.
+	IRQSTAT_MASKED, ///< ATOMIC() section.
+} IrqStatKind;
+
+/**
+ * Statistics of an interrupt handler or of an ATOMIC() section.
+ *
+ * Durations are in hpticks (TIMER_HW_HPTICKS_PER_SEC). Bucket \c i of
+ * the histogram counts the durations in [2^i, 2^(i+1)) hpticks, except
+ * bucket 0 that also counts the null ones and the last bucket that also
+ * counts the longer ones.
+ */
+typedef struct IrqStat
+{
+	struct IrqStat *next;
+	const char *name;   ///< Interrupt handler, or function holding the section.
+	uint16_t line;      ///< Line of the section, or interrupt number.
+	uint8_t kind;       ///< One of IrqStatKind.
+	uint32_t count;     ///< Number of runs.
+	uint32_t max;       ///< Longest run.
+	uint32_t hist[IRQSTAT_BUCKETS];
+} IrqStat;
+
+#if CONFIG_KERN_IRQSTAT
+
+/**
+ * Return a timestamp in hpticks for the measurements.
+ */
+uint32_t irqstat_now(void);
+
+/**
+ * Account a run started at \a start to the site cached in \a *site.
+ *
+ * The site is looked up by \a kind, \a name and \a line on the first call
+ * and stored in \a *site, which should be a static variable of the caller.
+ * Call it with interrupts disabled when \a kind is IRQSTAT_MASKED.
+ */
+void irqstat_record(IrqStat **site, uint8_t kind, const char *name, uint16_t line, uint32_t start);
+
+/**
+ * Same as irqstat_record() for an IRQSTAT_MASKED site.
+ *
+ * This is the function called by ATOMIC(), see cfg/atomic_hook.h.
+ */
+void irqstat_recordMasked(IrqStat **site, const char *name, uint16_t line, uint32_t start);
+
+/**
+ * Start measuring an interrupt handler.
+ *
+ * Put it at the beginning of the handler body, it declares a variable.
+ */
+#define IRQSTAT_BEGIN() \
+	uint32_t __irqstat_start = irqstat_now()
+
+/**
+ * Account the handler started by IRQSTAT_BEGIN() as \a name.
+ */
+#define IRQSTAT_END(name) \
+	do { \
+		static IrqStat *__irqstat_site; \
+		irqstat_record(&__irqstat_site, IRQSTAT_ISR, (name), 0, __irqstat_start); \
+	} while (0)
+
+/**
+ * Return the first site, in order of creation.
+ *
+ * Follow the \a next field to walk the others.
+ */
+const IrqStat *irqstat_list(void);
+
+/**
+ * Clear the statistics of all the sites.
+ */
+void irqstat_reset(void);
+
+/**
+ * Print the statistics on the debug console, longest runs first.
+ */
+void irqstat_report(void);
+
+#else /* !CONFIG_KERN_IRQSTAT */
+
+#define IRQSTAT_BEGIN()    do { } while (0)
+#define IRQSTAT_END(name)  do { } while (0)
+
+#endif /* CONFIG_KERN_IRQSTAT */
+
+#endif /* KERN_IRQSTAT_H */
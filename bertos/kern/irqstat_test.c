@@ -0,0 +1,191 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Interrupt latency statistics test.
+ *
+ * Two functions mask the interrupts for a known time with ATOMIC(): their
+ * sites must report the right counts, maxima and histogram buckets, while
+ * the timer interrupt keeps running and must be accounted too. Then the
+ * sites that do not fit in the pool must be accounted by kind.
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: echo  "#undef CONFIG_KERN_IRQSTAT" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN_IRQSTAT 1" >> $cfgdir/cfg_proc.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include <cfg/debug.h>
+#include <cfg/test.h>
+
+#include <cpu/irq.h>
+
+#include <kern/irqstat.h>
+#include <kern/proc.h>
+
+#include <drv/timer.h>
+
+#include <string.h>
+
+#define RUNS      5
+/* Bucket 8 is [256, 512) us, bucket 10 is [1024, 2048) us */
+#define SHORT_US  300
+#define LONG_US   1500
+
+static void busy_wait(uint32_t us)
+{
+	uint32_t start = timer_hpclock();
+
+	while (timer_hpclock() - start < us_to_hptime(us))
+		;
+}
+
+static void mask_short(void)
+{
+	ATOMIC(busy_wait(SHORT_US));
+}
+
+static void mask_long(void)
+{
+	ATOMIC(busy_wait(LONG_US));
+}
+
+static const IrqStat *find(uint8_t kind, const char *name)
+{
+	for (const IrqStat *st = irqstat_list(); st; st = st->next)
+		if (st->kind == kind && !strcmp(st->name, name))
+			return st;
+	return NULL;
+}
+
+static int check_site(const char *name, uint32_t us, int bucket)
+{
+	const IrqStat *st = find(IRQSTAT_MASKED, name);
+	uint32_t sum = 0;
+
+	if (!st)
+	{
+		kprintf("%s not found\n", name);
+		return -1;
+	}
+	for (int b = 0; b < IRQSTAT_BUCKETS; b++)
+	{
+		sum += st->hist[b];
+		/* Runs can only last longer than requested */
+		if (b < bucket && st->hist[b])
+		{
+			kprintf("%s: %lu runs in bucket %d\n", name, (unsigned long)st->hist[b], b);
+			return -1;
+		}
+	}
+	if (st->count != RUNS || sum != RUNS || st->max < us_to_hptime(us) || !st->hist[bucket])
+	{
+		kprintf("%s: bad statistics, count %lu, max %lu\n", name,
+			(unsigned long)st->count, (unsigned long)st->max);
+		return -1;
+	}
+	return 0;
+}
+
+/* Fill the pool: the sites left out share an "<other>" site of their kind */
+static int check_overflow(void)
+{
+	static IrqStat *isr[CONFIG_KERN_IRQSTAT_SITES], *masked;
+	const IrqStat *other_isr, *other_masked;
+	cpu_flags_t flags;
+
+	for (int i = 0; i < CONFIG_KERN_IRQSTAT_SITES; i++)
+		irqstat_record(&isr[i], IRQSTAT_ISR, "fill", i + 1, irqstat_now());
+	IRQ_SAVE_DISABLE(flags);
+	irqstat_record(&masked, IRQSTAT_MASKED, "overflow", 1, irqstat_now());
+	IRQ_RESTORE(flags);
+
+	other_isr = find(IRQSTAT_ISR, "<other>");
+	other_masked = find(IRQSTAT_MASKED, "<other>");
+	if (!other_isr || !other_isr->count || !other_masked || !other_masked->count)
+	{
+		kprintf("Sites out of the pool not accounted by kind\n");
+		return -1;
+	}
+	return 0;
+}
+
+int irqstat_testRun(void)
+{
+	const IrqStat *timer;
+
+	irqstat_reset();
+	for (int i = 0; i < RUNS; i++)
+	{
+		mask_short();
+		mask_long();
+		timer_delay(10);
+	}
+
+	timer = find(IRQSTAT_ISR, "timer");
+	if (!timer || timer->count < RUNS)
+	{
+		kprintf("Timer interrupt not accounted\n");
+		return -1;
+	}
+
+	if (check_site("mask_short", SHORT_US, 8) || check_site("mask_long", LONG_US, 10))
+		return -1;
+
+	irqstat_report();
+
+	irqstat_reset();
+	if (find(IRQSTAT_MASKED, "mask_long")->count || find(IRQSTAT_MASKED, "mask_long")->max)
+	{
+		kprintf("Statistics not cleared\n");
+		return -1;
+	}
+	return check_overflow();
+}
+
+int irqstat_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+	proc_init();
+	return 0;
+}
+
+int irqstat_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(irqstat);
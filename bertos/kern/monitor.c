@@ -52,18 +52,35 @@
 
 #include <cpu/frame.h> /* CPU_STACK_GROWS_UPWARD */
 
+#include <stddef.h> /* ptrdiff_t */
+
 /* Access to this list must be protected against the scheduler */
 static List MonitorProcs;
+/* Next process checked by the monitor, NULL to restart from the first one */
+static Process *monitor_next;
+
+static void monitor_defaultAlert(Process *proc, const char *name, size_t free)
+{
+	(void)proc;
+	kprintf("MONITOR: Free stack of process '%s' is only %u chars\n",
+			name, (unsigned int)free);
+}
+
+static MonitorAlert monitor_alert = monitor_defaultAlert;
 
 void monitor_init(void)
 {
 	LIST_INIT(&MonitorProcs);
+	monitor_next = NULL;
 }
 
 
 void monitor_add(Process *proc, const char *name)
 {
 	proc->monitor.name = name;
+	proc->monitor.free = proc->stack_base ? proc->stack_size : 0;
+	proc->monitor.reported = (size_t)-1;
+	proc->monitor.scan = 0;
 
 	PROC_ATOMIC(ADDTAIL(&MonitorProcs, &proc->monitor.link));
 }
@@ -71,7 +88,11 @@ void monitor_add(Process *proc, const char *name)
 
 void monitor_remove(Process *proc)
 {
-	PROC_ATOMIC(REMOVE(&proc->monitor.link));
+	PROC_ATOMIC(
+		if (monitor_next == proc)
+			monitor_next = NULL;
+		REMOVE(&proc->monitor.link);
+	);
 }
 
 void monitor_rename(Process *proc, const char *name)
@@ -79,6 +100,48 @@ void monitor_rename(Process *proc, const char *name)
 	proc->monitor.name = name;
 }
 
+void monitor_foreach(void (*func)(Process *proc, const char *name, void *data), void *data)
+{
+	Node *node;
+
+	proc_forbid();
+	FOREACH_NODE(node, &MonitorProcs)
+	{
+		Process *p = containerof(node, Process, monitor.link);
+		func(p, p->monitor.name, data);
+	}
+	proc_permit();
+}
+
+void monitor_setAlert(MonitorAlert alert)
+{
+	monitor_alert = alert ? alert : monitor_defaultAlert;
+}
+
+size_t monitor_stackFree(Process *proc)
+{
+	return proc->monitor.free;
+}
+
+#if CONFIG_KERN_MONITOR_SAMPLE_SP
+void monitor_sampleStack(Process *proc)
+{
+	size_t free;
+
+	if (!proc->stack_base)
+		return;
+
+	if (CPU_STACK_GROWS_UPWARD)
+		free = (proc->stack_base + proc->stack_size / sizeof(cpu_stack_t) - proc->stack)
+			* sizeof(cpu_stack_t);
+	else
+		free = (proc->stack - proc->stack_base) * sizeof(cpu_stack_t);
+
+	if (free < proc->monitor.free)
+		proc->monitor.free = free;
+}
+#endif
+
 size_t monitor_checkStack(cpu_stack_t *stack_base, size_t stack_size)
 {
 	cpu_stack_t *beg;
@@ -112,6 +175,59 @@ size_t monitor_checkStack(cpu_stack_t *stack_base, size_t stack_size)
 }
 
 
+#if CONFIG_KERN_ACCOUNTING
+/* Convert \a t hpticks to 1 / \a unit seconds */
+static unsigned long monitor_hpticksTo(uint64_t t, uint32_t unit)
+{
+	return (unsigned long)(t * unit / TIMER_HW_HPTICKS_PER_SEC);
+}
+
+/*
+ * Print a top-like table of the processes, with the CPU share of each one
+ * since boot and the average and worst latency of its dispatches.
+ */
+static void monitor_reportStats(void)
+{
+	Node *node;
+	ProcStats stats;
+	uint64_t idle = proc_idleTime();
+	uint64_t total = idle;
+	int i;
+
+	FOREACH_NODE(node, &MonitorProcs)
+	{
+		proc_stats(containerof(node, Process, monitor.link), &stats);
+		total += stats.runtime;
+	}
+	total = MAX(total, (uint64_t)1);
+
+	kprintf("\n%-7s%-10s%-9s%-9s%-9s%-9s%s\n",
+		"CPU%", "Time[ms]", "Vol", "Invol", "Lat[us]", "Max[us]", "Name");
+	for (i = 0; i < 62; i++)
+		kputchar('-');
+	kputchar('\n');
+
+	FOREACH_NODE(node, &MonitorProcs)
+	{
+		Process *p = containerof(node, Process, monitor.link);
+		unsigned int share;
+
+		proc_stats(p, &stats);
+		share = (unsigned int)(stats.runtime * 1000 / total);
+		kprintf("%3u.%u  %-10lu%-9lu%-9lu%-9lu%-9lu%s\n",
+			share / 10, share % 10,
+			monitor_hpticksTo(stats.runtime, 1000),
+			(unsigned long)stats.voluntary, (unsigned long)stats.involuntary,
+			monitor_hpticksTo(proc_avgLatency(&stats), 1000000UL),
+			monitor_hpticksTo(stats.latency_max, 1000000UL),
+			p->monitor.name);
+	}
+	i = (int)(idle * 1000 / total);
+	kprintf("%3d.%d  %-10lu%-9s%-9s%-9s%-9s%s\n", i / 10, i % 10,
+		monitor_hpticksTo(idle, 1000), "", "", "", "", "<idle>");
+}
+#endif /* CONFIG_KERN_ACCOUNTING */
+
 void monitor_report(void)
 {
 	Node *node;
@@ -127,33 +243,104 @@ void monitor_report(void)
 	{
 		Process *p = containerof(node, Process, monitor.link);
 		size_t free = monitor_checkStack(p->stack_base, p->stack_size);
+
+		if (p->stack_base && free < p->monitor.free)
+			p->monitor.free = free;
 		kprintf("%-9p%-9p%-9zu%-9zu%s\n",
 			p, p->stack_base, p->stack_size, free, p->monitor.name);
 	}
+#if CONFIG_KERN_ACCOUNTING
+	monitor_reportStats();
+#endif
 	proc_permit();
 }
 
+/*
+ * Go on checking the stack of \a p for at most \a *budget words.
+ *
+ * A pass walks the stack from its far end up to the current watermark:
+ * the first word not holding the fill code is the new watermark.
+ *
+ * \return true when the pass is over.
+ */
+static bool monitor_scan(Process *p, size_t *budget)
+{
+	struct ProcMonitor *m = &p->monitor;
+	cpu_stack_t *beg = p->stack_base;
+	int inc = +1;
+
+	if (CPU_STACK_GROWS_UPWARD)
+	{
+		beg = p->stack_base + p->stack_size / sizeof(cpu_stack_t);
+		inc = -1;
+	}
 
-static void NORETURN monitor(void)
+	while (m->scan < m->free / sizeof(cpu_stack_t))
+	{
+		if (!*budget)
+			return false;
+		(*budget)--;
+
+		if (beg[inc * (ptrdiff_t)m->scan] != CONFIG_KERN_STACKFILLCODE)
+		{
+			m->free = m->scan * sizeof(cpu_stack_t);
+			break;
+		}
+		m->scan++;
+	}
+	m->scan = 0;
+	return true;
+}
+
+/*
+ * Check the next CONFIG_KERN_MONITOR_SCAN stack words, stopping at the end
+ * of the list of processes.
+ */
+static void monitor_poll(void)
 {
-	Node *node;
+	size_t budget = CONFIG_KERN_MONITOR_SCAN;
 
-	for (;;)
+	proc_forbid();
+	while (budget && !LIST_EMPTY(&MonitorProcs))
 	{
-		proc_forbid();
-		FOREACH_NODE(node, &MonitorProcs)
+		Process *p = monitor_next;
+		Node *succ;
+
+		if (!p)
+			p = containerof(LIST_HEAD(&MonitorProcs), Process, monitor.link);
+
+		if (p->stack_base)
 		{
-			Process *p = containerof(node, Process, monitor.link);
-			size_t free = monitor_checkStack(p->stack_base, p->stack_size);
+			if (!monitor_scan(p, &budget))
+				break;
+
+			if (p->monitor.free < CONFIG_KERN_MONITOR_MARGIN
+					&& p->monitor.free < p->monitor.reported)
+			{
+				p->monitor.reported = p->monitor.free;
+				monitor_alert(p, p->monitor.name, p->monitor.free);
+			}
+		}
 
-			if (p->stack_base && free < 0x20)
-				kprintf("MONITOR: Free stack of process '%s' is only %u chars\n",
-						p->monitor.name, (unsigned int)free);
+		succ = p->monitor.link.succ;
+		if (succ == &MonitorProcs.tail)
+		{
+			monitor_next = NULL;
+			break;
 		}
-		proc_permit();
+		monitor_next = containerof(succ, Process, monitor.link);
+	}
+	proc_permit();
+}
+
+static void NORETURN monitor(void)
+{
+	for (;;)
+	{
+		monitor_poll();
 
 		/* Give some rest to the system */
-		timer_delay(500);
+		timer_delay(CONFIG_KERN_MONITOR_PERIOD);
 	}
 }
 
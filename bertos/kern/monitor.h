@@ -47,9 +47,36 @@
 
 #include <cpu/types.h>
 
+#ifndef CONFIG_KERN_MONITOR_PERIOD
+	#define CONFIG_KERN_MONITOR_PERIOD 500
+#endif
+#ifndef CONFIG_KERN_MONITOR_SCAN
+	#define CONFIG_KERN_MONITOR_SCAN 64
+#endif
+#ifndef CONFIG_KERN_MONITOR_MARGIN
+	#define CONFIG_KERN_MONITOR_MARGIN 32
+#endif
+
+struct Process;
+
 /**
- * Start the kernel monitor. It is a special process which checks every second the stacks of the
- * running processes trying to detect stack overflows.
+ * Stack alert hook.
+ *
+ * Called by the monitor process, with the scheduler disabled, when the
+ * free stack of \a proc drops below CONFIG_KERN_MONITOR_MARGIN bytes.
+ * It is called again only if the free stack keeps decreasing.
+ */
+typedef void (*MonitorAlert)(struct Process *proc, const char *name, size_t free);
+
+/**
+ * Start the kernel monitor. It is a special process which checks the stacks
+ * of the running processes trying to detect stack overflows.
+ *
+ * Every CONFIG_KERN_MONITOR_PERIOD ms it checks CONFIG_KERN_MONITOR_SCAN
+ * words of the stacks, resuming where it stopped the previous time. Only
+ * the area below the watermark of each process is checked, since the area
+ * above is known to be used, so a full round over all the stacks may take
+ * several periods but the scheduler is never disabled for long.
  *
  * \param stacksize Size of stack in chars
  * \param stack Pointer to the stack that will be used by the monitor
@@ -59,6 +86,23 @@
  */
 void monitor_start(size_t stacksize, cpu_stack_t *stack);
 
+/**
+ * Replace the stack alert hook.
+ *
+ * The default one prints a warning through kdebug; pass NULL to restore it.
+ */
+void monitor_setAlert(MonitorAlert alert);
+
+/**
+ * Return the lowest free stack of \a proc seen so far, in bytes.
+ *
+ * The watermark is updated by the monitor process, by monitor_report() and,
+ * with CONFIG_KERN_MONITOR_SAMPLE_SP, every time \a proc gets the CPU.
+ * Until the monitor has checked the whole stack it may be higher than the
+ * real one. The stack of the main process is not known, so it is always 0.
+ */
+size_t monitor_stackFree(struct Process *proc);
+
 
 /**
  * Manually check if a given stack has overflown. This is used to check for stacks
@@ -71,7 +115,13 @@ void monitor_start(size_t stacksize, cpu_stack_t *stack);
 size_t monitor_checkStack(cpu_stack_t *stack_base, size_t stack_size);
 
 
-/** Print a report of the stack status through kdebug */
+/**
+ * Print a report of the stack status through kdebug.
+ *
+ * The stacks are checked completely, with the scheduler disabled.
+ * With CONFIG_KERN_ACCOUNTING it also prints the CPU share, the context
+ * switches and the dispatch latency of each process.
+ */
 void monitor_report(void);
 
 #endif /* KERN_MONITOR_H */
@@ -0,0 +1,179 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Stack monitor test.
+ *
+ * A process sleeps with a large buffer on its stack: the stack pointer
+ * sampled at context switch must show it before the monitor runs. Then
+ * the monitor process must find the exact watermarks of all the stacks,
+ * a little at a time, and raise an alert only for the deep one.
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_monitor.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_MONITOR" >> $cfgdir/cfg_monitor.h
+ * $test$: echo "#define CONFIG_KERN_MONITOR 1" >> $cfgdir/cfg_monitor.h
+ * $test$: echo  "#undef CONFIG_KERN_MONITOR_PERIOD" >> $cfgdir/cfg_monitor.h
+ * $test$: echo "#define CONFIG_KERN_MONITOR_PERIOD 5" >> $cfgdir/cfg_monitor.h
+ * $test$: echo  "#undef CONFIG_KERN_MONITOR_SCAN" >> $cfgdir/cfg_monitor.h
+ * $test$: echo "#define CONFIG_KERN_MONITOR_SCAN 1024" >> $cfgdir/cfg_monitor.h
+ * $test$: echo  "#undef CONFIG_KERN_MONITOR_MARGIN" >> $cfgdir/cfg_monitor.h
+ * $test$: echo "#define CONFIG_KERN_MONITOR_MARGIN 49152" >> $cfgdir/cfg_monitor.h
+ * $test$: echo  "#undef CONFIG_KERN_MONITOR_SAMPLE_SP" >> $cfgdir/cfg_monitor.h
+ * $test$: echo "#define CONFIG_KERN_MONITOR_SAMPLE_SP 1" >> $cfgdir/cfg_monitor.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include <cfg/debug.h>
+#include <cfg/test.h>
+
+#include <kern/proc.h>
+#include <kern/monitor.h>
+
+#include <drv/timer.h>
+
+/* Leave CONFIG_KERN_MONITOR_MARGIN / 2 bytes free at most */
+#define HOG_STACK  (3 * KERN_MINSTACKSIZE)
+#define HOG_USE    (HOG_STACK - CONFIG_KERN_MONITOR_MARGIN / 2)
+
+static Process *hog_proc, *quiet_proc;
+static volatile bool go, done;
+static int hog_alerts, other_alerts;
+
+static PROC_DEFINE_STACK(hog_stack, HOG_STACK);
+static PROC_DEFINE_STACK(quiet_stack, KERN_MINSTACKSIZE);
+static PROC_DEFINE_STACK(monitor_stack, KERN_MINSTACKSIZE);
+
+/* Out of line, so that the buffer is really allocated on the stack */
+static void NOINLINE touch(volatile char *buf)
+{
+	buf[0] = 1;
+}
+
+/* Sleep with a large buffer on the stack, without touching most of it */
+static void NOINLINE deep(void)
+{
+	volatile char buf[HOG_USE];
+
+	touch(buf);
+	while (!go)
+		timer_delay(1);
+}
+
+static void hog(void)
+{
+	deep();
+	while (!done)
+		timer_delay(1);
+}
+
+static void quiet(void)
+{
+	while (!done)
+		timer_delay(1);
+}
+
+static void alert(Process *proc, const char *name, size_t free)
+{
+	kprintf("Alert: %s, %lu bytes free\n", name, (unsigned long)free);
+	if (proc == hog_proc)
+		hog_alerts++;
+	else
+		other_alerts++;
+}
+
+static int check_exact(Process *proc)
+{
+	size_t exact = monitor_checkStack(proc->stack_base, proc->stack_size);
+
+	if (monitor_stackFree(proc) != exact)
+	{
+		kprintf("%s: watermark %lu, free %lu\n", proc_name(proc),
+			(unsigned long)monitor_stackFree(proc), (unsigned long)exact);
+		return -1;
+	}
+	return 0;
+}
+
+int monitor_testRun(void)
+{
+	monitor_setAlert(alert);
+	hog_proc = proc_new(hog, NULL, sizeof(hog_stack), hog_stack);
+	quiet_proc = proc_new(quiet, NULL, sizeof(quiet_stack), quiet_stack);
+
+	/* Only the sampled stack pointer knows about the buffer */
+	timer_delay(20);
+	if (monitor_stackFree(hog_proc) > sizeof(hog_stack) - HOG_USE)
+	{
+		kprintf("Stack pointer not sampled, %lu bytes free\n",
+			(unsigned long)monitor_stackFree(hog_proc));
+		return -1;
+	}
+	go = true;
+
+	monitor_start(sizeof(monitor_stack), monitor_stack);
+	timer_delay(500);
+
+	if (check_exact(hog_proc) || check_exact(quiet_proc))
+		return -1;
+
+	if (!hog_alerts || other_alerts)
+	{
+		kprintf("Bad alerts: %d for the hog, %d for the others\n", hog_alerts, other_alerts);
+		return -1;
+	}
+
+	monitor_report();
+	done = true;
+	return 0;
+}
+
+int monitor_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+	proc_init();
+	return 0;
+}
+
+int monitor_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(monitor);
@@ -87,6 +87,7 @@
 
 #include "proc_p.h"
 #include "proc.h"
+#include "trace.h"
 
 #include "cfg/cfg_proc.h"
 #define LOG_LEVEL KERN_LOG_LEVEL
@@ -107,6 +108,10 @@
 	#include <struct/heap.h>
 #endif
 
+#if CONFIG_KERN_ACCOUNTING
+	#include <drv/timer.h>
+#endif
+
 #include <string.h>           /* memset() */
 
 #define PROC_SIZE_WORDS (ROUND_UP2(sizeof(Process), sizeof(cpu_stack_t)) / sizeof(cpu_stack_t))
@@ -160,15 +165,128 @@ static List zombie_list;
  */
 #define CONTEXT_SWITCH_FROM_ISR()	(!IRQ_RUNNING())
 
+#if CONFIG_KERN_ACCOUNTING
+
+/* Time spent idle-spinning in proc_schedule() */
+static uint64_t proc_idle_time;
+
+/*
+ * Charge the CPU time used so far to \a prev and start the clock of
+ * \a next, which has been waiting in the ready list since SCHED_STAMP().
+ */
+static void proc_account(Process *next, Process *prev, bool voluntary)
+{
+	uint32_t now = timer_hpclock();
+	uint32_t latency = now - next->acct.ready_since;
+
+	if (prev)
+	{
+		prev->acct.stats.runtime += (uint32_t)(now - prev->acct.run_since);
+		if (voluntary)
+			prev->acct.stats.voluntary++;
+		else
+			prev->acct.stats.involuntary++;
+	}
+
+	next->acct.run_since = now;
+	next->acct.stats.dispatches++;
+	next->acct.stats.latency_sum += latency;
+	if (latency > next->acct.stats.latency_max)
+		next->acct.stats.latency_max = latency;
+}
+
+/*
+ * While the scheduler spins the CPU still belongs to \a prev: move the
+ * time elapsed since \a start from its running time to the idle time.
+ */
+static void proc_accountIdle(Process *prev, uint32_t start)
+{
+	uint32_t idle = timer_hpclock() - start;
+
+	proc_idle_time += idle;
+	if (prev)
+		prev->acct.run_since += idle;
+}
+
+void proc_stats(struct Process *proc, ProcStats *stats)
+{
+	ATOMIC(
+		*stats = proc->acct.stats;
+		/* Add the time slice in progress */
+		if (proc == current_process)
+			stats->runtime += (uint32_t)(timer_hpclock() - proc->acct.run_since);
+	);
+}
+
+uint64_t proc_idleTime(void)
+{
+	uint64_t idle;
+
+	ATOMIC(idle = proc_idle_time);
+	return idle;
+}
+
+#else
+	#define proc_account(next, prev, voluntary)  ((void)(voluntary))
+#endif /* CONFIG_KERN_ACCOUNTING */
+
+#if CONFIG_KERN_FPU_CTRL
+
+/*
+ * Process whose FPU control words are loaded in the CPU, NULL for the
+ * power-on ones, shared by the processes that did not call proc_useFpuCtrl().
+ */
+static Process *fpu_ctrl_owner;
+static const CpuFpuCtrl fpu_ctrl_init = CPU_FPU_CTRL_INIT;
+
+/*
+ * Load the FPU control words of \a next, if they are not in the CPU
+ * already.
+ */
+INLINE void proc_fpuCtrlSwitch(Process *next)
+{
+	Process *owner = next->fpu_ctrl_used ? next : NULL;
+
+	if (owner != fpu_ctrl_owner)
+	{
+		if (fpu_ctrl_owner)
+			cpu_fpuCtrlSave(&fpu_ctrl_owner->fpu_ctrl);
+		cpu_fpuCtrlRestore(owner ? &owner->fpu_ctrl : &fpu_ctrl_init);
+		fpu_ctrl_owner = owner;
+	}
+}
+
+void proc_useFpuCtrl(void)
+{
+	ATOMIC(
+		if (fpu_ctrl_owner && fpu_ctrl_owner != current_process)
+			cpu_fpuCtrlSave(&fpu_ctrl_owner->fpu_ctrl);
+		cpu_fpuCtrlRestore(&fpu_ctrl_init);
+		current_process->fpu_ctrl_used = true;
+		fpu_ctrl_owner = current_process;
+	);
+}
+
+#else
+	#define proc_fpuCtrlSwitch(next)  ((void)(next))
+#endif /* CONFIG_KERN_FPU_CTRL */
+
 /*
  * Save context of old process and switch to new process.
-  */
-static void proc_context_switch(Process *next, Process *prev)
+ *
+ * \a voluntary tells whether the old process is releasing the CPU by
+ * itself or it is being preempted.
+ */
+static void proc_context_switch(Process *next, Process *prev, bool voluntary)
 {
 	cpu_stack_t *dummy;
 
 	if (UNLIKELY(next == prev))
 		return;
+	trace_event(TRACE_SWITCH, (uintptr_t)next);
+	proc_account(next, prev, voluntary);
+	monitor_sampleStack(next);
+	proc_fpuCtrlSwitch(next);
 	/*
 	 * If there is no old process, we save the old stack pointer into a
 	 * dummy variable that we ignore.  In fact, this happens only when the
@@ -191,6 +309,18 @@ static void proc_initStruct(Process *proc)
 	proc->flags = 0;
 #endif
 
+#if CONFIG_KERN_ACCOUNTING
+	memset(&proc->acct, 0, sizeof(proc->acct));
+#endif
+
+#if CONFIG_KERN_EDF
+	memset(&proc->edf, 0, sizeof(proc->edf));
+#endif
+
+#if CONFIG_KERN_FPU_CTRL
+	proc->fpu_ctrl_used = false;
+#endif
+
 #if CONFIG_KERN_PRI
 	proc->link.pri = 0;
 
@@ -199,6 +329,10 @@ static void proc_initStruct(Process *proc)
 	proc->inh_blocked_by = NULL;
 	LIST_INIT(&proc->inh_list);
 # endif
+# if CONFIG_KERN_PRI_CEILING
+	proc->orig_pri = proc->link.pri;
+	proc->ceil_top = NULL;
+# endif
 #endif
 }
 
@@ -219,10 +353,16 @@ void proc_init(void)
 	 */
 	proc_initStruct(&main_process);
 	current_process = &main_process;
+#if CONFIG_KERN_ACCOUNTING
+	ATOMIC(main_process.acct.run_since = timer_hpclock());
+#endif
 
 #if CONFIG_KERN_MONITOR
 	monitor_init();
 	monitor_add(current_process, "main");
+#endif
+#if CONFIG_KERN_EDF
+	edf_init();
 #endif
 	MOD_INIT(proc);
 }
@@ -445,13 +585,13 @@ void proc_rename(struct Process *proc, const char *name)
  */
 void proc_setPri(struct Process *proc, int pri)
 {
-#if CONFIG_KERN_PRI_INHERIT
+#if CONFIG_KERN_PRI_INHERIT || CONFIG_KERN_PRI_CEILING
 	int new_pri;
 
 	/*
 	 * Whatever it will happen below, this is the new
 	 * original priority of the process, i.e., the priority
-	 * it has without taking inheritance under account.
+	 * it has without taking inheritance and ceilings under account.
 	 */
 	proc->orig_pri = pri;
 
@@ -461,9 +601,9 @@ void proc_setPri(struct Process *proc, int pri)
 
 	/*
 	 * Actual process priority is the highest among its
-	 * own priority and the one of the top-priority
-	 * process that it is blocking (returned by
-	 * __prio_proc()).
+	 * own priority, the one of the top-priority
+	 * process that it is blocking and the ceiling of the
+	 * semaphores it holds (returned by __prio_proc()).
 	 */
 	proc->link.pri = new_pri;
 #else
@@ -471,7 +611,7 @@ void proc_setPri(struct Process *proc, int pri)
 		return;
 
 	proc->link.pri = pri;
-#endif // CONFIG_KERN_PRI_INHERIT
+#endif // CONFIG_KERN_PRI_INHERIT || CONFIG_KERN_PRI_CEILING
 
 	if (proc != current_process)
 		ATOMIC(sched_reenqueue(proc));
@@ -511,8 +651,18 @@ void proc_exit(void)
 #if CONFIG_KERN_MONITOR
 	monitor_remove(current_process);
 #endif
+#if CONFIG_KERN_EDF
+	edf_remove(current_process);
+#endif
 
 	proc_forbid();
+#if CONFIG_KERN_FPU_CTRL
+	if (fpu_ctrl_owner == current_process)
+	{
+		cpu_fpuCtrlRestore(&fpu_ctrl_init);
+		fpu_ctrl_owner = NULL;
+	}
+#endif
 #if CONFIG_KERN_HEAP
 	/*
 	 * Set the task as zombie, its resources will be freed in proc_new() in
@@ -532,7 +682,7 @@ void proc_exit(void)
 /**
  * Call the scheduler and eventually replace the current running process.
  */
-static void proc_schedule(void)
+static void proc_schedule(bool voluntary)
 {
 	Process *old_process = current_process;
 
@@ -557,13 +707,25 @@ static void proc_schedule(void)
 		 * disable interrupts while waiting, there would not be any
 		 * reason to do this.
 		 */
+#if CONFIG_KERN_ACCOUNTING
+		uint32_t idle_start = timer_hpclock();
+#endif
+#ifdef IRQ_WAIT
+		/* Sleep until an interrupt, without a window to miss it */
+		IRQ_WAIT;
+		MEMORY_BARRIER;
+#else
 		IRQ_ENABLE;
 		CPU_IDLE;
 		MEMORY_BARRIER;
 		IRQ_DISABLE;
+#endif
+#if CONFIG_KERN_ACCOUNTING
+		proc_accountIdle(old_process, idle_start);
+#endif
 	}
 	if (CONTEXT_SWITCH_FROM_ISR())
-		proc_context_switch(current_process, old_process);
+		proc_context_switch(current_process, old_process, voluntary);
 	/* This RET resumes the execution on the new process */
 	LOG_INFO("resuming %p:%s\n", current_process, proc_currentName());
 }
@@ -607,19 +769,19 @@ void proc_preempt(void)
 	/* We are inside a IRQ context, so ATOMIC is not needed here */
 	SCHED_ENQUEUE(current_process);
 	preempt_reset_quantum();
-	proc_schedule();
+	proc_schedule(false);
 }
 #endif /* CONFIG_KERN_PREEMPT */
 
 /* Immediately switch to a particular process */
-static void proc_switchTo(Process *proc)
+static void proc_switchTo(Process *proc, bool voluntary)
 {
 	Process *old_process = current_process;
 
 	SCHED_ENQUEUE(current_process);
 	preempt_reset_quantum();
 	current_process = proc;
-	proc_context_switch(current_process, old_process);
+	proc_context_switch(current_process, old_process, voluntary);
 }
 
 /**
@@ -635,7 +797,7 @@ void proc_switch(void)
 	ASSERT(proc_preemptAllowed());
 	ATOMIC(
 		preempt_reset_quantum();
-		proc_schedule();
+		proc_schedule(true);
 	);
 }
 
@@ -648,8 +810,12 @@ void proc_wakeup(Process *proc)
 	ASSERT(current_process);
 	IRQ_ASSERT_DISABLED();
 
+	trace_event(TRACE_WAKEUP, (uintptr_t)proc);
 	if (prio_proc(proc) >= prio_curr())
-		proc_switchTo(proc);
+	{
+		SCHED_STAMP(proc);
+		proc_switchTo(proc, false);
+	}
 	else
 		SCHED_ENQUEUE_HEAD(proc);
 }
@@ -673,6 +839,6 @@ void proc_yield(void)
 	IRQ_DISABLE;
 	proc = (struct Process *)list_remHead(&proc_ready_list);
 	if (proc)
-		proc_switchTo(proc);
+		proc_switchTo(proc, true);
 	IRQ_ENABLE;
 }
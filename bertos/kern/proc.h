@@ -104,6 +104,7 @@
 
 #include <cpu/types.h> // cpu_stack_t
 #include <cpu/frame.h> // CPU_SAVED_REGS_CNT
+#include <cpu/fpu.h> // CpuFpuCtrl
 
 /* The following silents warnings on nightly tests. We need to regenerate
  * all the projects before this can be removed.
@@ -111,6 +112,56 @@
 #ifndef CONFIG_KERN_PRI_INHERIT
 #define CONFIG_KERN_PRI_INHERIT 0
 #endif
+#ifndef CONFIG_KERN_PRI_CEILING
+#define CONFIG_KERN_PRI_CEILING 0
+#endif
+#ifndef CONFIG_KERN_ACCOUNTING
+#define CONFIG_KERN_ACCOUNTING 0
+#endif
+#ifndef CONFIG_KERN_EDF
+#define CONFIG_KERN_EDF 0
+#endif
+#ifndef CONFIG_KERN_FPU_CTRL
+#define CONFIG_KERN_FPU_CTRL 0
+#endif
+
+#if CONFIG_KERN_EDF && !CONFIG_KERN_PRI
+	#error CONFIG_KERN_EDF requires CONFIG_KERN_PRI
+#endif
+
+#if CONFIG_KERN_PRI_CEILING && !CONFIG_KERN_PRI
+	#error CONFIG_KERN_PRI_CEILING requires CONFIG_KERN_PRI
+#endif
+
+#if CONFIG_KERN_FPU_CTRL && !CPU_HAS_FPU
+	#error CONFIG_KERN_FPU_CTRL enabled on a CPU without floating point unit
+#endif
+
+/**
+ * Accounting figures of a process, see proc_stats().
+ *
+ * Times are expressed in hpticks (TIMER_HW_HPTICKS_PER_SEC); interrupts
+ * are charged to the process they preempt.
+ */
+typedef struct ProcStats
+{
+	uint64_t runtime;      ///< CPU time used by the process.
+	uint64_t latency_sum;  ///< Sum of the ready-to-run latencies.
+	uint32_t latency_max;  ///< Longest time spent in the ready list.
+	uint32_t dispatches;   ///< Number of times the process got the CPU.
+	uint32_t voluntary;    ///< Switches where the process blocked or yielded.
+	uint32_t involuntary;  ///< Switches where the process was preempted.
+} ProcStats;
+
+/**
+ * Deadline figures of a process of the EDF class, see edf_stats().
+ */
+typedef struct EdfStats
+{
+	uint32_t jobs;       ///< Periods started.
+	uint32_t misses;     ///< Jobs not completed by their deadline.
+	uint32_t throttles;  ///< Jobs suspended for exhausting their budget.
+} EdfStats;
 
 /*
  * WARNING: struct Process is considered private, so its definition can change any time
@@ -127,7 +178,12 @@ typedef struct Process
 	PriNode      inh_link;    /**< Link Process into priority inheritance lists */
 	List         inh_list;    /**< Priority inheritance list for this Process */
 	Semaphore    *inh_blocked_by;  /**< Semaphore blocking this Process */
-	int          orig_pri;    /**< Process priority without considering inheritance */
+# endif
+# if CONFIG_KERN_PRI_CEILING
+	Semaphore    *ceil_top;   /**< Last priority-ceiling semaphore locked */
+# endif
+# if CONFIG_KERN_PRI_INHERIT || CONFIG_KERN_PRI_CEILING
+	int          orig_pri;    /**< Process priority without considering inheritance and ceilings */
 # endif
 #else
 	Node         link;        /**< Link Process into scheduler lists */
@@ -156,9 +212,43 @@ typedef struct Process
 	{
 		Node        link;
 		const char *name;
+		size_t      free;      /**< Lowest free stack seen so far, in bytes */
+		size_t      reported;  /**< Free stack at the last alert */
+		size_t      scan;      /**< Stack words checked by the current pass */
 	} monitor;
 #endif
 
+#if CONFIG_KERN_ACCOUNTING
+	struct ProcAccounting
+	{
+		ProcStats   stats;
+		uint32_t    ready_since;  /**< When the process entered the ready list */
+		uint32_t    run_since;    /**< When the process got the CPU */
+	} acct;
+#endif
+
+#if CONFIG_KERN_EDF
+	struct ProcEdf
+	{
+		Node        link;         /**< Link into the EDF timeline */
+		ticks_t     period;       /**< Period, 0 for the priority class */
+		ticks_t     budget;       /**< CPU time granted each period */
+		ticks_t     rel_deadline; /**< Deadline, relative to the period start */
+		ticks_t     release;      /**< Start of the next period */
+		ticks_t     deadline;     /**< Absolute deadline of the current job */
+		ticks_t     left;         /**< Budget left to the current job */
+		ticks_t     event;        /**< Next deadline or release edf_tick() must handle */
+		int         pri;          /**< Priority to restore leaving the class */
+		uint8_t     flags;        /**< State of the current job */
+		EdfStats    stats;        /**< Deadline statistics */
+	} edf;
+#endif
+
+#if CONFIG_KERN_FPU_CTRL
+	CpuFpuCtrl    fpu_ctrl;      /**< FPU control words, while not loaded in the CPU */
+	bool          fpu_ctrl_used; /**< The process called proc_useFpuCtrl() */
+#endif
+
 } Process;
 
 /**
@@ -270,6 +360,49 @@ INLINE struct Process *proc_current(void)
 	}
 #endif
 
+#if CONFIG_KERN_ACCOUNTING
+	/**
+	 * Read the accounting figures of a process.
+	 *
+	 * The counters are never reset: sample them twice and take the
+	 * difference to get the figures of a time interval.
+	 */
+	void proc_stats(struct Process *proc, ProcStats *stats);
+
+	/**
+	 * Return the time spent by the scheduler waiting for a ready process [hpticks].
+	 */
+	uint64_t proc_idleTime(void);
+
+	/**
+	 * Return the average ready-to-run latency in \a stats [hpticks].
+	 */
+	INLINE uint32_t proc_avgLatency(const ProcStats *stats)
+	{
+		return stats->dispatches ? (uint32_t)(stats->latency_sum / stats->dispatches) : 0;
+	}
+#endif
+
+#if CONFIG_KERN_FPU_CTRL
+	/**
+	 * Give the current process its own FPU control words.
+	 *
+	 * From now on the rounding mode, precision and exception masks set by
+	 * the process are preserved across context switches, starting from the
+	 * power-on state. They are saved only when another process takes the
+	 * CPU, and the processes that did not call this function get the
+	 * power-on control words back.
+	 *
+	 * \note Only the control words are preserved: the FPU data registers
+	 *       are not saved by the kernel, see cpu/fpu.h. The processes that
+	 *       did not call this function share the power-on control words,
+	 *       and must not change them.
+	 */
+	void proc_useFpuCtrl(void);
+#else
+	#define proc_useFpuCtrl()  do {} while (0)
+#endif
+
 #if CONFIG_KERN_PREEMPT
 
 	/**
@@ -43,12 +43,17 @@
 #include "cfg/cfg_monitor.h"
 
 #include <cfg/compiler.h>
+#include <cfg/macros.h>      // MAX()
 
 #include <cpu/types.h>        /* for cpu_stack_t */
 #include <cpu/irq.h>          // IRQ_ASSERT_DISABLED()
 
 #include <kern/proc.h>   // struct Process
 
+#if CONFIG_KERN_ACCOUNTING
+	#include <drv/timer.h> // timer_hpclock()
+#endif
+
 #ifndef asm_switch_context
 /**
  * CPU dependent context switching routines.
@@ -78,11 +83,21 @@ extern REGISTER Process	*current_process;
 extern REGISTER List     proc_ready_list;
 
 #if CONFIG_KERN_PRI
-# if CONFIG_KERN_PRI_INHERIT
+# if CONFIG_KERN_PRI_INHERIT || CONFIG_KERN_PRI_CEILING
 	#define __prio_orig(proc) (proc->orig_pri)
+#  if CONFIG_KERN_PRI_INHERIT
 	#define __prio_inh(proc) (LIST_EMPTY(&(proc)->inh_list) ? INT_MIN : \
 					((PriNode *)LIST_HEAD(&proc->inh_list))->pri)
-	#define __prio_proc(proc) (__prio_inh(proc) > __prio_orig(proc) ? \
+#  else
+	#define __prio_inh(proc) INT_MIN
+#  endif
+#  if CONFIG_KERN_PRI_CEILING
+	#define __prio_ceil(proc) ((proc)->ceil_top ? (proc)->ceil_top->ceil_held : INT_MIN)
+#  else
+	#define __prio_ceil(proc) INT_MIN
+#  endif
+	#define __prio_proc(proc) MAX(__prio_ceil(proc), \
+					__prio_inh(proc) > __prio_orig(proc) ? \
 					__prio_inh(proc) : __prio_orig(proc))
 # endif
 	#define prio_next()	(LIST_EMPTY(&proc_ready_list) ? INT_MIN : \
@@ -103,6 +118,13 @@ extern REGISTER List     proc_ready_list;
 	#define SCHED_ENQUEUE_HEAD_INTERNAL(proc) ADDHEAD(&proc_ready_list, &(proc)->link)
 #endif
 
+#if CONFIG_KERN_ACCOUNTING
+	/* Remember when a process becomes ready, to measure its dispatch latency */
+	#define SCHED_STAMP(proc)  ((proc)->acct.ready_since = timer_hpclock())
+#else
+	#define SCHED_STAMP(proc)  do { } while (0)
+#endif
+
 /**
  * Enqueue a process in the ready list.
  *
@@ -115,12 +137,14 @@ extern REGISTER List     proc_ready_list;
 #define SCHED_ENQUEUE(proc)  do { \
 		IRQ_ASSERT_DISABLED(); \
 		LIST_ASSERT_VALID(&proc_ready_list); \
+		SCHED_STAMP(proc); \
 		SCHED_ENQUEUE_INTERNAL(proc); \
 	} while (0)
 
 #define SCHED_ENQUEUE_HEAD(proc)  do { \
 		IRQ_ASSERT_DISABLED(); \
 		LIST_ASSERT_VALID(&proc_ready_list); \
+		SCHED_STAMP(proc); \
 		SCHED_ENQUEUE_HEAD_INTERNAL(proc); \
 	} while (0)
 
@@ -185,8 +209,35 @@ void proc_schedInit(void);
 
 	/** Rename a process */
 	void monitor_rename(Process *proc, const char *name);
+
+	/** Call \a func for every registered process, with the scheduler disabled */
+	void monitor_foreach(void (*func)(Process *proc, const char *name, void *data), void *data);
 #endif /* CONFIG_KERN_MONITOR */
 
+#ifndef CONFIG_KERN_MONITOR_SAMPLE_SP
+	#define CONFIG_KERN_MONITOR_SAMPLE_SP 0
+#endif
+
+#if CONFIG_KERN_MONITOR && CONFIG_KERN_MONITOR_SAMPLE_SP
+	/** Lower the stack watermark of \a proc down to its saved stack pointer */
+	void monitor_sampleStack(Process *proc);
+#else
+	#define monitor_sampleStack(proc)  do { } while (0)
+#endif
+
+#if CONFIG_KERN && CONFIG_KERN_EDF
+	/** Initialize the EDF scheduling class */
+	void edf_init(void);
+
+	/** Move a process out of the EDF class, when it exits */
+	void edf_remove(Process *proc);
+
+	/** Charge the budget of the current job and release the new ones */
+	void edf_tick(void);
+#else
+	#define edf_tick()  do { } while (0)
+#endif
+
 /*
  * Quantum related macros are used in the
  * timer module and must be empty when
@@ -0,0 +1,195 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Per-process accounting test.
+ *
+ * A process burns the CPU in bursts, while a ticker sleeps on a timer and
+ * a sleeper is woken up by the main process. The burner must get most of
+ * the CPU time, the ticker must see the bursts as dispatch latency and the
+ * context switches must be split between voluntary and involuntary ones.
+ * All the time since proc_init() must be charged to some process or to
+ * the idle counter.
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: echo  "#undef CONFIG_KERN_ACCOUNTING" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN_ACCOUNTING 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_monitor.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_MONITOR" >> $cfgdir/cfg_monitor.h
+ * $test$: echo "#define CONFIG_KERN_MONITOR 1" >> $cfgdir/cfg_monitor.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include <cfg/debug.h>
+#include <cfg/test.h>
+
+#include <cpu/irq.h>
+
+#include <kern/proc.h>
+#include <kern/signal.h>
+#include <kern/monitor.h>
+
+#include <drv/timer.h>
+
+#define BURSTS     5
+#define BURST_MS  20
+#define WAKEUPS   10
+
+static struct Process *burner_proc, *ticker_proc, *sleeper_proc;
+static volatile bool done;
+static uint32_t start_time;
+
+static PROC_DEFINE_STACK(burner_stack, KERN_MINSTACKSIZE);
+static PROC_DEFINE_STACK(ticker_stack, KERN_MINSTACKSIZE);
+static PROC_DEFINE_STACK(sleeper_stack, KERN_MINSTACKSIZE);
+
+/* Keep the CPU busy without releasing it, even to the timer processes */
+static void burner(void)
+{
+	for (int i = 0; i < BURSTS; i++)
+	{
+		ticks_t start = timer_clock();
+
+		while (timer_clock() - start < ms_to_ticks(BURST_MS))
+			;
+		timer_delay(BURST_MS);
+	}
+	while (!done)
+		timer_delay(10);
+}
+
+static void ticker(void)
+{
+	while (!done)
+		timer_delay(1);
+}
+
+static void sleeper(void)
+{
+	for (;;)
+		sig_wait(SIG_USER0);
+}
+
+INLINE uint32_t to_us(uint64_t t)
+{
+	return (uint32_t)(t * 1000000UL / TIMER_HW_HPTICKS_PER_SEC);
+}
+
+int proc_stats_testRun(void)
+{
+	ProcStats main_st, burner_st, ticker_st, sleeper_st;
+	uint64_t idle, total;
+	uint32_t elapsed;
+	cpu_flags_t flags;
+
+	/* Let the sleeper start waiting before the burner gets in the way */
+	sleeper_proc = proc_new(sleeper, NULL, sizeof(sleeper_stack), sleeper_stack);
+	proc_yield();
+	burner_proc = proc_new(burner, NULL, sizeof(burner_stack), burner_stack);
+	ticker_proc = proc_new(ticker, NULL, sizeof(ticker_stack), ticker_stack);
+
+	for (int i = 0; i < WAKEUPS; i++)
+	{
+		timer_delay(BURST_MS * BURSTS * 2 / WAKEUPS);
+		sig_send(sleeper_proc, SIG_USER0);
+	}
+
+	/* Sample everything at the same time */
+	IRQ_SAVE_DISABLE(flags);
+	proc_stats(proc_current(), &main_st);
+	proc_stats(burner_proc, &burner_st);
+	proc_stats(ticker_proc, &ticker_st);
+	proc_stats(sleeper_proc, &sleeper_st);
+	idle = proc_idleTime();
+	elapsed = timer_hpclock() - start_time;
+	IRQ_RESTORE(flags);
+
+	monitor_report();
+	done = true;
+
+	total = main_st.runtime + burner_st.runtime + ticker_st.runtime + sleeper_st.runtime + idle;
+	kprintf("Elapsed %lu us, accounted %lu us\n",
+		(unsigned long)to_us(elapsed), (unsigned long)to_us(total));
+	if (to_us(total > elapsed ? total - elapsed : elapsed - total) > 1000)
+	{
+		kprintf("Accounted time does not match\n");
+		return -1;
+	}
+
+	if (to_us(burner_st.runtime) < BURSTS * BURST_MS * 900UL
+			|| burner_st.runtime < 5 * (main_st.runtime + ticker_st.runtime + sleeper_st.runtime))
+	{
+		kprintf("Burner did not get the CPU\n");
+		return -1;
+	}
+
+	/* The ticker waits for the end of a burst before running again */
+	if (to_us(ticker_st.latency_max) < BURST_MS * 1000UL / 2
+			|| to_us(proc_avgLatency(&ticker_st)) >= to_us(ticker_st.latency_max))
+	{
+		kprintf("Bad ticker latency %lu/%lu us\n",
+			(unsigned long)to_us(proc_avgLatency(&ticker_st)),
+			(unsigned long)to_us(ticker_st.latency_max));
+		return -1;
+	}
+
+	/* The sleeper runs as soon as it is woken up and goes back to sleep */
+	if (sleeper_st.dispatches != WAKEUPS + 1 || sleeper_st.voluntary != WAKEUPS + 1
+			|| sleeper_st.involuntary || main_st.involuntary < WAKEUPS)
+	{
+		kprintf("Bad switch counts\n");
+		return -1;
+	}
+	return 0;
+}
+
+int proc_stats_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+	proc_init();
+	start_time = timer_hpclock();
+	return 0;
+}
+
+int proc_stats_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(proc_stats);
@@ -0,0 +1,344 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Protothreads run loop.
+ *
+ * The ready list and the event lists are also touched by interrupts, so
+ * they are accessed with interrupts disabled. The other lists belong to
+ * the run loop process alone: a protothread yielding or waking up from a
+ * delay costs no locking at all.
+ */
+
+#include "pt.h"
+
+#include "cfg/cfg_proc.h"
+#include "cfg/cfg_signal.h"
+
+#if CONFIG_KERN && CONFIG_KERN_SIGNALS
+
+#include <cfg/debug.h>
+#include <cfg/module.h>
+
+#include <cpu/irq.h>
+
+#include <kern/proc.h>
+#include <kern/signal.h>
+
+/* Wakes up the run loop */
+#define SIG_PT  SIG_SYSTEM5
+
+/* Protothread states */
+enum
+{
+	PT_IDLE,      ///< Not started or finished.
+	PT_READY,     ///< In the ready list.
+	PT_RUNNING,   ///< Running, or about to decide what to wait for.
+	PT_SLEEPING,  ///< In the sleeping list.
+	PT_POLLING,   ///< In the polling list.
+	PT_EVENT,     ///< In the waiters list of a PtEvent.
+	PT_SIGNAL,    ///< Waiting for a signal, in no list.
+};
+
+#define PTF_POSTED  BV(0)  ///< Woken up by pt_eventPost().
+
+static List pt_ready;      /* Woken up by interrupts or other processes */
+static List pt_later;      /* Woken up by the run loop, for the next pass */
+static List pt_sleeping;   /* Sorted by wake time */
+static List pt_polling;
+static ticks_t pt_lastPoll;
+
+static Process *pt_proc;
+static PROC_DEFINE_STACK(pt_stack, CONFIG_PT_STACK);
+
+/* Move all the nodes of \a src to the tail of \a dst */
+static void pt_append(List *dst, List *src)
+{
+	Node *first, *last;
+
+	if (LIST_EMPTY(src))
+		return;
+
+	first = LIST_HEAD(src);
+	last = LIST_TAIL(src);
+	first->pred = LIST_TAIL(dst);
+	LIST_TAIL(dst)->succ = first;
+	last->succ = &dst->tail;
+	dst->tail.pred = last;
+	LIST_INIT(src);
+}
+
+/* Put \a pt in the ready list, with interrupts disabled */
+static void pt_wake(Pt *pt)
+{
+	IRQ_ASSERT_DISABLED();
+
+	pt->state = PT_READY;
+	ADDTAIL(&pt_ready, &pt->link);
+	sig_post(pt_proc, SIG_PT);
+}
+
+/* Same as pt_wake(), from the run loop */
+static void pt_wakeLater(Pt *pt)
+{
+	pt->state = PT_READY;
+	ADDTAIL(&pt_later, &pt->link);
+}
+
+/*
+ * Run the ready protothreads once. The ones becoming ready meanwhile run
+ * in the next pass, so the timers and the other processes are not starved.
+ */
+static bool pt_runReady(void)
+{
+	List run;
+	Pt *pt;
+
+	LIST_INIT(&run);
+	pt_append(&run, &pt_later);
+	ATOMIC(pt_append(&run, &pt_ready));
+	if (LIST_EMPTY(&run))
+		return false;
+
+	while ((pt = (Pt *)list_remHead(&run)))
+	{
+		pt->state = PT_RUNNING;
+		if (pt->func(pt) == PT_EXITED)
+			pt->state = PT_IDLE;
+	}
+	return true;
+}
+
+static void pt_expire(ticks_t now)
+{
+	Pt *pt;
+
+	while (!LIST_EMPTY(&pt_sleeping))
+	{
+		pt = (Pt *)LIST_HEAD(&pt_sleeping);
+		if (pt->wake - now > 0)
+			break;
+		REMOVE(&pt->link);
+		pt_wakeLater(pt);
+	}
+
+	if (!LIST_EMPTY(&pt_polling) && now - pt_lastPoll >= ms_to_ticks(CONFIG_PT_POLL))
+	{
+		pt_lastPoll = now;
+		while ((pt = (Pt *)list_remHead(&pt_polling)))
+			pt_wakeLater(pt);
+	}
+}
+
+static void pt_loop(void)
+{
+	for (;;)
+	{
+		ticks_t now, timeout = 0;
+		bool idle;
+
+		if (pt_runReady())
+			proc_yield();
+
+		now = timer_clock();
+		pt_expire(now);
+
+		ATOMIC(idle = LIST_EMPTY(&pt_ready));
+		if (!idle || !LIST_EMPTY(&pt_later))
+			continue;
+
+		if (!LIST_EMPTY(&pt_sleeping))
+			timeout = MAX(((Pt *)LIST_HEAD(&pt_sleeping))->wake - now, (ticks_t)1);
+		if (!LIST_EMPTY(&pt_polling))
+		{
+			ticks_t poll = MAX(ms_to_ticks(CONFIG_PT_POLL) - (now - pt_lastPoll), (ticks_t)1);
+
+			if (!timeout || poll < timeout)
+				timeout = poll;
+		}
+
+		if (timeout)
+			sig_waitTimeout(SIG_PT, timeout);
+		else
+			sig_wait(SIG_PT);
+	}
+}
+
+MOD_DEFINE(pt);
+
+void pt_init(void)
+{
+	LIST_INIT(&pt_ready);
+	LIST_INIT(&pt_later);
+	LIST_INIT(&pt_sleeping);
+	LIST_INIT(&pt_polling);
+	pt_lastPoll = timer_clock();
+
+	pt_proc = proc_new(pt_loop, NULL, sizeof(pt_stack), pt_stack);
+	ASSERT(pt_proc);
+	proc_setPri(pt_proc, CONFIG_PT_PRI);
+	MOD_INIT(pt);
+}
+
+void pt_spawn(Pt *pt, PtFunc func)
+{
+	MOD_CHECK(pt);
+	ASSERT(pt->state == PT_IDLE);
+
+	pt->func = func;
+	pt->lc = 0;
+	pt->flags = 0;
+	pt->sig_recv = pt->sig_wait = 0;
+	ATOMIC(pt_wake(pt));
+}
+
+bool pt_alive(Pt *pt)
+{
+	return pt->state != PT_IDLE;
+}
+
+void pt_yield(Pt *pt)
+{
+	ASSERT(pt->state == PT_RUNNING);
+	pt_wakeLater(pt);
+}
+
+void pt_sleep(Pt *pt, ticks_t ticks)
+{
+	Node *n, *next;
+
+	ASSERT(pt->state == PT_RUNNING);
+	pt->state = PT_SLEEPING;
+	pt->wake = timer_clock() + ticks;
+
+	/* Most delays end after the ones already waiting: scan from the tail */
+	REVERSE_FOREACH_NODE(n, &pt_sleeping)
+		if (((Pt *)n)->wake - pt->wake <= 0)
+			break;
+	next = n->succ;
+	INSERT_BEFORE(&pt->link, next);
+}
+
+void pt_poll(Pt *pt)
+{
+	ASSERT(pt->state == PT_RUNNING);
+	pt->state = PT_POLLING;
+	ADDTAIL(&pt_polling, &pt->link);
+}
+
+void pt_sigSend(Pt *pt, sigmask_t sigs)
+{
+	cpu_flags_t flags;
+
+	IRQ_SAVE_DISABLE(flags);
+	pt->sig_recv |= sigs;
+	if (pt->state == PT_SIGNAL && (pt->sig_recv & pt->sig_wait))
+		pt_wake(pt);
+	IRQ_RESTORE(flags);
+}
+
+bool pt_sigWait(Pt *pt, sigmask_t sigs)
+{
+	sigmask_t got;
+
+	IRQ_DISABLE;
+	got = pt->sig_recv & sigs;
+	if (got)
+		pt->sig_recv &= ~got;
+	else
+		pt->state = PT_SIGNAL;
+	pt->sig_wait = got ? got : sigs;
+	IRQ_ENABLE;
+	return got != 0;
+}
+
+void pt_eventInit(PtEvent *ev)
+{
+	LIST_INIT(&ev->waiters);
+	ev->pending = false;
+}
+
+void pt_eventPost(PtEvent *ev)
+{
+	cpu_flags_t flags;
+	Pt *pt;
+
+	IRQ_SAVE_DISABLE(flags);
+	pt = (Pt *)list_remHead(&ev->waiters);
+	if (pt)
+	{
+		pt->flags |= PTF_POSTED;
+		pt_wake(pt);
+	}
+	else
+		ev->pending = true;
+	IRQ_RESTORE(flags);
+}
+
+void pt_eventBroadcast(PtEvent *ev)
+{
+	cpu_flags_t flags;
+	Pt *pt;
+
+	IRQ_SAVE_DISABLE(flags);
+	while ((pt = (Pt *)list_remHead(&ev->waiters)))
+	{
+		pt->flags |= PTF_POSTED;
+		pt_wake(pt);
+	}
+	IRQ_RESTORE(flags);
+}
+
+void pt_eventHook(void *ev)
+{
+	pt_eventPost((PtEvent *)ev);
+}
+
+bool pt_eventWait(PtEvent *ev, Pt *pt)
+{
+	bool done = true;
+
+	IRQ_DISABLE;
+	if (pt->flags & PTF_POSTED)
+		pt->flags &= ~PTF_POSTED;
+	else if (ev->pending)
+		ev->pending = false;
+	else
+	{
+		pt->state = PT_EVENT;
+		ADDTAIL(&ev->waiters, &pt->link);
+		done = false;
+	}
+	IRQ_ENABLE;
+	return done;
+}
+
+#endif /* CONFIG_KERN && CONFIG_KERN_SIGNALS */
@@ -0,0 +1,289 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Protothreads: stackless tasks for low memory concurrency.
+ *
+ * A protothread is a function that can wait for something and resume
+ * where it stopped, without a stack of its own: all the protothreads run
+ * in turn on the stack of a single process, started by pt_init(). Each
+ * one costs only a Pt structure, so thousands of them take the memory of
+ * a couple of processes.
+ *
+ * The price is that the local variables of the function are lost while it
+ * waits: keep the state that must survive a wait in a structure that
+ * embeds the Pt, and get it back with containerof().
+ *
+ * \code
+ * typedef struct Blinker
+ * {
+ *     Pt pt;
+ *     int count;
+ * } Blinker;
+ *
+ * static int blink(Pt *pt)
+ * {
+ *     Blinker *b = containerof(pt, Blinker, pt);
+ *
+ *     PT_BEGIN(pt);
+ *     for (b->count = 0; b->count < 10; b->count++)
+ *     {
+ *         led_toggle();
+ *         PT_DELAY(pt, 500);
+ *     }
+ *     PT_END(pt);
+ * }
+ *
+ * static Blinker blinker;
+ *
+ * pt_init();
+ * pt_spawn(&blinker.pt, blink);
+ * \endcode
+ *
+ * A protothread can wait for:
+ *  - a time interval, with PT_DELAY();
+ *  - a PtEvent, with PT_WAIT_EVENT(); a plain Event can trigger a PtEvent,
+ *    see pt_eventHook();
+ *  - its own signals, with PT_WAIT_SIGNAL();
+ *  - any condition, with PT_WAIT_UNTIL(): the condition is checked every
+ *    CONFIG_PT_POLL ms, use it to wait for a KFile to have data, e.g.
+ *    <tt>PT_WAIT_UNTIL(pt, !fifo_isempty_locked(&ser.rxfifo))</tt>.
+ *
+ * The PT_* macros are built on a switch statement: they can not be used in
+ * a switch of the protothread itself, and two of them can not be on the
+ * same line.
+ *
+ * $WIZ$ module_name = "pt"
+ * $WIZ$ module_depends = "kernel", "signal", "timer"
+ * $WIZ$ module_configuration = "bertos/cfg/cfg_pt.h"
+ */
+
+#ifndef KERN_PT_H
+#define KERN_PT_H
+
+#include "cfg/cfg_pt.h"
+
+#include <cfg/compiler.h>
+#include <cfg/macros.h>
+
+#include <drv/timer.h>
+
+#include <struct/list.h>
+
+/** \name Return values of the protothread functions
+ * \{
+ */
+#define PT_WAITING  0   ///< The protothread is waiting.
+#define PT_EXITED   1   ///< The protothread has finished.
+/* \} */
+
+struct Pt;
+
+/**
+ * Body of a protothread, it must be enclosed in PT_BEGIN() and PT_END().
+ */
+typedef int (*PtFunc)(struct Pt *pt);
+
+/**
+ * Protothread context.
+ *
+ * \note All fields are private.
+ */
+typedef struct Pt
+{
+	Node      link;      ///< Link into the list of what the protothread waits for.
+	PtFunc    func;      ///< Body of the protothread.
+	ticks_t   wake;      ///< End of the current PT_DELAY().
+	uint16_t  lc;        ///< Line where the protothread resumes.
+	uint8_t   state;     ///< What the protothread is doing.
+	uint8_t   flags;
+	sigmask_t sig_recv;  ///< Signals received.
+	sigmask_t sig_wait;  ///< Signals waited for, or the ones that ended the wait.
+} Pt;
+
+/**
+ * Event a protothread can wait for.
+ */
+typedef struct PtEvent
+{
+	List waiters;        ///< Protothreads waiting for the event.
+	bool pending;        ///< Posted while nobody was waiting.
+} PtEvent;
+
+/* Resuming points are reached by falling through from the line above */
+#if GNUC_PREREQ(7,0)
+	#define PT_FALLTHROUGH  __attribute__((__fallthrough__))
+#else
+	#define PT_FALLTHROUGH  do { } while (0)
+#endif
+
+/**
+ * Start the body of a protothread.
+ */
+#define PT_BEGIN(pt)  switch ((pt)->lc) { case 0:
+
+/**
+ * End the body of a protothread.
+ */
+#define PT_END(pt)  } (pt)->lc = 0; return PT_EXITED
+
+/**
+ * Terminate the protothread.
+ */
+#define PT_EXIT(pt)  do { (pt)->lc = 0; return PT_EXITED; } while (0)
+
+/**
+ * Let the other protothreads run.
+ */
+#define PT_YIELD(pt) \
+	do { \
+		pt_yield(pt); \
+		(pt)->lc = __LINE__; return PT_WAITING; case __LINE__:; \
+	} while (0)
+
+/**
+ * Sleep for \a ticks timer ticks.
+ */
+#define PT_DELAY_TICKS(pt, ticks) \
+	do { \
+		pt_sleep((pt), (ticks)); \
+		(pt)->lc = __LINE__; return PT_WAITING; case __LINE__:; \
+	} while (0)
+
+/**
+ * Sleep for \a ms milliseconds.
+ */
+#define PT_DELAY(pt, ms)  PT_DELAY_TICKS(pt, ms_to_ticks(ms))
+
+/**
+ * Wait until \a cond is true.
+ *
+ * The condition is checked every CONFIG_PT_POLL ms.
+ */
+#define PT_WAIT_UNTIL(pt, cond) \
+	do { \
+		(pt)->lc = __LINE__; PT_FALLTHROUGH; case __LINE__: \
+		if (!(cond)) { pt_poll(pt); return PT_WAITING; } \
+	} while (0)
+
+/**
+ * Wait for the event \a ev to be posted.
+ */
+#define PT_WAIT_EVENT(pt, ev) \
+	do { \
+		(pt)->lc = __LINE__; PT_FALLTHROUGH; case __LINE__: \
+		if (!pt_eventWait((ev), (pt))) return PT_WAITING; \
+	} while (0)
+
+/**
+ * Wait for any of the signals \a sigs.
+ *
+ * The signals received are cleared and can be read with pt_sigReceived().
+ */
+#define PT_WAIT_SIGNAL(pt, sigs) \
+	do { \
+		(pt)->lc = __LINE__; PT_FALLTHROUGH; case __LINE__: \
+		if (!pt_sigWait((pt), (sigs))) return PT_WAITING; \
+	} while (0)
+
+/**
+ * Signals that ended the last PT_WAIT_SIGNAL() of \a pt.
+ */
+#define pt_sigReceived(pt)  ((pt)->sig_wait)
+
+/**
+ * Start the process running the protothreads.
+ */
+void pt_init(void);
+
+/**
+ * Start the protothread \a pt, running \a func.
+ *
+ * \a pt must be zeroed before its first use, and can be reused when
+ * \a func has returned PT_EXITED.
+ */
+void pt_spawn(Pt *pt, PtFunc func);
+
+/**
+ * Return true if the protothread \a pt has not finished yet.
+ */
+bool pt_alive(Pt *pt);
+
+/**
+ * Send the signals \a sigs to the protothread \a pt.
+ *
+ * \note Can be called from interrupts.
+ */
+void pt_sigSend(Pt *pt, sigmask_t sigs);
+
+/** Initialize the event \a ev. */
+void pt_eventInit(PtEvent *ev);
+
+/**
+ * Post the event \a ev.
+ *
+ * The first protothread waiting for the event is woken up; if there are
+ * none, the next one calling PT_WAIT_EVENT() will not wait.
+ *
+ * \note Can be called from interrupts.
+ */
+void pt_eventPost(PtEvent *ev);
+
+/**
+ * Wake up all the protothreads waiting for \a ev.
+ *
+ * \note Can be called from interrupts.
+ */
+void pt_eventBroadcast(PtEvent *ev);
+
+/**
+ * Post the PtEvent \a ev, as an Event hook.
+ *
+ * This lets any code that completes an Event wake a protothread:
+ * \code
+ * event_initSoftint(&e, pt_eventHook, &pt_ev);
+ * \endcode
+ */
+void pt_eventHook(void *ev);
+
+/* Used by the PT_* macros */
+void pt_yield(Pt *pt);
+void pt_sleep(Pt *pt, ticks_t ticks);
+void pt_poll(Pt *pt);
+bool pt_eventWait(PtEvent *ev, Pt *pt);
+bool pt_sigWait(Pt *pt, sigmask_t sigs);
+
+/* Test functions */
+int pt_testRun(void);
+int pt_testSetup(void);
+int pt_testTearDown(void);
+
+#endif /* KERN_PT_H */
@@ -0,0 +1,251 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Protothreads test and benchmark.
+ *
+ * Checks every way a protothread can wait, then starts thousands of
+ * sleeping protothreads at once. The benchmark compares the switches per
+ * second and the memory per task of protothreads and processes, with the
+ * same number of tasks yielding to each other: debug builds check every
+ * list insertion, so longer lists would measure those checks.
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include <cfg/debug.h>
+#include <cfg/test.h>
+
+#include <kern/proc.h>
+#include <kern/pt.h>
+
+#include <mware/event.h>
+
+#include <drv/timer.h>
+
+#define SLEEPERS      2000
+#define BENCH_TASKS   4
+#define BENCH_TICKS   100
+
+typedef struct Sleeper
+{
+	Pt pt;
+	ticks_t start;
+	mtime_t delay;
+} Sleeper;
+
+static Sleeper sleepers[SLEEPERS];
+static int woken, early;
+
+static PtEvent ev;
+static Pt ev_pt;
+static int ev_count;
+
+static Pt sig_pt;
+static sigmask_t sig_got;
+
+static Pt poll_pt;
+static volatile bool poll_flag;
+static bool poll_done;
+
+static Pt bench_pt[BENCH_TASKS];
+static volatile bool stop;
+static unsigned long pt_switches, proc_switches;
+static PROC_DEFINE_STACK(bench_stack[BENCH_TASKS], KERN_MINSTACKSIZE);
+
+static int sleeper(Pt *pt)
+{
+	Sleeper *s = containerof(pt, Sleeper, pt);
+
+	PT_BEGIN(pt);
+	s->start = timer_clock();
+	PT_DELAY(pt, s->delay);
+	if (timer_clock() - s->start < ms_to_ticks(s->delay))
+		early++;
+	woken++;
+	PT_END(pt);
+}
+
+static int ev_waiter(Pt *pt)
+{
+	PT_BEGIN(pt);
+	for (;;)
+	{
+		PT_WAIT_EVENT(pt, &ev);
+		if (++ev_count == 3)
+			PT_EXIT(pt);
+	}
+	PT_END(pt);
+}
+
+static int sig_waiter(Pt *pt)
+{
+	PT_BEGIN(pt);
+	PT_WAIT_SIGNAL(pt, SIG_USER0 | SIG_USER1);
+	sig_got = pt_sigReceived(pt);
+	PT_END(pt);
+}
+
+static int poller(Pt *pt)
+{
+	PT_BEGIN(pt);
+	PT_WAIT_UNTIL(pt, poll_flag);
+	poll_done = true;
+	PT_END(pt);
+}
+
+static int bench(Pt *pt)
+{
+	PT_BEGIN(pt);
+	while (!stop)
+	{
+		pt_switches++;
+		PT_YIELD(pt);
+	}
+	PT_END(pt);
+}
+
+static void bench_proc(void)
+{
+	while (!stop)
+	{
+		proc_switches++;
+		proc_yield();
+	}
+}
+
+static int check_waits(void)
+{
+	Event e;
+
+	pt_eventInit(&ev);
+	pt_spawn(&ev_pt, ev_waiter);
+	pt_spawn(&sig_pt, sig_waiter);
+	pt_spawn(&poll_pt, poller);
+	timer_delay(20);
+
+	/* A post with nobody waiting is not lost */
+	pt_eventPost(&ev);
+	pt_eventPost(&ev);
+	timer_delay(20);
+	event_initSoftint(&e, pt_eventHook, &ev);
+	event_do(&e);
+
+	pt_sigSend(&sig_pt, SIG_USER1 | SIG_USER2);
+	poll_flag = true;
+	timer_delay(3 * CONFIG_PT_POLL);
+
+	if (ev_count != 3 || pt_alive(&ev_pt))
+	{
+		kprintf("Event: %d posts received\n", ev_count);
+		return -1;
+	}
+	if (sig_got != SIG_USER1 || pt_alive(&sig_pt))
+	{
+		kprintf("Signal: got %02x\n", sig_got);
+		return -1;
+	}
+	if (!poll_done)
+	{
+		kprintf("Condition not polled\n");
+		return -1;
+	}
+	return 0;
+}
+
+static int check_sleepers(void)
+{
+	for (int i = 0; i < SLEEPERS; i++)
+	{
+		sleepers[i].delay = 1 + (i * 7) % 100;
+		pt_spawn(&sleepers[i].pt, sleeper);
+	}
+	timer_delay(300);
+
+	kprintf("%d protothreads woken, %d early\n", woken, early);
+	return (woken == SLEEPERS && !early) ? 0 : -1;
+}
+
+static void benchmark(void)
+{
+	stop = false;
+	for (int i = 0; i < BENCH_TASKS; i++)
+		pt_spawn(&bench_pt[i], bench);
+	timer_delayTicks(BENCH_TICKS);
+	stop = true;
+	timer_delay(20);
+
+	stop = false;
+	for (int i = 0; i < BENCH_TASKS; i++)
+		proc_new(bench_proc, NULL, sizeof(bench_stack[i]), bench_stack[i]);
+	timer_delayTicks(BENCH_TICKS);
+	stop = true;
+	timer_delay(20);
+
+	kprintf("Protothreads: %lu switches/s, %lu bytes per task\n",
+		pt_switches * TIMER_TICKS_PER_SEC / BENCH_TICKS,
+		(unsigned long)sizeof(Pt));
+	kprintf("Processes:    %lu switches/s, %lu bytes per task\n",
+		proc_switches * TIMER_TICKS_PER_SEC / BENCH_TICKS,
+		(unsigned long)(sizeof(Process) + KERN_MINSTACKSIZE));
+}
+
+int pt_testRun(void)
+{
+	if (check_waits() || check_sleepers())
+		return -1;
+	benchmark();
+	return 0;
+}
+
+int pt_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+	proc_init();
+	pt_init();
+	return 0;
+}
+
+int pt_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(pt);
@@ -40,12 +40,14 @@
 #include "rtask.h"
 #include "cfg/cfg_rtask.h"
 #include <cfg/module.h> // MOD_CHECK
+#include <cfg/macros.h> // MAX()
 
 #define LOG_LEVEL RTASK_LOG_LEVEL
 #define LOG_FORMAT RTASK_LOG_FORMAT
 #include <cfg/log.h>
 
 #include <cpu/types.h>
+#include <cpu/irq.h>
 
 #include <drv/timer.h>
 
@@ -56,28 +58,53 @@
 #include <kern/signal.h>
 #include <kern/sem.h>
 
-#define NEW_TASK SIG_USER0
+#include <string.h> // memset()
+
+#if CONFIG_KERN && CONFIG_KERN_SIGNALS
+
+/*
+ * Signals of the dispatcher, which runs no user code. The workers run the
+ * callbacks, which may use the user signals and wait on generic events or
+ * lwIP (SIG_SYSTEM6), see kern/signal.h.
+ */
+#define NEW_TASK  SIG_SYSTEM5
+#define DEADLINE  SIG_SYSTEM6
+/* Signal of the workers */
+#define RUN_TASK  SIG_SYSTEM5
 
 // TODO: Mixing static and dynamic tests in kernel must be tested with care,
 // until then use this workaround
 #if CONFIG_KERN_HEAP
-	#define PROC_NEW() proc_new(rtask_proc, NULL, CONFIG_RTASK_STACK, NULL)
+	#define PROC_NEW(entry, i) proc_new(entry, NULL, CONFIG_RTASK_STACK, NULL)
 #else
-	PROC_DEFINE_STACK(rtask_stack, CONFIG_RTASK_STACK);
-	#define PROC_NEW() proc_new(rtask_proc, NULL, sizeof(rtask_stack), rtask_stack)
+	/* One stack for the dispatcher, followed by the ones of the workers */
+	static cpu_stack_t rtask_stack[CONFIG_RTASK_WORKERS + 1]
+		[(CONFIG_RTASK_STACK + sizeof(cpu_stack_t) - 1) / sizeof(cpu_stack_t)];
+	STATIC_ASSERT(CONFIG_RTASK_STACK >= KERN_MINSTACKSIZE);
+	#define PROC_NEW(entry, i) proc_new(entry, NULL, sizeof(rtask_stack[0]), rtask_stack[(i)])
 #endif
 
 
 struct RTask
 {
-	Timer t;
+	Timer t;              /* Next deadline, in rt_list */
+	PriNode ready;        /* Link into ready_list, with the task priority */
 	rtask_cb_t callback;
 	void *user_data;
+	ticks_t due;          /* Deadline of the pending run */
+	bool busy;            /* Waiting for a worker or running */
+	RTaskStats stats;
 };
 
 DEFINE_POOL_STATIC(rtask_pool, RTask, CONFIG_RTASK_POOL_SIZE);
 static Process *process = NULL;
+/* Tasks sorted by deadline */
 static List rt_list;
+/* Expired tasks waiting for a worker, sorted by priority */
+static List ready_list;
+/* Workers waiting for a task */
+static Process *idle_workers[CONFIG_RTASK_WORKERS];
+static int idle_count;
 static Semaphore rtask_sem;
 #define RTASK_ATOMIC(code) \
 	do {                         \
@@ -87,35 +114,142 @@ static Semaphore rtask_sem;
 	} while (0)
 
 
-//TODO: "Remove synctimer_poll and use a list directly"
+/*
+ * Queue the expired tasks and wake up the workers.
+ * Called with the semaphore held.
+ */
+static void rtask_dispatch(void)
+{
+	ticks_t now = timer_clock();
+	Timer *t;
+
+	while ((t = (Timer *)LIST_HEAD(&rt_list))->link.succ && now - t->tick >= 0)
+	{
+		RTask *rt = containerof(t, RTask, t);
+
+		REMOVE(&t->link);
+		DB(t->magic = TIMER_MAGIC_INACTIVE;)
+
+		if (rt->busy)
+			rt->stats.overruns++;
+		else
+		{
+			rt->busy = true;
+			rt->due = t->tick;
+			LIST_ENQUEUE(&ready_list, &rt->ready);
+			if (idle_count)
+				sig_send(idle_workers[--idle_count], RUN_TASK);
+		}
+
+		/* The next deadline only depends on the previous one: skip the missed ones */
+		while (now - (t->tick + t->_delay) >= 0)
+		{
+			t->tick += t->_delay;
+			rt->stats.overruns++;
+		}
+		synctimer_readd(t, &rt_list);
+	}
+}
+
 static NORETURN void rtask_proc(void)
 {
+	Timer wakeup;
+
+	DB(wakeup.magic = TIMER_MAGIC_INACTIVE;)
+	timer_setSignal(&wakeup, proc_current(), DEADLINE);
 	while (1)
 	{
 		bool empty;
+		ticks_t delay = 0;
+
 		RTASK_ATOMIC(
-			empty = LIST_EMPTY(&rt_list);
 			sig_check(NEW_TASK);
+			rtask_dispatch();
+			empty = LIST_EMPTY(&rt_list);
+			if (!empty)
+				delay = ((Timer *)LIST_HEAD(&rt_list))->tick - timer_clock();
 		);
 		if (empty)
 			sig_wait(NEW_TASK);
+		else if (delay > 0)
+		{
+			cpu_flags_t flags;
+
+			/* Wake up exactly at the deadline, or earlier for a new task */
+			ATOMIC(
+				timer_setDelay(&wakeup, ((Timer *)LIST_HEAD(&rt_list))->tick - timer_clock());
+				timer_add(&wakeup);
+			);
+			sig_wait(NEW_TASK | DEADLINE);
 
-		ticks_t delay;
-		RTASK_ATOMIC(delay = synctimer_nextTimeout(&rt_list));
-		timer_delayTicks(delay);
-		RTASK_ATOMIC(synctimer_poll(&rt_list));
+			/*
+			 * DEADLINE is shared with other modules, ask the timer
+			 * itself whether it has expired. The tick interrupt
+			 * removes it as soon as the clock reaches its tick.
+			 */
+			IRQ_SAVE_DISABLE(flags);
+			if (timer_clock_unlocked() - wakeup.tick < 0)
+				timer_abort(&wakeup);
+			IRQ_RESTORE(flags);
+		}
 	}
 }
 
-static void rtask_trampoline(void *_rtask)
+/*
+ * Drop a worker from the idle ones. RUN_TASK is shared with other modules,
+ * so a worker may wake up while it is still listed there.
+ * Called with the semaphore held.
+ */
+static void rtask_unidle(Process *worker)
 {
-	// Access the pool and the list freely since this callback is called
-	// with the semaphore held in rtask_proc.
-	RTask *rtask = _rtask;
-	if (rtask->callback(rtask->user_data))
-		synctimer_readd(&rtask->t, &rt_list);
-	else
-		pool_free(&rtask_pool, rtask);
+	for (int i = 0; i < idle_count; i++)
+		if (idle_workers[i] == worker)
+		{
+			idle_workers[i] = idle_workers[--idle_count];
+			break;
+		}
+}
+
+static NORETURN void rtask_worker(void)
+{
+	while (1)
+	{
+		RTask *rt = NULL;
+
+		RTASK_ATOMIC(
+			rtask_unidle(proc_current());
+			if (LIST_EMPTY(&ready_list))
+			{
+				ASSERT(idle_count < CONFIG_RTASK_WORKERS);
+				idle_workers[idle_count++] = proc_current();
+			}
+			else
+				rt = containerof(list_remHead(&ready_list), RTask, ready.link);
+		);
+		if (!rt)
+		{
+			sig_wait(RUN_TASK);
+			continue;
+		}
+
+		proc_setPri(proc_current(), rt->ready.pri);
+
+		ticks_t start = timer_clock();
+		bool again = rt->callback(rt->user_data);
+		ticks_t runtime = timer_clock() - start;
+
+		RTASK_ATOMIC(
+			rt->stats.runs++;
+			rt->stats.max_lateness = MAX(rt->stats.max_lateness, start - rt->due);
+			rt->stats.max_runtime = MAX(rt->stats.max_runtime, runtime);
+			rt->busy = false;
+			if (!again)
+			{
+				synctimer_abort(&rt->t);
+				pool_free(&rtask_pool, rt);
+			}
+		);
+	}
 }
 
 RTask *rtask_add(rtask_cb_t cb, mtime_t delay, void *cb_data)
@@ -124,6 +258,8 @@ RTask *rtask_add(rtask_cb_t cb, mtime_t delay, void *cb_data)
 	// than rtask_proc, so each access to rtask_pool and rt_list
 	// must be protected with a semaphore.
 
+	ASSERT(ms_to_ticks(delay) > 0);
+
 	// The semaphore is not yet initialized, disable preemption
 	// altogether.
 	proc_forbid();
@@ -132,10 +268,18 @@ RTask *rtask_add(rtask_cb_t cb, mtime_t delay, void *cb_data)
 		MOD_CHECK(proc);
 
 		LIST_INIT(&rt_list);
+		LIST_INIT(&ready_list);
 		pool_init(rtask_pool, NULL);
 		sem_init(&rtask_sem);
-		process = PROC_NEW();
+		process = PROC_NEW(rtask_proc, 0);
 		ASSERT(process);
+		proc_setPri(process, CONFIG_RTASK_PRI);
+		for (int i = 0; i < CONFIG_RTASK_WORKERS; i++)
+		{
+			Process *worker = PROC_NEW(rtask_worker, i + 1);
+			ASSERT(worker);
+			(void)worker;
+		}
 	}
 	proc_permit();
 
@@ -143,9 +287,9 @@ RTask *rtask_add(rtask_cb_t cb, mtime_t delay, void *cb_data)
 	RTASK_ATOMIC(rt = (RTask *)pool_alloc(&rtask_pool));
 	if (rt)
 	{
+		memset(rt, 0, sizeof(*rt));
 		rt->callback = cb;
 		rt->user_data = cb_data;
-		timer_setSoftint(&rt->t, rtask_trampoline, rt);
 		timer_setDelay(&rt->t, ms_to_ticks(delay));
 		RTASK_ATOMIC(synctimer_add(&rt->t, &rt_list));
 		sig_send(process, NEW_TASK);
@@ -154,3 +298,15 @@ RTask *rtask_add(rtask_cb_t cb, mtime_t delay, void *cb_data)
 		LOG_ERR("Failed to allocate RTask\n");
 	return rt;
 }
+
+void rtask_setPri(RTask *rt, int pri)
+{
+	RTASK_ATOMIC(rt->ready.pri = pri);
+}
+
+void rtask_stats(RTask *rt, RTaskStats *stats)
+{
+	RTASK_ATOMIC(*stats = rt->stats);
+}
+
+#endif /* CONFIG_KERN && CONFIG_KERN_SIGNALS */
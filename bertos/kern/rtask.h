@@ -33,18 +33,27 @@
  * \brief Recurrent task module.
  *
  * This module is a convenient method to handle multiple recurrent low priority
- * tasks. It creates a process with the default priority and schedules all the
- * tasks internally.
+ * tasks. A dispatcher process keeps the tasks sorted by deadline and hands
+ * the expired ones to a pool of CONFIG_RTASK_WORKERS worker processes.
  * You can execute all the operations you want in each callback, since they
  * are executed in a different thread from the caller.
  *
  * Your callback may return true if you want the task to be scheduled
  * again, or false if you want the task to end.
  *
+ * Each deadline is computed from the previous one, never from the time
+ * the callback actually ran, so the tasks do not drift. When a task is
+ * still running (or waiting for a worker) at its next deadline, that
+ * activation is skipped and counted as an overrun, see rtask_stats().
+ * With CONFIG_KERN_PRI, the tasks waiting for a worker are served by
+ * priority, and each callback runs at the priority of its task.
+ *
  * Interval time for each task should be fairly high (>20 ms) to avoid
  * blocking the whole CPU on this low priority job.
  *
  * \note rtask_add() may block.
+ * \note The dispatcher waits for SIG_SYSTEM5 and SIG_SYSTEM6, the workers wait
+ *       for SIG_SYSTEM5 only between two callbacks, see kern/signal.h.
  *
  * \author Luca Ottaviano <lottaviano@develer.com>
  * \author Francesco Sacchi <batt@develer.com>
@@ -60,8 +69,36 @@ struct RTask;
 typedef bool (*rtask_cb_t)(void *user_data);
 typedef struct RTask RTask;
 
+/**
+ * Run statistics of a task.
+ */
+typedef struct RTaskStats
+{
+	uint32_t runs;        ///< Callback runs.
+	uint32_t overruns;    ///< Activations skipped because the task was late.
+	ticks_t max_lateness; ///< Longest delay from a deadline to the callback start [ticks].
+	ticks_t max_runtime;  ///< Longest callback run [ticks].
+} RTaskStats;
+
+/**
+ * Run \a cb every \a interval ms, starting \a interval ms from now.
+ *
+ * \return The new task, or NULL if the pool is exhausted.
+ */
 struct RTask *rtask_add(rtask_cb_t cb, mtime_t interval, void *cb_data);
 
+/**
+ * Set the priority of \a rt, 0 by default.
+ */
+void rtask_setPri(struct RTask *rt, int pri);
+
+/**
+ * Copy the statistics of \a rt in \a stats.
+ *
+ * \note \a rt is released as soon as its callback returns false.
+ */
+void rtask_stats(struct RTask *rt, RTaskStats *stats);
+
 /* Test functions */
 int rtask_testRun(void);
 int rtask_testSetup(void);
@@ -40,15 +40,24 @@
  * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
  * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
  * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_rtask.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_RTASK_POOL_SIZE" >> $cfgdir/cfg_rtask.h
+ * $test$: echo "#define CONFIG_RTASK_POOL_SIZE 64" >> $cfgdir/cfg_rtask.h
+ * $test$: echo  "#undef CONFIG_RTASK_WORKERS" >> $cfgdir/cfg_rtask.h
+ * $test$: echo "#define CONFIG_RTASK_WORKERS 4" >> $cfgdir/cfg_rtask.h
  *
+ * notest: avr
+ * notest: arm
  */
 
 #include <cfg/test.h>
+#include <cfg/macros.h>
 
 #include <drv/timer.h>
 
 #include <kern/rtask.h>
 #include <kern/proc.h>
+#include <kern/signal.h>
 
 static int count = 0;
 static bool test1(void *data)
@@ -57,18 +66,149 @@ static bool test1(void *data)
 	return true;
 }
 
+/*
+ * A callback leaving a system signal pending, like a module sharing it
+ * with the workers: its worker wakes up once more while idle.
+ */
+#define STRAY_RUNS  20
+static int stray_count;
+
+static bool stray_task(UNUSED_ARG(void *, data))
+{
+	sig_send(proc_current(), SIG_SYSTEM5);
+	return ++stray_count < STRAY_RUNS;
+}
+
+static int rtask_stray(void)
+{
+	stray_count = 0;
+	ASSERT(rtask_add(stray_task, 10, NULL));
+	timer_delay(10 * STRAY_RUNS * 2);
+	kprintf("Stray wakeups: %d runs\n", stray_count);
+	return stray_count == STRAY_RUNS ? 0 : -1;
+}
+
+/*
+ * Jitter benchmark: many periodic tasks, plus a slow one sleeping in its
+ * callback. Each run is compared with the ideal time of its period,
+ * counted from the first run, so any drift shows up as a growing error.
+ *
+ * The emulator timer interrupt may lag behind the wall clock, so the times
+ * are taken with timer_clock(), the clock the deadlines are based on.
+ */
+#define BENCH_TASKS   50
+#define BENCH_MS      2000
+#define SLOW_PERIOD   200
+#define SLOW_SLEEP    100
+
+typedef struct Bench
+{
+	RTask *rt;
+	mtime_t period;
+	ticks_t first;       /* First run */
+	uint32_t runs;
+	ticks_t max_error;   /* Worst distance from the ideal time */
+	uint32_t sum_error;
+} Bench;
+
+static Bench bench[BENCH_TASKS];
+static volatile bool bench_stop;
+
+static bool bench_task(void *data)
+{
+	Bench *b = data;
+	ticks_t now = timer_clock();
+
+	if (!b->runs)
+		b->first = now;
+	else
+	{
+		ticks_t error = now - b->first - (ticks_t)b->runs * ms_to_ticks(b->period);
+
+		error = ABS(error);
+		b->max_error = MAX(b->max_error, error);
+		b->sum_error += error;
+	}
+	b->runs++;
+	return !bench_stop;
+}
+
+static bool slow_task(UNUSED_ARG(void *, data))
+{
+	timer_delay(SLOW_SLEEP);
+	return !bench_stop;
+}
+
+static int rtask_bench(void)
+{
+	RTaskStats st;
+	RTask *slow;
+	uint32_t runs = 0, sum_error = 0;
+	ticks_t max_error = 0, max_lateness = 0;
+	int ret = 0;
+
+	slow = rtask_add(slow_task, SLOW_PERIOD, NULL);
+	for (int i = 0; i < BENCH_TASKS; i++)
+	{
+		bench[i].period = 10 + i;
+		bench[i].rt = rtask_add(bench_task, bench[i].period, &bench[i]);
+		ASSERT(bench[i].rt);
+	}
+	timer_delay(BENCH_MS);
+
+	for (int i = 0; i < BENCH_TASKS; i++)
+	{
+		rtask_stats(bench[i].rt, &st);
+		if (st.overruns || bench[i].runs + 2 < BENCH_MS / (uint32_t)bench[i].period)
+		{
+			kprintf("Task %d: %lu runs, %lu overruns\n", i,
+				(unsigned long)bench[i].runs, (unsigned long)st.overruns);
+			ret = -1;
+		}
+		max_error = MAX(max_error, bench[i].max_error);
+		sum_error += bench[i].sum_error;
+		runs += bench[i].runs - 1;
+		max_lateness = MAX(max_lateness, st.max_lateness);
+	}
+	rtask_stats(slow, &st);
+	bench_stop = true;
+
+	kprintf("%d tasks, %lu runs: jitter avg %lu us, max %lu us, max lateness %lu us\n",
+		BENCH_TASKS, (unsigned long)runs,
+		(unsigned long)(ticks_to_us(sum_error) / MAX(runs, (uint32_t)1)),
+		(unsigned long)ticks_to_us(max_error), (unsigned long)ticks_to_us(max_lateness));
+	kprintf("Slow task: %lu runs, %lu overruns, max runtime %ld ticks\n",
+		(unsigned long)st.runs, (unsigned long)st.overruns, (long)st.max_runtime);
+
+	/* No drift: every run within a couple of ticks of its ideal time */
+	if (max_error > 2 || st.overruns || st.runs + 1 < BENCH_MS / SLOW_PERIOD)
+		ret = -1;
+
+	/* Let the tasks see bench_stop */
+	timer_delay(SLOW_PERIOD * 2);
+	return ret;
+}
+
 /**
  * Run rtask test
  */
 int rtask_testRun(void)
 {
+	int expected = (5000/50) + (5000/100) * 2 + (5000/200) * 4;
+
 	kprintf("Add task..\n");
 	ASSERT(rtask_add(test1, 50, (void *)1));
 	ASSERT(rtask_add(test1, 100, (void *)2));
 	ASSERT(rtask_add(test1, 200, (void *)4));
 	timer_delay(5000);
 	kprintf("count: %d\n", count);
-	return (count == ((5000/50) + (5000/100) *2 + (5000/200) * 4));
+	/* The last runs may happen just before or just after the check */
+	if (ABS(count - expected) > 1 + 2 + 4)
+		return -1;
+
+	if (rtask_stray())
+		return -1;
+	return rtask_bench();
 }
 
 int rtask_testSetup(void)
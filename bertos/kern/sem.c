@@ -43,6 +43,7 @@
 #include <kern/proc.h>
 #include <kern/proc_p.h>
 #include <kern/signal.h>
+#include <kern/trace.h>
 
 INLINE void sem_verify(struct Semaphore *s)
 {
@@ -166,6 +167,80 @@ INLINE void pri_inheritUnblock(UNUSED_ARG(Semaphore *, s), UNUSED_ARG(Process *,
 }
 #endif /* CONFIG_KERN_PRI_INHERIT */
 
+#if CONFIG_KERN_PRI_CEILING
+
+/**
+ * Priority ceiling lock.
+ *
+ * Push \a s on the stack of the ceiling semaphores held by \a proc, its
+ * new owner, and raise the priority of \a proc to the ceiling.
+ * The owner is either the current process or a process leaving the wait
+ * queue, so it is not in the ready list and the update is O(1).
+ */
+INLINE void pri_ceilingLock(Semaphore *s, Process *proc)
+{
+	if (s->ceiling == INT_MIN)
+		return;
+
+	s->ceil_held = MAX(s->ceiling, __prio_ceil(proc));
+	s->ceil_prev = proc->ceil_top;
+	proc->ceil_top = s;
+	proc->link.pri = __prio_proc(proc);
+}
+
+/**
+ * Priority ceiling unlock.
+ *
+ * Pop \a s from the stack of the current process and go back to the
+ * priority it had before locking it.
+ *
+ * \return true if \a s has a ceiling.
+ */
+INLINE bool pri_ceilingUnlock(Semaphore *s)
+{
+	if (s->ceiling == INT_MIN)
+		return false;
+
+	/* Ceiling semaphores must be released in reverse locking order */
+	ASSERT(current_process->ceil_top == s);
+	current_process->ceil_top = s->ceil_prev;
+	current_process->link.pri = __prio_proc(current_process);
+	return true;
+}
+
+/**
+ * Leave the CPU to the processes that became ready while the current
+ * one was running at the ceiling priority.
+ */
+INLINE void pri_ceilingYield(void)
+{
+	bool yield;
+
+	ATOMIC(yield = prio_next() > prio_curr());
+	if (yield)
+		proc_yield();
+}
+
+void sem_initCeiling(struct Semaphore *s, int ceiling)
+{
+	sem_init(s);
+	s->ceiling = ceiling;
+}
+#else
+INLINE void pri_ceilingLock(UNUSED_ARG(Semaphore *, s), UNUSED_ARG(Process *, proc))
+{
+}
+
+INLINE bool pri_ceilingUnlock(UNUSED_ARG(Semaphore *, s))
+{
+	return false;
+}
+
+INLINE void pri_ceilingYield(void)
+{
+}
+#endif /* CONFIG_KERN_PRI_CEILING */
+
 
 /**
  * \brief Initialize a Semaphore structure.
@@ -175,6 +250,9 @@ void sem_init(struct Semaphore *s)
 	LIST_INIT(&s->wait_queue);
 	s->owner = NULL;
 	s->nest_count = 0;
+#if CONFIG_KERN_PRI_CEILING
+	s->ceiling = INT_MIN;
+#endif
 }
 
 
@@ -198,7 +276,8 @@ bool sem_attempt(struct Semaphore *s)
 	if ((!s->owner) || (s->owner == current_process))
 	{
 		s->owner = current_process;
-		s->nest_count++;
+		if (s->nest_count++ == 0)
+			pri_ceilingLock(s, current_process);
 		result = true;
 	}
 	proc_permit();
@@ -234,6 +313,7 @@ void sem_obtain(struct Semaphore *s)
 	{
 		/* Append calling process to the wait queue */
 		ADDTAIL(&s->wait_queue, (Node *)current_process);
+		trace_event(TRACE_SEM_BLOCK, (uintptr_t)s);
 
 		/* Trigger priority inheritance logic, if enabled */
 		pri_inheritBlock(s);
@@ -252,7 +332,8 @@ void sem_obtain(struct Semaphore *s)
 
 		/* The semaphore was free: lock it */
 		s->owner = current_process;
-		s->nest_count++;
+		if (s->nest_count++ == 0)
+			pri_ceilingLock(s, current_process);
 		proc_permit();
 	}
 }
@@ -274,6 +355,7 @@ void sem_obtain(struct Semaphore *s)
 void sem_release(struct Semaphore *s)
 {
 	Process *proc = NULL;
+	bool ceiling = false;
 
 	proc_forbid();
 	sem_verify(s);
@@ -286,6 +368,11 @@ void sem_release(struct Semaphore *s)
 	 */
 	if (--s->nest_count == 0)
 	{
+		trace_event(TRACE_SEM_RELEASE, (uintptr_t)s);
+
+		/* Drop the priority ceiling, if any */
+		ceiling = pri_ceilingUnlock(s);
+
 		/* Give semaphore to the first applicant, if any */
 		if (UNLIKELY((proc = (Process *)list_remHead(&s->wait_queue))))
 		{
@@ -294,6 +381,7 @@ void sem_release(struct Semaphore *s)
 
 			s->nest_count = 1;
 			s->owner = proc;
+			pri_ceilingLock(s, proc);
 		} else {
 			/* Disown semaphore */
 			s->owner = NULL;
@@ -303,4 +391,6 @@ void sem_release(struct Semaphore *s)
 
 	if (proc)
 		ATOMIC(proc_wakeup(proc));
+	if (UNLIKELY(ceiling))
+		pri_ceilingYield();
 }
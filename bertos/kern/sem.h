@@ -37,6 +37,21 @@
  * \brief Mutually exclusive semaphores.
  *        Shared locking not supported in this implementation.
  *
+ * With CONFIG_KERN_PRI_CEILING a semaphore can be given a priority
+ * ceiling with sem_initCeiling() (immediate priority-ceiling protocol):
+ * the process that locks it runs at the ceiling priority until it
+ * releases it, so none of the other users of the semaphore can run
+ * and find it locked. Locking and unlocking take constant time and
+ * processes can lock several ceiling semaphores in any order without
+ * deadlocks, as long as:
+ *  - the ceiling is higher than the priority of every user of the
+ *    semaphore;
+ *  - nested semaphores are released in the reverse order they were
+ *    locked.
+ *
+ * Processes blocked on a semaphore still wait in its queue, as it
+ * happens if a user has a priority above the ceiling.
+ *
  *
  * \author Bernie Innocenti <bernie@codewiz.org>
  *
@@ -49,6 +64,8 @@
 #ifndef KERN_SEM_H
 #define KERN_SEM_H
 
+#include "cfg/cfg_proc.h"
+
 #include <cfg/compiler.h>
 #include <struct/list.h>
 
@@ -61,6 +78,11 @@ typedef struct Semaphore
 	struct Process *owner;
 	List            wait_queue;
 	int             nest_count;
+#if CONFIG_KERN_PRI_CEILING
+	int             ceiling;    ///< Priority ceiling, INT_MIN for none.
+	int             ceil_held;  ///< Ceiling of the owner while holding it.
+	struct Semaphore *ceil_prev;  ///< Ceiling semaphore locked before this one.
+#endif
 } Semaphore;
 
 /**
@@ -71,6 +93,18 @@ void sem_init(struct Semaphore *s);
 bool sem_attempt(struct Semaphore *s);
 void sem_obtain(struct Semaphore *s);
 void sem_release(struct Semaphore *s);
+
+#if CONFIG_KERN_PRI_CEILING
+	/**
+	 * Initialize a semaphore with the priority \a ceiling.
+	 *
+	 * The ceiling must be higher than the priority of all the
+	 * processes using the semaphore.
+	 */
+	void sem_initCeiling(struct Semaphore *s, int ceiling);
+#else
+	#define sem_initCeiling(s, ceiling)  ((void)(ceiling), sem_init(s))
+#endif
 /* \} */
 /* \} */ //defgroup kern_sem
 
@@ -48,6 +48,15 @@
  * Notice that priority inheritance makes sense iff priorities
  * exist, so the whole test depends on CONFIG_KERN_PRI.
  *
+ * The priority ceiling benchmark runs processes of many priorities
+ * locking one or two nested semaphores, first with priority inheritance
+ * and then with a priority ceiling. With inheritance the highest priority
+ * process may wait for two critical sections, with the ceiling for one
+ * at most; for this process the worst time taken to lock and unlock the
+ * semaphores and the worst response time, from its wake up to the end of
+ * its critical section, are logged. With the ceiling some processes lock
+ * the semaphores in the reverse order: this must not deadlock.
+ *
  * \author Daniele Basile <asterix@develer.com>
  * \author Stefano Fedrigo <aleph@develer.com>
  * \author Dario Faggioli <raistlin@linux.it>
@@ -57,8 +66,15 @@
  * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
  * $test$: echo  "#undef CONFIG_KERN_PRI" >> $cfgdir/cfg_proc.h
  * $test$: echo "#define CONFIG_KERN_PRI 1" >> $cfgdir/cfg_proc.h
+ * $test$: echo  "#undef CONFIG_KERN_PREEMPT" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN_PREEMPT 1" >> $cfgdir/cfg_proc.h
  * $test$: echo  "#undef CONFIG_KERN_PRI_INHERIT" >> $cfgdir/cfg_proc.h
  * $test$: echo "#define CONFIG_KERN_PRI_INHERIT 1" >> $cfgdir/cfg_proc.h
+ * $test$: echo  "#undef CONFIG_KERN_PRI_CEILING" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN_PRI_CEILING 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
  * $test$: cp bertos/cfg/cfg_sem.h $cfgdir/
  * $test$: echo  "#undef CONFIG_KERN_SEMAPHORES" >> $cfgdir/cfg_sem.h
  * $test$: echo "#define CONFIG_KERN_SEMAPHORES 1" >> $cfgdir/cfg_sem.h
@@ -359,6 +375,175 @@ void sem_inv_test(void)
 
 #endif /* CONFIG_KERN_PRI */
 
+#if CONFIG_KERN_PRI_CEILING
+
+// Global settings for the priority ceiling benchmark.
+#define CEIL_PROCS   8
+#define CEIL_ROUNDS  50
+#define CEIL_PRI     (CEIL_PROCS + 1)
+#define CEIL_CS_US   500
+
+static PROC_DEFINE_STACK(ceil_stack[CEIL_PROCS], KERN_MINSTACKSIZE * 2);
+
+static Semaphore outer, inner;
+static bool ceil_mode;
+static int ceil_done, ceil_errors;
+/* Worst times and total response time of the highest priority process */
+static uint32_t lock_max, unlock_max, response_max;
+static uint64_t response_sum;
+
+static void ceil_account(int n, uint32_t *max, uint32_t start)
+{
+	uint32_t t = timer_hpclock() - start;
+
+	if (n == CEIL_PROCS - 1 && t > *max)
+		*max = t;
+	if (n == CEIL_PROCS - 1 && max == &response_max)
+		response_sum += t;
+}
+
+static void proc_semCeilTest(void)
+{
+	int n = (int)(ssize_t)proc_currentUserData();
+	Semaphore *locks[2];
+	int cnt = 2;
+	uint32_t wake, start;
+
+	/*
+	 * Mix processes locking one or both semaphores, so that the
+	 * highest priority one may find them held by two different
+	 * processes.
+	 */
+	switch (n % 3)
+	{
+	case 0:
+		locks[0] = &inner;
+		cnt = 1;
+		break;
+	case 1:
+		locks[0] = &outer;
+		locks[1] = &inner;
+		break;
+	default:
+		/* With the ceiling the nesting order does not matter */
+		if (ceil_mode)
+		{
+			locks[0] = &inner;
+			locks[1] = &outer;
+		}
+		else
+		{
+			locks[0] = &outer;
+			cnt = 1;
+		}
+		break;
+	}
+
+	for (int i = 0; i < CEIL_ROUNDS; i++)
+	{
+		/* Wake up together with some of the others */
+		timer_delayTicks(1 + (n + i) % 3);
+
+		wake = timer_hpclock();
+		for (int j = 0; j < cnt; j++)
+			sem_obtain(locks[j]);
+		ceil_account(n, &lock_max, wake);
+
+		if (ceil_mode && proc_pri(proc_current()) != CEIL_PRI)
+			ceil_errors++;
+		start = timer_hpclock();
+		while (timer_hpclock() - start < us_to_hptime(CEIL_CS_US))
+			;
+
+		start = timer_hpclock();
+		for (int j = cnt - 1; j >= 0; j--)
+			sem_release(locks[j]);
+		ceil_account(n, &unlock_max, start);
+		ceil_account(n, &response_max, wake);
+
+		if (proc_pri(proc_current()) != n + 1)
+			ceil_errors++;
+	}
+
+	proc_forbid();
+	ceil_done++;
+	proc_permit();
+}
+
+static int sem_ceilRun(bool ceiling)
+{
+	int orig_pri = proc_pri(proc_current());
+	ticks_t start_time = timer_clock();
+
+	ceil_mode = ceiling;
+	ceil_done = 0;
+	lock_max = unlock_max = response_max = 0;
+	response_sum = 0;
+	if (ceiling)
+	{
+		sem_initCeiling(&outer, CEIL_PRI);
+		sem_initCeiling(&inner, CEIL_PRI);
+	}
+	else
+	{
+		sem_init(&outer);
+		sem_init(&inner);
+	}
+
+	proc_setPri(proc_current(), CEIL_PRI);
+	for (int i = 0; i < CEIL_PROCS; i++)
+	{
+		struct Process *p = proc_new(proc_semCeilTest, (iptr_t)(ssize_t)i,
+				sizeof(ceil_stack[i]), ceil_stack[i]);
+		proc_setPri(p, i + 1);
+	}
+	proc_setPri(proc_current(), orig_pri);
+
+	while (ceil_done < CEIL_PROCS)
+	{
+		if ((timer_clock() - start_time) > ms_to_ticks(TEST_TIME_OUT_MS))
+		{
+			kprintf("> Main: %s semaphores locked up\n", ceiling ? "Ceiling" : "Inheritance");
+			return -1;
+		}
+		timer_delay(10);
+	}
+
+	kprintf("> Main: %-11s worst lock %5lu us, unlock %5lu us, response %5lu us (avg %lu us)\n",
+		ceiling ? "ceiling" : "inheritance",
+		(unsigned long)hptime_to_us(lock_max),
+		(unsigned long)hptime_to_us(unlock_max),
+		(unsigned long)hptime_to_us(response_max),
+		(unsigned long)hptime_to_us(response_sum / CEIL_ROUNDS));
+	return 0;
+}
+
+static int sem_ceil_test(void)
+{
+	kputs("> Main: Run Priority Ceiling benchmark...\n");
+	ceil_errors = 0;
+
+	if (sem_ceilRun(false) || sem_ceilRun(true))
+		return -1;
+
+	if (ceil_errors)
+	{
+		kprintf("> Main: %d wrong priorities with the ceiling\n", ceil_errors);
+		return -1;
+	}
+	kputs("> Main: Test Finished..Ok!\n");
+	return 0;
+}
+
+#else
+
+static int sem_ceil_test(void)
+{
+	return 0;
+}
+
+#endif /* CONFIG_KERN_PRI_CEILING */
+
 /**
  * Run semaphore test
  */
@@ -368,7 +553,7 @@ int sem_testRun(void)
 	sem_ser_test();		// Serialization
 	sem_inv_test();		// Priority Inversion
 
-	return 0;
+	return sem_ceil_test();	// Priority ceiling
 }
 
 int sem_testSetup(void)
@@ -134,6 +134,7 @@
 #include <cpu/irq.h>
 #include <kern/proc.h>
 #include <kern/proc_p.h>
+#include <kern/trace.h>
 
 
 #if CONFIG_KERN_SIGNALS
@@ -240,7 +241,10 @@ INLINE void __sig_signal(Signal *s, Process *proc, sigmask_t sigs, bool wakeup)
 		if (wakeup)
 			proc_wakeup(proc);
 		else
+		{
+			trace_event(TRACE_WAKEUP, (uintptr_t)proc);
 			SCHED_ENQUEUE_HEAD(proc);
+		}
 	}
 	IRQ_RESTORE(flags);
 }
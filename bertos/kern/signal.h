@@ -171,6 +171,19 @@ int signal_testTearDown(void);
 
 /**
  * \name Signal definitions
+ *
+ * SIG_SYSTEM5 and SIG_SYSTEM6 are shared by several modules, so a process
+ * may receive them from a module it is not waiting for. Every module checks
+ * its own state again after waking up, and waits again if there is nothing
+ * to do: a stray signal only costs a spurious wakeup. New users must do the
+ * same. Most modules use the signal only in their own processes, but some
+ * wait for it in the process of the caller:
+ *  - SIG_SYSTEM5: syslog sender, protothread run loop, recurrent task
+ *    dispatcher and workers, HTTP workers and the process calling
+ *    http_poll() with workers;
+ *  - SIG_SYSTEM6: recurrent task dispatcher, generic events
+ *    (event_initGeneric()) and lwIP mailboxes, the latter two in the
+ *    waiting process.
  * \{
  */
 #define SIG_USER0    BV(0)  /**< Free for user usage */
@@ -0,0 +1,188 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Binary kernel event tracer.
+ *
+ * There is a single CPU, so the writers are the processes and the
+ * interrupt handlers preempting them. Nothing ever waits for a lock: on
+ * CPUs with an atomic add a slot is reserved with it, otherwise with
+ * interrupts disabled for a handful of instructions. In the first case
+ * an interrupt can record its events between the reservation and the
+ * timestamp of the event it preempted, so events of interrupt handlers
+ * may appear slightly out of order; trace_decode.py sorts them.
+ */
+
+#include "trace.h"
+
+#if CONFIG_KERN_TRACE
+
+#include "proc_p.h"
+#include "cfg/cfg_monitor.h"
+
+#include <cfg/debug.h>
+#include <cfg/macros.h>
+
+#include <cpu/irq.h>
+
+#include <stddef.h> // offsetof
+#include <string.h>
+
+STATIC_ASSERT(IS_POW2(CONFIG_KERN_TRACE_SIZE));
+
+static TraceEvent trace_ring[CONFIG_KERN_TRACE_SIZE];
+/* Events recorded since trace_start(), the ring index is taken modulo the size */
+static uint32_t trace_head;
+static volatile bool trace_on;
+
+INLINE hptime_t trace_now(void)
+{
+#if OS_HOSTED
+	return hptime_get();
+#else
+	return (hptime_t)_clock * TIMER_HW_CNT + timer_hw_hpread();
+#endif
+}
+
+void trace_event(uint8_t type, uintptr_t arg)
+{
+	TraceEvent *ev;
+
+	if (!trace_on)
+		return;
+
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+	ev = &trace_ring[__sync_fetch_and_add(&trace_head, 1) & (CONFIG_KERN_TRACE_SIZE - 1)];
+	ev->time = trace_now();
+#else
+	cpu_flags_t flags;
+
+	IRQ_SAVE_DISABLE(flags);
+	ev = &trace_ring[trace_head++ & (CONFIG_KERN_TRACE_SIZE - 1)];
+	ev->time = trace_now();
+	IRQ_RESTORE(flags);
+#endif
+
+	ev->arg = arg;
+	ev->type = type;
+}
+
+void trace_start(void)
+{
+	trace_on = false;
+	trace_head = 0;
+	trace_on = true;
+}
+
+void trace_stop(void)
+{
+	trace_on = false;
+}
+
+#if CONFIG_KERN_MONITOR
+
+typedef struct TraceNames
+{
+	KFile *fd;
+	uint16_t cnt;
+	bool ok;
+} TraceNames;
+
+static void trace_countName(UNUSED_ARG(struct Process *, proc), UNUSED_ARG(const char *, name), void *data)
+{
+	((TraceNames *)data)->cnt++;
+}
+
+static void trace_writeName(struct Process *proc, const char *name, void *data)
+{
+	TraceNames *names = (TraceNames *)data;
+	uintptr_t addr = (uintptr_t)proc;
+	size_t len = strlen(name) + 1;
+
+	if (kfile_write(names->fd, &addr, sizeof(addr)) != sizeof(addr)
+			|| kfile_write(names->fd, name, len) != len)
+		names->ok = false;
+}
+
+#endif /* CONFIG_KERN_MONITOR */
+
+int trace_dump(KFile *fd)
+{
+	bool on = trace_on;
+	TraceHeader hdr;
+	uint32_t first;
+	size_t len;
+	bool ok;
+
+	/* Events recorded meanwhile would overwrite the oldest ones */
+	trace_on = false;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = TRACE_MAGIC;
+	hdr.ticks_per_sec = TIMER_HW_HPTICKS_PER_SEC;
+	hdr.events = MIN(trace_head, (uint32_t)CONFIG_KERN_TRACE_SIZE);
+	hdr.lost = trace_head - hdr.events;
+	hdr.version = TRACE_VERSION;
+	hdr.header_size = sizeof(TraceHeader);
+	hdr.event_size = sizeof(TraceEvent);
+	hdr.time_size = sizeof(hptime_t);
+	hdr.arg_size = sizeof(uintptr_t);
+	hdr.arg_offset = offsetof(TraceEvent, arg);
+	hdr.type_offset = offsetof(TraceEvent, type);
+
+#if CONFIG_KERN_MONITOR
+	TraceNames names = { fd, 0, true };
+	monitor_foreach(trace_countName, &names);
+	hdr.procs = names.cnt;
+#endif
+
+	ok = kfile_write(fd, &hdr, sizeof(hdr)) == sizeof(hdr);
+
+	/* The oldest events are at the head of the ring, if it wrapped */
+	first = hdr.lost & (CONFIG_KERN_TRACE_SIZE - 1);
+	len = MIN((size_t)hdr.events, (size_t)(CONFIG_KERN_TRACE_SIZE - first)) * sizeof(TraceEvent);
+	ok = ok && kfile_write(fd, &trace_ring[first], len) == len;
+	len = hdr.events * sizeof(TraceEvent) - len;
+	ok = ok && kfile_write(fd, trace_ring, len) == len;
+
+#if CONFIG_KERN_MONITOR
+	if (ok)
+	{
+		monitor_foreach(trace_writeName, &names);
+		ok = names.ok;
+	}
+#endif
+
+	trace_on = on;
+	return ok ? 0 : EOF;
+}
+
+#endif /* CONFIG_KERN_TRACE */
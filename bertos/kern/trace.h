@@ -0,0 +1,164 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Binary kernel event tracer.
+ *
+ * When CONFIG_KERN_TRACE is enabled, the kernel records its scheduling
+ * events in a ring buffer of CONFIG_KERN_TRACE_SIZE entries: context
+ * switches, wakeups, semaphores blocking and released, expired timers and
+ * interrupts. An event is just a timestamp, a type and the address of the
+ * object involved, so recording it costs a few stores instead of the
+ * milliseconds of a kprintf().
+ *
+ * The ring keeps the most recent events. Stop the recording, dump it to
+ * any KFile and decode it on the host with bertos/kern/trace_decode.py,
+ * either as a text timeline or in the Chrome trace format:
+ * \code
+ * trace_start();
+ * // ...reproduce the problem...
+ * trace_stop();
+ * trace_dump(&ser.fd);
+ * \endcode
+ *
+ * Interrupt handlers can be traced with trace_event(TRACE_IRQ_ENTER, id)
+ * and trace_event(TRACE_IRQ_EXIT, id): the system timer uses
+ * TRACE_IRQ_TIMER. With CONFIG_KERN_MONITOR enabled the dump also holds
+ * the names of the processes.
+ *
+ * $WIZ$ module_name = "trace"
+ * $WIZ$ module_depends = "kernel", "timer", "kfile"
+ * $WIZ$ module_configuration = "bertos/cfg/cfg_trace.h"
+ */
+
+#ifndef KERN_TRACE_H
+#define KERN_TRACE_H
+
+#include "cfg/cfg_trace.h"
+
+#include <cfg/compiler.h>
+
+#include <drv/timer.h> // hptime_t
+
+#include <io/kfile.h>
+
+/**
+ * Event types.
+ */
+typedef enum TraceType
+{
+	TRACE_SWITCH = 1,  ///< Context switch to the process in the argument.
+	TRACE_WAKEUP,      ///< Process woken up.
+	TRACE_SEM_BLOCK,   ///< Current process blocked on a semaphore.
+	TRACE_SEM_RELEASE, ///< Semaphore released.
+	TRACE_TIMER,       ///< Timer expired.
+	TRACE_IRQ_ENTER,   ///< Interrupt handler started, the argument is the IRQ id.
+	TRACE_IRQ_EXIT,    ///< Interrupt handler finished.
+	TRACE_USER,        ///< Application defined event.
+} TraceType;
+
+/// IRQ id of the system timer.
+#define TRACE_IRQ_TIMER  0
+
+/// First word of a dump, "BTRC" in the byte order of the target.
+#define TRACE_MAGIC      0x43525442UL
+#define TRACE_VERSION    1
+
+/**
+ * Recorded event, written as is by trace_dump().
+ */
+typedef struct TraceEvent
+{
+	hptime_t time;  ///< Timestamp, in TIMER_HW_HPTICKS_PER_SEC units.
+	uintptr_t arg;  ///< Process, semaphore, timer or IRQ id.
+	uint8_t type;   ///< One of TraceType.
+} TraceEvent;
+
+/**
+ * Header of a dump.
+ *
+ * It is followed by \a events TraceEvent structures, oldest first, then by
+ * \a procs process records: the address of the process (\a arg_size
+ * bytes) and its name, terminated by a NUL.
+ */
+typedef struct TraceHeader
+{
+	uint32_t magic;         ///< TRACE_MAGIC.
+	uint32_t ticks_per_sec; ///< Timestamp resolution.
+	uint32_t lost;          ///< Events overwritten before the dump.
+	uint16_t events;        ///< Events in the dump.
+	uint16_t procs;         ///< Process names in the dump.
+	uint8_t version;        ///< TRACE_VERSION.
+	uint8_t header_size;    ///< sizeof(TraceHeader).
+	uint8_t event_size;     ///< sizeof(TraceEvent).
+	uint8_t time_size;      ///< sizeof(hptime_t).
+	uint8_t arg_size;       ///< sizeof(uintptr_t).
+	uint8_t arg_offset;     ///< Offset of the argument in TraceEvent.
+	uint8_t type_offset;    ///< Offset of the type in TraceEvent.
+} TraceHeader;
+
+#if CONFIG_KERN_TRACE
+
+/**
+ * Record an event, if the tracer is running.
+ *
+ * \note Interrupt safe.
+ */
+void trace_event(uint8_t type, uintptr_t arg);
+
+/**
+ * Empty the ring buffer and start recording.
+ */
+void trace_start(void);
+
+/**
+ * Stop recording, the events stay in the ring buffer.
+ */
+void trace_stop(void);
+
+/**
+ * Write the recorded events to \a fd, see TraceHeader for the format.
+ *
+ * Recording is suspended while dumping.
+ *
+ * \return 0 if successful, EOF on write errors.
+ */
+int trace_dump(KFile *fd);
+
+#else /* !CONFIG_KERN_TRACE */
+
+INLINE void trace_event(UNUSED_ARG(uint8_t, type), UNUSED_ARG(uintptr_t, arg))
+{
+}
+
+#endif /* CONFIG_KERN_TRACE */
+
+#endif /* KERN_TRACE_H */
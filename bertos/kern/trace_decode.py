@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+#
+# This file is part of BeRTOS.
+#
+# Bertos is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+#
+# Decode a kernel trace written by trace_dump() (see kern/trace.h).
+#
+# By default the events are printed as a timeline, with times relative
+# to the first event. With --chrome the output is a JSON file for the
+# Chrome trace viewer (chrome://tracing) or Perfetto: every process is a
+# track showing when it was running, interrupts have a track of their own.
+#
+# Usage: trace_decode.py [--chrome] DUMP > OUTPUT
+#
+
+import argparse
+import json
+import struct
+import sys
+
+TRACE_MAGIC = 0x43525442
+TRACE_VERSION = 1
+
+HEADER = "IIIHHBBBBBBB"
+
+EVENTS = {
+	1: "switch",
+	2: "wakeup",
+	3: "sem_block",
+	4: "sem_release",
+	5: "timer",
+	6: "irq_enter",
+	7: "irq_exit",
+	8: "user",
+}
+
+INT_FORMATS = {1: "B", 2: "H", 4: "I", 8: "Q"}
+
+def parse(data):
+	for order in "<>":
+		if struct.unpack_from(order + "I", data)[0] == TRACE_MAGIC:
+			break
+	else:
+		sys.exit("Not a trace dump")
+
+	fmt = order + HEADER
+	(magic, ticks, lost, nevents, nprocs, version, header_size, event_size,
+		time_size, arg_size, arg_offset, type_offset) = struct.unpack_from(fmt, data)
+	if version != TRACE_VERSION:
+		sys.exit("Unsupported trace version %d" % version)
+
+	time_fmt = order + INT_FORMATS[time_size]
+	arg_fmt = order + INT_FORMATS[arg_size]
+	pos = header_size
+
+	events = []
+	wrap = 1 << (8 * time_size)
+	base = 0
+	prev = None
+	for i in range(nevents):
+		ev = data[pos:pos + event_size]
+		if len(ev) < event_size:
+			sys.exit("Truncated dump")
+		t = struct.unpack_from(time_fmt, ev)[0]
+		# Narrow timestamps wrap around, events come (mostly) in time order
+		if prev is not None and t + base < prev - wrap // 2:
+			base += wrap
+		prev = t + base
+		events.append((prev, EVENTS.get(ev[type_offset], "type%d" % ev[type_offset]),
+			struct.unpack_from(arg_fmt, ev, arg_offset)[0]))
+		pos += event_size
+
+	names = {}
+	for i in range(nprocs):
+		if pos + arg_size > len(data):
+			break
+		addr = struct.unpack_from(arg_fmt, data, pos)[0]
+		end = data.find(b"\0", pos + arg_size)
+		if end < 0:
+			break
+		names[addr] = data[pos + arg_size:end].decode(errors="replace")
+		pos = end + 1
+
+	# Events preempted by an interrupt handler can follow its ones
+	events.sort(key=lambda ev: ev[0])
+	return ticks, lost, events, names
+
+def proc_name(names, addr):
+	return names.get(addr, "0x%x" % addr)
+
+def timeline(ticks, lost, events, names, out):
+	if lost:
+		out.write("# %d older events lost\n" % lost)
+	start = events[0][0] if events else 0
+	for t, kind, arg in events:
+		us = (t - start) * 1e6 / ticks
+		if kind in ("switch", "wakeup"):
+			obj = proc_name(names, arg)
+		elif kind in ("irq_enter", "irq_exit", "user"):
+			obj = "%d" % arg
+		else:
+			obj = "0x%x" % arg
+		out.write("%14.3f  %-12s %s\n" % (us, kind, obj))
+
+def chrome(ticks, lost, events, names, out):
+	trace = []
+	start = events[0][0] if events else 0
+	current = None
+	irqs = []
+
+	def us(t):
+		return (t - start) * 1e6 / ticks
+
+	for t, kind, arg in events:
+		if kind == "switch":
+			if current is not None:
+				trace.append({"name": "run", "ph": "E", "pid": 0, "tid": current, "ts": us(t)})
+			current = proc_name(names, arg)
+			trace.append({"name": "run", "ph": "B", "pid": 0, "tid": current, "ts": us(t)})
+		elif kind == "irq_enter":
+			irqs.append(arg)
+			trace.append({"name": "irq %d" % arg, "ph": "B", "pid": 0, "tid": "irq", "ts": us(t)})
+		elif kind == "irq_exit":
+			if irqs:
+				irqs.pop()
+				trace.append({"name": "irq %d" % arg, "ph": "E", "pid": 0, "tid": "irq", "ts": us(t)})
+		else:
+			obj = proc_name(names, arg) if kind == "wakeup" else "0x%x" % arg
+			trace.append({"name": "%s %s" % (kind, obj), "ph": "i", "s": "t", "pid": 0,
+				"tid": "irq" if irqs else (current or "kernel"), "ts": us(t)})
+	if current is not None and events:
+		trace.append({"name": "run", "ph": "E", "pid": 0, "tid": current, "ts": us(events[-1][0])})
+
+	json.dump({"traceEvents": trace, "displayTimeUnit": "ns",
+		"otherData": {"lost_events": lost}}, out, indent=0)
+	out.write("\n")
+
+def main():
+	parser = argparse.ArgumentParser(description="Decode a BeRTOS kernel trace.")
+	parser.add_argument("--chrome", action="store_true", help="write the Chrome trace format")
+	parser.add_argument("dump", help="file written by trace_dump()")
+	args = parser.parse_args()
+
+	with open(args.dump, "rb") as f:
+		ticks, lost, events, names = parse(f.read())
+	if args.chrome:
+		chrome(ticks, lost, events, names, sys.stdout)
+	else:
+		timeline(ticks, lost, events, names, sys.stdout)
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,250 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Kernel event tracer test.
+ *
+ * Two processes exchange signals while a third one blocks on a semaphore
+ * held by the main process; the dump must hold every kind of event, in
+ * time order, and the process names. Then the cost of a single event is
+ * measured.
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_sem.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SEMAPHORES" >> $cfgdir/cfg_sem.h
+ * $test$: echo "#define CONFIG_KERN_SEMAPHORES 1" >> $cfgdir/cfg_sem.h
+ * $test$: cp bertos/cfg/cfg_monitor.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_MONITOR" >> $cfgdir/cfg_monitor.h
+ * $test$: echo "#define CONFIG_KERN_MONITOR 1" >> $cfgdir/cfg_monitor.h
+ * $test$: cp bertos/cfg/cfg_trace.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_TRACE" >> $cfgdir/cfg_trace.h
+ * $test$: echo "#define CONFIG_KERN_TRACE 1" >> $cfgdir/cfg_trace.h
+ * $test$: echo  "#undef CONFIG_KERN_TRACE_SIZE" >> $cfgdir/cfg_trace.h
+ * $test$: echo "#define CONFIG_KERN_TRACE_SIZE 1024" >> $cfgdir/cfg_trace.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include "trace.h"
+
+#include <cfg/debug.h>
+#include <cfg/test.h>
+
+#include <kern/proc.h>
+#include <kern/sem.h>
+#include <kern/signal.h>
+
+#include <drv/timer.h>
+
+#include <struct/kfile_mem.h>
+
+#include <string.h>
+
+#define PINGS        20
+#define BENCH_EVENTS 100000L
+
+static struct Process *ping_proc, *pong_proc;
+static Semaphore sem;
+static volatile bool locked;
+
+static uint8_t dump[sizeof(TraceHeader) + CONFIG_KERN_TRACE_SIZE * sizeof(TraceEvent) + 256];
+
+static PROC_DEFINE_STACK(ping_stack, KERN_MINSTACKSIZE);
+static PROC_DEFINE_STACK(pong_stack, KERN_MINSTACKSIZE);
+static PROC_DEFINE_STACK(locker_stack, KERN_MINSTACKSIZE);
+
+/*
+ * Exited processes leave the monitor, keep them around to find their
+ * names in the dump.
+ */
+static void park(void)
+{
+	for (;;)
+		sig_wait(SIG_USER2);
+}
+
+static void ping(void)
+{
+	for (int i = 0; i < PINGS; i++)
+	{
+		sig_send(pong_proc, SIG_USER0);
+		sig_wait(SIG_USER1);
+	}
+	park();
+}
+
+static void pong(void)
+{
+	for (int i = 0; i < PINGS; i++)
+	{
+		sig_wait(SIG_USER0);
+		sig_send(ping_proc, SIG_USER1);
+	}
+	park();
+}
+
+static void locker(void)
+{
+	sem_obtain(&sem);
+	locked = true;
+	sem_release(&sem);
+	park();
+}
+
+static bool hasName(const char *names, const char *end, const char *name)
+{
+	/* Process records: address, then the NUL terminated name */
+	while (names + sizeof(uintptr_t) < end)
+	{
+		names += sizeof(uintptr_t);
+		if (!strcmp(names, name))
+			return true;
+		names += strlen(names) + 1;
+	}
+	return false;
+}
+
+INLINE bool fromIrq(const TraceEvent *ev)
+{
+	return ev->type == TRACE_IRQ_ENTER || ev->type == TRACE_IRQ_EXIT || ev->type == TRACE_TIMER;
+}
+
+static int check_dump(size_t size)
+{
+	const TraceHeader *hdr = (const TraceHeader *)dump;
+	const TraceEvent *ev = (const TraceEvent *)(hdr + 1);
+	const char *names = (const char *)(ev + hdr->events);
+	unsigned seen = 0;
+
+	if (size < sizeof(*hdr) || hdr->magic != TRACE_MAGIC || hdr->version != TRACE_VERSION
+			|| hdr->event_size != sizeof(TraceEvent) || hdr->lost)
+		return -1;
+	kprintf("%u events, %u processes\n", hdr->events, hdr->procs);
+
+	for (int i = 0; i < hdr->events; i++)
+	{
+		/* Only the events of a nested interrupt can be out of order */
+		if (i && ev[i].time < ev[i - 1].time && !fromIrq(&ev[i]) && !fromIrq(&ev[i - 1]))
+		{
+			kprintf("Event %d out of order\n", i);
+			return -1;
+		}
+		seen |= BV(ev[i].type);
+	}
+	for (int type = TRACE_SWITCH; type < TRACE_USER; type++)
+		if (!(seen & BV(type)))
+		{
+			kprintf("No event of type %d\n", type);
+			return -1;
+		}
+
+	if (hdr->procs != 4 || !hasName(names, (const char *)dump + size, "ping")
+			|| !hasName(names, (const char *)dump + size, "locker"))
+		return -1;
+	return 0;
+}
+
+static void bench(void)
+{
+	hptime_t start, traced, idle;
+
+	trace_start();
+	start = hptime_get();
+	for (long i = 0; i < BENCH_EVENTS; i++)
+		trace_event(TRACE_USER, i);
+	traced = hptime_get() - start;
+
+	trace_stop();
+	start = hptime_get();
+	for (long i = 0; i < BENCH_EVENTS; i++)
+		trace_event(TRACE_USER, i);
+	idle = hptime_get() - start;
+
+	kprintf("Event: %ld ns, stopped tracer: %ld ns\n",
+		(long)(traced * 1000 / HPTIME_TICKS_PER_MICRO / BENCH_EVENTS),
+		(long)(idle * 1000 / HPTIME_TICKS_PER_MICRO / BENCH_EVENTS));
+}
+
+int trace_testRun(void)
+{
+	KFileMem mem;
+	kfile_off_t size;
+
+	trace_start();
+
+	ping_proc = proc_new(ping, NULL, sizeof(ping_stack), ping_stack);
+	pong_proc = proc_new(pong, NULL, sizeof(pong_stack), pong_stack);
+
+	sem_obtain(&sem);
+	proc_new(locker, NULL, sizeof(locker_stack), locker_stack);
+	timer_delay(20);
+	sem_release(&sem);
+	timer_delay(20);
+
+	trace_stop();
+	if (!locked)
+		return -1;
+
+	kfilemem_init(&mem, dump, sizeof(dump));
+	if (trace_dump(&mem.fd))
+		return -1;
+	size = mem.fd.seek_pos;
+	if (check_dump(size))
+	{
+		kprintf("Bad trace dump\n");
+		return -1;
+	}
+
+	bench();
+	return 0;
+}
+
+int trace_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+	proc_init();
+	sem_init(&sem);
+	return 0;
+}
+
+int trace_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(trace);
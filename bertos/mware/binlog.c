@@ -0,0 +1,326 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Deferred binary logging.
+ *
+ * The ring has many producers, interrupts included, and one consumer.
+ * A producer reserves the words of its record moving the head with a
+ * compare-and-swap (or with interrupts disabled, on CPUs without it),
+ * fills the arguments and writes the header word last. The consumer
+ * takes a record only when its header is there, and clears the words
+ * before giving them back by moving the tail.
+ *
+ * A record reserved but not yet written holds back the following ones,
+ * so the drain may see fewer records than the ones logged so far.
+ */
+
+#include "binlog.h"
+
+#include <cfg/debug.h>
+#include <cfg/macros.h>
+
+#include <cpu/irq.h>
+
+#include <drv/timer.h>
+
+#include <kern/proc.h>
+
+#include <mware/formatwr.h>
+
+#include <stdarg.h>
+#include <string.h>
+
+STATIC_ASSERT(IS_POW2(CONFIG_BINLOG_SIZE));
+STATIC_ASSERT(IS_POW2(BINLOG_MAX_ARGS + 1));
+
+#define BINLOG_MASK  (CONFIG_BINLOG_SIZE - 1)
+
+/* Defined by the linker, the section exists even if nobody logs */
+extern const char __start_binlog_fmt[];
+static USED_VAR(const char, binlog_anchor[]) BINLOG_FMT_ATTR = "";
+
+static uintptr_t binlog_ring[CONFIG_BINLOG_SIZE];
+/* Words reserved and words consumed since boot, taken modulo the size */
+static volatile uint32_t binlog_head;
+static volatile uint32_t binlog_tail;
+static volatile uint32_t binlog_lost_cnt;
+
+void binlog_write(uintptr_t hdr, const uintptr_t *args)
+{
+	unsigned n = hdr & BINLOG_MAX_ARGS;
+	uint32_t head;
+
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+	do
+	{
+		head = binlog_head;
+		if (head + n + 1 - binlog_tail > CONFIG_BINLOG_SIZE)
+		{
+			__sync_fetch_and_add(&binlog_lost_cnt, 1);
+			return;
+		}
+	}
+	while (!__sync_bool_compare_and_swap(&binlog_head, head, head + n + 1));
+#else
+	cpu_flags_t flags;
+
+	IRQ_SAVE_DISABLE(flags);
+	head = binlog_head;
+	if (head + n + 1 - binlog_tail > CONFIG_BINLOG_SIZE)
+	{
+		binlog_lost_cnt++;
+		IRQ_RESTORE(flags);
+		return;
+	}
+	binlog_head = head + n + 1;
+	IRQ_RESTORE(flags);
+#endif
+
+	for (unsigned i = 0; i < n; i++)
+		binlog_ring[(head + 1 + i) & BINLOG_MASK] = args[i];
+	/* The consumer takes the record as soon as it sees the header */
+	MEMORY_BARRIER;
+	binlog_ring[head & BINLOG_MASK] = hdr;
+}
+
+/*
+ * Move the oldest complete record to \a rec.
+ *
+ * \return The number of arguments, -1 if there is no record.
+ */
+static int binlog_pop(uintptr_t *rec)
+{
+	uint32_t tail;
+	int n = -1;
+
+	/* One consumer at a time */
+	proc_forbid();
+	tail = binlog_tail;
+	if (tail != binlog_head && (rec[0] = binlog_ring[tail & BINLOG_MASK]))
+	{
+		n = rec[0] & BINLOG_MAX_ARGS;
+		binlog_ring[tail & BINLOG_MASK] = 0;
+		for (int i = 1; i <= n; i++)
+		{
+			rec[i] = binlog_ring[(tail + i) & BINLOG_MASK];
+			binlog_ring[(tail + i) & BINLOG_MASK] = 0;
+		}
+		MEMORY_BARRIER;
+		binlog_tail = tail + n + 1;
+	}
+	proc_permit();
+	return n;
+}
+
+static void binlog_printf(void (*put)(char c, void *ctx), void *ctx, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	_formatted_write(fmt, put, ctx, ap);
+	va_end(ap);
+}
+
+/*
+ * Format a record one conversion at a time, passing each argument with
+ * the type its conversion expects.
+ */
+static void binlog_format(const char *fmt, const uintptr_t *args, int nargs,
+		void (*put)(char c, void *ctx), void *ctx)
+{
+	char spec[16];
+	int n = 0;
+
+	while (*fmt)
+	{
+		const char *conv = fmt + 1;
+		bool is_long = false, is_size = false;
+
+		if (*fmt != '%')
+		{
+			put(*fmt++, ctx);
+			continue;
+		}
+
+		while (*conv && strchr("-+ #0123456789.hlz", *conv))
+		{
+			is_long |= *conv == 'l';
+			is_size |= *conv == 'z';
+			conv++;
+		}
+		if (!*conv || (size_t)(conv - fmt) >= sizeof(spec) - 1)
+			break;
+		memcpy(spec, fmt, conv - fmt + 1);
+		spec[conv - fmt + 1] = '\0';
+		fmt = conv + 1;
+
+		if (*conv == '%')
+		{
+			put('%', ctx);
+			continue;
+		}
+		if (n == nargs)
+		{
+			put('?', ctx);
+			continue;
+		}
+
+		switch (*conv)
+		{
+		case 's':
+			binlog_printf(put, ctx, spec, (const char *)args[n]);
+			break;
+		case 'p':
+			binlog_printf(put, ctx, spec, (void *)args[n]);
+			break;
+		case 'd':
+		case 'i':
+			if (is_long)
+				binlog_printf(put, ctx, spec, (long)args[n]);
+			else if (is_size)
+				binlog_printf(put, ctx, spec, (size_t)args[n]);
+			else
+				binlog_printf(put, ctx, spec, (int)args[n]);
+			break;
+		case 'c':
+		case 'u':
+		case 'x':
+		case 'X':
+			if (is_long)
+				binlog_printf(put, ctx, spec, (unsigned long)args[n]);
+			else if (is_size)
+				binlog_printf(put, ctx, spec, (size_t)args[n]);
+			else
+				binlog_printf(put, ctx, spec, (unsigned int)args[n]);
+			break;
+		default:
+			/* Floating point values are not stored, no octal in formatwr */
+			put('?', ctx);
+			break;
+		}
+		n++;
+	}
+}
+
+size_t binlog_drain(void (*put)(char c, void *ctx), void *ctx)
+{
+	uintptr_t rec[BINLOG_MAX_ARGS + 1];
+	size_t cnt = 0;
+	int n;
+
+	while ((n = binlog_pop(rec)) >= 0)
+	{
+		binlog_format((const char *)(rec[0] & ~(uintptr_t)BINLOG_MAX_ARGS), rec + 1, n, put, ctx);
+		cnt++;
+	}
+	return cnt;
+}
+
+static void binlog_kputchar(char c, UNUSED_ARG(void *, ctx))
+{
+	kputchar(c);
+}
+
+void binlog_flush(void)
+{
+	static uint32_t reported;
+	uint32_t lost = binlog_lost_cnt;
+
+	binlog_drain(binlog_kputchar, NULL);
+	if (lost != reported)
+	{
+		kprintf("binlog: %lu records lost\n", (unsigned long)(lost - reported));
+		reported = lost;
+	}
+}
+
+int binlog_dump(KFile *fd)
+{
+	uintptr_t rec[BINLOG_MAX_ARGS + 1];
+	BinlogHeader hdr;
+	int n;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = BINLOG_MAGIC;
+	hdr.lost = binlog_lost_cnt;
+	hdr.version = BINLOG_VERSION;
+	hdr.header_size = sizeof(BinlogHeader);
+	hdr.word_size = sizeof(uintptr_t);
+	hdr.args_mask = BINLOG_MAX_ARGS;
+	hdr.fmt_base = (uintptr_t)__start_binlog_fmt;
+
+	if (kfile_write(fd, &hdr, sizeof(hdr)) != sizeof(hdr))
+		return EOF;
+
+	while ((n = binlog_pop(rec)) >= 0)
+	{
+		size_t len = (n + 1) * sizeof(uintptr_t);
+
+		if (kfile_write(fd, rec, len) != len)
+			return EOF;
+	}
+	return 0;
+}
+
+uint32_t binlog_lost(void)
+{
+	return binlog_lost_cnt;
+}
+
+#if CONFIG_KERN
+
+static PROC_DEFINE_STACK(binlog_stack, KERN_MINSTACKSIZE * 2);
+
+static NORETURN void binlog_drainer(void)
+{
+	for (;;)
+	{
+		binlog_flush();
+		timer_delay(CONFIG_BINLOG_PERIOD);
+	}
+}
+
+void binlog_init(void)
+{
+	struct Process *p = proc_new(binlog_drainer, NULL, sizeof(binlog_stack), binlog_stack);
+
+	ASSERT(p);
+	proc_setPri(p, CONFIG_BINLOG_PRI);
+}
+
+#else /* !CONFIG_KERN */
+
+void binlog_init(void)
+{
+}
+
+#endif /* CONFIG_KERN */
@@ -0,0 +1,178 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Deferred binary logging.
+ *
+ * kprintf() formats the message in the caller and waits for the console,
+ * which may take milliseconds on a slow serial line. BINLOG() instead
+ * stores the address of its format string and the raw arguments in a
+ * ring buffer, a few stores and a compare-and-swap, so it can be used in
+ * interrupt handlers and hot paths. The messages are formatted later:
+ *
+ *  - by the drain process started by binlog_init(), which prints them
+ *    on the debug console every CONFIG_BINLOG_PERIOD ms;
+ *  - by binlog_flush() or binlog_drain(), called by the application;
+ *  - on the host: binlog_dump() writes the raw records to a KFile and
+ *    bertos/mware/binlog_decode.py formats them, reading the strings from
+ *    the ELF image, so they don't even need to be sent.
+ *
+ * \code
+ * BINLOG("rx %d bytes from %s, status %lx\n", len, "uart1", status);
+ * \endcode
+ *
+ * With CONFIG_BINLOG enabled the LOG_* macros of cfg/log.h use BINLOG().
+ *
+ * Since the arguments are read after the call returns, a record holds at
+ * most BINLOG_MAX_ARGS arguments, each one converted to a uintptr_t:
+ *  - integers up to the size of a pointer (long on 32 bit CPUs);
+ *  - pointers, and strings that never change: literals, __func__;
+ *  - no floating point values nor long long.
+ *
+ * When the ring is full new records are dropped and counted.
+ *
+ * $WIZ$ module_name = "binlog"
+ * $WIZ$ module_depends = "formatwr", "kfile"
+ * $WIZ$ module_configuration = "bertos/cfg/cfg_binlog.h"
+ */
+
+#ifndef MWARE_BINLOG_H
+#define MWARE_BINLOG_H
+
+#include "cfg/cfg_binlog.h"
+
+#include <cfg/compiler.h>
+#include <cfg/macros.h> // PP_COUNT()
+
+#include <io/kfile.h>
+
+/// Max arguments of a record.
+#define BINLOG_MAX_ARGS  7
+
+/// First word of a dump, "BLOG" in the byte order of the target.
+#define BINLOG_MAGIC     0x474f4c42UL
+#define BINLOG_VERSION   1
+
+/**
+ * Header of a dump.
+ *
+ * It is followed by the records until the end of the dump: a word with
+ * the address of the format string, whose low bits hold the number of
+ * arguments, then a word for each argument.
+ */
+typedef struct BinlogHeader
+{
+	uint32_t magic;       ///< BINLOG_MAGIC.
+	uint32_t lost;        ///< Records dropped because the ring was full.
+	uint8_t version;      ///< BINLOG_VERSION.
+	uint8_t header_size;  ///< sizeof(BinlogHeader).
+	uint8_t word_size;    ///< sizeof(uintptr_t).
+	uint8_t args_mask;    ///< Mask of the argument count in the first word.
+	uintptr_t fmt_base;   ///< Run time address of the binlog_fmt section.
+} BinlogHeader;
+
+/*
+ * Format strings live in their own section, aligned so that the low bits
+ * of their address are free for the argument count.
+ */
+#define BINLOG_FMT_ATTR  __attribute__((__section__("binlog_fmt"), __aligned__(BINLOG_MAX_ARGS + 1)))
+
+#define BINLOG_NARGS(...) \
+	(PP_COUNT(~, ## __VA_ARGS__) - 1 + STATIC_ASSERT_EXPR(PP_COUNT(~, ## __VA_ARGS__) - 1 <= BINLOG_MAX_ARGS))
+
+#define BINLOG_W(x)  ((uintptr_t)(x))
+#define BINLOG_ARGS(...)  PP_CAT(BINLOG_ARGS_, PP_COUNT(~, ## __VA_ARGS__))(__VA_ARGS__)
+#define BINLOG_ARGS_1(...)
+#define BINLOG_ARGS_2(a)                    , BINLOG_W(a)
+#define BINLOG_ARGS_3(a, b)                 BINLOG_ARGS_2(a), BINLOG_W(b)
+#define BINLOG_ARGS_4(a, b, c)              BINLOG_ARGS_3(a, b), BINLOG_W(c)
+#define BINLOG_ARGS_5(a, b, c, d)           BINLOG_ARGS_4(a, b, c), BINLOG_W(d)
+#define BINLOG_ARGS_6(a, b, c, d, e)        BINLOG_ARGS_5(a, b, c, d), BINLOG_W(e)
+#define BINLOG_ARGS_7(a, b, c, d, e, f)     BINLOG_ARGS_6(a, b, c, d, e), BINLOG_W(f)
+#define BINLOG_ARGS_8(a, b, c, d, e, f, g)  BINLOG_ARGS_7(a, b, c, d, e, f), BINLOG_W(g)
+
+/**
+ * Log a message, in the printf format understood by kprintf().
+ *
+ * \a fmt must be a string literal.
+ *
+ * \note Interrupt safe.
+ */
+#define BINLOG(fmt, ...) \
+	do { \
+		static const char binlog_fmt_[] BINLOG_FMT_ATTR = "" fmt; \
+		binlog_write((uintptr_t)binlog_fmt_ | BINLOG_NARGS(__VA_ARGS__), \
+			(const uintptr_t []){ 0 BINLOG_ARGS(__VA_ARGS__) } + 1); \
+	} while (0)
+
+/**
+ * Store a record, use BINLOG() instead.
+ */
+void binlog_write(uintptr_t hdr, const uintptr_t *args);
+
+/**
+ * Format the pending records, oldest first, through \a put.
+ *
+ * \return The number of records formatted.
+ */
+size_t binlog_drain(void (*put)(char c, void *ctx), void *ctx);
+
+/**
+ * Print the pending records on the debug console.
+ */
+void binlog_flush(void);
+
+/**
+ * Write the pending records to \a fd without formatting them, see
+ * BinlogHeader for the format.
+ *
+ * \return 0 if successful, EOF on write errors.
+ */
+int binlog_dump(KFile *fd);
+
+/**
+ * Return the number of records dropped because the ring was full.
+ */
+uint32_t binlog_lost(void);
+
+/**
+ * Start the process printing the records on the debug console.
+ *
+ * It runs at CONFIG_BINLOG_PRI, low by default, so the drain does not
+ * delay the other processes. Without the kernel call binlog_flush() instead.
+ */
+void binlog_init(void);
+
+int binlog_testSetup(void);
+int binlog_testRun(void);
+int binlog_testTearDown(void);
+
+#endif /* MWARE_BINLOG_H */
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+#
+# This file is part of BeRTOS.
+#
+# Bertos is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+#
+# Format the records written by binlog_dump() (see mware/binlog.h).
+#
+# The format strings, and the constant strings passed as arguments, are
+# read from the ELF image of the firmware that wrote the dump.
+#
+# Usage: binlog_decode.py ELF DUMP > OUTPUT
+#
+
+import argparse
+import re
+import struct
+import sys
+
+BINLOG_MAGIC = 0x474f4c42
+BINLOG_VERSION = 1
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+INT_FORMATS = {2: "H", 4: "I", 8: "Q"}
+
+CONVERSION = re.compile(r"%([-+ #0]*)(\d*)(\.\d+)?(hh|h|l|z)?([a-zA-Z%])")
+
+class Image:
+	def __init__(self, data):
+		if data[:4] != b"\x7fELF":
+			sys.exit("Not an ELF file")
+		self.data = data
+		is64 = data[4] == 2
+		order = "<" if data[5] == 1 else ">"
+		if is64:
+			shoff = struct.unpack_from(order + "Q", data, 0x28)[0]
+			shentsize, shnum, shstrndx = struct.unpack_from(order + "HHH", data, 0x3a)
+			shdr = order + "IIQQQQ"
+		else:
+			shoff = struct.unpack_from(order + "I", data, 0x20)[0]
+			shentsize, shnum, shstrndx = struct.unpack_from(order + "HHH", data, 0x2e)
+			shdr = order + "IIIIII"
+
+		sections = [struct.unpack_from(shdr, data, shoff + i * shentsize) for i in range(shnum)]
+		strtab = sections[shstrndx][4]
+		# (name, addr, offset, size) of the sections loaded in memory
+		self.sections = [(self.cstr(strtab + name), addr, offset, size)
+			for name, type, flags, addr, offset, size in sections
+			if flags & SHF_ALLOC and type != SHT_NOBITS]
+
+	def cstr(self, offset):
+		end = self.data.index(b"\0", offset)
+		return self.data[offset:end].decode("latin-1")
+
+	def section(self, name):
+		for s in self.sections:
+			if s[0] == name:
+				return s
+		sys.exit("No %s section, is binlog linked in?" % name)
+
+	def string(self, addr):
+		for name, start, offset, size in self.sections:
+			if start <= addr < start + size:
+				return self.cstr(offset + addr - start)
+		return None
+
+def signed(val, bits):
+	val &= (1 << bits) - 1
+	return val - (1 << bits) if val >> (bits - 1) else val
+
+def format_record(image, bias, fmt, args, word_size):
+	int_bits = 16 if word_size == 2 else 32
+	args = list(args)
+
+	def conv(m):
+		flags, width, prec, length, c = m.groups()
+		if c == "%":
+			return "%"
+		if not args:
+			return "?"
+		val = args.pop(0)
+		bits = 8 * word_size if length in ("l", "z") else int_bits
+		spec = "%" + flags + width + (prec or "")
+		if c in "di":
+			return (spec + "d") % signed(val, bits)
+		if c in "uxX":
+			return (spec + ("d" if c == "u" else c)) % (val & ((1 << bits) - 1))
+		if c == "c":
+			return (spec + "c") % chr(val & 0xff)
+		if c == "p":
+			return (spec + "s") % ("%#x" % val)
+		if c != "s":
+			return "?"
+		s = image.string(val - bias)
+		return (spec + "s") % (s if s is not None else "<%#x>" % val)
+
+	return CONVERSION.sub(conv, fmt)
+
+def main():
+	parser = argparse.ArgumentParser(description="Format a binlog dump.")
+	parser.add_argument("elf", help="firmware image")
+	parser.add_argument("dump", help="dump written by binlog_dump()")
+	args = parser.parse_args()
+
+	image = Image(open(args.elf, "rb").read())
+	data = open(args.dump, "rb").read()
+
+	for order in "<>":
+		if len(data) >= 4 and struct.unpack_from(order + "I", data)[0] == BINLOG_MAGIC:
+			break
+	else:
+		sys.exit("Not a binlog dump")
+
+	magic, lost, version, header_size, word_size, args_mask = struct.unpack_from(order + "IIBBBB", data)
+	if version != BINLOG_VERSION:
+		sys.exit("Unsupported binlog version %d" % version)
+	word = order + INT_FORMATS[word_size]
+	fmt_base = struct.unpack_from(word, data, header_size - word_size)[0]
+	# Position independent executables are loaded at a random address
+	bias = fmt_base - image.section("binlog_fmt")[1]
+
+	pos = header_size
+	while pos + word_size <= len(data):
+		hdr = struct.unpack_from(word, data, pos)[0]
+		nargs = hdr & args_mask
+		rec = [struct.unpack_from(word, data, pos + (i + 1) * word_size)[0] for i in range(nargs)]
+		pos += (nargs + 1) * word_size
+		if pos > len(data):
+			sys.exit("Truncated dump")
+
+		fmt = image.string((hdr & ~args_mask) - bias)
+		if fmt is None:
+			sys.exit("Format string at %#x not found, wrong ELF?" % (hdr & ~args_mask))
+		sys.stdout.write(format_record(image, bias, fmt, rec, word_size))
+
+	if lost:
+		sys.stderr.write("%d records lost\n" % lost)
+
+if __name__ == "__main__":
+	main()
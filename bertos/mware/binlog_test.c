@@ -0,0 +1,357 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Deferred binary logging test.
+ *
+ * The records must be formatted as sprintf() would do, LOG_* macros
+ * included, across the wrap around of the ring; a full ring must drop
+ * the new records and count them. A timer interrupt logs while the main
+ * loop does the same, and no record may get lost or mixed. Then the cost
+ * of a record is compared with sprintf() and kprintf().
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: echo  "#undef CONFIG_KERN_PRI" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN_PRI 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_binlog.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_BINLOG" >> $cfgdir/cfg_binlog.h
+ * $test$: echo "#define CONFIG_BINLOG 1" >> $cfgdir/cfg_binlog.h
+ * $test$: echo  "#undef CONFIG_BINLOG_SIZE" >> $cfgdir/cfg_binlog.h
+ * $test$: echo "#define CONFIG_BINLOG_SIZE 64" >> $cfgdir/cfg_binlog.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include "binlog.h"
+
+#define LOG_LEVEL   LOG_LVL_INFO
+#define LOG_FORMAT  LOG_FMT_VERBOSE
+#include <cfg/log.h>
+
+#include <cfg/debug.h>
+#include <cfg/test.h>
+
+#include <drv/timer.h>
+
+#include <kern/proc.h>
+
+#include <struct/kfile_mem.h>
+
+#include <stdio.h>
+#include <stdlib.h> // atoi()
+#include <string.h>
+
+#define BENCH_RECORDS 100000L
+#define BENCH_PRINTS  20
+
+static char out[256];
+static size_t out_len;
+static char expect[256];
+
+static void put_out(char c, UNUSED_ARG(void *, ctx))
+{
+	if (out_len < sizeof(out) - 1)
+		out[out_len++] = c;
+	out[out_len] = '\0';
+}
+
+static size_t drain_out(void)
+{
+	out_len = 0;
+	out[0] = '\0';
+	return binlog_drain(put_out, NULL);
+}
+
+static int check_out(int line)
+{
+	if (strcmp(out, expect))
+	{
+		kprintf("Line %d: got '%s', expected '%s'\n", line, out, expect);
+		return -1;
+	}
+	return 0;
+}
+
+#define CHECK(fmt, ...) \
+	do { \
+		BINLOG(fmt, ## __VA_ARGS__); \
+		sprintf(expect, fmt, ## __VA_ARGS__); \
+		if (drain_out() != 1 || check_out(__LINE__)) \
+			return -1; \
+	} while (0)
+
+static int check_format(void)
+{
+	static const int var = 0;
+	size_t size = 1234;
+	int line;
+
+	CHECK("plain\n");
+	CHECK("%d %i|%5d|%-4d|%+d\n", -42, 7, 12, -3, 5);
+	CHECK("%u %x %X %08x\n", 40000U, 0xbeefU, 0xcafeU, 0x1234U);
+	CHECK("%ld %lu %lx\n", -100000L, 3000000000UL, 0xdeadbeefUL);
+	CHECK("%s|%-6s|%5s|%.2s\n", "abc", "de", "f", "ghi");
+	CHECK("%c%c %zu %p %%\n", 'o', 'k', size, &var);
+	CHECK("%d %d %d %d %d %d %d\n", 1, 2, 3, 4, 5, 6, 7);
+
+	LOG_INFO("x=%d\n", 3); line = __LINE__;
+	sprintf(expect, "%s():%d:INFO: x=%d\n", __func__, line, 3);
+	if (drain_out() != 1 || check_out(line))
+		return -1;
+	return 0;
+}
+
+static int check_full(void)
+{
+	uint32_t lost = binlog_lost();
+	size_t len = 0;
+	int i;
+
+	/* A record with 3 arguments takes 4 words */
+	for (i = 0; i < CONFIG_BINLOG_SIZE / 4 + 1; i++)
+		BINLOG("%d %d %d\n", i, i, i);
+	if (binlog_lost() != lost + 1)
+		return -1;
+
+	for (i = 0; i < CONFIG_BINLOG_SIZE / 4; i++)
+		len += sprintf(expect + len, "%d %d %d\n", i, i, i);
+	if (drain_out() != CONFIG_BINLOG_SIZE / 4 || check_out(__LINE__))
+		return -1;
+	return 0;
+}
+
+static int check_wrap(void)
+{
+	/* Records of different sizes, so that they wrap at every position */
+	for (int i = 0; i < CONFIG_BINLOG_SIZE * 4; i++)
+	{
+		switch (i % 3)
+		{
+		case 0:
+			CHECK("%d\n", i);
+			break;
+		case 1:
+			BINLOG("a%d b%d\n", i, -i);
+			BINLOG("c\n");
+			sprintf(expect, "a%d b%d\nc\n", i, -i);
+			if (drain_out() != 2 || check_out(__LINE__))
+				return -1;
+			break;
+		default:
+			CHECK("%s %u %lu %d %d\n", "x", i, (unsigned long)i, i, i);
+			break;
+		}
+	}
+	return 0;
+}
+
+/*
+ * The interrupt and the main loop number their records, each sequence
+ * must come out complete and in order.
+ */
+static Timer isr_timer;
+static volatile unsigned isr_cnt;
+static unsigned isr_next, main_next;
+static bool seq_ok = true;
+
+static void isr_log(UNUSED_ARG(iptr_t, data))
+{
+	BINLOG("i%u\n", isr_cnt);
+	isr_cnt++;
+	timer_add(&isr_timer);
+}
+
+static void put_seq(char c, UNUSED_ARG(void *, ctx))
+{
+	static char line[16];
+	static size_t len;
+	unsigned n;
+
+	if (c != '\n')
+	{
+		if (len < sizeof(line) - 1)
+			line[len++] = c;
+		return;
+	}
+	line[len] = '\0';
+	len = 0;
+
+	n = (unsigned)atoi(line + 1);
+	if (line[0] == 'i' && n == isr_next)
+		isr_next++;
+	else if (line[0] == 'm' && n == main_next)
+		main_next++;
+	else
+	{
+		kprintf("Unexpected record '%s'\n", line);
+		seq_ok = false;
+	}
+}
+
+static int check_isr(void)
+{
+	uint32_t lost = binlog_lost();
+	ticks_t start = timer_clock();
+	unsigned i = 0;
+
+	timer_setSoftint(&isr_timer, isr_log, 0);
+	timer_setDelay(&isr_timer, 1);
+	timer_add(&isr_timer);
+
+	while (timer_clock() - start < ms_to_ticks(200))
+	{
+		BINLOG("m%u\n", i);
+		i++;
+		binlog_drain(put_seq, NULL);
+	}
+	timer_abort(&isr_timer);
+	binlog_drain(put_seq, NULL);
+
+	kprintf("%u records from the main loop, %u from the interrupt\n", main_next, isr_next);
+	if (!seq_ok || main_next != i || isr_next != isr_cnt || isr_cnt < 20 || binlog_lost() != lost)
+		return -1;
+	return 0;
+}
+
+static int check_dump(void)
+{
+	uint8_t dump[sizeof(BinlogHeader) + 5 * sizeof(uintptr_t)];
+	const BinlogHeader *hdr = (const BinlogHeader *)dump;
+	const uintptr_t *rec = (const uintptr_t *)(hdr + 1);
+	KFileMem mem;
+
+	BINLOG("one %d\n", 1);
+	BINLOG("two %d %s\n", 2, "x");
+	kfilemem_init(&mem, dump, sizeof(dump));
+	if (binlog_dump(&mem.fd) || mem.fd.seek_pos != sizeof(dump))
+		return -1;
+	if (hdr->magic != BINLOG_MAGIC || hdr->version != BINLOG_VERSION
+			|| hdr->word_size != sizeof(uintptr_t) || hdr->fmt_base == 0)
+		return -1;
+	/* The format string is in the section, the low bits count the arguments */
+	if (strcmp((const char *)(rec[0] & ~(uintptr_t)hdr->args_mask), "one %d\n")
+			|| (rec[0] & hdr->args_mask) != 1 || rec[1] != 1
+			|| (rec[2] & hdr->args_mask) != 2 || rec[3] != 2)
+		return -1;
+	return drain_out() == 0 ? 0 : -1;
+}
+
+static void put_null(UNUSED_ARG(char, c), UNUSED_ARG(void *, ctx))
+{
+}
+
+static void bench(void)
+{
+	hptime_t logged = 0, formatted, printed, start;
+	long i;
+
+	/* Drain the ring when full, only the stores are timed */
+	for (i = 0; i < BENCH_RECORDS; i += CONFIG_BINLOG_SIZE / 3)
+	{
+		start = hptime_get();
+		for (int j = 0; j < CONFIG_BINLOG_SIZE / 3; j++)
+			BINLOG("bench %d %s\n", j, "binlog");
+		logged += hptime_get() - start;
+		binlog_drain(put_null, NULL);
+	}
+
+	start = hptime_get();
+	for (i = 0; i < BENCH_RECORDS; i++)
+		sprintf(out, "bench %ld %s\n", i, "sprintf");
+	formatted = hptime_get() - start;
+
+	start = hptime_get();
+	for (i = 0; i < BENCH_PRINTS; i++)
+		kprintf("bench %ld %s\n", i, "kprintf");
+	printed = hptime_get() - start;
+
+	kprintf("BINLOG: %ld ns, sprintf: %ld ns, kprintf: %ld ns\n",
+		(long)(logged * 1000 / HPTIME_TICKS_PER_MICRO / BENCH_RECORDS),
+		(long)(formatted * 1000 / HPTIME_TICKS_PER_MICRO / BENCH_RECORDS),
+		(long)(printed * 1000 / HPTIME_TICKS_PER_MICRO / BENCH_PRINTS));
+}
+
+int binlog_testRun(void)
+{
+	if (check_format())
+	{
+		kprintf("Bad formatting\n");
+		return -1;
+	}
+	if (check_full())
+	{
+		kprintf("Full ring not handled\n");
+		return -1;
+	}
+	if (check_wrap())
+	{
+		kprintf("Wrap around failed\n");
+		return -1;
+	}
+	if (check_isr())
+	{
+		kprintf("Interrupt records lost or mixed\n");
+		return -1;
+	}
+	if (check_dump())
+	{
+		kprintf("Bad dump\n");
+		return -1;
+	}
+	bench();
+
+	/* The drain process prints the records in background */
+	binlog_init();
+	LOG_INFO("printed by the drain process\n");
+	timer_delay(CONFIG_BINLOG_PERIOD * 2);
+	return drain_out() == 0 ? 0 : -1;
+}
+
+int binlog_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+	proc_init();
+	return 0;
+}
+
+int binlog_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(binlog);
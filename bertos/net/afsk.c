@@ -213,7 +213,10 @@ void afsk_adc_isr(Afsk *af, int8_t curr_sample)
 			)
 			this_bit = 1;
 
-		af->status = hdlc_decode (&af->rx_hdlc, this_bit, &af->rx_fifo);
+		if (af->rx_frames.frames)
+			hdlc_decodeFrame (&af->rx_hdlc, this_bit, &af->rx_frames);
+		else
+			af->status = hdlc_decode (&af->rx_hdlc, this_bit, &af->rx_fifo);
 	}
 
 
@@ -379,6 +382,24 @@ void afsk_tail (KFile * fd, int c)
 }
 
 
+/**
+ * Switch the receiver to the frame oriented interface.
+ *
+ * Received frames are decoded straight into \a frames and published on
+ * af->rx_frames once their FCS has been checked, where upper layers
+ * can process them in place (see ax25_setRxFrames() and
+ * kiss_setRxFrames()). The KFile interface is then only used to transmit.
+ *
+ * \param af Afsk context to operate on.
+ * \param frames Frame buffers to receive into.
+ * \param count Number of frame buffers, at least 2.
+ */
+void afsk_setRxFrames (Afsk * af, HdlcFrame * frames, uint8_t count)
+{
+	ATOMIC (hdlc_frameQueueInit (&af->rx_frames, frames, count));
+}
+
+
 /**
  * Initialize an AFSK1200 modem.
  * \param af Afsk context to operate on.
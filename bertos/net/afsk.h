@@ -123,6 +123,12 @@ typedef struct Afsk
 	/** FIFO rx buffer */
 	uint8_t rx_buf[CONFIG_AFSK_RX_BUFLEN];
 
+	/**
+	 * Queue of received frames, used instead of rx_fifo
+	 * when frame buffers are supplied with afsk_setRxFrames().
+	 */
+	HdlcFrameQueue rx_frames;
+
 	/** FIFO for transmitted data */
 	FIFOBuffer tx_fifo;
 
@@ -178,6 +184,7 @@ void afsk_adc_isr (Afsk * af, int8_t sample);
 uint8_t afsk_dac_isr (Afsk * af);
 void afsk_set_timings (Afsk * af, uint8_t txhead, uint8_t txtail);
 void afsk_init (Afsk * af, int adc_ch, int dac_ch);
+void afsk_setRxFrames (Afsk * af, HdlcFrame * frames, uint8_t count);
 
 #define HEAD   1
 #define TAIL   4
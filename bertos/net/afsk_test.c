@@ -165,6 +165,58 @@ static void messageout_hook(struct AX25Msg *msg)
 		ASSERT (msg->info[i] == (uint8_t) (i + 1));
 }
 
+static int bench_cnt;
+static void bench_hook(UNUSED_ARG(struct AX25Msg *, msg))
+{
+	bench_cnt++;
+}
+
+/*
+ * Compare the octet stream receive path with the frame oriented one,
+ * demodulating the whole test corpus from memory.
+ */
+static void afsk_benchmark(void)
+{
+	enum { RUNS = 16 };
+	static int8_t samples[200000];
+	static HdlcFrame frames[4];
+	size_t n;
+	ticks_t t;
+
+	fp_adc = afsk_fileOpen("test/afsk_test.au");
+	n = fread(samples, 1, sizeof(samples), fp_adc);
+	ASSERT(n > 0 && n < sizeof(samples));
+
+	for (int frame_mode = 0; frame_mode < 2; frame_mode++)
+	{
+		bench_cnt = 0;
+		t = timer_clock();
+		for (int run = 0; run < RUNS; run++)
+		{
+			afsk_init(&afsk_fd, 0, 0);
+			ax25_init(&ax25, &afsk_fd.fd, bench_hook);
+			if (frame_mode)
+			{
+				afsk_setRxFrames(&afsk_fd, frames, countof(frames));
+				ax25_setRxFrames(&ax25, &afsk_fd.rx_frames);
+			}
+
+			for (size_t i = 0; i < n; i++)
+			{
+				afsk_adc_isr(&afsk_fd, samples[i]);
+				ax25_poll(&ax25);
+			}
+		}
+		t = timer_clock() - t;
+
+		kprintf("%s rx: %d frames, %lu us per corpus\n", frame_mode ? "frame" : "kfile",
+			bench_cnt / RUNS, (unsigned long)(ticks_to_us(t) / RUNS));
+		ASSERT(bench_cnt / RUNS >= 15);
+	}
+	kprintf("frame rx: %u crc errors, %u overruns\n",
+		afsk_fd.rx_frames.crc_errors, afsk_fd.rx_frames.overruns);
+}
+
 int afsk_testRun(void)
 {
 	int c;
@@ -211,7 +263,9 @@ int afsk_testRun(void)
 
 		ax25_poll(&ax25);
 	}
+	ASSERT(fclose(fp_adc) == 0);
 
+	afsk_benchmark();
 	return 0;
 }
 
@@ -68,10 +68,10 @@
 		(addr)[i] = (c == ' ') ? '\x0' : c; \
 	}
 
-static void ax25_decode(AX25Ctx *ctx)
+static void ax25_decode(AX25Ctx *ctx, const uint8_t *frame, size_t frm_len)
 {
 	AX25Msg msg;
-	uint8_t *buf = ctx->buf;
+	const uint8_t *buf = frame;
 
 	DECODE_CALL(buf, msg.dst.call);
 	msg.dst.ssid = (*buf++ >> 1) & 0x0F;
@@ -119,7 +119,7 @@ static void ax25_decode(AX25Ctx *ctx)
 		return;
 	}
 
-	msg.len = ctx->frm_len - (buf - ctx->buf);
+	msg.len = frm_len - (buf - frame);
 	msg.info = buf;
 	LOG_INFO("DATA: %.*s\n", msg.len, msg.info);
 
@@ -142,6 +142,23 @@ void ax25_poll(AX25Ctx *ctx)
 {
 	int c;
 
+	if (ctx->rxq)
+	{
+		HdlcFrame *frm;
+
+		/* Decode frames in place, straight from the receiver buffers */
+		while ((frm = hdlc_frameGet(ctx->rxq)))
+		{
+			if (frm->len >= AX25_MIN_FRAME_LEN - HDLC_FCS_LEN)
+			{
+				LOG_INFO("Frame found!\n");
+				ax25_decode(ctx, frm->buf, frm->len);
+			}
+			hdlc_frameRelease(ctx->rxq);
+		}
+		return;
+	}
+
 	while ((c = kfile_getc(ctx->ch)) != EOF)
 	{
 		if (ctx->frm_len < CONFIG_AX25_FRAME_BUF_LEN)
@@ -157,7 +174,7 @@ void ax25_poll(AX25Ctx *ctx)
 		{
 			ctx->frm_len -= 2;	  // drop the CRC octets
 			LOG_INFO ("Frame found!\n");
-			ax25_decode (ctx);
+			ax25_decode (ctx, ctx->buf, ctx->frm_len);
 		}
 		kfile_clearerr (ctx->ch);
 		ctx->frm_len = 0;
@@ -199,7 +216,7 @@ static void ax25_putchar (AX25Ctx * ctx, uint8_t c)
 	kfile_putc (c, ctx->ch);
 }
 
-static void ax25_sendCall(AX25Ctx *ctx, const AX25Call *addr, bool last)
+static void ax25_sendCall(AX25Ctx *ctx, const AX25Call *addr, bool last, bool repeated)
 {
 	unsigned len = MIN(sizeof(addr->call), strlen(addr->call));
 
@@ -216,10 +233,10 @@ static void ax25_sendCall(AX25Ctx *ctx, const AX25Call *addr, bool last)
 		for (unsigned i = 0; i < sizeof(addr->call) - len; i++)
 			ax25_putchar(ctx, ' ' << 1);
 
-	/* The bit7 "has-been-repeated" flag is not implemented here */
+	/* The bit7 is the "has-been-repeated" flag of repeater addresses */
 	/* Bits6:5 should be set to 1 for all SSIDs (0x60) */
 	/* The bit0 of last call SSID should be set to 1 */
-	uint8_t ssid = 0x60 | (addr->ssid << 1) | (last ? 0x01 : 0);
+	uint8_t ssid = 0x60 | (addr->ssid << 1) | (last ? 0x01 : 0) | (repeated ? 0x80 : 0);
 	ax25_putchar(ctx, ssid);
 }
 
@@ -240,7 +257,7 @@ void ax25_sendVia(AX25Ctx *ctx, const AX25Call *path, size_t path_len, const voi
 
 	/* Send call */
 	for (size_t i = 0; i < path_len; i++)
-		ax25_sendCall(ctx, &path[i], (i == path_len - 1));
+		ax25_sendCall(ctx, &path[i], (i == path_len - 1), false);
 
 	ax25_putchar(ctx, AX25_CTRL_UI);
 	ax25_putchar(ctx, AX25_PID_NOLAYER3);
@@ -250,6 +267,31 @@ void ax25_sendVia(AX25Ctx *ctx, const AX25Call *path, size_t path_len, const voi
 
 }
 
+#if CONFIG_AX25_RPT_LST
+/**
+ * Send a decoded AX25 message, keeping its repeaters list and
+ * their has-been-repeated flags.
+ * This is what a digipeater needs to forward a frame.
+ *
+ * \param ctx AX25 context to operate on.
+ * \param msg the message to be sent.
+ */
+void ax25_sendMsg(AX25Ctx *ctx, const AX25Msg *msg)
+{
+	ax25_sendCall(ctx, &msg->dst, false, false);
+	ax25_sendCall(ctx, &msg->src, msg->rpt_cnt == 0, false);
+
+	for (int i = 0; i < msg->rpt_cnt; i++)
+		ax25_sendCall(ctx, &msg->rpt_lst[i], i == msg->rpt_cnt - 1, AX25_REPEATED(msg, i));
+
+	ax25_putchar(ctx, msg->ctrl);
+	ax25_putchar(ctx, msg->pid);
+
+	for (size_t i = 0; i < msg->len; i++)
+		ax25_putchar(ctx, msg->info[i]);
+}
+#endif
+
 static void print_call(KFile *ch, const AX25Call *call)
 {
 	kfile_printf(ch, "%.6s", call->call);
@@ -283,6 +325,21 @@ void ax25_print(KFile *ch, const AX25Msg *msg)
 	kfile_printf(ch, ":%.*s\n", msg->len, msg->info);
 }
 
+/**
+ * Receive frames from a frame queue instead of reading the channel
+ * octet by octet.
+ *
+ * Frames are decoded in place: the info field of the AX25Msg passed to the
+ * hook points into the frame buffer and is only valid during the callback.
+ *
+ * \param ctx AX25 context to operate on.
+ * \param q Queue of received frames, see afsk_setRxFrames().
+ */
+void ax25_setRxFrames(AX25Ctx *ctx, HdlcFrameQueue *q)
+{
+	ctx->rxq = q;
+}
+
 /**
  * Init the AX25 protocol decoder.
  *
@@ -38,7 +38,7 @@
  *
  * $WIZ$ module_name = "ax25"
  * $WIZ$ module_configuration = "bertos/cfg/cfg_ax25.h"
- * $WIZ$ module_depends = "kfile"
+ * $WIZ$ module_depends = "kfile", "hdlc"
  */
 
 
@@ -49,6 +49,7 @@
 
 #include <cfg/compiler.h>
 #include <io/kfile.h>
+#include <net/hdlc.h>
 
 /**
  * Maximum size of a AX25 frame.
@@ -78,6 +79,7 @@ typedef struct AX25Ctx
 	KFile *ch;						  ///< KFile used to access the physical medium
 	size_t frm_len;				  ///< received frame length.
 	ax25_callback_t hook;		  ///< Hook function to be called when a message is received
+	HdlcFrameQueue *rxq;		  ///< Received frames, NULL to read octets from \a ch
 } AX25Ctx;
 
 
@@ -172,9 +174,14 @@ void ax25_sendVia(AX25Ctx *ctx, const AX25Call *path, size_t path_len, const voi
  */
 #define ax25_send(ctx, dst, src, buf, len) ax25_sendVia(ctx, ({static AX25Call __path[]={dst, src}; (AX25Call *)&__path;}), 2, buf, len)
 void ax25_init(AX25Ctx *ctx, KFile *channel, ax25_callback_t hook);
+void ax25_setRxFrames(AX25Ctx *ctx, HdlcFrameQueue *q);
 
 void ax25_print(KFile *ch, const AX25Msg *msg);
 
+#if CONFIG_AX25_RPT_LST
+void ax25_sendMsg(AX25Ctx *ctx, const AX25Msg *msg);
+#endif
+
 int ax25_testSetup(void);
 int ax25_testTearDown(void);
 int ax25_testRun(void);
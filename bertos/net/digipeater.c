@@ -0,0 +1,312 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief APRS/AX25 digipeater.
+ */
+
+#include "digipeater.h"
+
+#define LOG_LEVEL  DIGI_LOG_LEVEL
+#define LOG_FORMAT DIGI_LOG_FORMAT
+#include <cfg/log.h>
+
+#include <cfg/debug.h>
+
+#include <algo/crc_ccitt.h>
+
+#include <string.h>
+
+STATIC_ASSERT(CONFIG_DIGI_DUPE_ENTRIES <= 255);
+STATIC_ASSERT(CONFIG_DIGI_TXQUEUE_LEN <= 255);
+
+#define CALL_LEN  sizeof(((AX25Call *)0)->call)
+
+static const void *digi_dupeKey(const void *data, uint8_t *key_length)
+{
+	const DigiDupe *d = (const DigiDupe *)data;
+
+	*key_length = DIGI_DUPE_KEY_LEN;
+	return d->key;
+}
+
+static void digi_makeKey(uint8_t *key, const AX25Msg *msg)
+{
+	uint16_t crc = crc_ccitt(CRC_CCITT_INIT_VAL, msg->info, msg->len);
+
+	memcpy(key, msg->src.call, CALL_LEN);
+	key[6] = msg->src.ssid;
+	memcpy(key + 7, msg->dst.call, CALL_LEN);
+	key[13] = msg->dst.ssid;
+	key[14] = crc >> 8;
+	key[15] = crc & 0xFF;
+}
+
+/*
+ * Rebuild the cache index from the live entries.
+ *
+ * The hash table has no removal: recycled entries just change their key
+ * in place, leaving stale nodes behind. Rebuilding once per cache cycle
+ * keeps the table at most half full.
+ */
+static void digi_rehash(DigiCtx *ctx)
+{
+	ht_init(&ctx->ht);
+
+	for (int i = 0; i < CONFIG_DIGI_DUPE_ENTRIES; i++)
+		if (ctx->dupes[i].key[0])
+			ht_insert(&ctx->ht, &ctx->dupes[i]);
+}
+
+/*
+ * Look up a message in the duplicate cache and remember it.
+ *
+ * \return true if the message has been seen in the last
+ *         CONFIG_DIGI_DUPE_TIME milliseconds.
+ */
+static bool digi_isDupe(DigiCtx *ctx, const AX25Msg *msg)
+{
+	uint8_t key[DIGI_DUPE_KEY_LEN];
+	ticks_t now = timer_clock();
+
+	digi_makeKey(key, msg);
+
+	DigiDupe *d;
+	const DigiDupe *found = (const DigiDupe *)ht_find(&ctx->ht, key, sizeof(key));
+	if (found)
+	{
+		d = &ctx->dupes[found - ctx->dupes];
+		bool dupe = (now - d->stamp) < ms_to_ticks(CONFIG_DIGI_DUPE_TIME);
+		d->stamp = now;
+		return dupe;
+	}
+
+	d = &ctx->dupes[ctx->dupe_next];
+	memcpy(d->key, key, sizeof(key));
+	d->stamp = now;
+
+	if (++ctx->dupe_next >= CONFIG_DIGI_DUPE_ENTRIES)
+	{
+		ctx->dupe_next = 0;
+		digi_rehash(ctx);
+	}
+	else if (!ht_insert(&ctx->ht, d))
+		digi_rehash(ctx);
+
+	return false;
+}
+
+/* Compare a callsign with a NUL terminated string, ignoring the SSID */
+static bool digi_callIs(const AX25Call *call, const char *str)
+{
+	return strncmp(call->call, str, CALL_LEN) == 0
+		&& (strlen(str) >= CALL_LEN || call->call[strlen(str)] == '\0');
+}
+
+static bool digi_callEq(const AX25Call *a, const AX25Call *b)
+{
+	return a->ssid == b->ssid && strncmp(a->call, b->call, CALL_LEN) == 0;
+}
+
+/*
+ * Match a WIDEn-N like repeater against \a rule.
+ *
+ * \return the n of the alias, or 0 if the rule does not match.
+ */
+static int digi_matchWide(const AX25Call *rpt, const DigiRule *rule)
+{
+	size_t plen = strlen(rule->alias);
+
+	if (plen >= CALL_LEN || strncmp(rpt->call, rule->alias, plen) != 0)
+		return 0;
+
+	char n = rpt->call[plen];
+	if (n < '1' || n > '0' + rule->max_n)
+		return 0;
+	if (plen + 1 < CALL_LEN && rpt->call[plen + 1] != '\0')
+		return 0;
+	/* Reject WIDEn-0 and hop counts larger than n */
+	if (rpt->ssid == 0 || rpt->ssid > n - '0')
+		return 0;
+
+	return n - '0';
+}
+
+/*
+ * Rewrite the path of \a msg as needed to digipeat it.
+ *
+ * \return true if the message must be digipeated.
+ */
+static bool digi_rewrite(DigiCtx *ctx, AX25Msg *msg)
+{
+	int i;
+
+	/* Find the first hop still to be done */
+	for (i = 0; i < msg->rpt_cnt; i++)
+		if (!AX25_REPEATED(msg, i))
+			break;
+	if (i == msg->rpt_cnt)
+		return false;
+
+	AX25Call *rpt = &msg->rpt_lst[i];
+
+	if (digi_callEq(rpt, ctx->mycall))
+	{
+		msg->rpt_flags |= BV(i);
+		return true;
+	}
+
+	for (size_t r = 0; r < ctx->rules_cnt; r++)
+	{
+		const DigiRule *rule = &ctx->rules[r];
+
+		if (rule->type == DIGI_RULE_ALIAS)
+		{
+			if (!digi_callIs(rpt, rule->alias) || rpt->ssid != 0)
+				continue;
+
+			*rpt = *ctx->mycall;
+			msg->rpt_flags |= BV(i);
+			return true;
+		}
+
+		if (!digi_matchWide(rpt, rule))
+			continue;
+
+		if (--rpt->ssid == 0)
+			msg->rpt_flags |= BV(i);
+
+		/* Trace the path inserting our call before the hop, if there is room */
+		if (msg->rpt_cnt < AX25_MAX_RPT)
+		{
+			memmove(&msg->rpt_lst[i + 1], rpt, (msg->rpt_cnt - i) * sizeof(*rpt));
+			*rpt = *ctx->mycall;
+			/* Shift the flags of the following hops */
+			uint8_t low = msg->rpt_flags & (BV(i) - 1);
+			msg->rpt_flags = ((msg->rpt_flags & ~(BV(i) - 1)) << 1) | low | BV(i);
+			msg->rpt_cnt++;
+		}
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Examine a received message and queue it for transmission if it has
+ * to be digipeated.
+ *
+ * The message is copied, so it can be released as soon as this function
+ * returns; this is meant to be called from the AX25 message hook.
+ *
+ * \param ctx Digipeater context.
+ * \param msg Received message.
+ * \return true if the message has been queued.
+ */
+bool digi_handle(DigiCtx *ctx, const AX25Msg *msg)
+{
+	ctx->rx_cnt++;
+
+	/* Never digipeat our own frames */
+	if (digi_callEq(&msg->src, ctx->mycall))
+		return false;
+
+	/* Work on a copy: the queue slot may still be in use */
+	AX25Msg rw = *msg;
+	if (!digi_rewrite(ctx, &rw))
+		return false;
+
+	if (digi_isDupe(ctx, msg))
+	{
+		LOG_INFO("Dupe from %.6s-%d\n", msg->src.call, msg->src.ssid);
+		ctx->dupe_cnt++;
+		return false;
+	}
+
+	DigiFrame *f = &ctx->txq[ctx->tx_head];
+	if (ctx->tx_cnt >= CONFIG_DIGI_TXQUEUE_LEN || msg->len > sizeof(f->info))
+	{
+		LOG_WARN("Dropping frame from %.6s-%d\n", msg->src.call, msg->src.ssid);
+		ctx->drop_cnt++;
+		return false;
+	}
+
+	f->msg = rw;
+	memcpy(f->info, msg->info, msg->len);
+	f->msg.info = f->info;
+
+	ctx->tx_head = (ctx->tx_head + 1) % CONFIG_DIGI_TXQUEUE_LEN;
+	ctx->tx_cnt++;
+	ctx->digi_cnt++;
+	return true;
+}
+
+/**
+ * Transmit the queued messages.
+ */
+void digi_poll(DigiCtx *ctx)
+{
+	while (ctx->tx_cnt)
+	{
+		int tail = (ctx->tx_head + CONFIG_DIGI_TXQUEUE_LEN - ctx->tx_cnt) % CONFIG_DIGI_TXQUEUE_LEN;
+
+		ax25_sendMsg(ctx->ax25, &ctx->txq[tail].msg);
+		ctx->tx_cnt--;
+	}
+}
+
+/**
+ * Initialize a digipeater.
+ *
+ * \param ctx       Digipeater context.
+ * \param ax25      AX25 context used to transmit digipeated messages.
+ * \param mycall    Our callsign, used to trace the path.
+ * \param rules     Aliases we answer to, see DIGI_ALIAS() and DIGI_WIDEN().
+ * \param rules_cnt Number of rules.
+ */
+void digi_init(DigiCtx *ctx, AX25Ctx *ax25, const AX25Call *mycall, const DigiRule *rules, size_t rules_cnt)
+{
+	ASSERT(ctx);
+	ASSERT(ax25);
+	ASSERT(mycall);
+
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->ax25 = ax25;
+	ctx->mycall = mycall;
+	ctx->rules = rules;
+	ctx->rules_cnt = rules_cnt;
+
+	ctx->ht.mem = ctx->ht_nodes;
+	ctx->ht.max_elts_log2 = UINT32_LOG2(DIGI_HT_SIZE);
+	ctx->ht.flags.key_internal = false;
+	ctx->ht.key_data.hook = digi_dupeKey;
+	ht_init(&ctx->ht);
+}
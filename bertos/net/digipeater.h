@@ -0,0 +1,167 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \defgroup digipeater AX25 digipeater
+ * \ingroup net
+ * \{
+ *
+ * \brief APRS/AX25 digipeater.
+ *
+ * Received messages are passed to digi_handle(), usually from the
+ * AX25 message hook. The first repeater of the path not yet used is
+ * matched against our callsign and a list of rules: when one of them
+ * applies, the path is rewritten and the message is queued for
+ * transmission, unless the same message has already been digipeated
+ * recently. Queued messages are sent by digi_poll().
+ *
+ * Duplicates are found with a fixed size cache keyed on source,
+ * destination and a hash of the info field, looked up through a
+ * hash table so the cost does not depend on the cache size.
+ *
+ * \code
+ * static const DigiRule rules[] =
+ * {
+ *	DIGI_WIDEN("WIDE", 2),
+ *	DIGI_ALIAS("RELAY"),
+ * };
+ * static const AX25Call mycall = AX25_CALL("N0CALL", 10);
+ *
+ * digi_init(&digi, &ax25, &mycall, rules, countof(rules));
+ * \endcode
+ *
+ * $WIZ$ module_name = "digipeater"
+ * $WIZ$ module_configuration = "bertos/cfg/cfg_digipeater.h"
+ * $WIZ$ module_depends = "ax25", "hashtable", "crc-ccitt", "timer"
+ */
+
+#ifndef NET_DIGIPEATER_H
+#define NET_DIGIPEATER_H
+
+#include "cfg/cfg_digipeater.h"
+#include "cfg/cfg_ax25.h"
+
+#include <net/ax25.h>
+
+#include <drv/timer.h>
+
+#include <struct/hashtable.h>
+
+#include <cfg/compiler.h>
+#include <cfg/macros.h>
+
+#if !CONFIG_AX25_RPT_LST
+	#error The digipeater needs CONFIG_AX25_RPT_LST
+#endif
+
+/**
+ * \name Digipeating rule types.
+ * \{
+ */
+#define DIGI_RULE_ALIAS  0 ///< Replace a generic alias (eg. RELAY) with our call.
+#define DIGI_RULE_WIDEN  1 ///< New paradigm WIDEn-N: decrement N and insert our call.
+/* \} */
+
+/**
+ * A digipeating rule.
+ */
+typedef struct DigiRule
+{
+	const char *alias;  ///< Alias, or prefix of WIDEn-N aliases (eg. "WIDE").
+	uint8_t type;       ///< One of DIGI_RULE_*.
+	uint8_t max_n;      ///< Largest n accepted for WIDEn-N rules.
+} DigiRule;
+
+/// Declare a rule for a generic alias.
+#define DIGI_ALIAS(str)         { .alias = (str), .type = DIGI_RULE_ALIAS, .max_n = 0 }
+/// Declare a rule for WIDEn-N like aliases with n up to \a n.
+#define DIGI_WIDEN(prefix, n)   { .alias = (prefix), .type = DIGI_RULE_WIDEN, .max_n = (n) }
+
+/// Length of the key identifying a message in the duplicate cache.
+#define DIGI_DUPE_KEY_LEN  16
+
+/**
+ * Entry of the duplicate cache.
+ */
+typedef struct DigiDupe
+{
+	uint8_t key[DIGI_DUPE_KEY_LEN]; ///< Source, destination and info hash.
+	ticks_t stamp;                  ///< When the message was digipeated.
+} DigiDupe;
+
+/**
+ * A message waiting to be transmitted.
+ */
+typedef struct DigiFrame
+{
+	AX25Msg msg;                          ///< Rewritten message.
+	uint8_t info[CONFIG_DIGI_INFO_LEN];   ///< Copy of the info field.
+} DigiFrame;
+
+/// Hash table size: a power of two, large enough to never fill up.
+#define DIGI_HT_SIZE  (1 << UINT32_LOG2(CONFIG_DIGI_DUPE_ENTRIES * 4))
+
+/**
+ * Digipeater context.
+ */
+typedef struct DigiCtx
+{
+	AX25Ctx *ax25;                 ///< AX25 context used to transmit.
+	const AX25Call *mycall;        ///< Our callsign.
+	const DigiRule *rules;         ///< Digipeating rules.
+	size_t rules_cnt;              ///< Number of rules.
+
+	DigiDupe dupes[CONFIG_DIGI_DUPE_ENTRIES]; ///< Duplicate cache entries.
+	uint8_t dupe_next;             ///< Next entry to be recycled.
+	struct HashTable ht;           ///< Duplicate cache index.
+	const void *ht_nodes[DIGI_HT_SIZE];
+
+	DigiFrame txq[CONFIG_DIGI_TXQUEUE_LEN]; ///< Transmit queue.
+	uint8_t tx_head;               ///< Next free slot in the transmit queue.
+	uint8_t tx_cnt;                ///< Messages in the transmit queue.
+
+	uint32_t rx_cnt;               ///< Messages examined.
+	uint32_t digi_cnt;             ///< Messages queued for transmission.
+	uint32_t dupe_cnt;             ///< Messages dropped as duplicates.
+	uint32_t drop_cnt;             ///< Messages dropped because the queue was full.
+} DigiCtx;
+
+void digi_init(DigiCtx *ctx, AX25Ctx *ax25, const AX25Call *mycall, const DigiRule *rules, size_t rules_cnt);
+bool digi_handle(DigiCtx *ctx, const AX25Msg *msg);
+void digi_poll(DigiCtx *ctx);
+
+int digipeater_testSetup(void);
+int digipeater_testRun(void);
+int digipeater_testTearDown(void);
+
+/** \} */ //defgroup digipeater
+
+#endif /* NET_DIGIPEATER_H */
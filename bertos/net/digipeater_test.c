@@ -0,0 +1,327 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief AX25 digipeater test.
+ *
+ * $test$: cp bertos/cfg/cfg_digipeater.h $cfgdir/
+ * $test$: echo "#undef CONFIG_DIGI_DUPE_TIME" >> $cfgdir/cfg_digipeater.h
+ * $test$: echo "#define CONFIG_DIGI_DUPE_TIME 100" >> $cfgdir/cfg_digipeater.h
+ */
+
+#include "digipeater.h"
+#include "afsk.h"
+#include "hdlc.h"
+
+#include <struct/kfile_mem.h>
+
+#include <drv/timer.h>
+
+#include <cfg/debug.h>
+#include <cfg/test.h>
+
+#include <cpu/byteorder.h>
+
+#include <stdio.h>
+#include <string.h>
+
+static DigiCtx digi;
+static AX25Ctx rx, tx, enc;
+static HdlcFrame rx_frames[4];
+static HdlcFrameQueue rxq;
+
+static uint8_t tx_buf[CONFIG_HDLC_FRAME_LEN];
+static KFileMem tx_mem;
+static uint8_t enc_buf[CONFIG_HDLC_FRAME_LEN];
+static KFileMem enc_mem;
+
+static const AX25Call mycall = AX25_CALL("N0CALL", 10);
+static const DigiRule rules[] =
+{
+	DIGI_WIDEN("WIDE", 2),
+	DIGI_ALIAS("RELAY"),
+};
+
+/* Last message digipeated, decoded back from the transmitter output */
+static AX25Msg out;
+static uint8_t out_info[CONFIG_DIGI_INFO_LEN];
+static int out_cnt;
+
+static void digi_hook(AX25Msg *msg)
+{
+	digi_handle(&digi, msg);
+}
+
+static void out_hook(AX25Msg *msg)
+{
+	out = *msg;
+	memcpy(out_info, msg->info, msg->len);
+	out.info = out_info;
+	out_cnt++;
+}
+
+/* Queue a frame as if it had just been received by the modem */
+static void rx_frame(const uint8_t *buf, size_t len)
+{
+	HdlcFrame *f = &rxq.frames[rxq.head];
+
+	ASSERT(len <= sizeof(f->buf));
+	memcpy(f->buf, buf, len);
+	f->len = len;
+	rxq.head = (rxq.head + 1 == rxq.count) ? 0 : rxq.head + 1;
+	ASSERT(rxq.head != rxq.tail);
+}
+
+/* Send the queued messages and decode them back in out */
+static void digi_flush(void)
+{
+	kfile_seek(&tx_mem.fd, 0, KSM_SEEK_SET);
+	digi_poll(&digi);
+
+	size_t len = tx_mem.fd.seek_pos;
+	if (!len)
+		return;
+
+	rx.hook = out_hook;
+	rx_frame(tx_buf, len);
+	ax25_poll(&rx);
+	rx.hook = digi_hook;
+}
+
+/*
+ * Receive a message sent through \a path, then transmit what the
+ * digipeater queued.
+ *
+ * \return true if the message has been digipeated.
+ */
+static bool digi_roundtrip(const AX25Call *path, size_t path_len, const char *info)
+{
+	int cnt = out_cnt;
+
+	kfile_seek(&enc_mem.fd, 0, KSM_SEEK_SET);
+	ax25_sendVia(&enc, path, path_len, info, strlen(info));
+	rx_frame(enc_buf, enc_mem.fd.seek_pos);
+	ax25_poll(&rx);
+	digi_flush();
+
+	return out_cnt != cnt;
+}
+
+static void check_rpt(int idx, const char *call, uint8_t ssid, bool repeated)
+{
+	ASSERT(idx < out.rpt_cnt);
+	ASSERT(strncmp(out.rpt_lst[idx].call, call, 6) == 0);
+	ASSERT(out.rpt_lst[idx].ssid == ssid);
+	ASSERT(!AX25_REPEATED(&out, idx) == !repeated);
+}
+
+static void digipeater_testRules(void)
+{
+	AX25Call wide22[] = AX25_PATH(AX25_CALL("APRS", 0), AX25_CALL("N1AAA", 0), AX25_CALL("WIDE2", 2));
+	ASSERT(digi_roundtrip(wide22, countof(wide22), "wide2-2"));
+	ASSERT(out.rpt_cnt == 2);
+	check_rpt(0, "N0CALL", 10, true);
+	check_rpt(1, "WIDE2", 1, false);
+	ASSERT(out.len == 7 && memcmp(out.info, "wide2-2", 7) == 0);
+
+	/* Second hop: WIDE2-1 is used up */
+	AX25Call wide21[] = AX25_PATH(AX25_CALL("APRS", 0), AX25_CALL("N1AAA", 0),
+		AX25_CALL("N2BBB", 0), AX25_CALL("WIDE2", 1));
+	ASSERT(digi_roundtrip(wide21, 3, "wide2-1") == false);
+	ASSERT(digi_roundtrip(wide21, countof(wide21), "wide2-1") == false);
+
+	AX25Call wide11[] = AX25_PATH(AX25_CALL("APRS", 0), AX25_CALL("N1AAA", 0),
+		AX25_CALL("WIDE1", 1), AX25_CALL("WIDE2", 1));
+	ASSERT(digi_roundtrip(wide11, countof(wide11), "wide1-1"));
+	ASSERT(out.rpt_cnt == 3);
+	check_rpt(0, "N0CALL", 10, true);
+	check_rpt(1, "WIDE1", 0, true);
+	check_rpt(2, "WIDE2", 1, false);
+
+	AX25Call relay[] = AX25_PATH(AX25_CALL("APRS", 0), AX25_CALL("N1AAA", 0), AX25_CALL("RELAY", 0));
+	ASSERT(digi_roundtrip(relay, countof(relay), "relay"));
+	ASSERT(out.rpt_cnt == 1);
+	check_rpt(0, "N0CALL", 10, true);
+
+	/* Hop counts larger than n and unknown aliases are not digipeated */
+	AX25Call wide33[] = AX25_PATH(AX25_CALL("APRS", 0), AX25_CALL("N1AAA", 0), AX25_CALL("WIDE3", 3));
+	ASSERT(!digi_roundtrip(wide33, countof(wide33), "wide3-3"));
+	AX25Call wide23[] = AX25_PATH(AX25_CALL("APRS", 0), AX25_CALL("N1AAA", 0), AX25_CALL("WIDE2", 3));
+	ASSERT(!digi_roundtrip(wide23, countof(wide23), "wide2-3"));
+	AX25Call trace[] = AX25_PATH(AX25_CALL("APRS", 0), AX25_CALL("N1AAA", 0), AX25_CALL("TRACE", 0));
+	ASSERT(!digi_roundtrip(trace, countof(trace), "trace"));
+
+	/* Our own frames are never digipeated */
+	AX25Call own[] = AX25_PATH(AX25_CALL("APRS", 0), AX25_CALL("N0CALL", 10), AX25_CALL("WIDE1", 1));
+	ASSERT(!digi_roundtrip(own, countof(own), "own"));
+	ASSERT(digi.drop_cnt == 0);
+}
+
+static void digipeater_testDupes(void)
+{
+	AX25Call path[] = AX25_PATH(AX25_CALL("APRS", 0), AX25_CALL("N1AAA", 0), AX25_CALL("WIDE1", 1));
+	AX25Call other[] = AX25_PATH(AX25_CALL("APRS", 0), AX25_CALL("N1AAA", 0), AX25_CALL("RELAY", 0));
+	uint32_t dupes = digi.dupe_cnt;
+
+	ASSERT(digi_roundtrip(path, countof(path), "dupe"));
+	/* The same message heard again through another path */
+	ASSERT(!digi_roundtrip(other, countof(other), "dupe"));
+	ASSERT(digi.dupe_cnt == dupes + 1);
+	ASSERT(digi_roundtrip(path, countof(path), "not a dupe"));
+
+	/* Fill the whole cache, then check the index is still consistent */
+	for (int i = 0; i < CONFIG_DIGI_DUPE_ENTRIES * 3; i++)
+	{
+		char info[16];
+		sprintf(info, "msg %d", i);
+		ASSERT(digi_roundtrip(path, countof(path), info));
+		ASSERT(!digi_roundtrip(path, countof(path), info));
+	}
+
+	/* Forgotten after CONFIG_DIGI_DUPE_TIME */
+	ASSERT(digi_roundtrip(path, countof(path), "expired"));
+	ASSERT(!digi_roundtrip(path, countof(path), "expired"));
+	timer_delay(CONFIG_DIGI_DUPE_TIME + 10);
+	ASSERT(digi_roundtrip(path, countof(path), "expired"));
+}
+
+/* Frames received from the AFSK test recording */
+static HdlcFrame corpus[32];
+static int corpus_cnt;
+
+static void digipeater_loadCorpus(void)
+{
+	static int8_t samples[200000];
+	static Afsk afsk;
+	uint32_t hdr[6];
+
+	FILE *fp = fopen("test/afsk_test.au", "rb");
+	ASSERT(fp);
+	ASSERT(fread(hdr, 1, sizeof(hdr), fp) == sizeof(hdr));
+	ASSERT(fseek(fp, be32_to_cpu(hdr[1]), SEEK_SET) == 0);
+	size_t n = fread(samples, 1, sizeof(samples), fp);
+	ASSERT(n > 0 && n < sizeof(samples));
+	fclose(fp);
+
+	afsk_init(&afsk, 0, 0);
+	afsk_setRxFrames(&afsk, rx_frames, countof(rx_frames));
+
+	for (size_t i = 0; i < n; i++)
+	{
+		HdlcFrame *f;
+
+		afsk_adc_isr(&afsk, samples[i]);
+		while ((f = hdlc_frameGet(&afsk.rx_frames)))
+		{
+			if (corpus_cnt < (int)countof(corpus))
+				corpus[corpus_cnt++] = *f;
+			hdlc_frameRelease(&afsk.rx_frames);
+		}
+	}
+	kprintf("Corpus: %d frames\n", corpus_cnt);
+	ASSERT(corpus_cnt >= 15);
+}
+
+/*
+ * Replay the recorded frames through the receive path and the
+ * digipeater, measuring the throughput and the duplicate hit rate.
+ */
+static void digipeater_benchmark(void)
+{
+	/* The recording was made on a network using TRACEn-N and WIDEn-N up to 7 hops */
+	static const DigiRule bench_rules[] =
+	{
+		DIGI_WIDEN("WIDE", 7),
+		DIGI_WIDEN("TRACE", 7),
+	};
+	ticks_t t;
+	uint32_t frames = 0;
+
+	digipeater_loadCorpus();
+	hdlc_frameQueueInit(&rxq, rx_frames, countof(rx_frames));
+	digi_init(&digi, &tx, &mycall, bench_rules, countof(bench_rules));
+
+	t = timer_clock();
+	while (timer_clock() - t < ms_to_ticks(500))
+	{
+		for (int i = 0; i < corpus_cnt; i++)
+		{
+			rx_frame(corpus[i].buf, corpus[i].len);
+			ax25_poll(&rx);
+			kfile_seek(&tx_mem.fd, 0, KSM_SEEK_SET);
+			digi_poll(&digi);
+		}
+		frames += corpus_cnt;
+	}
+	t = timer_clock() - t;
+
+	kprintf("Replay: %lu frames in %lu ms, %lu frames/s\n", (unsigned long)frames,
+		(unsigned long)ticks_to_ms(t), (unsigned long)(frames * 1000 / ticks_to_ms(t)));
+	uint32_t candidates = digi.dupe_cnt + digi.digi_cnt + digi.drop_cnt;
+	kprintf("Digipeated %lu, dupes %lu (%lu%% of candidates), dropped %lu\n",
+		(unsigned long)digi.digi_cnt, (unsigned long)digi.dupe_cnt,
+		(unsigned long)(candidates ? digi.dupe_cnt * 100 / candidates : 0),
+		(unsigned long)digi.drop_cnt);
+	ASSERT(digi.rx_cnt == frames);
+	ASSERT(digi.digi_cnt > 0);
+}
+
+int digipeater_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+
+	kfilemem_init(&tx_mem, tx_buf, sizeof(tx_buf));
+	kfilemem_init(&enc_mem, enc_buf, sizeof(enc_buf));
+	ax25_init(&tx, &tx_mem.fd, NULL);
+	ax25_init(&enc, &enc_mem.fd, NULL);
+	ax25_init(&rx, &enc_mem.fd, digi_hook);
+
+	hdlc_frameQueueInit(&rxq, rx_frames, countof(rx_frames));
+	ax25_setRxFrames(&rx, &rxq);
+	digi_init(&digi, &tx, &mycall, rules, countof(rules));
+	return 0;
+}
+
+int digipeater_testRun(void)
+{
+	digipeater_testRules();
+	digipeater_testDupes();
+	digipeater_benchmark();
+	return 0;
+}
+
+int digipeater_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(digipeater);
@@ -43,78 +43,33 @@
 #include <cfg/macros.h>
 #include "cfg/cfg_afsk.h"
 
+#include <algo/crc_ccitt.h>
 
-/** Store a bit into the CRC
- * \param hdlc HDLC context.
- * \param lsb_int  bit to be stored.
-*/
-static void hdlccrcBit (Hdlc * hdlc, bool lsb_int)
-{
-	uint16_t last_bit;
-
-	last_bit = hdlc->crc ^ lsb_int; // XOR lsb of CRC with the latest bit
-	hdlc->crc >>= 1;                // Shift 16-bit CRC one bit to the right
-
-	if (last_bit & 0x0001)          // If XOR result from above has lsb set
-		hdlc->crc ^= 0x8408;         // mix in the polynomial
-
-}
-
-
-/** Store a bit into the current byte. Calculate CRC on the bit
- * When byte is full, and we are in a frame, put it in the fifo
- * \param hdlc HDLC context.
- * \param bit  bit to be stored.
- * \param fifo FIFO buffer used to push characters to.
-*/
-static int hdlc_store_bit (Hdlc * hdlc, bool bit, FIFOBuffer * fifo)
-{
-
-
-	hdlc->this_byte >>= 1;
-	hdlc->this_byte |= bit ? 0x80 : 0;
-	hdlc->bit_idx++;
-	hdlccrcBit (hdlc, bit);
+#include <string.h> /* memset */
 
-	if (hdlc->bit_idx >= 8)
-	{
-		hdlc->bit_idx = 0;
 
-		// if last octet was a flag then this is real data
-		if (hdlc->state == RX_WAIT_DATA)
-			hdlc->state = RX_IN_FRAME;
-
-		// only pass data up to app if in a frame
-		if (hdlc->state == RX_IN_FRAME)
-		{
-			// filled a byte, add to message in the queue
-			if (fifo_isfull (fifo))
-			{
-				return HDLC_ERROR_OVERRUN;
-			}
-			fifo_push (fifo, hdlc->this_byte);
-		}
-	}
-	return HDLC_ERROR_NONE;
-}
+/*
+ * Events reported by hdlc_rxBit().
+ */
+#define RX_EV_NONE   0   ///< nothing to do
+#define RX_EV_BYTE   1   ///< hdlc->this_byte is a new octet of the current frame
+#define RX_EV_FLAG   2   ///< flag received, hdlc->state tells if it closes a frame
+#define RX_EV_ABORT  3   ///< abort sequence received
 
 
 /**
- * High-Level Data Link Control decoding function.
- * Parse bitstream in order to find characters.
+ * Bit level receiver shared by the stream and the frame decoders.
+ * Undo the NRZI coding and the bit stuffing, then assemble octets.
  *
  * \param hdlc HDLC context.
  * \param bit  current bit to be parsed.
- * \param fifo FIFO buffer used to push characters.
  *
- * \return int current status
+ * \return one of the RX_EV_* events.
  */
-int hdlc_decode (Hdlc * hdlc, bool bit, FIFOBuffer * fifo)
+INLINE int hdlc_rxBit (Hdlc * hdlc, bool bit)
 {
-	int ret = HDLC_ERROR_NONE;
 	bool this_bit;
 
-
 	// if bit has changed from last bit then its a zero, else its a one
 	if ((bit ^ hdlc->last_bit) & 0x01)
 		this_bit = 0;
@@ -140,61 +95,214 @@ int hdlc_decode (Hdlc * hdlc, bool bit, FIFOBuffer * fifo)
 			hdlc->state = RX_WAIT_FLAG;
 			hdlc->crc = 0xffff;
 			hdlc->bit_idx = 0;
-			fifo_flush (fifo);
 			hdlc->ones_count = 0;
-			return HDLC_ERROR_ABORT;
+			return RX_EV_ABORT;
 		}
 		else if (hdlc->ones_count == 6)
 		{
 			hdlc->ones_count = 0;
-			// flag - if in frame then its the end of the frame so check CRC
-			if (hdlc->state == RX_IN_FRAME)
-			{
+			return RX_EV_FLAG;
+		}
+		else if (hdlc->ones_count == 5)
+		{
+			// was bit stuffing
+			// just clear count and throw bit away - its not part of the CRC
+			hdlc->ones_count = 0;
+			return RX_EV_NONE;
+		}
+		else
+		// its a real '0' so store it (and add to CRC)
+		hdlc->ones_count = 0;
+	}
+
+	// store the bit into the current byte
+	hdlc->this_byte >>= 1;
+	hdlc->this_byte |= this_bit ? 0x80 : 0;
+	hdlc->bit_idx++;
+
+	if (hdlc->bit_idx >= 8)
+	{
+		hdlc->bit_idx = 0;
+
+		// if last octet was a flag then this is real data
+		if (hdlc->state == RX_WAIT_DATA)
+			hdlc->state = RX_IN_FRAME;
+
+		// only pass data up to app if in a frame
+		if (hdlc->state == RX_IN_FRAME)
+			return RX_EV_BYTE;
+	}
+	return RX_EV_NONE;
+}
+
+/*
+ * A flag has been received: it's (maybe) an opening flag,
+ * clear CRC and bit counter ready for frame.
+ */
+INLINE void hdlc_rxFlag (Hdlc * hdlc)
+{
+	hdlc->state = RX_WAIT_DATA;
+	hdlc->crc = 0xffff;
+	hdlc->bit_idx = 0;
+}
+
+
+/**
+ * High-Level Data Link Control decoding function.
+ * Parse bitstream in order to find characters.
+ *
+ * \param hdlc HDLC context.
+ * \param bit  current bit to be parsed.
+ * \param fifo FIFO buffer used to push characters.
+ *
+ * \return int current status
+ */
+int hdlc_decode (Hdlc * hdlc, bool bit, FIFOBuffer * fifo)
+{
+	int ret = HDLC_ERROR_NONE;
+
+	switch (hdlc_rxBit (hdlc, bit))
+	{
+	case RX_EV_BYTE:
+		// filled a byte, add to message in the queue
+		if (fifo_isfull (fifo))
+			return HDLC_ERROR_OVERRUN;
+		hdlc->crc = updcrc_ccitt (hdlc->this_byte, hdlc->crc);
+		fifo_push (fifo, hdlc->this_byte);
+		break;
+
+	case RX_EV_FLAG:
+		// flag - if in frame then its the end of the frame so check CRC
+		if (hdlc->state == RX_IN_FRAME)
+		{
 /*
 // note: when the crc is included in the message, the valid crc is:
 //	  0xF0B8, before the compliment and byte swap,
 //	  0x0F47, after compliment, before the byte swap,
 //	  0x470F, after the compliment and the byte swap.
-//   0x4f85 if the first 7 bits of the trailing flag are included in the CRC already!!
+// the CRC is updated a whole byte at a time so the trailing flag never gets into it
 */
-				if (hdlc->crc == HDLC_GOOD_CRC)
+			if (hdlc->crc == HDLC_GOOD_CRC)
+			{
+				// crc OK
+				ret = HDLC_PKT_AVAILABLE;
+			}
+			else
+			{
+				fifo_flush (fifo);
+				ret = HDLC_ERROR_CRC;
+			}
+		}
+		// not in a frame, just another flag!!
+		else
+		{
+			fifo_flush (fifo);
+		}
+		hdlc_rxFlag (hdlc);
+		break;
+
+	case RX_EV_ABORT:
+		fifo_flush (fifo);
+		ret = HDLC_ERROR_ABORT;
+		break;
+	}
+
+	return ret;
+}
+
+
+/**
+ * Initialise a queue of received frames.
+ *
+ * \param q      Frame queue.
+ * \param frames Frame buffers, owned by the queue from now on.
+ * \param count  Number of buffers in \a frames, at least 2:
+ *               one is always being filled by the decoder.
+ */
+void hdlc_frameQueueInit (HdlcFrameQueue * q, HdlcFrame * frames, uint8_t count)
+{
+	ASSERT (count >= 2);
+
+	memset (q, 0, sizeof (*q));
+	q->count = count;
+	q->frames = frames;
+	frames[0].len = 0;
+}
+
+
+/**
+ * High-Level Data Link Control frame decoding function.
+ *
+ * Like hdlc_decode(), but octets are stored straight into the frame
+ * buffer at the head of \a q. When the closing flag is received and
+ * the FCS is correct, the frame is published to the consumer by
+ * advancing the head of the queue; broken frames are discarded and
+ * only accounted in the queue statistics.
+ *
+ * \param hdlc HDLC context.
+ * \param bit  current bit to be parsed.
+ * \param q    frame queue to fill.
+ *
+ * \return int current status
+ */
+int hdlc_decodeFrame (Hdlc * hdlc, bool bit, HdlcFrameQueue * q)
+{
+	HdlcFrame *frm = &q->frames[q->head];
+	int ret = HDLC_ERROR_NONE;
+
+	switch (hdlc_rxBit (hdlc, bit))
+	{
+	case RX_EV_BYTE:
+		if (frm->len >= sizeof (frm->buf))
+		{
+			// too long, drop it and wait for the next frame
+			hdlc->state = RX_WAIT_FLAG;
+			frm->len = 0;
+			q->overruns++;
+			return HDLC_ERROR_OVERRUN;
+		}
+		hdlc->crc = updcrc_ccitt (hdlc->this_byte, hdlc->crc);
+		frm->buf[frm->len++] = hdlc->this_byte;
+		break;
+
+	case RX_EV_FLAG:
+		if (hdlc->state == RX_IN_FRAME)
+		{
+			if (hdlc->crc == HDLC_GOOD_CRC && frm->len > HDLC_FCS_LEN)
+			{
+				uint8_t next = (q->head + 1 == q->count) ? 0 : q->head + 1;
+
+				if (next == q->tail)
 				{
-					// crc OK
-					ret = HDLC_PKT_AVAILABLE;
+					// consumer too slow, no buffer to receive into
+					q->overruns++;
+					ret = HDLC_ERROR_OVERRUN;
 				}
 				else
 				{
-					fifo_flush (fifo);
-					ret = HDLC_ERROR_CRC;
+					frm->len -= HDLC_FCS_LEN;
+					// frame contents must be visible before the new head
+					MEMORY_BARRIER;
+					q->head = next;
+					frm = &q->frames[next];
+					ret = HDLC_PKT_AVAILABLE;
 				}
 			}
-			// not in a frame, just another flag!!
 			else
 			{
-				fifo_flush (fifo);
-				ret = HDLC_ERROR_NONE;
+				q->crc_errors++;
+				ret = HDLC_ERROR_CRC;
 			}
-
-			hdlc->state = RX_WAIT_DATA;
-			// its (maybe) an opening flag
-			// clear CRC and bit counter ready for frame
-			hdlc->crc = 0xffff;
-			hdlc->bit_idx = 0;
-			hdlc->ones_count = 0;
-			return ret;
 		}
-		else if (hdlc->ones_count == 5)
-		{
-			// was bit stuffing
-			// just clear count and throw bit away - its not part of the CRC
-			hdlc->ones_count = 0;
-			return ret;
-		}
-		else
-		// its a real '0' so store it (and add to CRC)
-		hdlc->ones_count = 0;
+		frm->len = 0;
+		hdlc_rxFlag (hdlc);
+		break;
+
+	case RX_EV_ABORT:
+		frm->len = 0;
+		ret = HDLC_ERROR_ABORT;
+		break;
 	}
-	ret = hdlc_store_bit (hdlc, this_bit, fifo);
 
 	return ret;
 }
@@ -238,7 +346,7 @@ int hdlc_encode (Hdlc * hdlc, FIFOBuffer * fifo)
 				if (--hdlc->flag_count == 0)
 				{
 					hdlc->this_byte = fifo_pop (fifo);
-					hdlc->crc = 0xffff;
+					hdlc->crc = updcrc_ccitt (hdlc->this_byte, CRC_CCITT_INIT_VAL);
 					hdlc->bit_idx = 0;
 					hdlc->ones_count = 0;
 					hdlc->state = TX_IN_FRAME;
@@ -259,6 +367,7 @@ int hdlc_encode (Hdlc * hdlc, FIFOBuffer * fifo)
 				else
 				{
 					hdlc->this_byte = fifo_pop (fifo);
+					hdlc->crc = updcrc_ccitt (hdlc->this_byte, hdlc->crc);
 				}
 				break;
 			case TX_CRC_LO:
@@ -296,8 +405,6 @@ int hdlc_encode (Hdlc * hdlc, FIFOBuffer * fifo)
 			hdlc->ones_count++;
 		hdlc->this_byte >>= 1;
 		hdlc->bit_idx++;
-		// a bit stuffed zero doesn't update the CRC but all other bits do!
-		hdlccrcBit (hdlc, data);
 	}
 
 	// NRZI coding - to send a 1 we return the same value as last time
@@ -37,13 +37,18 @@
  *
  * \author Robin Gilks <g8ecj@gilks.org>
  * $WIZ$ module_name = "hdlc"
- * $WIZ$ module_depends = "kfile"
+ * $WIZ$ module_configuration = "bertos/cfg/cfg_hdlc.h"
+ * $WIZ$ module_depends = "kfile", "crc-ccitt"
  */
 
 #ifndef NET_HDLC_H
 #define NET_HDLC_H
 
-#include <stdbool.h>
+#include "cfg/cfg_hdlc.h"
+
+#include <cfg/compiler.h>
+#include <cfg/debug.h>
+
 #include <struct/fifobuf.h>
 
 
@@ -87,12 +92,75 @@ typedef struct Hdlc
 #define HDLC_ERROR_ABORT   3
 #define HDLC_PKT_AVAILABLE 4
 
-// this is an odd value because we process the hdlc data as a stream and we
-// don't see the closing flag until we have already put 7 bits of it into the CRC
-#define HDLC_GOOD_CRC   0x4f85
+// residue of the CRC-CCITT computed over a frame including its FCS
+#define HDLC_GOOD_CRC   0xf0b8
+
+
+/// length of the frame check sequence trailing each frame
+#define HDLC_FCS_LEN    2
 
 
+/**
+ * Buffer for a received frame.
+ */
+typedef struct HdlcFrame
+{
+	uint16_t len;                               ///< frame length, FCS excluded
+	uint8_t buf[CONFIG_HDLC_FRAME_LEN];         ///< frame contents
+} HdlcFrame;
+
+/**
+ * Queue of received frames.
+ *
+ * The decoder (usually running in interrupt context) fills the
+ * frame at the head of the queue in place, and publishes it when
+ * its FCS has been checked. The consumer processes the frames
+ * in place as well, then releases them: no octet is ever copied
+ * and no lock is needed with a single producer and a single consumer.
+ */
+typedef struct HdlcFrameQueue
+{
+	HdlcFrame *frames;           ///< frame buffers
+	uint8_t count;               ///< number of frame buffers
+	volatile uint8_t head;       ///< frame being filled by the decoder
+	volatile uint8_t tail;       ///< oldest frame not yet released by the consumer
+	uint16_t crc_errors;         ///< frames discarded because of a bad FCS
+	uint16_t overruns;           ///< frames discarded because too long or no buffer available
+} HdlcFrameQueue;
+
+/**
+ * Return the oldest received frame, or NULL if none is available.
+ * The frame stays valid until hdlc_frameRelease() is called.
+ */
+INLINE HdlcFrame *hdlc_frameGet (HdlcFrameQueue * q)
+{
+	if (q->tail == q->head)
+		return NULL;
+	MEMORY_BARRIER;
+	return &q->frames[q->tail];
+}
+
+/**
+ * Give the frame returned by hdlc_frameGet() back to the decoder.
+ */
+INLINE void hdlc_frameRelease (HdlcFrameQueue * q)
+{
+	ASSERT (q->tail != q->head);
+	MEMORY_BARRIER;
+	q->tail = (q->tail + 1 == q->count) ? 0 : q->tail + 1;
+}
+
+/**
+ * Return true if the decoder is in the middle of a frame.
+ */
+INLINE bool hdlc_frameRxBusy (const HdlcFrameQueue * q)
+{
+	return q->frames[q->head].len != 0;
+}
+
 int hdlc_decode (Hdlc * hdlc, bool bit, FIFOBuffer * fifo);
+void hdlc_frameQueueInit (HdlcFrameQueue * q, HdlcFrame * frames, uint8_t count);
+int hdlc_decodeFrame (Hdlc * hdlc, bool bit, HdlcFrameQueue * q);
 int hdlc_encode (Hdlc * hdlc, FIFOBuffer * fifo);
 void hdlc_head (Hdlc * hdlc, uint8_t head, uint16_t bitrate);
 void hdlc_tail (Hdlc * hdlc, uint8_t tail, uint16_t bitrate);
@@ -39,6 +39,11 @@
  * Quering from browser the /status page, the server return a json dictionary where are store
  * some board status info, like board temperature, up-time, etc.
  *
+ * Pages that never change can be built into the firmware with
+ * http_mkassets.py and registered with http_setAssets(): they are served
+ * straight from memory, compressed when the client allows it, and
+ * conditional requests are answered with 304 Not Modified.
+ *
  * notest: avr
  */
 
@@ -54,6 +59,15 @@
 #define LOG_VERBOSITY     HTTP_LOG_FORMAT
 #include <cfg/log.h>
 
+#include <lwip/tcp.h>
+
+#if CONFIG_HTTP_WORKERS
+	#include <kern/proc.h>
+	#include <kern/signal.h>
+#endif
+
+#include <ctype.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -70,13 +84,63 @@ static struct {	const char *key; const char *content; } http_content_type[] =
 	{"txt", "Content-type: text/plain\r\n\r\n"},
 };
 
-static const char http_html_hdr_200[] = "HTTP/1.0 200 OK\r\n";
-static const char http_html_hdr_404[] = "HTTP/1.0 404 Not Found\r\n";
-static const char http_html_hdr_500[] = "HTTP/1.0 500 Internal Server Error\r\n";
+static const char http_ver_10[] = "HTTP/1.0 ";
+static const char http_ver_11[] = "HTTP/1.1 ";
+
+static const struct { int code; const char *line; } http_status[] =
+{
+	{ 200, "200 OK\r\n" },
+	{ 304, "304 Not Modified\r\n" },
+	{ 404, "404 Not Found\r\n" },
+	{ 500, "500 Internal Server Error\r\n" },
+};
+
+static const char http_conn_close[] = "Connection: close\r\n";
+static const char http_conn_keepalive[] = "Connection: keep-alive\r\n";
+static const char http_chunked[] = "Transfer-Encoding: chunked\r\n";
+static const char http_last_chunk[] = "0\r\n\r\n";
+/* Sent instead of a header that does not fit in HTTP_HDR_LEN */
+static const char http_hdr_overflow[] =
+	"HTTP/1.0 500 Internal Server Error\r\nConnection: close\r\n\r\n";
+
+/* Longest status line plus the optional fields and the content type */
+#define HTTP_HDR_LEN      256
+/* Length of a header that did not fit in the buffer */
+#define HTTP_HDR_FULL     (HTTP_HDR_LEN + 1)
+/* Chunks up to this size are sent with their framing in a single write */
+#define HTTP_CHUNK_MERGE  128
+
+/* Persistent connections need a worker per client and an idle timeout */
+#define HTTP_KEEPALIVE    (CONFIG_HTTP_WORKERS > 0 && LWIP_SO_RCVTIMEO)
+#define HTTP_CLIENTS      (CONFIG_HTTP_WORKERS > 0 ? CONFIG_HTTP_WORKERS : 1)
+
+/* HttpClient flags */
+#define HC_HTTP11     BV(0)  ///< The client speaks HTTP/1.1.
+#define HC_KEEPALIVE  BV(1)  ///< Keep the connection open after the response.
+#define HC_CHUNKED    BV(2)  ///< The response body is chunk encoded.
+#define HC_REPLIED    BV(3)  ///< Response header sent with http_sendHeader().
+#define HC_ERROR      BV(4)  ///< A write failed, close the connection.
 
+/**
+ * State of a client connection.
+ */
+typedef struct HttpClient
+{
+	struct netconn *conn;           ///< Connection being served, NULL if idle.
+#if CONFIG_HTTP_WORKERS
+	struct Process *proc;           ///< Worker serving this connection.
+#endif
+	size_t len;                     ///< Bytes received in req.
+	size_t req_len;                 ///< Length of the request being served.
+	uint8_t flags;                  ///< HC_* flags of the request being served.
+	char name[80];                  ///< Requested page name.
+	char req[CONFIG_HTTP_REQ_LEN];  ///< Request, followed by pipelined data.
+} HttpClient;
+
+static HttpClient http_clients[HTTP_CLIENTS];
 static HttpCGI *cgi_table;
 static http_handler_t http_callback;
-static char decoded_str[80];
+static const HttpAssetTable *http_assets;
 
 /**
  * Get key value from tokenized buffer
@@ -88,6 +152,7 @@ int http_getValue(char *tolenized_buf, size_t tolenized_buf_len, const char *key
 
 	char *p = tolenized_buf;
 	size_t value_len = 0;
+	char decoded_str[80];
 
 	memset(value, 0, len);
 
@@ -194,11 +259,16 @@ void http_getPageName(const char *recv_buf, size_t recv_len, char *page_name, si
 	const char *p = recv_buf;
 	if (p && (recv_len > sizeof("GET /")))
 	{
-		if (*p++ == 'G' && *p++ == 'E' && *p++ == 'T')
+		if (!strncmp(p, "GET", 3))
 		{
 			str_ok = true;
 			/* skip the space and "/" */
-			p += 2;
+			p += 5;
+		}
+		else if (recv_len > sizeof("POST /") && !strncmp(p, "POST", 4))
+		{
+			str_ok = true;
+			p += 6;
 		}
 	}
 
@@ -251,17 +321,255 @@ int http_searchContentType(const char *name)
 }
 
 
+static bool http_matchNoCase(const char *s, const char *word, size_t len)
+{
+	while (len--)
+		if (tolower((unsigned char)*s++) != tolower((unsigned char)*word++))
+			return false;
+
+	return true;
+}
+
+static bool http_hasToken(const char *value, size_t value_len, const char *token)
+{
+	size_t len = strlen(token);
+
+	for (size_t i = 0; i + len <= value_len; i++)
+		if (http_matchNoCase(value + i, token, len))
+			return true;
+
+	return false;
+}
+
+/**
+ * Find a header field in a request.
+ *
+ * \param req request received from the client.
+ * \param req_len length of the request.
+ * \param name field name to look for, case is ignored.
+ * \param value_len filled with the length of the value, if not NULL.
+ * \return the field value, without leading and trailing spaces, or
+ *         NULL if the field is not present. The value is not nul terminated.
+ */
+const char *http_findHeader(const char *req, size_t req_len, const char *name, size_t *value_len)
+{
+	const char *end = req + req_len;
+	const char *p = req;
+	size_t name_len = strlen(name);
+
+	/* Skip the request line, stop at the empty line ending the header */
+	while ((p = memchr(p, '\n', end - p)) && ++p < end && *p != '\r' && *p != '\n')
+	{
+		const char *eol = memchr(p, '\n', end - p);
+		if (!eol)
+			eol = end;
+
+		if ((size_t)(eol - p) > name_len && p[name_len] == ':'
+			&& http_matchNoCase(p, name, name_len))
+		{
+			const char *value = p + name_len + 1;
+
+			while (value < eol && (*value == ' ' || *value == '\t'))
+				value++;
+			while (eol > value && isspace((unsigned char)eol[-1]))
+				eol--;
+
+			if (value_len)
+				*value_len = eol - value;
+			return value;
+		}
+	}
+
+	return NULL;
+}
+
+static HttpClient *http_findClient(struct netconn *conn)
+{
+	for (int i = 0; i < HTTP_CLIENTS; i++)
+		if (http_clients[i].conn == conn)
+			return &http_clients[i];
+
+	return NULL;
+}
+
+/*
+ * Append \a str to a header buffer of HTTP_HDR_LEN octets.
+ * Return the new length, HTTP_HDR_FULL from now on if it does not fit.
+ */
+static size_t http_append(char *buf, size_t len, const char *str)
+{
+	size_t str_len = strlen(str);
+
+	if (len + str_len > HTTP_HDR_LEN)
+		return HTTP_HDR_FULL;
+
+	memcpy(buf + len, str, str_len);
+	return len + str_len;
+}
+
+/* Same as http_append(), with a formatted string */
+static size_t http_appendf(char *buf, size_t len, const char *fmt, ...)
+{
+	size_t room;
+	va_list ap;
+	int n;
+
+	if (len >= HTTP_HDR_LEN)
+		return HTTP_HDR_FULL;
+
+	room = HTTP_HDR_LEN - len;
+	va_start(ap, fmt);
+	n = vsnprintf(buf + len, room, fmt, ap);
+	va_end(ap);
+
+	/* The terminator must fit too, even if it is not sent */
+	if (n < 0 || (size_t)n >= room)
+		return HTTP_HDR_FULL;
+	return len + n;
+}
+
+/*
+ * Write to the connection of \a c, which is closed after the request
+ * if the write fails. \a c may be NULL for an unknown connection.
+ */
+static err_t http_write(HttpClient *c, struct netconn *conn, const void *data, size_t len, u8_t flags)
+{
+	err_t err = netconn_write(conn, data, len, flags);
+
+	if (err != ERR_OK && c)
+		c->flags |= HC_ERROR;
+	return err;
+}
+
+/*
+ * Send a header of \a len octets, or a 500 response closing the connection
+ * if it did not fit in the buffer.
+ */
+static err_t http_writeHeader(HttpClient *c, struct netconn *conn, const char *hdr, size_t len)
+{
+	if (len > HTTP_HDR_LEN)
+	{
+		LOG_ERR("Header too long\n");
+		if (c)
+			c->flags &= ~(HC_KEEPALIVE | HC_CHUNKED);
+		return http_write(c, conn, http_hdr_overflow, sizeof(http_hdr_overflow) - 1, NETCONN_NOCOPY);
+	}
+
+	return http_write(c, conn, hdr, len, NETCONN_COPY);
+}
+
+/*
+ * Format the status line and the fields telling how the body is delimited,
+ * updating the connection state.
+ */
+static size_t http_startHeader(HttpClient *c, char *hdr, int status, long content_len)
+{
+	size_t len;
+	unsigned i;
+
+	for (i = 0; i < countof(http_status) - 1; i++)
+		if (http_status[i].code == status)
+			break;
+
+	len = http_append(hdr, 0, (c && (c->flags & HC_HTTP11)) ? http_ver_11 : http_ver_10);
+	len = http_append(hdr, len, http_status[i].line);
+
+	if (c)
+	{
+		if (content_len == HTTP_LEN_CHUNKED && !(c->flags & HC_HTTP11))
+			content_len = HTTP_LEN_CLOSE;
+		if (content_len == HTTP_LEN_CLOSE)
+			c->flags &= ~HC_KEEPALIVE;
+
+		if (!(c->flags & HC_KEEPALIVE))
+			len = http_append(hdr, len, http_conn_close);
+		else if (!(c->flags & HC_HTTP11))
+			len = http_append(hdr, len, http_conn_keepalive);
+
+		if (content_len == HTTP_LEN_CHUNKED)
+		{
+			c->flags |= HC_CHUNKED;
+			len = http_append(hdr, len, http_chunked);
+		}
+		c->flags |= HC_REPLIED;
+	}
+
+	return len;
+}
+
+/**
+ * Send on \param client socket the http header with \param status code
+ * (200, 304, 404 or 500) and \param content_type.
+ *
+ * \param content_len tells how the body is delimited: its length in bytes,
+ *        HTTP_LEN_CHUNKED if it will be sent with http_sendChunk() or
+ *        HTTP_LEN_CLOSE if it ends when the connection is closed.
+ *
+ * Only the first two kinds of responses let the connection persist. Chunked
+ * responses to HTTP/1.0 clients are sent as is and the connection is closed.
+ */
+void http_sendHeader(struct netconn *client, int status, int content_type, long content_len)
+{
+	HttpClient *c = http_findClient(client);
+	char hdr[HTTP_HDR_LEN];
+	size_t len;
+
+	ASSERT(content_type < HTTP_CONTENT_CNT);
+
+	len = http_startHeader(c, hdr, status, content_len);
+	if (content_len >= 0)
+		len = http_appendf(hdr, len, "Content-Length: %ld\r\n", content_len);
+	len = http_append(hdr, len, http_content_type[content_type].content);
+
+	http_writeHeader(c, client, hdr, len);
+}
+
+/**
+ * Send on \param client socket a chunk of the response body.
+ *
+ * The response header must have been sent with HTTP_LEN_CHUNKED, the server
+ * terminates the body when the handler returns. If the client can not
+ * receive chunked responses, the data is sent as is.
+ *
+ * \return 0 on success, -1 on error.
+ */
+int http_sendChunk(struct netconn *client, const void *buf, size_t len)
+{
+	HttpClient *c = http_findClient(client);
+	char chunk[HTTP_CHUNK_MERGE + 16];
+	size_t hdr_len;
+
+	if (!len)
+		return 0;
+
+	if (!c || !(c->flags & HC_CHUNKED))
+		return http_write(c, client, buf, len, NETCONN_COPY) == ERR_OK ? 0 : -1;
+
+	hdr_len = snprintf(chunk, sizeof(chunk), "%lx\r\n", (unsigned long)len);
+	if (len <= HTTP_CHUNK_MERGE)
+	{
+		memcpy(chunk + hdr_len, buf, len);
+		memcpy(chunk + hdr_len + len, "\r\n", 2);
+		return http_write(c, client, chunk, hdr_len + len + 2, NETCONN_COPY) == ERR_OK ? 0 : -1;
+	}
+
+	if (http_write(c, client, chunk, hdr_len, NETCONN_COPY | NETCONN_MORE) != ERR_OK
+		|| http_write(c, client, buf, len, NETCONN_COPY | NETCONN_MORE) != ERR_OK
+		|| http_write(c, client, "\r\n", 2, NETCONN_NOCOPY) != ERR_OK)
+		return -1;
+
+	return 0;
+}
+
 /**
  * Send on \param client socket the 200 Ok http header with
  * select \param content_type
+ *
+ * The body ends when the connection is closed.
  */
 void http_sendOk(struct netconn *client, int content_type)
 {
-	ASSERT(content_type < HTTP_CONTENT_CNT);
-
-	netconn_write(client, http_html_hdr_200, sizeof(http_html_hdr_200) - 1, NETCONN_NOCOPY);
-	netconn_write(client, http_content_type[content_type].content,
-			strlen(http_content_type[content_type].content), NETCONN_NOCOPY);
+	http_sendHeader(client, 200, content_type, HTTP_LEN_CLOSE);
 }
 
 
@@ -271,11 +579,7 @@ void http_sendOk(struct netconn *client, int content_type)
  */
 void http_sendFileNotFound(struct netconn *client, int content_type)
 {
-	ASSERT(content_type < HTTP_CONTENT_CNT);
-
-	netconn_write(client, http_html_hdr_404, sizeof(http_html_hdr_404) - 1, NETCONN_NOCOPY);
-	netconn_write(client, http_content_type[content_type].content,
-			strlen(http_content_type[content_type].content), NETCONN_NOCOPY);
+	http_sendHeader(client, 404, content_type, HTTP_LEN_CLOSE);
 }
 
 /**
@@ -284,11 +588,7 @@ void http_sendFileNotFound(struct netconn *client, int content_type)
  */
 void http_sendInternalErr(struct netconn *client, int content_type)
 {
-	ASSERT(content_type < HTTP_CONTENT_CNT);
-
-	netconn_write(client, http_html_hdr_500, sizeof(http_html_hdr_500) - 1, NETCONN_NOCOPY);
-	netconn_write(client, http_content_type[content_type].content,
-			strlen(http_content_type[content_type].content), NETCONN_NOCOPY);
+	http_sendHeader(client, 500, content_type, HTTP_LEN_CLOSE);
 }
 
 static http_handler_t cgi_search(const char *name,  HttpCGI *table)
@@ -335,56 +635,333 @@ static http_handler_t cgi_search(const char *name,  HttpCGI *table)
 	return table[i].handler;
 }
 
-static char req_string[80];
+/*
+ * Look for the empty line ending the request header, the scan starts from
+ * \a from. Return the header length, 0 if it is not complete.
+ */
+static size_t http_headLen(const char *buf, size_t len, size_t from)
+{
+	const char *end = buf + len;
+	const char *p = buf + from;
+
+	while ((p = memchr(p, '\n', end - p)) && ++p < end)
+	{
+		if (*p == '\n')
+			return p + 1 - buf;
+		if (*p == '\r' && p + 1 < end && p[1] == '\n')
+			return p + 2 - buf;
+	}
+
+	return 0;
+}
+
+static size_t http_bodyLen(const char *head, size_t head_len)
+{
+	const char *value = http_findHeader(head, head_len, "Content-Length", NULL);
+	size_t len = 0;
+
+	/* The value is always followed by the header terminator */
+	while (value && *value >= '0' && *value <= '9')
+		len = len * 10 + *value++ - '0';
+
+	return len;
+}
+
+static bool http_recv(HttpClient *c)
+{
+	struct netbuf *rx_buf_conn = netconn_recv(c->conn);
+	void *data;
+	u16_t len;
+
+	if (!rx_buf_conn)
+		return false;
+
+	do
+	{
+		netbuf_data(rx_buf_conn, &data, &len);
+		size_t copy = MIN((size_t)len, sizeof(c->req) - c->len);
+		memcpy(c->req + c->len, data, copy);
+		c->len += copy;
+	}
+	while (netbuf_next(rx_buf_conn) >= 0);
+
+	netbuf_delete(rx_buf_conn);
+	return true;
+}
+
+/*
+ * Receive the next request, that may span several netbufs or already be
+ * in the buffer after the previous one.
+ */
+static bool http_recvRequest(HttpClient *c)
+{
+	size_t head = 0, body = 0, scan = 0;
+	bool truncated = false;
+
+	/* Drop the request just served, keep pipelined data */
+	c->len -= c->req_len;
+	memmove(c->req, c->req + c->req_len, c->len);
+
+	for (;;)
+	{
+		if (!head && (head = http_headLen(c->req, c->len, scan)))
+			body = http_bodyLen(c->req, head);
+
+		if (head && c->len >= head + body)
+		{
+			c->req_len = head + body;
+			break;
+		}
+
+		if (c->len == sizeof(c->req))
+		{
+			LOG_WARN("Request too long, truncated\n");
+			c->req_len = c->len;
+			truncated = true;
+			break;
+		}
+
+		scan = c->len > 2 ? c->len - 2 : 0;
+		if (!http_recv(c))
+			return false;
+	}
+
+	const char *eol = memchr(c->req, '\n', c->req_len);
+	size_t line_len = eol ? (size_t)(eol - c->req) : c->req_len;
+
+	if (line_len && c->req[line_len - 1] == '\r')
+		line_len--;
+
+	c->flags = 0;
+	if (line_len >= 8 && !memcmp(c->req + line_len - 8, "HTTP/1.1", 8))
+		c->flags |= HC_HTTP11;
+
+	#if HTTP_KEEPALIVE
+	{
+		size_t len;
+		const char *conn = http_findHeader(c->req, head, "Connection", &len);
+
+		/* HTTP/1.1 connections persist by default, HTTP/1.0 ones on request */
+		if ((c->flags & HC_HTTP11) ? !(conn && http_hasToken(conn, len, "close"))
+				: (conn && http_hasToken(conn, len, "keep-alive")))
+			c->flags |= HC_KEEPALIVE;
+	}
+	#endif
+	if (truncated)
+		c->flags &= ~HC_KEEPALIVE;
+
+	return true;
+}
+
+/* FNV-1a, the same hash computed by http_mkassets.py */
+static uint32_t http_hashPath(const char *path)
+{
+	uint32_t h = 2166136261UL;
+
+	while (*path)
+		h = (h ^ (uint8_t)*path++) * 16777619UL;
+
+	return h;
+}
+
+/**
+ * Look for \param path in a static asset \param table.
+ *
+ * \return the asset, or NULL if not found.
+ */
+const HttpAsset *http_findAsset(const HttpAssetTable *table, const char *path)
+{
+	uint32_t hash = http_hashPath(path);
+
+	for (uint16_t slot = hash & table->index_mask; table->index[slot];
+			slot = (slot + 1) & table->index_mask)
+	{
+		const HttpAsset *asset = &table->assets[table->index[slot] - 1];
+
+		if (asset->hash == hash && !strcmp(asset->path, path))
+			return asset;
+	}
+
+	return NULL;
+}
+
+/**
+ * Serve the assets in \param table before looking for a handler.
+ *
+ * Assets come with their header already formatted, so answering takes
+ * a lookup in the table, a check of the conditional request fields and
+ * two writes. Their data is never copied, so the table must be kept
+ * in memory while the server is running.
+ */
+void http_setAssets(const HttpAssetTable *table)
+{
+	http_assets = table;
+}
+
+static bool http_serveAsset(HttpClient *c)
+{
+	const HttpAsset *asset;
+	const HttpAssetBody *body;
+	const char *value;
+	size_t value_len;
+	char hdr[HTTP_HDR_LEN];
+	size_t len;
+
+	if (!http_assets || !(asset = http_findAsset(http_assets, c->name)))
+		return false;
+
+	body = &asset->plain;
+	value = http_findHeader(c->req, c->req_len, "Accept-Encoding", &value_len);
+	if (asset->gzip.data && value && http_hasToken(value, value_len, "gzip"))
+		body = &asset->gzip;
+
+	value = http_findHeader(c->req, c->req_len, "If-None-Match", &value_len);
+	if (value && (http_hasToken(value, value_len, body->etag)
+			|| (value_len == 1 && *value == '*')))
+	{
+		len = http_startHeader(c, hdr, 304, 0);
+		len = http_appendf(hdr, len, "ETag: %s\r\n\r\n", body->etag);
+		http_writeHeader(c, c->conn, hdr, len);
+		return true;
+	}
+
+	len = http_startHeader(c, hdr, 200, body->len);
+	len = http_append(hdr, len, body->fields);
+	if (http_writeHeader(c, c->conn, hdr, len) == ERR_OK && len <= HTTP_HDR_LEN)
+		http_write(c, c->conn, body->data, body->len, NETCONN_NOCOPY);
+	return true;
+}
+
+static void http_handleRequest(HttpClient *c)
+{
+	memset(c->name, 0, sizeof(c->name));
+	http_getPageName(c->req, c->req_len, c->name, sizeof(c->name));
+
+	if (c->name[0] == '\0')
+		strcpy(c->name, HTTP_DEFAULT_PAGE);
+
+	if (http_serveAsset(c))
+		return;
+
+	http_handler_t cgi = cgi_search(c->name, cgi_table);
+	if (cgi)
+	{
+		if (cgi(c->conn, c->name, c->req, c->req_len) < 0)
+		{
+			LOG_ERR("Internal server error\n");
+			http_sendInternalErr(c->conn, HTTP_CONTENT_HTML);
+			http_write(c, c->conn, http_server_error, http_server_error_len - 1, NETCONN_NOCOPY);
+		}
+	}
+	else
+	{
+		http_callback(c->conn, c->name, c->req, c->req_len);
+	}
+}
+
+/*
+ * Serve all the requests of a connection, then close it.
+ */
+static void http_serveClient(HttpClient *c)
+{
+	/*
+	 * Responses are written in a few segments: don't wait for the client
+	 * to ack the header before sending the body.
+	 */
+	if (c->conn->pcb.tcp)
+		tcp_nagle_disable(c->conn->pcb.tcp);
+	#if HTTP_KEEPALIVE
+		c->conn->recv_timeout = CONFIG_HTTP_KEEPALIVE_TIMEOUT;
+	#endif
+
+	c->len = c->req_len = 0;
+	while (http_recvRequest(c))
+	{
+		http_handleRequest(c);
+
+		if ((c->flags & (HC_CHUNKED | HC_ERROR)) == HC_CHUNKED)
+			http_write(c, c->conn, http_last_chunk, sizeof(http_last_chunk) - 1, NETCONN_NOCOPY);
+
+		/* Handlers writing their own header do not delimit the response */
+		if (!(c->flags & HC_REPLIED) || !(c->flags & HC_KEEPALIVE)
+				|| (c->flags & HC_ERROR))
+			break;
+	}
+
+	netconn_close(c->conn);
+	netconn_delete(c->conn);
+}
+
+#if CONFIG_HTTP_WORKERS
+
+/* Shared with other modules, see kern/signal.h */
+#define SIG_HTTP  SIG_SYSTEM5
+
+static struct Process *http_dispatcher;
+
+#if !CONFIG_KERN_HEAP
+static cpu_stack_t http_stack[CONFIG_HTTP_WORKERS]
+			[CONFIG_HTTP_WORKER_STACK / sizeof(cpu_stack_t)]
+				ALIGNED(sizeof(cpu_stack_t));
+#endif
+
+static NORETURN void http_worker(void)
+{
+	HttpClient *c = (HttpClient *)proc_currentUserData();
+
+	for (;;)
+	{
+		/* The signal may come from another module, see kern/signal.h */
+		while (!c->conn)
+			sig_wait(SIG_HTTP);
+		http_serveClient(c);
+
+		c->conn = NULL;
+		sig_send(http_dispatcher, SIG_HTTP);
+	}
+}
+
+static HttpClient *http_idleWorker(void)
+{
+	for (int i = 0; i < CONFIG_HTTP_WORKERS; i++)
+		if (!http_clients[i].conn)
+			return &http_clients[i];
+
+	return NULL;
+}
+
+#endif /* CONFIG_HTTP_WORKERS */
 
 /**
  * Http polling function.
  *
  * Call this functions to process each client connections.
  *
+ * Without workers the connection is served before returning. Otherwise it
+ * is handed to an idle worker, waiting for one if all of them are busy.
  */
 void http_poll(struct netconn *server)
 {
 	struct netconn *client;
-	struct netbuf *rx_buf_conn;
-	char *rx_buf;
-	uint16_t len;
 
 	client = netconn_accept(server);
 	if (!client)
 		return;
 
-	rx_buf_conn = netconn_recv(client);
-	if (rx_buf_conn)
-	{
-		netbuf_data(rx_buf_conn, (void **)&rx_buf, &len);
-		if (rx_buf)
-		{
-			memset(req_string, 0, sizeof(req_string));
-			http_getPageName(rx_buf, len, req_string, sizeof(req_string));
+	#if CONFIG_HTTP_WORKERS
+		HttpClient *c;
 
-			if (req_string[0] == '\0')
-				strcpy(req_string, HTTP_DEFAULT_PAGE);
+		http_dispatcher = proc_current();
+		while (!(c = http_idleWorker()))
+			sig_wait(SIG_HTTP);
 
-			http_handler_t cgi = cgi_search(req_string, cgi_table);
-			if (cgi)
-			{
-				if (cgi(client, req_string, rx_buf, len) < 0)
-				{
-					LOG_ERR("Internal server error\n");
-					http_sendInternalErr(client, HTTP_CONTENT_HTML);
-					netconn_write(client, http_server_error, http_server_error_len - 1, NETCONN_NOCOPY);
-				}
-			}
-			else
-			{
-				http_callback(client, req_string, rx_buf, len);
-			}
-		}
-		netconn_close(client);
-		netbuf_delete(rx_buf_conn);
-	}
-	netconn_delete(client);
+		c->conn = client;
+		sig_send(c->proc, SIG_HTTP);
+	#else
+		http_clients[0].conn = client;
+		http_serveClient(&http_clients[0]);
+		http_clients[0].conn = NULL;
+	#endif
 }
 
 /**
@@ -396,6 +973,9 @@ void http_poll(struct netconn *server)
  * In this way the user could filter some client request and redirect they to custom callback, i.e.
  * the client could request status of the device only loading the particular page name.
  *
+ * When CONFIG_HTTP_WORKERS is not 0 the worker processes are created here,
+ * so the kernel must already be initialized.
+ *
  * \param default_callback fuction that server call for all request, that does'nt match cgi table.
  * \param table of callcack to call when client request a particular page.
  */
@@ -405,5 +985,19 @@ void http_init(http_handler_t default_callback, struct HttpCGI *table)
 
 	cgi_table = table;
 	http_callback = default_callback;
-}
 
+	#if CONFIG_HTTP_WORKERS
+		for (int i = 0; i < CONFIG_HTTP_WORKERS; i++)
+		{
+			#if CONFIG_KERN_HEAP
+				cpu_stack_t *stack = NULL;
+			#else
+				cpu_stack_t *stack = http_stack[i];
+			#endif
+
+			http_clients[i].proc = proc_new(http_worker, &http_clients[i],
+					CONFIG_HTTP_WORKER_STACK, stack);
+			ASSERT(http_clients[i].proc);
+		}
+	#endif
+}
@@ -74,15 +74,61 @@ enum
 #define CGI_MATCH_EXT    2  ///< Select item in table if the extention match
 #define CGI_MATCH_NAME   3  ///< Select item in table if the string is content
 
+/**
+ * A representation of a static asset.
+ */
+typedef struct HttpAssetBody
+{
+	const char *fields;     ///< Header fields, up to the empty line ending the header.
+	const char *etag;       ///< Entity tag, quotes included.
+	const uint8_t *data;    ///< Body, NULL if this representation is not available.
+	uint32_t len;           ///< Body length.
+} HttpAssetBody;
+
+/**
+ * Static asset, served without calling any handler.
+ */
+typedef struct HttpAsset
+{
+	const char *path;       ///< Path, without the leading '/'.
+	uint32_t hash;          ///< Hash of the path.
+	HttpAssetBody plain;    ///< Identity encoded body.
+	HttpAssetBody gzip;     ///< Gzip encoded body.
+} HttpAsset;
+
+/**
+ * Table of static assets, generated by http_mkassets.py.
+ */
+typedef struct HttpAssetTable
+{
+	const HttpAsset *assets;  ///< Assets.
+	const uint16_t *index;    ///< Hash index: asset position + 1, 0 for free slots.
+	uint16_t index_mask;      ///< Index size - 1, the size is a power of 2.
+} HttpAssetTable;
+
+/**
+ * \name Response body length values for http_sendHeader().
+ * \{
+ */
+#define HTTP_LEN_CLOSE    -1L  ///< Body ends when the connection is closed.
+#define HTTP_LEN_CHUNKED  -2L  ///< Body is sent with http_sendChunk().
+/* \} */
+
 int http_getValue(char *tolenized_buf, size_t tolenized_buf_len, const char *key, char *value, size_t len);
 int http_tokenizeGetRequest(char *raw_buf, size_t raw_len);
 void http_getPageName(const char *recv_buf, size_t recv_len, char *page_name, size_t len);
 size_t http_decodeUrl(const char *raw_buf, size_t raw_len, char *decodec_buf, size_t len);
 int http_searchContentType(const char *name);
+const char *http_findHeader(const char *req, size_t req_len, const char *name, size_t *value_len);
 
 void http_sendOk(struct netconn *client, int content_type);
 void http_sendFileNotFound(struct netconn *client, int content_type);
 void http_sendInternalErr(struct netconn *client, int content_type);
+void http_sendHeader(struct netconn *client, int status, int content_type, long content_len);
+int http_sendChunk(struct netconn *client, const void *buf, size_t len);
+
+const HttpAsset *http_findAsset(const HttpAssetTable *table, const char *path);
+void http_setAssets(const HttpAssetTable *table);
 
 void http_poll(struct netconn *server);
 void http_init(http_handler_t default_callback, struct HttpCGI *table);
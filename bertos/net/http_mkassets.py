@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+#
+# This file is part of BeRTOS.
+#
+# Bertos is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+#
+# Build the static asset table of the HTTP server from a directory.
+#
+# Every file becomes an HttpAsset (see net/http.h) with its header fields
+# already formatted. Files that shrink when compressed also get a gzip body,
+# sent to the clients that accept it.
+#
+# Usage: http_mkassets.py [--name NAME] [--no-gzip] DIR > assets.c
+#
+
+import argparse
+import gzip
+import hashlib
+import os
+import sys
+
+CONTENT_TYPES = {
+	"htm":  "text/html",
+	"html": "text/html",
+	"css":  "text/css",
+	"js":   "text/javascript",
+	"json": "application/json",
+	"png":  "image/png",
+	"jpg":  "image/jpeg",
+	"jpeg": "image/jpeg",
+	"ico":  "image/x-icon",
+	"gif":  "image/gif",
+	"svg":  "image/svg+xml",
+	"txt":  "text/plain",
+}
+
+def fnv1a(s):
+	"""Path hash, must match http_hashPath() in net/http.c."""
+	h = 2166136261
+	for b in s.encode():
+		h = ((h ^ b) * 16777619) & 0xffffffff
+	return h
+
+def c_string(s):
+	return '"' + s.replace("\\", "\\\\").replace('"', '\\"').replace("\r", "\\r").replace("\n", "\\n") + '"'
+
+def c_bytes(name, data):
+	out = ["static const uint8_t %s[] =\n{" % name]
+	for i in range(0, len(data), 12):
+		out.append("\t" + " ".join("0x%02x," % b for b in data[i:i + 12]))
+	out.append("};\n")
+	return "\n".join(out)
+
+def fields(ctype, data, etag, encoding, vary):
+	f = "Content-type: %s\r\n" % ctype
+	if encoding:
+		f += "Content-Encoding: %s\r\n" % encoding
+	if vary:
+		f += "Vary: Accept-Encoding\r\n"
+	f += "Content-Length: %d\r\nETag: %s\r\n\r\n" % (len(data), etag)
+	return f
+
+def main():
+	parser = argparse.ArgumentParser(description="Build the HTTP server static asset table.")
+	parser.add_argument("--name", default="http_assets", help="name of the HttpAssetTable")
+	parser.add_argument("--no-gzip", action="store_true", help="do not add gzip bodies")
+	parser.add_argument("dir", help="directory holding the assets")
+	args = parser.parse_args()
+
+	paths = []
+	for root, dirs, files in os.walk(args.dir):
+		dirs.sort()
+		for f in sorted(files):
+			full = os.path.join(root, f)
+			paths.append((os.path.relpath(full, args.dir).replace(os.sep, "/"), full))
+
+	if len(paths) > 0x7fff:
+		sys.exit("Too many assets")
+
+	out = sys.stdout
+	out.write("/* Generated by http_mkassets.py from %s, do not edit. */\n" % args.dir)
+	out.write("#include <net/http.h>\n\n")
+
+	entries = []
+	for n, (path, full) in enumerate(paths):
+		data = open(full, "rb").read()
+		ext = path.rsplit(".", 1)[-1].lower() if "." in path else ""
+		ctype = CONTENT_TYPES.get(ext, "application/octet-stream")
+		tag = hashlib.sha1(data).hexdigest()[:16]
+
+		gz = None
+		if not args.no_gzip:
+			gz = gzip.compress(data, 9, mtime=0)
+			if len(gz) >= len(data):
+				gz = None
+
+		out.write(c_bytes("asset%d" % n, data))
+		plain = '{ %s, %s, asset%d, %d }' % (
+			c_string(fields(ctype, data, '"%s"' % tag, None, gz is not None)),
+			c_string('"%s"' % tag), n, len(data))
+		if gz:
+			out.write(c_bytes("asset%d_gz" % n, gz))
+			gzip_body = '{ %s, %s, asset%d_gz, %d }' % (
+				c_string(fields(ctype, gz, '"%s-gz"' % tag, "gzip", True)),
+				c_string('"%s-gz"' % tag), n, len(gz))
+		else:
+			gzip_body = "{ NULL, NULL, NULL, 0 }"
+		entries.append("\t{ %s, 0x%08xUL,\n\t\t%s,\n\t\t%s },"
+				% (c_string(path), fnv1a(path), plain, gzip_body))
+
+	# Open addressing index, at most half full
+	size = 2
+	while size < 2 * len(paths):
+		size *= 2
+	index = [0] * size
+	for n, (path, full) in enumerate(paths):
+		slot = fnv1a(path) & (size - 1)
+		while index[slot]:
+			slot = (slot + 1) & (size - 1)
+		index[slot] = n + 1
+
+	out.write("static const HttpAsset %s_list[] =\n{\n%s\n};\n\n" % (args.name, "\n".join(entries)))
+	out.write("static const uint16_t %s_index[] =\n{\n" % args.name)
+	for i in range(0, size, 12):
+		out.write("\t" + " ".join("%d," % x for x in index[i:i + 12]) + "\n")
+	out.write("};\n\n")
+	out.write("const HttpAssetTable %s =\n{\n\t%s_list,\n\t%s_index,\n\t%d,\n};\n"
+			% (args.name, args.name, args.name, size - 1))
+
+if __name__ == "__main__":
+	main()
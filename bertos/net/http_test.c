@@ -34,6 +34,33 @@
  *
  * \author Daniele Basile <asterix@develer.com>
  *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_http.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_HTTP_WORKERS" >> $cfgdir/cfg_http.h
+ * $test$: echo "#define CONFIG_HTTP_WORKERS 2" >> $cfgdir/cfg_http.h
+ * $test$: echo  "#undef HTTP_LOG_LEVEL" >> $cfgdir/cfg_http.h
+ * $test$: echo "#define HTTP_LOG_LEVEL LOG_LVL_ERR" >> $cfgdir/cfg_http.h
+ * $test$: cp bertos/cfg/cfg_lwip.h $cfgdir/
+ * $test$: echo  "#undef LWIP_NETIF_LOOPBACK" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_NETIF_LOOPBACK 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef LWIP_HAVE_LOOPIF" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_HAVE_LOOPIF 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef LWIP_SO_RCVTIMEO" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_SO_RCVTIMEO 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_NETCONN" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_NETCONN 8" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_NETBUF" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_NETBUF 8" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_TCP_PCB" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_TCP_PCB 8" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEM_SIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEM_SIZE 16384" >> $cfgdir/cfg_lwip.h
+ *
  * notest: avr
  */
 
@@ -43,8 +70,23 @@
 
 #include <net/http.h>
 
+#include <drv/timer.h>
+
+#include <kern/proc.h>
+
+#include <netif/loopif.h>
+
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+/* lwIP and the error pages are not in the test sources list */
+#include "lwip.c"
+#include "hw/hw_http.c"
+
+/* Generated by http_mkassets.py from test/http_assets */
+#include "../../test/http_assets.c"
+
 static const char get_str[] = "\
 GET /test/page1 HTTP/1.1 Host: 10.3.3.199 Connection: keep-alive \
 User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/535.1 \
@@ -112,10 +154,566 @@ static int contents_check_type[] =
 
 #define CONTENT_TEST_CNT  8
 
+/*
+ * Server tests: the server and the clients talk through lwIP over the
+ * loopback interface.
+ */
+#define TEST_PORT    80
+#define BENCH_TIME   500
+
+static struct netif loop_netif;
+static struct netconn *server;
+static PROC_DEFINE_STACK(server_stack, KERN_MINSTACKSIZE * 2);
+
+static const char len_body[] = "Content with a known length";
+static const char legacy_body[] = "Legacy handler";
+static char big_chunk[300];
+
+typedef struct TestClient
+{
+	struct netconn *conn;
+	size_t len;
+	char buf[1024];
+	char head[256];
+	char body[1024];
+	size_t body_len;
+	bool closed;
+} TestClient;
+
+static int len_handler(struct netconn *client, const char *name, char *recv_buf, size_t recv_len)
+{
+	(void)name;
+	(void)recv_buf;
+	(void)recv_len;
+
+	http_sendHeader(client, 200, HTTP_CONTENT_PLAIN, sizeof(len_body) - 1);
+	netconn_write(client, len_body, sizeof(len_body) - 1, NETCONN_NOCOPY);
+	return 0;
+}
+
+static int chunk_handler(struct netconn *client, const char *name, char *recv_buf, size_t recv_len)
+{
+	(void)name;
+	(void)recv_buf;
+	(void)recv_len;
+
+	http_sendHeader(client, 200, HTTP_CONTENT_PLAIN, HTTP_LEN_CHUNKED);
+	http_sendChunk(client, "Hello", 5);
+	http_sendChunk(client, big_chunk, sizeof(big_chunk));
+	http_sendChunk(client, "!", 1);
+	return 0;
+}
+
+/* Send back the request body */
+static int echo_handler(struct netconn *client, const char *name, char *recv_buf, size_t recv_len)
+{
+	char *body = strstr(recv_buf, "\r\n\r\n");
+	(void)name;
+
+	ASSERT(body);
+	body += 4;
+	http_sendHeader(client, 200, HTTP_CONTENT_PLAIN, recv_buf + recv_len - body);
+	netconn_write(client, body, recv_buf + recv_len - body, NETCONN_COPY);
+	return 0;
+}
+
+static int legacy_handler(struct netconn *client, const char *name, char *recv_buf, size_t recv_len)
+{
+	(void)name;
+	(void)recv_buf;
+	(void)recv_len;
+
+	http_sendOk(client, HTTP_CONTENT_PLAIN);
+	netconn_write(client, legacy_body, sizeof(legacy_body) - 1, NETCONN_NOCOPY);
+	return 0;
+}
+
+/* Serve the status page as a handler reading it from a file would do */
+static int page_handler(struct netconn *client, const char *name, char *recv_buf, size_t recv_len)
+{
+	const HttpAssetBody *page = &test_assets_list[0].plain;
+	(void)recv_buf;
+	(void)recv_len;
+
+	http_sendHeader(client, 200, http_searchContentType(name), page->len);
+	netconn_write(client, page->data, page->len, NETCONN_COPY);
+	return 0;
+}
+
+static HttpCGI test_cgi[] =
+{
+	{ CGI_MATCH_WORD, "len.txt", len_handler },
+	{ CGI_MATCH_WORD, "chunk.txt", chunk_handler },
+	{ CGI_MATCH_WORD, "echo", echo_handler },
+	{ CGI_MATCH_NAME, "page/", page_handler },
+	{ CGI_MATCH_NONE, NULL, NULL },
+};
+
+static void server_proc(void)
+{
+	for (;;)
+		http_poll(server);
+}
+
+static bool client_connect(TestClient *t)
+{
+	struct ip_addr addr;
+
+	IP4_ADDR(&addr, 127, 0, 0, 1);
+	memset(t, 0, sizeof(*t));
+	t->conn = netconn_new(NETCONN_TCP);
+	if (!t->conn)
+		return false;
+	t->conn->recv_timeout = 2000;
+
+	if (netconn_connect(t->conn, &addr, TEST_PORT) != ERR_OK)
+	{
+		netconn_delete(t->conn);
+		return false;
+	}
+	return true;
+}
+
+static void client_close(TestClient *t)
+{
+	netconn_close(t->conn);
+	netconn_delete(t->conn);
+}
+
+static bool client_send(TestClient *t, const char *str)
+{
+	return netconn_write(t->conn, str, strlen(str), NETCONN_COPY) == ERR_OK;
+}
+
+static bool client_recv(TestClient *t)
+{
+	struct netbuf *nb;
+
+	if (t->closed || !(nb = netconn_recv(t->conn)))
+	{
+		t->closed = true;
+		return false;
+	}
+
+	size_t len = MIN((size_t)netbuf_len(nb), sizeof(t->buf) - 1 - t->len);
+	netbuf_copy(nb, t->buf + t->len, len);
+	t->len += len;
+	t->buf[t->len] = '\0';
+	netbuf_delete(nb);
+	return true;
+}
+
+/*
+ * Read a whole response and check its status line. The body is decoded
+ * according to the header and the response is removed from the buffer.
+ */
+static bool client_response(TestClient *t, const char *status)
+{
+	char *head_end;
+	const char *field;
+	size_t head;
+
+	while (!(head_end = strstr(t->buf, "\r\n\r\n")))
+		if (!client_recv(t))
+			return false;
+	head = head_end + 4 - t->buf;
+
+	if (strncmp(t->buf, status, strlen(status)))
+	{
+		kprintf("Bad status line: %.*s\n", (int)head, t->buf);
+		return false;
+	}
+
+	memcpy(t->head, t->buf, MIN(head, sizeof(t->head) - 1));
+	t->head[MIN(head, sizeof(t->head) - 1)] = '\0';
+
+	t->body_len = 0;
+	if (!strncmp(t->buf + sizeof("HTTP/1.1"), "304", 3))
+		;
+	else if ((field = http_findHeader(t->buf, head, "Content-Length", NULL)))
+	{
+		size_t len = atoi(field);
+
+		while (t->len < head + len)
+			if (!client_recv(t))
+				return false;
+		memcpy(t->body, t->buf + head, len);
+		t->body_len = len;
+		head += len;
+	}
+	else if (http_findHeader(t->buf, head, "Transfer-Encoding", NULL))
+	{
+		for (;;)
+		{
+			char *end;
+			size_t len;
+
+			while (!strstr(t->buf + head, "\r\n"))
+				if (!client_recv(t))
+					return false;
+			len = strtoul(t->buf + head, &end, 16);
+			head = end + 2 - t->buf;
+
+			while (t->len < head + len + 2)
+				if (!client_recv(t))
+					return false;
+			memcpy(t->body + t->body_len, t->buf + head, len);
+			t->body_len += len;
+			head += len + 2;
+
+			if (!len)
+				break;
+		}
+	}
+	else
+	{
+		/* Body delimited by the connection close */
+		while (client_recv(t))
+			;
+		t->body_len = t->len - head;
+		memcpy(t->body, t->buf + head, t->body_len);
+		head = t->len;
+	}
+
+	t->body[t->body_len] = '\0';
+	t->len -= head;
+	memmove(t->buf, t->buf + head, t->len + 1);
+	return true;
+}
+
+static bool client_get(TestClient *t, const char *page, const char *body)
+{
+	char req[64];
+
+	sprintf(req, "GET /%s HTTP/1.1\r\nHost: test\r\n\r\n", page);
+	return client_send(t, req) && client_response(t, "HTTP/1.1 200 OK")
+		&& !strcmp(t->body, body);
+}
+
+static int server_keepAliveTest(void)
+{
+	static TestClient t;
+
+	if (!client_connect(&t))
+		return -1;
+
+	/* The same connection serves every request */
+	for (int i = 0; i < 5; i++)
+	{
+		if (!client_get(&t, "len.txt", len_body))
+			goto error;
+	}
+
+	/* Requests split over several segments */
+	if (!client_send(&t, "GET /len.t")
+		|| !client_send(&t, "xt HTTP/1.1\r\nHost: te")
+		|| !client_send(&t, "st\r\n\r")
+		|| !client_send(&t, "\n")
+		|| !client_response(&t, "HTTP/1.1 200 OK")
+		|| strcmp(t.body, len_body))
+		goto error;
+
+	/* Pipelined requests, with a body split in two writes */
+	if (!client_send(&t, "GET /len.txt HTTP/1.1\r\n\r\n"
+			"POST /echo HTTP/1.1\r\nContent-Length: 10\r\n\r\n01234")
+		|| !client_send(&t, "56789")
+		|| !client_response(&t, "HTTP/1.1 200 OK")
+		|| strcmp(t.body, len_body)
+		|| !client_response(&t, "HTTP/1.1 200 OK")
+		|| strcmp(t.body, "0123456789"))
+		goto error;
+
+	/* Chunked response */
+	if (!client_send(&t, "GET /chunk.txt HTTP/1.1\r\n\r\n")
+		|| !client_response(&t, "HTTP/1.1 200 OK")
+		|| t.body_len != 5 + sizeof(big_chunk) + 1
+		|| memcmp(t.body, "Hello", 5)
+		|| memcmp(t.body + 5, big_chunk, sizeof(big_chunk))
+		|| t.body[t.body_len - 1] != '!')
+		goto error;
+
+	/* Handlers not telling the body length close the connection */
+	if (!client_get(&t, "legacy.txt", legacy_body) || !t.closed)
+		goto error;
+
+	client_close(&t);
+	return 0;
+
+error:
+	kprintf("Keep-alive test failed\n");
+	client_close(&t);
+	return -1;
+}
+
+static int server_http10Test(void)
+{
+	static TestClient t;
+
+	if (!client_connect(&t))
+		return -1;
+
+	/* HTTP/1.0 clients get the body as is and the connection is closed */
+	if (!client_send(&t, "GET /chunk.txt HTTP/1.0\r\n\r\n")
+		|| !client_response(&t, "HTTP/1.0 200 OK")
+		|| t.body_len != 5 + sizeof(big_chunk) + 1 || !t.closed)
+	{
+		kprintf("HTTP/1.0 test failed\n");
+		client_close(&t);
+		return -1;
+	}
+
+	client_close(&t);
+	return 0;
+}
+
+static int server_concurrencyTest(void)
+{
+	static TestClient slow, fast;
+	int ret = -1;
+
+	if (!client_connect(&slow))
+		return -1;
+	if (!client_connect(&fast))
+	{
+		client_close(&slow);
+		return -1;
+	}
+
+	/* A stalled client must not delay the others */
+	if (client_send(&slow, "GET /len.txt HTT")
+		&& client_get(&fast, "len.txt", len_body)
+		&& client_send(&slow, "P/1.1\r\n\r\n")
+		&& client_response(&slow, "HTTP/1.1 200 OK")
+		&& !strcmp(slow.body, len_body))
+		ret = 0;
+	else
+		kprintf("Concurrency test failed\n");
+
+	client_close(&fast);
+	client_close(&slow);
+	return ret;
+}
+
+static int server_benchmark(void)
+{
+	static TestClient t;
+	unsigned long keepalive = 0, close = 0;
+	ticks_t start;
+
+	if (!client_connect(&t))
+		return -1;
+	start = timer_clock();
+	while (timer_clock() - start < ms_to_ticks(BENCH_TIME))
+	{
+		if (!client_get(&t, "len.txt", len_body))
+		{
+			client_close(&t);
+			return -1;
+		}
+		keepalive++;
+	}
+	client_close(&t);
+
+	start = timer_clock();
+	while (timer_clock() - start < ms_to_ticks(BENCH_TIME))
+	{
+		if (!client_connect(&t))
+			return -1;
+		if (!client_send(&t, "GET /len.txt HTTP/1.1\r\nConnection: close\r\n\r\n")
+			|| !client_response(&t, "HTTP/1.1 200 OK"))
+		{
+			client_close(&t);
+			return -1;
+		}
+		client_close(&t);
+		close++;
+	}
+
+	kprintf("Requests/s: keep-alive %lu, connection per request %lu\n",
+		keepalive * 1000 / BENCH_TIME, close * 1000 / BENCH_TIME);
+	return 0;
+}
+
+static bool client_asset(TestClient *t, const char *path, const char *fields, const char *status)
+{
+	char req[160];
+
+	sprintf(req, "GET /%s HTTP/1.1\r\n%s\r\n", path, fields);
+	return client_send(t, req) && client_response(t, status);
+}
+
+static int server_assetTest(void)
+{
+	static TestClient t;
+	static char fields[80];
+	const HttpAsset *index = &test_assets_list[0];
+
+	if (!client_connect(&t))
+		return -1;
+
+	/* The default page comes from the table */
+	if (!client_asset(&t, "", "", "HTTP/1.1 200 OK")
+		|| t.body_len != index->plain.len
+		|| memcmp(t.body, index->plain.data, t.body_len)
+		|| !strstr(t.head, index->plain.etag))
+		goto error;
+
+	/* Compressed body only to clients accepting it */
+	if (!client_asset(&t, "index.htm", "Accept-Encoding: deflate, gzip\r\n", "HTTP/1.1 200 OK")
+		|| t.body_len != index->gzip.len
+		|| memcmp(t.body, index->gzip.data, t.body_len)
+		|| !strstr(t.head, "Content-Encoding: gzip"))
+		goto error;
+
+	/* Conditional requests, the connection persists after a 304 */
+	sprintf(fields, "If-None-Match: %s\r\n", index->plain.etag);
+	if (!client_asset(&t, "index.htm", fields, "HTTP/1.1 304 Not Modified")
+		|| t.body_len || !strstr(t.head, index->plain.etag))
+		goto error;
+
+	/* The etag of the other encoding does not match */
+	sprintf(fields, "If-None-Match: %s\r\nAccept-Encoding: gzip\r\n", index->plain.etag);
+	if (!client_asset(&t, "index.htm", fields, "HTTP/1.1 200 OK")
+		|| t.body_len != index->gzip.len)
+		goto error;
+
+	if (!client_asset(&t, "css/style.css", "", "HTTP/1.1 200 OK")
+		|| t.body_len != test_assets_list[2].plain.len
+		|| !strstr(t.head, "text/css"))
+		goto error;
+
+	/* Everything else still goes to the handlers */
+	if (!client_get(&t, "len.txt", len_body)
+		|| !client_asset(&t, "page/status.htm", "", "HTTP/1.1 200 OK")
+		|| t.body_len != index->plain.len)
+		goto error;
+
+	client_close(&t);
+	return 0;
+
+error:
+	kprintf("Asset test failed\n");
+	client_close(&t);
+	return -1;
+}
+
+/*
+ * An asset whose header does not fit in the server buffer: the request
+ * fails with a complete 500 response and the connection is closed.
+ */
+static char long_fields[400];
+static HttpAsset long_asset[] =
+{
+	{ "long.htm", 0, { long_fields, "\"0\"", (const uint8_t *)"x", 1 }, { NULL, NULL, NULL, 0 } },
+};
+static const uint16_t long_index[] = { 1 };
+static const HttpAssetTable long_assets = { long_asset, long_index, 0 };
+
+static int server_longHeaderTest(void)
+{
+	static TestClient t;
+	uint32_t h = 2166136261UL;
+	int ret = 0;
+
+	for (const char *p = long_asset[0].path; *p; p++)
+		h = (h ^ (uint8_t)*p) * 16777619UL;
+	long_asset[0].hash = h;
+
+	for (size_t i = 0; i < sizeof(long_fields) - 5; i++)
+		long_fields[i] = 'a' + i % 26;
+	memcpy(long_fields, "X-Pad: ", 7);
+	strcpy(long_fields + sizeof(long_fields) - 5, "\r\n\r\n");
+
+	http_setAssets(&long_assets);
+	if (client_connect(&t))
+	{
+		if (!client_asset(&t, "long.htm", "", "HTTP/1.0 500 Internal Server Error")
+			|| t.body_len || !t.closed)
+			ret = -1;
+		client_close(&t);
+	}
+	else
+		ret = -1;
+	http_setAssets(&test_assets);
+
+	if (ret)
+		kprintf("Long header test failed\n");
+	return ret;
+}
+
+static unsigned long asset_rate(TestClient *t, const char *path, const char *fields, const char *status)
+{
+	unsigned long count = 0;
+	ticks_t start = timer_clock();
+
+	while (timer_clock() - start < ms_to_ticks(BENCH_TIME))
+	{
+		if (!client_asset(t, path, fields, status))
+			return 0;
+		count++;
+	}
+
+	return count * 1000 / BENCH_TIME;
+}
+
+static int server_assetBenchmark(void)
+{
+	static TestClient t;
+	static char fields[80];
+	unsigned long handler, asset, cached;
+
+	if (!client_connect(&t))
+		return -1;
+
+	sprintf(fields, "If-None-Match: %s\r\n", test_assets_list[0].plain.etag);
+	handler = asset_rate(&t, "page/status.htm", "", "HTTP/1.1 200 OK");
+	asset = asset_rate(&t, "index.htm", "", "HTTP/1.1 200 OK");
+	cached = asset_rate(&t, "index.htm", fields, "HTTP/1.1 304 Not Modified");
+	client_close(&t);
+
+	kprintf("Requests/s: handler %lu, static asset %lu, not modified %lu\n",
+		handler, asset, cached);
+	return (handler && asset && cached) ? 0 : -1;
+}
+
+static int http_serverTest(void)
+{
+	if (server_keepAliveTest() || server_http10Test()
+		|| server_concurrencyTest() || server_benchmark()
+		|| server_assetTest() || server_longHeaderTest()
+		|| server_assetBenchmark())
+		return -1;
+
+	return 0;
+}
+
+
 
 int http_testSetup(void)
 {
+	struct ip_addr addr, netmask, gw;
+
 	kdbg_init();
+	timer_init();
+	proc_init();
+
+	tcpip_init(NULL, NULL);
+	IP4_ADDR(&addr, 127, 0, 0, 1);
+	IP4_ADDR(&netmask, 255, 0, 0, 0);
+	IP4_ADDR(&gw, 127, 0, 0, 1);
+	netif_add(&loop_netif, &addr, &netmask, &gw, NULL, loopif_init, tcpip_input);
+	netif_set_up(&loop_netif);
+
+	for (size_t i = 0; i < sizeof(big_chunk); i++)
+		big_chunk[i] = 'a' + i % 26;
+
+	server = netconn_new(NETCONN_TCP);
+	netconn_bind(server, IP_ADDR_ANY, TEST_PORT);
+	netconn_listen(server);
+
+	http_init(legacy_handler, test_cgi);
+	http_setAssets(&test_assets);
+	proc_new(server_proc, NULL, sizeof(server_stack), server_stack);
 	return 0;
 }
 
@@ -295,7 +893,7 @@ int http_testRun(void)
 		}
 	}
 
-	return 0;
+	return http_serverTest();
 
 error:
 	kprintf("Error!\n");
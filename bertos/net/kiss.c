@@ -38,6 +38,7 @@
  * It also passes data the other way
  * It implements KISS commands 1-6
  * It uses the standard p-persist algorithms for keying of a radio
+ * It serves one or more modems, addressed by the port nibble of the command byte
  *
  */
 
@@ -86,7 +87,11 @@
 #define WAIT_FOR_PARAMETER 3
 #define WAIT_FOR_TRANSPOSE 4
 #define WAIT_FOR_DATA      5
-#define WAIT_FOR_TRANSMIT  6
+
+// octets from the serial port decoded at a time
+#define KISS_SERIAL_CHUNK  32
+
+#define KISS_PORT(cmd)     ((cmd) >> 4)
 
 
 
@@ -94,16 +99,18 @@
  * Load kiss parameters from eeprom
  * Check a basic crc and if in error then load a set of defaults
  *
- * \param k kiss context
+ * \param k kiss port
  *
  */
-static void load_params (KissCtx * k)
+static void load_params (KissPort * k)
 {
+	static const Params blank;
 	uint8_t sum;
 	KISS_EEPROM_LOAD ();
 
 	sum = k->params.txdelay + k->params.persist + k->params.slot + k->params.txtail + k->params.duplex + k->params.hware;
-	if (k->params.chksum != sum)
+	// a blank backing store passes the checksum too
+	if (k->params.chksum != sum || memcmp (&k->params, &blank, sizeof (blank)) == 0)
 	{
 		LOG_WARN ("Bad EPROM Checksum - loading defaults\n");
 		// load sensible defaults if backing store has a bad checksum
@@ -121,10 +128,10 @@ static void load_params (KissCtx * k)
  * Save kiss parameters to eeprom
  * Calculate and store a basic CRC with the data
  *
- * \param k kiss context
+ * \param k kiss port
  *
  */
-static void save_params (KissCtx * k)
+static void save_params (KissPort * k)
 {
 	k->params.chksum =
 		(k->params.txdelay + k->params.persist + k->params.slot + k->params.txtail + k->params.duplex + k->params.hware);
@@ -145,28 +152,72 @@ static void save_params (KissCtx * k)
  */
 static void kiss_decode_command (KissCtx * k, uint8_t b)
 {
-	switch (k->command)
+	KissPort *port = &k->port[KISS_PORT (k->command)];
+
+	switch (k->command & 0x0f)
 	{
 	case TXDELAY:
-		k->params.txdelay = b;
+		port->params.txdelay = b;
 		break;
 	case PERSIST:
-		k->params.persist = b;
+		port->params.persist = b;
 		break;
 	case SLOT:
-		k->params.slot = b;
+		port->params.slot = b;
 		break;
 	case TXTAIL:
-		k->params.txtail = b;
+		port->params.txtail = b;
 		break;
 	case DUPLEX:
-		k->params.duplex = b;
+		port->params.duplex = b;
 		break;
 	case HARDWARE:
 		LOG_INFO ("Hardware command not supported");
 		break;
 	}
-	save_params (k);
+	save_params (port);
+}
+
+
+/**
+ * Find the first octet that needs escaping
+ *
+ * \param buf data to scan
+ * \param len data length
+ *
+ * \return the number of octets before the first FEND or FESC, \a len if none
+ */
+static size_t kiss_scan (const uint8_t * buf, size_t len)
+{
+	const uint8_t *p = buf;
+	const uint8_t *end = buf + len;
+
+#if CPU_REG_BITS >= 32
+	// true if any octet of v is zero
+	#define HAS_ZERO(v)  (((v) - 0x01010101UL) & ~(v) & 0x80808080UL)
+
+	while (p < end && ((uintptr_t) p & 3))
+	{
+		if (*p == FEND || *p == FESC)
+			return p - buf;
+		p++;
+	}
+
+	// skip four octets at a time, the exact position is found below
+	for (; end - p >= 4; p += 4)
+	{
+		uint32_t w = *(const uint32_t *) (const void *) p;
+
+		if (HAS_ZERO (w ^ 0xC0C0C0C0UL) | HAS_ZERO (w ^ 0xDBDBDBDBUL))
+			break;
+	}
+	#undef HAS_ZERO
+#endif
+
+	while (p < end && *p != FEND && *p != FESC)
+		p++;
+
+	return p - buf;
 }
 
 
@@ -195,26 +246,27 @@ static void kiss_decode_command (KissCtx * k, uint8_t b)
  * Check KISS parameters to see if/when we can transmit
  *
  * \param k kiss context
+ * \param f frame to transmit
  *
  * \return bool true if transmit completed
  */
-static bool kiss_tx_to_modem (KissCtx * k)
+static bool kiss_tx_to_modem (KissCtx * k, const KissFrame * f)
 {
+	KissPort *port = &k->port[f->port];
 	uint16_t i;
 
 	// not really full duplex, we just crash over any other traffic on the channel
-	if (k->params.duplex)
+	if (port->params.duplex)
 	{
-		for (i = 0; i < k->tx_pos; i++)
-			kfile_putc (k->tx_buf[i], k->modem);
-		kfile_flush (k->modem);	  // wait for transmitter to finish
+		kfile_write (port->modem, f->buf, f->len);
+		kfile_flush (port->modem);	  // wait for transmitter to finish
 		return true;
 	}
 
 	// see if the channel is busy
-	if (k->rx_pos > 0)
+	if (port->rx_pos > 0 || (port->rxq && hdlc_frameRxBusy (port->rxq)))
 	{
-		timer_delay (k->params.slot * 10);
+		timer_delay (port->params.slot * 10);
 		rand ();						  // stir random up a bit
 		return false;				  // next time round we may be OK to TX
 	}
@@ -223,11 +275,10 @@ static bool kiss_tx_to_modem (KissCtx * k)
 	{
 		i = rand ();
 		// make an 8 bit random number from a 16 bit one
-		if (((i >> 8) ^ (i & 0xff)) < k->params.persist)
+		if (((i >> 8) ^ (i & 0xff)) < port->params.persist)
 		{
-			for (i = 0; i < k->tx_pos; i++)
-				kfile_putc (k->tx_buf[i], k->modem);
-			kfile_flush (k->modem);	// wait for transmitter to finish
+			kfile_write (port->modem, f->buf, f->len);
+			kfile_flush (port->modem);	// wait for transmitter to finish
 			return true;
 		}
 		else
@@ -246,34 +297,38 @@ static bool kiss_tx_to_modem (KissCtx * k)
  * Encode the raw ax25 data as a KISS protocol stream
  *
  * \param k KISS context
+ * \param port port the frame was received from
+ * \param buf frame to encode
+ * \param size frame length
  *
  */
-static void kiss_tx_to_serial (KissCtx * k)
+static void kiss_tx_to_serial (KissCtx * k, uint8_t port, const uint8_t * buf, uint16_t size)
 {
 	/// function used by KISS poll to process completed rx'd packets
 	/// here, we're just pumping out the KISS data to the serial object
+	/// in runs of octets that need no escaping
 
-	uint16_t len;
-	uint8_t c;
+	uint8_t esc[2] = { FEND, (uint8_t) (port << 4) };   /// data command on the given port
 
-	kfile_putc (FEND, k->serial);
-	kfile_putc (0, k->serial);       /// channel 0, data command
+	kfile_write (k->serial, esc, sizeof (esc));
 
-	for (len = 0; len < k->rx_pos; len++)
+	while (size)
 	{
-		c = k->rx_buf[len];
-		switch (c)
+		size_t run = kiss_scan (buf, size);
+
+		if (run)
 		{
-		case FEND:
-			kfile_putc (FESC, k->serial);
-			kfile_putc (TFEND, k->serial);
-			break;
-		case FESC:
-			kfile_putc (FESC, k->serial);
-			kfile_putc (TFESC, k->serial);
-			break;
-		default:
-			kfile_putc (c, k->serial);
+			kfile_write (k->serial, buf, run);
+			buf += run;
+			size -= run;
+		}
+		if (size)
+		{
+			esc[0] = FESC;
+			esc[1] = (*buf == FEND) ? TFEND : TFESC;
+			kfile_write (k->serial, esc, sizeof (esc));
+			buf++;
+			size--;
 		}
 	}
 
@@ -282,87 +337,160 @@ static void kiss_tx_to_serial (KissCtx * k)
 
 
 /**
- * Read incoming binary data from the modem
- * Encode into SLIP encoded data prefixed by a KISS data command and add to KISS object's buffer
- * Pass up to the serial port if HDLC CRC is OK
+ * Read incoming binary data from one modem
  *
  * \param k kiss context
+ * \param p port to read
  *
  */
-void kiss_poll_modem (KissCtx * k)
+static void kiss_poll_port (KissCtx * k, uint8_t p)
 {
+	KissPort *port = &k->port[p];
 	int c;
 
+	if (port->rxq)
+	{
+		HdlcFrame *frm;
+
+		// encode frames in place, straight from the modem buffers
+		while ((frm = hdlc_frameGet (port->rxq)))
+		{
+			if (frm->len >= CONFIG_KISS_MIN_FRAME_LEN - HDLC_FCS_LEN)
+			{
+				LOG_INFO ("Frame found!\n");
+				kiss_tx_to_serial (k, p, frm->buf, frm->len);
+			}
+			hdlc_frameRelease (port->rxq);
+		}
+		return;
+	}
+
 	// get octets from modem
-	while ((c = kfile_getc (k->modem)) != EOF)
+	while ((c = kfile_getc (port->modem)) != EOF)
 	{
-		if (k->rx_pos < CONFIG_KISS_FRAME_BUF_LEN)
+		if (port->rx_pos < CONFIG_KISS_FRAME_BUF_LEN)
 		{
-			k->rx_buf[k->rx_pos++] = c;
+			port->rx_buf[port->rx_pos++] = c;
 		}
 	}
 
-	switch (kfile_error (k->modem))
+	switch (kfile_error (port->modem))
 	{
 	case HDLC_PKT_AVAILABLE:
-		if (k->rx_pos >= CONFIG_KISS_MIN_FRAME_LEN)
+		if (port->rx_pos >= CONFIG_KISS_MIN_FRAME_LEN)
 		{
-			k->rx_pos -= 2;            // drop the CRC octets
+			port->rx_pos -= 2;            // drop the CRC octets
 			LOG_INFO ("Frame found!\n");
-			kiss_tx_to_serial (k);
+			kiss_tx_to_serial (k, p, port->rx_buf, port->rx_pos);
 		}
-		kfile_clearerr (k->modem);
-		k->rx_pos = 0;
+		kfile_clearerr (port->modem);
+		port->rx_pos = 0;
 		break;
 	case HDLC_ERROR_CRC:
 		LOG_INFO ("CRC error\n");
-		kfile_clearerr (k->modem);
-		k->rx_pos = 0;
+		kfile_clearerr (port->modem);
+		port->rx_pos = 0;
 		break;
 	case HDLC_ERROR_OVERRUN:
-		if (k->rx_pos >= CONFIG_KISS_MIN_FRAME_LEN)
+		if (port->rx_pos >= CONFIG_KISS_MIN_FRAME_LEN)
 			LOG_INFO ("Buffer overrun\n");
-		kfile_clearerr (k->modem);
-		k->rx_pos = 0;
+		kfile_clearerr (port->modem);
+		port->rx_pos = 0;
 		break;
 	case HDLC_ERROR_ABORT:
-		if (k->rx_pos >= CONFIG_KISS_MIN_FRAME_LEN)
+		if (port->rx_pos >= CONFIG_KISS_MIN_FRAME_LEN)
 			LOG_INFO ("Data abort\n");
-		kfile_clearerr (k->modem);
-		k->rx_pos = 0;
+		kfile_clearerr (port->modem);
+		port->rx_pos = 0;
 		break;
 //    default: // ignore other states
 	}
 }
 
 
+/**
+ * Read incoming binary data from the modems
+ * Encode into SLIP encoded data prefixed by a KISS data command and add to KISS object's buffer
+ * Pass up to the serial port if HDLC CRC is OK
+ *
+ * \param k kiss context
+ *
+ */
+void kiss_poll_modem (KissCtx * k)
+{
+	for (uint8_t p = 0; p < CONFIG_KISS_PORTS; p++)
+		if (k->port[p].modem)
+			kiss_poll_port (k, p);
+}
+
 
 /**
- * Read incoming KISS data from serial port
- * Decode the SLIP encoded data and add to KISS object's buffer
- * TX to radio if appropriate
+ * Transmit the queued frames, as long as the channel allows
  *
  * \param k kiss context
- * \return true if param command processed
  *
  */
-bool kiss_poll_serial (KissCtx * k)
+static void kiss_tx_queued (KissCtx * k)
 {
+	while (k->tx_cnt && kiss_tx_to_modem (k, &k->txq[k->tx_tail]))
+	{
+		k->tx_tail = (k->tx_tail + 1) % CONFIG_KISS_TXQUEUE_LEN;
+		k->tx_cnt--;
+	}
+}
 
-	int c;
-	uint8_t b;
+
+/**
+ * Append octets to the frame being received from the serial port
+ * Frames that would overflow the buffer are thrown away
+ */
+static void kiss_append (KissCtx * k, KissFrame * f, const uint8_t * buf, size_t len)
+{
+	if (f->len + len > CONFIG_KISS_FRAME_BUF_LEN - 2)
+	{
+		LOG_INFO ("Frame too long\n");
+		f->len = 0;
+		k->state = WAIT_FOR_FEND;
+		return;
+	}
+	memcpy (f->buf + f->len, buf, len);
+	f->len += len;
+}
+
+
+/**
+ * Decode a chunk of KISS data
+ *
+ * \param k kiss context
+ * \param buf data read from the serial port
+ * \param len data length
+ * \return true if param command processed
+ *
+ */
+static bool kiss_decode (KissCtx * k, const uint8_t * buf, size_t len)
+{
+	const uint8_t *end = buf + len;
+	// frame being received, valid only while receiving data
+	KissFrame *f = &k->txq[(k->tx_tail + k->tx_cnt) % CONFIG_KISS_TXQUEUE_LEN];
 	bool ret = false;
+	uint8_t b;
 
-	while ((c = kfile_getc (k->serial)) != EOF)
+	while (buf < end)
 	{
+		// fast path: copy whole runs of plain data
+		if (k->state == WAIT_FOR_DATA)
+		{
+			size_t run = kiss_scan (buf, end - buf);
 
-		k->last_tick = timer_clock ();
-		// about to overflow buffer? reset
-		if (k->tx_pos >= (CONFIG_KISS_FRAME_BUF_LEN - 2))
-			k->tx_pos = 0;
+			if (run)
+			{
+				kiss_append (k, f, buf, run);
+				buf += run;
+				continue;
+			}
+		}
 
-		// trim value to 0-255, maybe add to buffer
-		b = c & 0x00FF;
+		b = *buf++;
 
 		switch (k->state)			  // see what we are looking for
 		{
@@ -373,18 +501,25 @@ bool kiss_poll_serial (KissCtx * k)
 		case WAIT_FOR_COMMAND:
 			if (b == FEND)			  // may get two FEND in a row!!
 				break;
-			if ((b & 0xf0) != 0)	  // we only support channel 0
+			if (KISS_PORT (b) >= CONFIG_KISS_PORTS || !k->port[KISS_PORT (b)].modem)
 			{
-				LOG_INFO ("Only KISS channel 0 supported");
+				LOG_INFO ("KISS port %d not available\n", KISS_PORT (b));
 				k->state = WAIT_FOR_FEND;
 			}
 			else if ((b & 0x0f) != 0)
 			{
 				k->state = WAIT_FOR_PARAMETER;
-				k->command = b & 0x0f;
+				k->command = b;
+			}
+			else if (k->tx_cnt >= CONFIG_KISS_TXQUEUE_LEN)
+			{
+				LOG_INFO ("TX queue full\n");
+				k->state = WAIT_FOR_FEND;
 			}
 			else
 			{
+				f->port = KISS_PORT (b);
+				f->len = 0;
 				k->state = WAIT_FOR_DATA;	// command == data
 			}
 			break;
@@ -403,68 +538,144 @@ bool kiss_poll_serial (KissCtx * k)
 				b = FESC;
 				break;
 			}
-			k->tx_buf[k->tx_pos++] = b;
 			k->state = WAIT_FOR_DATA;
+			kiss_append (k, f, &b, 1);
 			break;
 		case WAIT_FOR_DATA:
 			if (b == FESC)
 			{
 				k->state = WAIT_FOR_TRANSPOSE;
 			}
-			else if (b == FEND)
+			else if (f->len >= CONFIG_KISS_MIN_FRAME_LEN)
 			{
-				if (k->tx_pos >= CONFIG_KISS_MIN_FRAME_LEN)
-				{
-					k->state = WAIT_FOR_TRANSMIT;
-				}
-				else
-				{
-					k->tx_pos = 0;	  // too short - throw it away
-					k->state = WAIT_FOR_COMMAND;	// might be starting a new frame
-				}
+				// FEND: queue the frame and start the next one
+				if (++k->tx_cnt == CONFIG_KISS_TXQUEUE_LEN)
+					kiss_tx_queued (k);   // try to make room
+				f = &k->txq[(k->tx_tail + k->tx_cnt) % CONFIG_KISS_TXQUEUE_LEN];
+				k->state = WAIT_FOR_COMMAND;
 			}
 			else
 			{
-				k->tx_buf[k->tx_pos++] = b;
+				f->len = 0;	  // too short - throw it away
+				k->state = WAIT_FOR_COMMAND;	// might be starting a new frame
 			}
 			break;
 		}
 	}
 
-	if (k->state == WAIT_FOR_TRANSMIT)
+	return ret;
+}
+
+
+/**
+ * Read incoming KISS data from serial port
+ * Decode the SLIP encoded data and add to KISS object's queue
+ * TX to radio if appropriate
+ *
+ * \param k kiss context
+ * \return true if param command processed
+ *
+ */
+bool kiss_poll_serial (KissCtx * k)
+{
+	uint8_t chunk[KISS_SERIAL_CHUNK];
+	size_t len;
+	int c = 0;
+	bool ret = false;
+	bool got = false;
+
+	/*
+	 * Collect octets one at a time, as a serial port with a timeout would
+	 * block on a read larger than what its fifo holds, but decode them in
+	 * batches.
+	 */
+	while (c != EOF)
 	{
-		// note that we throw data away while we wait to transmit
-		if (kiss_tx_to_modem (k))
+		for (len = 0; len < sizeof (chunk); len++)
 		{
-			k->tx_pos = 0;			  // reset buffer pointer when we've done
-			k->state = WAIT_FOR_COMMAND;	// might be starting a frame
+			if ((c = kfile_getc (k->serial)) == EOF)
+				break;
+			chunk[len] = c;
+		}
+
+		if (len)
+		{
+			got = true;
+			ret |= kiss_decode (k, chunk, len);
 		}
 	}
 
+	// frames keep queueing while we wait to transmit
+	kiss_tx_queued (k);
+
+	if (got)
+		k->last_tick = timer_clock ();
+
 	// sanity checks
-	// no serial input in last 2 secs?
-	if (timer_clock () - k->last_tick > ms_to_ticks (2000L))
-		k->tx_pos = 0;
+	// no serial input in last 2 secs? drop the partial frame
+	if (timer_clock () - k->last_tick > ms_to_ticks (2000L)
+		&& (k->state == WAIT_FOR_DATA || k->state == WAIT_FOR_TRANSPOSE))
+	{
+		k->txq[(k->tx_tail + k->tx_cnt) % CONFIG_KISS_TXQUEUE_LEN].len = 0;
+		k->state = WAIT_FOR_FEND;
+	}
 	
 	return ret;
 }
 
 
+/**
+ * Get the TX delay and tail of port 0
+ */
 void kiss_poll_params(KissCtx * k, uint8_t *head, uint8_t *tail)
 {
-	*head = k->params.txdelay;
-	*tail = k->params.txtail;
+	*head = k->port[0].params.txdelay;
+	*tail = k->port[0].params.txtail;
 
 
 }
 
 
+/**
+ * Take received frames from a frame queue instead of reading
+ * the modem octet by octet.
+ *
+ * \param k kiss context
+ * \param port modem port
+ * \param q queue of received frames, see afsk_setRxFrames()
+ *
+ */
+void kiss_setRxFrames (KissCtx * k, uint8_t port, HdlcFrameQueue * q)
+{
+	ASSERT (port < CONFIG_KISS_PORTS);
+	k->port[port].rxq = q;
+}
+
+
+/**
+ * Add a modem to the KISS context
+ *
+ * \param k kiss context
+ * \param port port number, less than CONFIG_KISS_PORTS
+ * \param channel KFile object to the modem
+ *
+ */
+void kiss_addPort (KissCtx * k, uint8_t port, KFile * channel)
+{
+	ASSERT (port < CONFIG_KISS_PORTS);
+	ASSERT (channel);
+
+	k->port[port].modem = channel;
+	load_params (&k->port[port]);
+}
+
+
 /**
  * Initialise the KISS context
  * Check KISS parameters to see if/when we can transmit
  *
  * \param k kiss context
- * \param channel KFile object to the modem
+ * \param channel KFile object to the modem on port 0
  * \param serial KFile object to the serial (UART) port
  *
  */
@@ -476,11 +687,10 @@ void kiss_init (KissCtx * k, KFile * channel, KFile * serial)
 	ASSERT (serial);
 
 	memset (k, 0, sizeof (*k));
-	k->modem = channel;
 	k->serial = serial;
 	k->state = WAIT_FOR_FEND;
 
 	// get KISS parameters from EEPROM
-	load_params (k);
+	kiss_addPort (k, 0, channel);
 
 }
@@ -41,6 +41,14 @@
  * You will see how to implement the KISS protocol, init the afsk de/modulator and
  * how to process messages using ax25 module and how the p-persist algorithm works.
  *
+ * A single context can serve up to CONFIG_KISS_PORTS modems: port 0 is
+ * set by kiss_init(), the others are added with kiss_addPort(). The port
+ * is carried in the high nibble of the KISS command byte, both ways.
+ *
+ * Frames coming from the host are queued (see CONFIG_KISS_TXQUEUE_LEN)
+ * while the radio channel of their port is busy, so the serial line
+ * keeps being decoded in the meantime.
+ *
  * $WIZ$ module_name = "kiss"
  * $WIZ$ module_configuration = "bertos/cfg/cfg_kiss.h"
  * $WIZ$ module_depends = "timer", "kfile", "hdlc"
@@ -55,6 +63,7 @@
 #include <cfg/compiler.h>
 
 #include <io/kfile.h>
+#include <net/hdlc.h>
 
 
 
@@ -73,26 +82,48 @@ typedef struct Params
 
 
 
-typedef struct KissCtx
+/**
+ * A modem served by a KISS context.
+ */
+typedef struct KissPort
 {
+	KFile *modem;                                ///< I/f to the afsk modem, NULL if the port is not used
+	HdlcFrameQueue *rxq;                         ///< Frames received by the modem, NULL to read octets from \a modem
 	uint8_t rx_buf[CONFIG_KISS_FRAME_BUF_LEN];   ///< Buffer of decoded data prior to transmission to serial
 	uint16_t rx_pos;                             ///< Offset in buffer of next octet
-	uint8_t tx_buf[CONFIG_KISS_FRAME_BUF_LEN];   ///< buffer of decoded KISS data prior to transmission to the modem
-	uint16_t tx_pos;                             ///< Offset in buffer of next octet
-	KFile *modem;                                ///< I/f to the afsk modem
+	Params params;                               ///< Operational KISS Parameters that control transmission
+} KissPort;
+
+/**
+ * A frame received from the host, waiting to be transmitted.
+ */
+typedef struct KissFrame
+{
+	uint8_t buf[CONFIG_KISS_FRAME_BUF_LEN];      ///< Decoded KISS data
+	uint16_t len;                                ///< Number of octets in buffer
+	uint8_t port;                                ///< Destination port
+} KissFrame;
+
+typedef struct KissCtx
+{
+	KissPort port[CONFIG_KISS_PORTS];            ///< Modem ports
+	KissFrame txq[CONFIG_KISS_TXQUEUE_LEN];      ///< Frames waiting for the channel, plus the one being decoded
+	uint8_t tx_tail;                             ///< First frame waiting to be transmitted
+	uint8_t tx_cnt;                              ///< Number of frames waiting to be transmitted
 	KFile *serial;                               ///< I/f to the serial port
 	uint8_t command;                             ///< KISS command byte
 	uint8_t state;                               ///< what data we are expecting next
-	ticks_t last_tick;                           ///< timestamp of last byte into tx_buf
-	Params params;                               ///< Operational KISS Parameters that control transmission
+	ticks_t last_tick;                           ///< timestamp of last byte from the serial port
 } KissCtx;
 
 
 
 void kiss_init (KissCtx * k, KFile * channel, KFile * serial);
+void kiss_addPort (KissCtx * k, uint8_t port, KFile * channel);
 bool kiss_poll_serial (KissCtx * k);
 void kiss_poll_modem (KissCtx * k);
 void kiss_poll_params(KissCtx * k, uint8_t *head, uint8_t *tail);
+void kiss_setRxFrames (KissCtx * k, uint8_t port, HdlcFrameQueue * q);
 
 /** \} */ //defgroup kiss_module
 
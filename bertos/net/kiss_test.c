@@ -33,6 +33,10 @@
  * \brief KISS test.
  *
  * $test$: cp bertos/cfg/cfg_kiss.h $cfgdir/
+ * $test$: echo "#undef CONFIG_KISS_PORTS" >> $cfgdir/cfg_kiss.h
+ * $test$: echo "#define CONFIG_KISS_PORTS 2" >> $cfgdir/cfg_kiss.h
+ * $test$: echo "#undef CONFIG_KISS_TXQUEUE_LEN" >> $cfgdir/cfg_kiss.h
+ * $test$: echo "#define CONFIG_KISS_TXQUEUE_LEN 4" >> $cfgdir/cfg_kiss.h
  *
  * \author Robin Gilks <g8ecj@gilks.org>
  */
@@ -40,9 +44,13 @@
 #include "kiss.h"
 #include "hdlc.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #include <struct/kfile_mem.h>
+#include <struct/kfile_fifo.h>
+
+#include <drv/timer.h>
 
 #include <cfg/debug.h>
 #include <cfg/kfile_debug.h>
@@ -77,10 +85,225 @@ test_bodge (UNUSED_ARG (KFile *, fd))
 	return HDLC_PKT_AVAILABLE;
 }
 
+/*
+ * Reference SLIP encoder, one octet at a time
+ */
+static void kiss_encodeRef (KFile * fd, uint8_t port, const uint8_t * buf, size_t len)
+{
+	kfile_putc (192, fd);
+	kfile_putc (port << 4, fd);
+	for (size_t i = 0; i < len; i++)
+	{
+		if (buf[i] == 192)
+		{
+			kfile_putc (219, fd);
+			kfile_putc (220, fd);
+		}
+		else if (buf[i] == 219)
+		{
+			kfile_putc (219, fd);
+			kfile_putc (221, fd);
+		}
+		else
+			kfile_putc (buf[i], fd);
+	}
+	kfile_putc (192, fd);
+}
+
+/*
+ * Reference SLIP decoder of a single data frame, one octet at a time
+ */
+static size_t kiss_decodeRef (KFile * fd, uint8_t * buf)
+{
+	size_t len = 0;
+	int c;
+
+	while ((c = kfile_getc (fd)) != EOF && c != 192)
+		;
+	c = kfile_getc (fd);	  // command
+	while ((c = kfile_getc (fd)) != EOF && c != 192)
+	{
+		if (c == 219)
+			c = (kfile_getc (fd) == 220) ? 192 : 219;
+		buf[len++] = c;
+	}
+	return len;
+}
+
+#define TEST_FRAMES     8
+#define TEST_FRAME_LEN  256
+
+static uint8_t frames[TEST_FRAMES][TEST_FRAME_LEN];
+static uint8_t serial_buf[TEST_FRAMES * TEST_FRAME_LEN * 2 + 64];
+static uint8_t modem_buf[2][TEST_FRAMES * TEST_FRAME_LEN];
+static KFileMem modem[2];
+static KFileMem serial;
+
+static void kiss_makeFrames (void)
+{
+	for (int i = 0; i < TEST_FRAMES; i++)
+		for (int j = 0; j < TEST_FRAME_LEN; j++)
+			frames[i][j] = rand ();
+	// make sure escapes at the edges are handled
+	frames[0][0] = 192;
+	frames[0][TEST_FRAME_LEN - 1] = 219;
+	frames[1][0] = 219;
+	frames[1][1] = 192;
+}
+
+static uint8_t fifo_buf[64];
+static FIFOBuffer fifo;
+static KFileFifo pipe;
+
+/*
+ * Feed the serial port through a fifo in pieces of random size
+ */
+static void kiss_feed (const uint8_t * buf, size_t len)
+{
+	const uint8_t *end = buf + len;
+
+	while (buf < end)
+	{
+		size_t n = MIN ((size_t) (rand () % sizeof (fifo_buf)), (size_t) (end - buf));
+
+		buf += kfile_write (&pipe.fd, buf, n);
+		kiss_poll_serial (&kiss);
+	}
+}
+
+/*
+ * Frames for two ports multiplexed on one serial line.
+ */
+static void kiss_testPorts (void)
+{
+	static const uint8_t duplex[] = { 192, 0x05, 1, 192, 192, 0x15, 1, 192 };
+	static HdlcFrame hdlc_frames[4];
+	static HdlcFrameQueue rxq;
+	KFileMem ref;
+
+	fifo_init (&fifo, fifo_buf, sizeof (fifo_buf));
+	kfilefifo_init (&pipe, &fifo);
+	kfilemem_init (&modem[0], modem_buf[0], sizeof (modem_buf[0]));
+	kfilemem_init (&modem[1], modem_buf[1], sizeof (modem_buf[1]));
+	kiss_init (&kiss, &modem[0].fd, &pipe.fd);
+	kiss_addPort (&kiss, 1, &modem[1].fd);
+
+	// encode the test stream: even frames go to port 0, odd ones to port 1
+	kfilemem_init (&ref, serial_buf, sizeof (serial_buf));
+	kfile_write (&ref.fd, duplex, sizeof (duplex));
+	for (int i = 0; i < TEST_FRAMES; i++)
+		kiss_encodeRef (&ref.fd, i & 1, frames[i], TEST_FRAME_LEN);
+	kiss_feed (serial_buf, ref.fd.seek_pos);
+	ASSERT (kiss.port[0].params.duplex && kiss.port[1].params.duplex);
+	ASSERT (kiss.tx_cnt == 0);
+	for (int i = 0; i < TEST_FRAMES; i++)
+		ASSERT (memcmp (modem_buf[i & 1] + (i / 2) * TEST_FRAME_LEN, frames[i], TEST_FRAME_LEN) == 0);
+	kprintf ("serial to modem multi-port data flow OK\n");
+
+	// a busy channel queues the frames from the serial port
+	kfilemem_init (&modem[0], modem_buf[0], sizeof (modem_buf[0]));
+	kiss.port[0].params.duplex = 0;
+	kiss.port[0].rx_pos = 1;
+	for (int i = 0; i < 3; i++)
+	{
+		kfilemem_init (&ref, serial_buf, sizeof (serial_buf));
+		kiss_encodeRef (&ref.fd, 0, frames[i], TEST_FRAME_LEN);
+		kiss_feed (serial_buf, ref.fd.seek_pos);
+	}
+	ASSERT (kiss.tx_cnt == 3);
+	ASSERT (modem[0].fd.seek_pos == 0);
+	kiss.port[0].rx_pos = 0;
+	kiss.port[0].params.duplex = 1;
+	kiss_poll_serial (&kiss);
+	ASSERT (kiss.tx_cnt == 0);
+	ASSERT (memcmp (modem_buf[0], frames[0], 3 * TEST_FRAME_LEN) == 0);
+	kprintf ("serial to modem queueing OK\n");
+
+	// modem to serial on port 1
+	kfilemem_init (&serial, serial_buf, sizeof (serial_buf));
+	kiss.serial = &serial.fd;
+	hdlc_frameQueueInit (&rxq, hdlc_frames, countof (hdlc_frames));
+	kiss_setRxFrames (&kiss, 1, &rxq);
+	memcpy (hdlc_frames[0].buf, frames[0], TEST_FRAME_LEN);
+	hdlc_frames[0].len = TEST_FRAME_LEN;
+	rxq.head = 1;
+	kiss_poll_modem (&kiss);
+	ASSERT (serial_buf[1] == 0x10);
+	kfile_seek (&serial.fd, 0, KSM_SEEK_SET);
+	ASSERT (kiss_decodeRef (&serial.fd, modem_buf[1]) == TEST_FRAME_LEN);
+	ASSERT (memcmp (modem_buf[1], frames[0], TEST_FRAME_LEN) == 0);
+	kprintf ("modem to serial multi-port data flow OK\n");
+}
+
+#define BENCH(bytes, code) \
+	({ \
+		ticks_t start = timer_clock (); \
+		unsigned long done = 0; \
+		while (timer_clock () - start < ms_to_ticks (200)) \
+		{ \
+			code; \
+			done += (bytes); \
+		} \
+		(unsigned long) (done / ticks_to_ms (timer_clock () - start)); \
+	})
+
+static void kiss_benchmark (void)
+{
+	static HdlcFrame hdlc_frames[TEST_FRAMES + 1];
+	static HdlcFrameQueue rxq;
+	unsigned long ref, batch;
+	size_t len;
+
+	for (int i = 0; i < TEST_FRAMES; i++)
+	{
+		memcpy (hdlc_frames[i].buf, frames[i], TEST_FRAME_LEN);
+		hdlc_frames[i].len = TEST_FRAME_LEN;
+	}
+	kfilemem_init (&serial, serial_buf, sizeof (serial_buf));
+	kfilemem_init (&modem[0], modem_buf[0], sizeof (modem_buf[0]));
+	kiss_init (&kiss, &modem[0].fd, &serial.fd);
+	kiss.port[0].params.duplex = 1;
+	kiss_setRxFrames (&kiss, 0, &rxq);
+
+	ref = BENCH (TEST_FRAMES * TEST_FRAME_LEN,
+	{
+		kfile_seek (&serial.fd, 0, KSM_SEEK_SET);
+		for (int i = 0; i < TEST_FRAMES; i++)
+			kiss_encodeRef (&serial.fd, 0, frames[i], TEST_FRAME_LEN);
+	});
+	batch = BENCH (TEST_FRAMES * TEST_FRAME_LEN,
+	{
+		kfile_seek (&serial.fd, 0, KSM_SEEK_SET);
+		hdlc_frameQueueInit (&rxq, hdlc_frames, countof (hdlc_frames));
+		hdlc_frames[0].len = TEST_FRAME_LEN;
+		rxq.head = TEST_FRAMES;
+		kiss_poll_modem (&kiss);
+	});
+	kprintf ("KISS encode: %lu KB/s octet by octet, %lu KB/s batched\n", ref, batch);
+	len = serial.fd.seek_pos;
+
+	ref = BENCH (TEST_FRAMES * TEST_FRAME_LEN,
+	{
+		kfile_seek (&serial.fd, 0, KSM_SEEK_SET);
+		for (int i = 0; i < TEST_FRAMES; i++)
+			kiss_decodeRef (&serial.fd, modem_buf[0]);
+	});
+	serial.fd.size = len;
+	batch = BENCH (TEST_FRAMES * TEST_FRAME_LEN,
+	{
+		kfile_seek (&serial.fd, 0, KSM_SEEK_SET);
+		kfile_seek (&modem[0].fd, 0, KSM_SEEK_SET);
+		kiss_poll_serial (&kiss);
+	});
+	kprintf ("KISS decode: %lu KB/s octet by octet, %lu KB/s batched\n", ref, batch);
+	ASSERT (memcmp (modem_buf[0], frames[0], sizeof (modem_buf[0])) == 0);
+}
+
 int
 kiss_testSetup (void)
 {
 	kdbg_init ();
+	timer_init ();
 	// what I send into the kiss module via the modem interface
 	kfilemem_init (&mem, kiss_packet_raw, sizeof (kiss_packet_raw));
 	// actually get stuff back into kiss_packet_rx
@@ -111,6 +334,10 @@ kiss_testRun (void)
 	kiss_poll_serial (&kiss);
 	ASSERT (memcmp (kiss_packet_rx, kiss_packet_raw, sizeof (kiss_packet_raw - 2)) == 0);  // ignore CRC in check
 	kprintf ("serial to modem binary data flow OK\n");
+
+	kiss_makeFrames ();
+	kiss_testPorts ();
+	kiss_benchmark ();
 	return 0;
 }
 
@@ -233,6 +233,7 @@ static void
 tcpip_thread(void *arg)
 {
   struct tcpip_msg *msg;
+  int n;
   LWIP_UNUSED_ARG(arg);
 
 #if IP_REASSEMBLY
@@ -262,53 +263,58 @@ tcpip_thread(void *arg)
   LOCK_TCPIP_CORE();
   while (1) {                          /* MAIN Loop */
     sys_mbox_fetch(mbox, (void *)&msg);
-    switch (msg->type) {
+    /* Handle the messages already queued before looking at the timeouts again */
+    n = 0;
+    do {
+      switch (msg->type) {
 #if LWIP_NETCONN
-    case TCPIP_MSG_API:
-      LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: API message %p\n", (void *)msg));
-      msg->msg.apimsg->function(&(msg->msg.apimsg->msg));
-      break;
+      case TCPIP_MSG_API:
+        LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: API message %p\n", (void *)msg));
+        msg->msg.apimsg->function(&(msg->msg.apimsg->msg));
+        break;
 #endif /* LWIP_NETCONN */
 
-    case TCPIP_MSG_INPKT:
-      LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: PACKET %p\n", (void *)msg));
+      case TCPIP_MSG_INPKT:
+        LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: PACKET %p\n", (void *)msg));
 #if LWIP_ARP
-      if (msg->msg.inp.netif->flags & NETIF_FLAG_ETHARP) {
-        ethernet_input(msg->msg.inp.p, msg->msg.inp.netif);
-      } else
+        if (msg->msg.inp.netif->flags & NETIF_FLAG_ETHARP) {
+          ethernet_input(msg->msg.inp.p, msg->msg.inp.netif);
+        } else
 #endif /* LWIP_ARP */
-      { ip_input(msg->msg.inp.p, msg->msg.inp.netif);
-      }
-      memp_free(MEMP_TCPIP_MSG_INPKT, msg);
-      break;
+        { ip_input(msg->msg.inp.p, msg->msg.inp.netif);
+        }
+        memp_free(MEMP_TCPIP_MSG_INPKT, msg);
+        break;
 
 #if LWIP_NETIF_API
-    case TCPIP_MSG_NETIFAPI:
-      LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: Netif API message %p\n", (void *)msg));
-      msg->msg.netifapimsg->function(&(msg->msg.netifapimsg->msg));
-      break;
+      case TCPIP_MSG_NETIFAPI:
+        LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: Netif API message %p\n", (void *)msg));
+        msg->msg.netifapimsg->function(&(msg->msg.netifapimsg->msg));
+        break;
 #endif /* LWIP_NETIF_API */
 
-    case TCPIP_MSG_CALLBACK:
-      LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: CALLBACK %p\n", (void *)msg));
-      msg->msg.cb.f(msg->msg.cb.ctx);
-      memp_free(MEMP_TCPIP_MSG_API, msg);
-      break;
-
-    case TCPIP_MSG_TIMEOUT:
-      LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: TIMEOUT %p\n", (void *)msg));
-      sys_timeout(msg->msg.tmo.msecs, msg->msg.tmo.h, msg->msg.tmo.arg);
-      memp_free(MEMP_TCPIP_MSG_API, msg);
-      break;
-    case TCPIP_MSG_UNTIMEOUT:
-      LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: UNTIMEOUT %p\n", (void *)msg));
-      sys_untimeout(msg->msg.tmo.h, msg->msg.tmo.arg);
-      memp_free(MEMP_TCPIP_MSG_API, msg);
-      break;
-
-    default:
-      break;
-    }
+      case TCPIP_MSG_CALLBACK:
+        LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: CALLBACK %p\n", (void *)msg));
+        msg->msg.cb.f(msg->msg.cb.ctx);
+        memp_free(MEMP_TCPIP_MSG_API, msg);
+        break;
+
+      case TCPIP_MSG_TIMEOUT:
+        LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: TIMEOUT %p\n", (void *)msg));
+        sys_timeout(msg->msg.tmo.msecs, msg->msg.tmo.h, msg->msg.tmo.arg);
+        memp_free(MEMP_TCPIP_MSG_API, msg);
+        break;
+      case TCPIP_MSG_UNTIMEOUT:
+        LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: UNTIMEOUT %p\n", (void *)msg));
+        sys_untimeout(msg->msg.tmo.h, msg->msg.tmo.arg);
+        memp_free(MEMP_TCPIP_MSG_API, msg);
+        break;
+
+      default:
+        break;
+      }
+    } while (++n < TCPIP_MSG_BATCH &&
+             sys_mbox_tryfetch(mbox, (void *)&msg) != SYS_MBOX_EMPTY);
   }
 }
 
@@ -13,14 +13,11 @@
 #include <lwip/sys.h>
 
 #include <kern/signal.h>
-#include <kern/msg.h>
 #include <kern/proc.h>
 #include <kern/proc_p.h>
 
 #include <struct/heap.h>
 
-#include <mware/event.h>
-
 /****************************************************************************/
 
 /*
@@ -166,52 +163,144 @@ u32_t sys_arch_sem_wait(sys_sem_t sem, u32_t timeout)
 
 /* Mbox functions */
 
-typedef struct IpPort
-{
-	Node node;
-	MsgPort port;
-} IpPort;
+/*
+ * Mailboxes are rings of message pointers with their own storage, so that
+ * posting a message never allocates memory. A full mailbox blocks
+ * sys_mbox_post() and makes sys_mbox_trypost() fail: this is how lwIP
+ * pushes back on the producers (e.g. tcpip_input() drops the packet).
+ *
+ * A process waiting on a mailbox queues a MboxWaiter on its own stack.
+ * The waker unlinks it and posts the signal with preemption disabled, so
+ * a waiter that times out can always tell whether it was also woken.
+ */
+#define SIG_MBOX  SIG_SYSTEM6
 
-#define MAX_PORT_CNT 16
-static struct IpPort port_pool[MAX_PORT_CNT];
-static List free_port;
+typedef struct MboxWaiter
+{
+	Node link;
+	struct Process *proc;
+} MboxWaiter;
 
-typedef struct IpMsg
+struct IpMbox
 {
-	Msg msg;
-	void *data;
-} IpMsg;
+	Node link;
+	List readers;
+	List writers;
+	int head;
+	int count;
+	int size;
+	void *msg[SYS_MBOX_SIZE];
+};
 
-#define MAX_MSG_CNT 32
-static struct IpMsg msg_pool[MAX_MSG_CNT];
-static List free_msg;
+#define MAX_PORT_CNT 16
+static struct IpMbox mbox_pool[MAX_PORT_CNT];
+static List free_mbox;
 
-// TODO: allocate memory for 'size' messages
-sys_mbox_t sys_mbox_new(UNUSED_ARG(int, size))
+sys_mbox_t sys_mbox_new(int size)
 {
-	IpPort *port;
+	sys_mbox_t mbox;
 
-	PROC_ATOMIC(port = (IpPort *)list_remHead(&free_port));
-	if (UNLIKELY(!port))
+	PROC_ATOMIC(mbox = (sys_mbox_t)list_remHead(&free_mbox));
+	if (UNLIKELY(!mbox))
 	{
 		LOG_ERR("Out of message ports!\n");
 		return SYS_MBOX_NULL;
 	}
-	msg_initPort(&port->port, event_createGeneric());
-	port->port.event.Ev.Sig.sig_proc = NULL;
 
-	return (sys_mbox_t)(&port->port);
+	if (size <= 0)
+		size = SYS_MBOX_SIZE;
+	else if (size > SYS_MBOX_SIZE)
+	{
+		LOG_WARN("Mailbox size %d too big, using %d\n", size, SYS_MBOX_SIZE);
+		size = SYS_MBOX_SIZE;
+	}
+
+	LIST_INIT(&mbox->readers);
+	LIST_INIT(&mbox->writers);
+	mbox->head = 0;
+	mbox->count = 0;
+	mbox->size = size;
+
+	return mbox;
 }
 
 void sys_mbox_free(sys_mbox_t mbox)
 {
-	IpPort *port = containerof(mbox, IpPort, port);
-	PROC_ATOMIC(ADDHEAD(&free_port, &port->node));
+	ASSERT(LIST_EMPTY(&mbox->readers));
+	ASSERT(LIST_EMPTY(&mbox->writers));
+	PROC_ATOMIC(ADDHEAD(&free_mbox, &mbox->link));
+}
+
+/*
+ * Wake up the first process waiting in \a queue.
+ * Must be called with preemption disabled.
+ */
+INLINE void mbox_wake(List *queue)
+{
+	MboxWaiter *w = (MboxWaiter *)list_remHead(queue);
+
+	if (w)
+	{
+		struct Process *proc = w->proc;
+
+		w->proc = NULL;
+		sig_post(proc, SIG_MBOX);
+	}
+}
+
+/*
+ * Sleep in \a queue until woken up or until \a timeout ticks have passed,
+ * 0 means forever. Must be called with preemption disabled, which is
+ * disabled again on return. The caller checks its condition again.
+ */
+static void mbox_sleep(List *queue, ticks_t timeout)
+{
+	MboxWaiter w;
+	sigmask_t sigs;
+
+	w.proc = proc_current();
+	ADDTAIL(queue, &w.link);
+	proc_permit();
+
+	sigs = timeout ? sig_waitTimeout(SIG_MBOX, timeout) : sig_wait(SIG_MBOX);
+
+	proc_forbid();
+	if (w.proc)
+		/* Timed out, or woken by someone else using the same signal */
+		REMOVE(&w.link);
+	else if (!(sigs & SIG_MBOX))
+		/* Woken just after the timeout, drop the pending signal */
+		sig_check(SIG_MBOX);
+}
+
+INLINE void mbox_put(sys_mbox_t mbox, void *data)
+{
+	int tail = mbox->head + mbox->count;
+
+	if (tail >= mbox->size)
+		tail -= mbox->size;
+	mbox->msg[tail] = data;
+	mbox->count++;
+	mbox_wake(&mbox->readers);
+}
+
+INLINE void mbox_get(sys_mbox_t mbox, void **data)
+{
+	if (data)
+		*data = mbox->msg[mbox->head];
+	if (++mbox->head == mbox->size)
+		mbox->head = 0;
+	mbox->count--;
+	mbox_wake(&mbox->writers);
 }
 
 void sys_mbox_post(sys_mbox_t mbox, void *data)
 {
-	sys_mbox_trypost(mbox, data);
+	proc_forbid();
+	while (mbox->count == mbox->size)
+		mbox_sleep(&mbox->writers, 0);
+	mbox_put(mbox, data);
+	proc_permit();
 }
 
 /*
@@ -220,24 +309,17 @@ void sys_mbox_post(sys_mbox_t mbox, void *data)
  */
 err_t sys_mbox_trypost(sys_mbox_t mbox, void *data)
 {
-	IpMsg *msg;
+	err_t err = ERR_MEM;
 
-	PROC_ATOMIC(msg = (IpMsg *)list_remHead(&free_msg));
-	if (UNLIKELY(!msg))
+	proc_forbid();
+	if (mbox->count < mbox->size)
 	{
-		LOG_ERR("out of messages!\n");
-		return ERR_MEM;
+		mbox_put(mbox, data);
+		err = ERR_OK;
 	}
-	msg->data = data;
-
-	msg_lockPort(mbox);
-	ADDTAIL(&mbox->queue, &msg->msg.link);
-	msg_unlockPort(mbox);
-
-	if (mbox->event.Ev.Sig.sig_proc)
-		event_do(&mbox->event);
+	proc_permit();
 
-	return ERR_OK;
+	return err;
 }
 
 u32_t sys_arch_mbox_fetch(sys_mbox_t mbox, void **data, u32_t timeout)
@@ -258,35 +340,26 @@ u32_t sys_arch_mbox_fetch(sys_mbox_t mbox, void **data, u32_t timeout)
 	implemented by lwIP.
 	*/
 
-	Msg *msg;
 	ticks_t start = timer_clock();
+	ticks_t delay = ms_to_ticks(timeout);
 
-	while (1)
+	proc_forbid();
+	while (!mbox->count)
 	{
-		/* Fast path */
-		msg = msg_get(mbox);
-		if (LIKELY(msg))
-			break;
+		ticks_t elapsed = timer_clock() - start;
 
-		mbox->event.Ev.Sig.sig_proc = proc_current();
-		/* Slow path */
 		if (!timeout)
-			event_wait(&mbox->event);
+			mbox_sleep(&mbox->readers, 0);
+		else if (elapsed < delay)
+			mbox_sleep(&mbox->readers, delay - elapsed);
 		else
 		{
-			if (!event_waitTimeout(&mbox->event,
-					ms_to_ticks(timeout)))
-			{
-				mbox->event.Ev.Sig.sig_proc = NULL;
-				return SYS_ARCH_TIMEOUT;
-			}
+			proc_permit();
+			return SYS_ARCH_TIMEOUT;
 		}
 	}
-	mbox->event.Ev.Sig.sig_proc = NULL;
-	if (data)
-		*data = containerof(msg, IpMsg, msg)->data;
-
-	PROC_ATOMIC(ADDHEAD(&free_msg, &msg->link));
+	mbox_get(mbox, data);
+	proc_permit();
 
 	return ticks_to_ms(timer_clock() - start);
 }
@@ -305,16 +378,17 @@ u32_t sys_arch_mbox_tryfetch(sys_mbox_t mbox, void **data)
 	although this would introduce unnecessary delays.
 	*/
 
-	Msg *msg;
+	u32_t ret = SYS_MBOX_EMPTY;
 
-	msg = msg_get(mbox);
-	if (UNLIKELY(!msg))
-		return SYS_MBOX_EMPTY;
-	if (data)
-		*data = containerof(msg, IpMsg, msg)->data;
-	PROC_ATOMIC(ADDHEAD(&free_msg, &msg->link));
+	proc_forbid();
+	if (mbox->count)
+	{
+		mbox_get(mbox, data);
+		ret = 0;
+	}
+	proc_permit();
 
-	return 0;
+	return ret;
 }
 
 typedef struct ThreadNode
@@ -357,21 +431,23 @@ static void thread_trampoline(void)
 
 #if !CONFIG_KERN_HEAP
 /*
- * NOTE: threads are never destroyed, consequently these stacks are never
- * deallocated. So, the stack allocator can be implemented as a simple index
- * that is atomically incremented at each allocation.
+ * NOTE: threads are never destroyed, consequently their stacks are never
+ * deallocated. So, the stacks are carved out of a single area with a simple
+ * index that is atomically incremented at each allocation.
  */
-static cpu_stack_t thread_stack[MAX_THREAD_CNT]
-			[DEFAULT_THREAD_STACKSIZE / sizeof(cpu_stack_t)]
+static cpu_stack_t thread_stack[SYS_THREAD_STACKS / sizeof(cpu_stack_t)]
 				ALIGNED(sizeof(cpu_stack_t));
-static int last_stack;
+static size_t last_stack;
 #endif
 
 sys_thread_t sys_thread_new(const char *name, void (* thread)(void *arg),
 				void *arg, int stacksize, int prio)
 {
 	ThreadNode *thread_node;
-	cpu_stack_t *stackbase;
+	cpu_stack_t *stackbase = NULL;
+
+	if (stacksize <= 0)
+		stacksize = DEFAULT_THREAD_STACKSIZE;
 
 	proc_forbid();
 	thread_node = (ThreadNode *)list_remHead(&free_thread);
@@ -381,22 +457,39 @@ sys_thread_t sys_thread_new(const char *name, void (* thread)(void *arg),
 		LOG_ERR("Out of threads!\n");
 		return NULL;
 	}
+
+	#if !CONFIG_KERN_HEAP
+	{
+		size_t words = DIV_ROUNDUP(stacksize, sizeof(cpu_stack_t));
+
+		if (UNLIKELY(last_stack + words > countof(thread_stack)))
+		{
+			ADDHEAD(&free_thread, &thread_node->node);
+			proc_permit();
+			LOG_ERR("Out of thread stacks!\n");
+			return NULL;
+		}
+		stackbase = &thread_stack[last_stack];
+		last_stack += words;
+		stacksize = words * sizeof(cpu_stack_t);
+	}
+	#endif
 	ADDHEAD(&used_thread, &thread_node->node);
 	proc_permit();
 
 	thread_node->entry = thread;
 	thread_node->arg = arg;
 
-	#if !CONFIG_KERN_HEAP
-		ASSERT(stacksize <= DEFAULT_THREAD_STACKSIZE);
-		PROC_ATOMIC(stackbase = thread_stack[last_stack++]);
-	#else
-		stackbase = NULL;
-	#endif
 	thread_node->pid = proc_new_with_name(name, thread_trampoline,
 				(void *)thread_node, stacksize, stackbase);
 	if (thread_node->pid == NULL)
+	{
+		PROC_ATOMIC(
+			REMOVE(&thread_node->node);
+			ADDHEAD(&free_thread, &thread_node->node);
+		);
 		return NULL;
+	}
 
 	#if CONFIG_KERN_PRI
 		proc_setPri(thread_node->pid, prio);
@@ -411,8 +504,7 @@ sys_thread_t sys_thread_new(const char *name, void (* thread)(void *arg),
 void sys_init(void)
 {
 	LIST_INIT(&free_sem);
-	LIST_INIT(&free_port);
-	LIST_INIT(&free_msg);
+	LIST_INIT(&free_mbox);
 	LIST_INIT(&free_thread);
 	LIST_INIT(&used_thread);
 
@@ -420,10 +512,7 @@ void sys_init(void)
 		ADDHEAD(&free_sem, &sem_pool[i].node);
 
 	for (int i = 0; i < MAX_PORT_CNT; ++i)
-		ADDHEAD(&free_port, &port_pool[i].node);
-
-	for (int i = 0; i < MAX_MSG_CNT; ++i)
-		ADDHEAD(&free_msg, &msg_pool[i].msg.link);
+		ADDHEAD(&free_mbox, &mbox_pool[i].link);
 
 	for (int i = 0; i < MAX_THREAD_CNT; ++i)
 		ADDHEAD(&free_thread, &thread_pool[i].node);
@@ -67,7 +67,7 @@ typedef uint16_t u16_t;
 typedef int16_t s16_t;
 typedef uint32_t u32_t;
 typedef int32_t s32_t;
-typedef int mem_ptr_t;
+typedef uintptr_t mem_ptr_t;
 
 
 /* Define (sn)printf formatters for these lwIP types */
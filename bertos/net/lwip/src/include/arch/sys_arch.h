@@ -41,7 +41,6 @@
 #include <arch/cc.h>
 
 #include <kern/sem.h>
-#include <kern/msg.h>
 #include <kern/proc.h>
 
 /****************************************************************************/
@@ -72,8 +71,19 @@ void mutex_release(struct Mutex *s);
 
 /****************************************************************************/
 
+/*
+ * Port options, see cfg/cfg_lwip.h.
+ */
+#ifndef SYS_MBOX_SIZE
+#define SYS_MBOX_SIZE      16
+#endif
+
+#ifndef SYS_THREAD_STACKS
+#define SYS_THREAD_STACKS  (TCPIP_THREAD_STACKSIZE + DEFAULT_THREAD_STACKSIZE)
+#endif
+
 typedef Mutex *sys_sem_t;
-typedef MsgPort *sys_mbox_t;
+typedef struct IpMbox *sys_mbox_t;
 typedef struct Process *sys_thread_t;
 // TODO: what does it mean?
 typedef int sys_prot_t;
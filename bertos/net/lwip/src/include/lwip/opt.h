@@ -1058,6 +1058,14 @@
 #define TCPIP_MBOX_SIZE                 0
 #endif
 
+/**
+ * TCPIP_MSG_BATCH: The maximum number of queued messages handled by the
+ * tcpip thread in a row, before looking at its timeouts again.
+ */
+#ifndef TCPIP_MSG_BATCH
+#define TCPIP_MSG_BATCH                 1
+#endif
+
 /**
  * SLIPIF_THREAD_NAME: The name assigned to the slipif_loop thread.
  */
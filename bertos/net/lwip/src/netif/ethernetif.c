@@ -76,6 +76,9 @@
 
 #include "cfg/cfg_lwip.h"
 
+#include <cfg/debug.h>
+#include <cfg/macros.h>
+
 #include <drv/eth.h>
 #include <drv/timer.h>
 
@@ -108,9 +111,23 @@
 struct ethernetif
 {
 	struct eth_addr *ethaddr;
-	/* Add whatever per-interface state that is needed here. */
+#if CONFIG_ETH_RING
+	/* Receive buffers lent to the driver */
+	int rx_posted;
+	/* Frame being reassembled from several receive buffers */
+	struct pbuf *rx_frame;
+#endif
 };
 
+#if CONFIG_ETH_RING
+	#if ETH_PAD_SIZE
+		#error "ETH_PAD_SIZE is not supported by the descriptor ring interface"
+	#endif
+
+	/* Descriptors handled at each round of the receive loop */
+	#define ETH_RX_BATCH  CONFIG_ETH_RXBUFS
+#endif
+
 /**
  * In this function, the hardware should be initialized.
  * Called from ethernetif_init().
@@ -141,6 +158,23 @@ static void low_level_init(struct netif *netif)
 	eth_init();
 }
 
+#if CONFIG_ETH_RING
+
+/*
+ * Release the pbufs of the frames already sent by the driver.
+ */
+static void low_level_reclaim(void)
+{
+	EthBuf done[CONFIG_ETH_TXBUFS];
+	size_t n = eth_txCollect(done, countof(done));
+
+	for (size_t i = 0; i < n; i++)
+		if (done[i].ctx)
+			pbuf_free((struct pbuf *)done[i].ctx);
+}
+
+#endif /* CONFIG_ETH_RING */
+
 /**
  * This function should do the actual transmission of the packet. The packet is
  * contained in the pbuf that is passed to the function. This pbuf
@@ -157,6 +191,66 @@ static void low_level_init(struct netif *netif)
  *       dropped because of memory failure (except for the TCP timers).
  */
 
+#if CONFIG_ETH_RING
+
+/*
+ * Lend the pbuf chain to the driver, one descriptor for each pbuf: the
+ * chain is referenced until the driver gives the descriptors back.
+ *
+ * PBUF_REF data may be reused by the caller as soon as we return, and a
+ * chain longer than the ring can't be queued at all: in these cases the
+ * frame is copied in a single PBUF_RAM buffer.
+ */
+static err_t low_level_output(UNUSED_ARG(struct netif *, netif), struct pbuf *p)
+{
+	EthBuf bufs[CONFIG_ETH_TXBUFS];
+	struct pbuf *q;
+	size_t cnt = 0;
+	bool copy = pbuf_clen(p) > CONFIG_ETH_TXBUFS;
+
+	for (q = p; q != NULL && !copy; q = q->next)
+		if (q->type == PBUF_REF)
+			copy = true;
+
+	if (copy)
+	{
+		q = pbuf_alloc(PBUF_RAW, p->tot_len, PBUF_RAM);
+		if (q == NULL)
+		{
+			LINK_STATS_INC(link.memerr);
+			LINK_STATS_INC(link.drop);
+			return ERR_MEM;
+		}
+		pbuf_copy(q, p);
+		p = q;
+	}
+	else
+		pbuf_ref(p);
+
+	for (q = p; q != NULL; q = q->next)
+	{
+		bufs[cnt].data = q->payload;
+		bufs[cnt].len = q->len;
+		bufs[cnt].flags = 0;
+		bufs[cnt].ctx = NULL;
+		cnt++;
+	}
+	bufs[cnt - 1].flags = ETH_BUF_EOF;
+	bufs[cnt - 1].ctx = p;
+
+	low_level_reclaim();
+	while (!eth_txPost(bufs, cnt))
+	{
+		eth_txWait();
+		low_level_reclaim();
+	}
+
+	LINK_STATS_INC(link.xmit);
+	return ERR_OK;
+}
+
+#else /* !CONFIG_ETH_RING */
+
 static err_t low_level_output(UNUSED_ARG(struct netif *, netif), struct pbuf *p)
 {
 	struct pbuf *q;
@@ -229,25 +323,19 @@ static struct pbuf *low_level_input(UNUSED_ARG(struct netif *, netif))
 	return p;
 }
 
+#endif /* CONFIG_ETH_RING */
+
 /**
- * This function should be called when a packet is ready to be read
- * from the interface. It uses the function low_level_input() that
- * should handle the actual reception of bytes from the network
- * interface. Then the type of the received packet is determined and
- * the appropriate input function is called.
+ * Determine the type of a received packet and call the appropriate
+ * input function.
  *
  * @param netif the lwip network interface structure for this ethernetif
+ * @param p the received packet, including the Ethernet header
  */
-static void ethernetif_input(struct netif *netif)
+static void ethernetif_deliver(struct netif *netif, struct pbuf *p)
 {
 	struct eth_hdr *ethhdr;
-	struct pbuf *p;
 
-	/* move received packet into a new pbuf */
-	p = low_level_input(netif);
-	/* no packet could be read, silently ignore this */
-	if (p == NULL)
-		return;
 	/* points to packet payload, which starts with an Ethernet header */
 	ethhdr = p->payload;
 
@@ -278,13 +366,124 @@ static void ethernetif_input(struct netif *netif)
 }
 
 
+#if CONFIG_ETH_RING
+
+/*
+ * Lend new pool buffers to the driver, up to the size of its ring.
+ */
+static void low_level_refill(struct ethernetif *ethernetif)
+{
+	while (ethernetif->rx_posted < CONFIG_ETH_RXBUFS)
+	{
+		struct pbuf *p = pbuf_alloc(PBUF_RAW, PBUF_POOL_BUFSIZE, PBUF_POOL);
+		EthBuf buf;
+
+		if (p == NULL)
+		{
+			LINK_STATS_INC(link.memerr);
+			break;
+		}
+		ASSERT(p->next == NULL);
+
+		buf.data = p->payload;
+		buf.len = p->len;
+		buf.flags = 0;
+		buf.ctx = p;
+		if (!eth_rxPost(&buf))
+		{
+			pbuf_free(p);
+			break;
+		}
+		ethernetif->rx_posted++;
+	}
+}
+
+/**
+ * Take back from the driver all the buffers filled so far, pass the
+ * complete frames to the stack and replace the buffers with new ones.
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ */
+static void ethernetif_input(struct netif *netif)
+{
+	struct ethernetif *ethernetif = netif->state;
+	EthBuf bufs[ETH_RX_BATCH];
+	size_t n;
+
+	while ((n = eth_rxCollect(bufs, countof(bufs))) > 0)
+	{
+		ethernetif->rx_posted -= n;
+		for (size_t i = 0; i < n; i++)
+		{
+			struct pbuf *q = (struct pbuf *)bufs[i].ctx;
+
+			q->len = q->tot_len = bufs[i].len;
+			if (ethernetif->rx_frame)
+				pbuf_cat(ethernetif->rx_frame, q);
+			else
+				ethernetif->rx_frame = q;
+
+			if (bufs[i].flags & ETH_BUF_EOF)
+			{
+				LINK_STATS_INC(link.recv);
+				ethernetif_deliver(netif, ethernetif->rx_frame);
+				ethernetif->rx_frame = NULL;
+			}
+		}
+		low_level_refill(ethernetif);
+	}
+}
+
 static NORETURN void ethernetif_loop(void *arg)
 {
 	struct netif *netif = (struct netif *)arg;
+	struct ethernetif *ethernetif = netif->state;
+
 	while (1)
+	{
+		low_level_refill(ethernetif);
+		/* Out of pool buffers: give the stack some time to free them */
+		if (ethernetif->rx_posted == 0)
+		{
+			timer_delay(1);
+			continue;
+		}
+		eth_rxWait();
 		ethernetif_input(netif);
+	}
 }
 
+#else /* !CONFIG_ETH_RING */
+
+/**
+ * This function should be called when a packet is ready to be read
+ * from the interface. It uses the function low_level_input() that
+ * should handle the actual reception of bytes from the network
+ * interface.
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ */
+static void ethernetif_input(struct netif *netif)
+{
+	struct pbuf *p;
+
+	/* move received packet into a new pbuf */
+	p = low_level_input(netif);
+	/* no packet could be read, silently ignore this */
+	if (p == NULL)
+		return;
+	ethernetif_deliver(netif, p);
+}
+
+static NORETURN void ethernetif_loop(void *arg)
+{
+	struct netif *netif = (struct netif *)arg;
+	while (1)
+		ethernetif_input(netif);
+}
+
+#endif /* CONFIG_ETH_RING */
+
 /**
  * Should be called at the beginning of the program to set up the
  * network interface. It calls the function low_level_init() to do the
@@ -318,6 +517,10 @@ err_t ethernetif_init(struct netif *netif)
 	NETIF_INIT_SNMP(netif, snmp_ifType_ethernet_csmacd, LINK_SPEED_OF_YOUR_NETIF_IN_BPS);
 
 	netif->state = ethernetif;
+#if CONFIG_ETH_RING
+	ethernetif->rx_posted = 0;
+	ethernetif->rx_frame = NULL;
+#endif
 
 	netif->hwaddr_len = 6;
 	netif->name[0] = IFNAME0;
@@ -0,0 +1,313 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief lwIP system layer test and api_msg benchmark.
+ *
+ * First the mailboxes of sys_arch are checked: capacity, ordering,
+ * timeouts and producers blocked on a full mailbox. Then the test measures
+ * the netconn calls served by the tcpip thread, and the UDP datagrams that
+ * several processes send to a receiver through the loopback interface.
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_eth.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_ETH_RING" >> $cfgdir/cfg_eth.h
+ * $test$: echo "#define CONFIG_ETH_RING 1" >> $cfgdir/cfg_eth.h
+ * $test$: cp bertos/cfg/cfg_lwip.h $cfgdir/
+ * $test$: echo  "#undef LWIP_SO_RCVTIMEO" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_SO_RCVTIMEO 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef LWIP_SOCKET" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_SOCKET 0" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef LWIP_HAVE_LOOPIF" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_HAVE_LOOPIF 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef LWIP_NETIF_LOOPBACK" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_NETIF_LOOPBACK 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEM_SIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEM_SIZE 16384" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_NETCONN" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_NETCONN 8" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_NETBUF" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_NETBUF 16" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_TCPIP_MSG_API" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_TCPIP_MSG_API 16" >> $cfgdir/cfg_lwip.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include <cfg/compiler.h>
+#include <cfg/test.h>
+#include <cfg/debug.h>
+
+#include <drv/timer.h>
+
+#include <kern/proc.h>
+
+#include <netif/loopif.h>
+
+#include <lwip/tcpip.h>
+
+/* lwIP and the drivers are not in the test sources list */
+#include "net/lwip.c"
+#include "hw/hw_eth.c"
+#undef LOG_LEVEL
+#undef LOG_FORMAT
+#include "emul/eth_emul.c"
+
+#define UDP_PORT     5002
+#define SENDERS      3
+#define MSG_CNT      200
+#define BENCH_TIME   1000 /* ms */
+
+static struct netif loop_netif;
+static sys_mbox_t test_mbox;
+static volatile bool producer_done;
+static volatile bool senders_stop;
+static volatile int senders_left;
+static unsigned long sent;
+
+static PROC_DEFINE_STACK(producer_stack, KERN_MINSTACKSIZE * 2);
+static PROC_DEFINE_STACK(sender_stack[SENDERS], KERN_MINSTACKSIZE * 3);
+
+INLINE void *msg_val(int i)
+{
+	return (void *)(uintptr_t)(i + 1);
+}
+
+static int test_mboxBounds(void)
+{
+	void *data;
+	ticks_t start;
+	int ret = -1;
+
+	test_mbox = sys_mbox_new(4);
+	if (test_mbox == SYS_MBOX_NULL)
+		return -1;
+
+	for (int i = 0; i < 4; i++)
+		if (sys_mbox_trypost(test_mbox, msg_val(i)) != ERR_OK)
+			goto out;
+	if (sys_mbox_trypost(test_mbox, msg_val(4)) != ERR_MEM)
+		goto out;
+
+	for (int i = 0; i < 4; i++)
+		if (sys_arch_mbox_tryfetch(test_mbox, &data) == SYS_MBOX_EMPTY || data != msg_val(i))
+			goto out;
+	if (sys_arch_mbox_tryfetch(test_mbox, &data) != SYS_MBOX_EMPTY)
+		goto out;
+
+	start = timer_clock();
+	if (sys_arch_mbox_fetch(test_mbox, &data, 50) != SYS_ARCH_TIMEOUT
+			|| timer_clock() - start < ms_to_ticks(50))
+		goto out;
+	ret = 0;
+out:
+	sys_mbox_free(test_mbox);
+	return ret;
+}
+
+static void producer(void)
+{
+	for (int i = 0; i < MSG_CNT; i++)
+		sys_mbox_post(test_mbox, msg_val(i));
+	producer_done = true;
+}
+
+/*
+ * A producer blocked on a full mailbox must resume as soon as the consumer
+ * makes room, without losing or reordering messages.
+ */
+static int test_mboxBlocking(void)
+{
+	void *data;
+	int ret = -1;
+
+	test_mbox = sys_mbox_new(2);
+	if (test_mbox == SYS_MBOX_NULL)
+		return -1;
+	producer_done = false;
+	proc_new(producer, NULL, sizeof(producer_stack), producer_stack);
+
+	for (int i = 0; i < MSG_CNT; i++)
+	{
+		if (sys_arch_mbox_fetch(test_mbox, &data, 1000) == SYS_ARCH_TIMEOUT
+				|| data != msg_val(i))
+			goto out;
+		/* The producer fills the mailbox again while we are away */
+		if (i % 16 == 0)
+			timer_delay(1);
+	}
+	timer_delay(10);
+	if (producer_done)
+		ret = 0;
+out:
+	sys_mbox_free(test_mbox);
+	return ret;
+}
+
+/*
+ * Every netconn call is an api_msg posted to the tcpip thread, which
+ * answers by signalling a semaphore.
+ */
+static void bench_netconn(void)
+{
+	unsigned long calls = 0;
+	ticks_t start, elapsed;
+
+	start = timer_clock();
+	while ((elapsed = timer_clock() - start) < ms_to_ticks(BENCH_TIME))
+	{
+		struct netconn *conn = netconn_new(NETCONN_UDP);
+
+		netconn_bind(conn, IP_ADDR_ANY, UDP_PORT + 1);
+		netconn_delete(conn);
+		calls += 3;
+	}
+	kprintf("netconn calls: %lu/s\n", calls * 1000 / ticks_to_ms(elapsed));
+}
+
+static void sender(void)
+{
+	static const char payload[64];
+	struct netconn *conn;
+	struct netbuf *buf;
+	struct ip_addr addr;
+
+	IP4_ADDR(&addr, 127, 0, 0, 1);
+	conn = netconn_new(NETCONN_UDP);
+	netconn_connect(conn, &addr, UDP_PORT);
+	buf = netbuf_new();
+	netbuf_ref(buf, payload, sizeof(payload));
+
+	while (!senders_stop)
+		if (netconn_send(conn, buf) == ERR_OK)
+			sent++;
+
+	netbuf_delete(buf);
+	netconn_delete(conn);
+	senders_left--;
+}
+
+/*
+ * Several senders compete for the tcpip thread, each datagram goes
+ * through it twice: once as an api_msg and once through the loopback
+ * interface. The receiver mailbox is bounded, so datagrams in excess are
+ * dropped at the receiver.
+ */
+static int bench_udp(void)
+{
+	struct netconn *conn;
+	struct netbuf *buf;
+	unsigned long received = 0;
+	ticks_t start, elapsed;
+
+	conn = netconn_new(NETCONN_UDP);
+	netconn_bind(conn, IP_ADDR_ANY, UDP_PORT);
+	conn->recv_timeout = 100;
+
+	sent = 0;
+	senders_stop = false;
+	senders_left = SENDERS;
+	for (int i = 0; i < SENDERS; i++)
+		proc_new(sender, NULL, sizeof(sender_stack[i]), sender_stack[i]);
+
+	start = timer_clock();
+	while ((elapsed = timer_clock() - start) < ms_to_ticks(BENCH_TIME))
+	{
+		if ((buf = netconn_recv(conn)) == NULL)
+			break;
+		netbuf_delete(buf);
+		received++;
+	}
+	senders_stop = true;
+	while (senders_left)
+	{
+		if ((buf = netconn_recv(conn)) != NULL)
+		{
+			netbuf_delete(buf);
+			received++;
+		}
+	}
+	netconn_delete(conn);
+
+	if (!received)
+		return -1;
+	kprintf("UDP loopback: %lu datagrams/s, %lu%% dropped\n",
+		received * 1000 / ticks_to_ms(elapsed),
+		(sent - MIN(sent, received)) * 100 / sent);
+	return 0;
+}
+
+int lwip_testRun(void)
+{
+	if (test_mboxBounds())
+	{
+		kprintf("Mailbox bounds failed\n");
+		return -1;
+	}
+	if (test_mboxBlocking())
+	{
+		kprintf("Blocking post failed\n");
+		return -1;
+	}
+
+	bench_netconn();
+	return bench_udp();
+}
+
+int lwip_testSetup(void)
+{
+	struct ip_addr addr, netmask, gw;
+
+	kdbg_init();
+	timer_init();
+	proc_init();
+
+	tcpip_init(NULL, NULL);
+	IP4_ADDR(&addr, 127, 0, 0, 1);
+	IP4_ADDR(&netmask, 255, 0, 0, 0);
+	IP4_ADDR(&gw, 127, 0, 0, 1);
+	netif_add(&loop_netif, &addr, &netmask, &gw, NULL, loopif_init, tcpip_input);
+	netif_set_up(&loop_netif);
+	return 0;
+}
+
+int lwip_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(lwip);
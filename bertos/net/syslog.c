@@ -41,27 +41,52 @@
 
 #include "cfg/cfg_syslog.h"
 
+#include <cfg/debug.h>
+#include <cfg/macros.h>
+
 #include <cpu/byteorder.h> // host_to_net16
 
+#include <drv/timer.h>
+
+#include <kern/proc.h>
+#include <kern/signal.h>
+
 #include <lwip/ip_addr.h>
 #include <lwip/netif.h>
 #include <lwip/netbuf.h>
 #include <lwip/tcpip.h>
 
 #include <stdarg.h>
-#include <stdio.h>
+#include <stdio.h> // vsnprintf()
+#include <string.h>
 
-static char syslog_message[CONFIG_SYSLOG_BUFSIZE];
+/* A datagram must hold at least one message and its newline */
+STATIC_ASSERT(CONFIG_SYSLOG_DATAGRAM > CONFIG_SYSLOG_BUFSIZE);
+
+#define SIG_SYSLOG  SIG_SYSTEM5
+
+static unsigned char syslog_queue[CONFIG_SYSLOG_QUEUE];
+static char syslog_datagram[CONFIG_SYSLOG_DATAGRAM];
+static PROC_DEFINE_STACK(syslog_stack, KERN_MINSTACKSIZE * 2);
 static SysLog *local_syslog_ctx;
 
 /**
- * Return the number of log message has been sent.
+ * Return the number of log messages, both sent and dropped.
  */
 uint32_t syslog_count(void)
 {
 	return local_syslog_ctx->syslog_cnt;
 }
 
+/**
+ * Return the number of log messages dropped, because the queue was full
+ * or the network failed to send them.
+ */
+uint32_t syslog_dropped(void)
+{
+	return local_syslog_ctx->drop_cnt;
+}
+
 /**
  * Get the current syslog server address, in lwip ip_address format.
  */
@@ -79,60 +104,174 @@ void syslog_setIp(struct ip_addr addr)
 	local_syslog_ctx->server_addr = addr;
 }
 
-
 /**
- * Print the log message on upd socket and serial if you configure the
- * macro CONFIG_SYSLOG_SERIAL in cfg_syslog.h,
+ * Queue a log message for the syslog server, and print it also on serial
+ * if you configure the macro CONFIG_SYSLOG_SERIAL in cfg_syslog.h.
+ *
+ * Messages longer than CONFIG_SYSLOG_BUFSIZE are truncated.
+ *
+ * \return the length of the queued message, or -1 if it was dropped.
  */
 int syslog_printf(const char *fmt, ...)
 {
+	SysLog *ctx = local_syslog_ctx;
+	char msg[CONFIG_SYSLOG_BUFSIZE];
+	unsigned char *tail;
+	int len;
+	bool wake;
 	va_list ap;
-	va_start(ap, fmt);
-	int len = vsnprintf(syslog_message, sizeof(syslog_message), fmt, ap);
-	va_end(ap);
-	syslog_message[sizeof(syslog_message) - 1] = 0;
 
 	#if CONFIG_SYSLOG_SERIAL
-		kputs(syslog_message);
+		va_start(ap, fmt);
+		kvprintf(fmt, ap);
+		va_end(ap);
 	#endif
 
-	if (local_syslog_ctx == NULL)
+	if (ctx == NULL)
 	{
 		kputs("SysLog not init\n");
 		return -1;
 	}
 
-	local_syslog_ctx->syslog_server = netconn_new(NETCONN_UDP);
-	if (local_syslog_ctx->syslog_server == NULL)
+	/* Format outside the lock, only the copy into the queue is atomic */
+	va_start(ap, fmt);
+	vsnprintf(msg, sizeof(msg), fmt, ap);
+	va_end(ap);
+	msg[sizeof(msg) - 1] = '\0';
+
+	proc_forbid();
+	wake = fifo_isempty(&ctx->queue);
+	tail = ctx->queue.tail;
+
+	/* Queued messages are NUL terminated */
+	for (len = 0; msg[len] && !fifo_isfull(&ctx->queue); len++)
+		fifo_push(&ctx->queue, msg[len]);
+
+	ctx->syslog_cnt++;
+	if (msg[len] || fifo_isfull(&ctx->queue))
 	{
-		kputs("Unable to alloc UDP connetions\n");
-		return -1;
+		/* Drop the part already queued */
+		ctx->queue.tail = tail;
+		ctx->drop_cnt++;
+		len = -1;
 	}
+	else
+		fifo_push(&ctx->queue, '\0');
+	proc_permit();
+
+	/*
+	 * The sender looks at the queue again before sleeping. Don't switch
+	 * to it now: it runs when the caller releases the CPU.
+	 */
+	if (wake && len >= 0)
+		sig_post(ctx->sender, SIG_SYSLOG);
 
-	netbuf_ref(local_syslog_ctx->send_buf, syslog_message, len);
-	if (netconn_sendto(local_syslog_ctx->syslog_server, local_syslog_ctx->send_buf,
-						&(local_syslog_ctx->server_addr), CONFIG_SYSLOG_PORT) != ERR_OK)
+	return len;
+}
+
+/*
+ * Move queued messages to the datagram, newline terminated, as many as
+ * they fit. Must be called with preemption disabled.
+ */
+static size_t syslog_collect(FIFOBuffer *queue, int *msgs)
+{
+	size_t len = 0;
+
+	*msgs = 0;
+	while (!fifo_isempty(queue))
 	{
-		kputs("Unable to send log!\n");
-	}
+		unsigned char *head = queue->head;
+		size_t start = len;
+		bool fit = true;
+		char c;
+
+		while ((c = fifo_pop(queue)) != '\0')
+		{
+			if (len < sizeof(syslog_datagram))
+				syslog_datagram[len++] = c;
+			else
+				fit = false;
+		}
+		if (len == start || syslog_datagram[len - 1] != '\n')
+		{
+			if (len < sizeof(syslog_datagram))
+				syslog_datagram[len++] = '\n';
+			else
+				fit = false;
+		}
 
-	local_syslog_ctx->syslog_cnt++;
-	netconn_delete(local_syslog_ctx->syslog_server);
+		if (!fit)
+		{
+			/* Too long, leave it for the next datagram */
+			queue->head = head;
+			len = start;
+			break;
+		}
+		(*msgs)++;
 
+		if (!CONFIG_SYSLOG_COALESCE)
+			break;
+	}
 	return len;
 }
 
+static NORETURN void syslog_sender(void)
+{
+	SysLog *ctx = local_syslog_ctx;
+	#if CONFIG_SYSLOG_RATE
+		ticks_t last = timer_clock() - ms_to_ticks(1000);
+	#endif
+
+	for (;;)
+	{
+		size_t len;
+		int msgs;
+
+		while (fifo_isempty(&ctx->queue))
+			sig_wait(SIG_SYSLOG);
+
+		#if CONFIG_SYSLOG_RATE
+		{
+			/* Meanwhile more messages are queued for the same datagram */
+			ticks_t interval = ms_to_ticks(1000) / CONFIG_SYSLOG_RATE;
+			ticks_t elapsed = timer_clock() - last;
+
+			if (elapsed < interval)
+				timer_delay(ticks_to_ms(interval - elapsed));
+			last = timer_clock();
+		}
+		#endif
+
+		proc_forbid();
+		len = syslog_collect(&ctx->queue, &msgs);
+		proc_permit();
+
+		netbuf_ref(ctx->send_buf, syslog_datagram, len);
+		if (netconn_sendto(ctx->syslog_server, ctx->send_buf,
+				&ctx->server_addr, CONFIG_SYSLOG_PORT) != ERR_OK)
+			ctx->drop_cnt += msgs;
+	}
+}
+
 /**
  * Init the syslog message.
  *
+ * Start the process sending the queued messages.
+ *
  * \param syslog_ctx syslog context
  * \param addr lwip ip_address (you could use the macro IP4_ADDR() to get it form ip address)
  */
 void syslog_init(SysLog *syslog_ctx, struct ip_addr addr)
 {
-	memset(syslog_ctx, 0, sizeof(syslog_ctx));
+	memset(syslog_ctx, 0, sizeof(*syslog_ctx));
 	syslog_ctx->server_addr = addr;
 	syslog_ctx->send_buf = netbuf_new();
+	ASSERT(syslog_ctx->send_buf);
+	syslog_ctx->syslog_server = netconn_new(NETCONN_UDP);
+	ASSERT(syslog_ctx->syslog_server);
+	fifo_init(&syslog_ctx->queue, syslog_queue, sizeof(syslog_queue));
 
 	local_syslog_ctx = syslog_ctx;
+	syslog_ctx->sender = proc_new(syslog_sender, NULL, sizeof(syslog_stack), syslog_stack);
+	ASSERT(syslog_ctx->sender);
 }
@@ -41,6 +41,11 @@
  * ip address of the remote syslog server, then the syslog module redirect all LOG_* (INFO, WARN, ERR)
  * message to syslog server, optionally we can send both message on serial and on syslog.
  *
+ * Logging does not wait for the network: syslog_printf() formats the message
+ * in a queue and returns, while a sender process packs the queued messages
+ * in datagrams, one per line. When the queue is full the new messages are
+ * dropped and counted, see syslog_dropped().
+ *
  * The usage pattern is as follows:
  * \code
  * //Init the network, es using dhcp:
@@ -81,9 +86,13 @@
 #ifndef NET_SYSLOG_H
 #define NET_SYSLOG_H
 
+#include <struct/fifobuf.h>
+
 #include <lwip/netif.h>
 #include <lwip/ip_addr.h>
 
+struct Process;
+
 typedef struct SysLog
 {
 	struct netconn *syslog_server;
@@ -91,10 +100,15 @@ typedef struct SysLog
 	struct ip_addr server_addr;
 
 	uint32_t syslog_cnt;
+	uint32_t drop_cnt;
+
+	FIFOBuffer queue;
+	struct Process *sender;
 } SysLog;
 
 
 uint32_t syslog_count(void);
+uint32_t syslog_dropped(void);
 struct ip_addr syslog_ip(void);
 void syslog_setIp(struct ip_addr addr);
 
@@ -0,0 +1,295 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief Syslog test and benchmark over the loopback interface.
+ *
+ * Several processes log as fast as they can, while the test receives the
+ * datagrams sent to the loopback address. It checks that each process'
+ * messages arrive in order and measures the messages delivered each
+ * second and the time spent by the callers in syslog_printf().
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_eth.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_ETH_RING" >> $cfgdir/cfg_eth.h
+ * $test$: echo "#define CONFIG_ETH_RING 1" >> $cfgdir/cfg_eth.h
+ * $test$: cp bertos/cfg/cfg_syslog.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_SYSLOG_SERIAL" >> $cfgdir/cfg_syslog.h
+ * $test$: echo "#define CONFIG_SYSLOG_SERIAL 0" >> $cfgdir/cfg_syslog.h
+ * $test$: cp bertos/cfg/cfg_lwip.h $cfgdir/
+ * $test$: echo  "#undef LWIP_SO_RCVTIMEO" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_SO_RCVTIMEO 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef LWIP_SOCKET" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_SOCKET 0" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef LWIP_HAVE_LOOPIF" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_HAVE_LOOPIF 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef LWIP_NETIF_LOOPBACK" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_NETIF_LOOPBACK 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEM_SIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEM_SIZE 16384" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_NETCONN" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_NETCONN 8" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_NETBUF" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_NETBUF 16" >> $cfgdir/cfg_lwip.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include <cfg/compiler.h>
+#include <cfg/test.h>
+#include <cfg/debug.h>
+
+#include <drv/timer.h>
+
+#include <kern/proc.h>
+
+#include <os/hptime.h>
+
+#include <netif/loopif.h>
+
+#include <lwip/tcpip.h>
+
+#include <stdio.h>
+
+/* lwIP and the drivers are not in the test sources list */
+#include "net/lwip.c"
+#include "hw/hw_eth.c"
+#undef LOG_LEVEL
+#undef LOG_FORMAT
+#include "emul/eth_emul.c"
+#include "syslog.c"
+
+#define LOGGERS      3
+#define BURST        64
+#define BENCH_TIME   1000 /* ms */
+
+typedef struct Logger
+{
+	unsigned long calls;
+	hptime_t busy;
+	hptime_t max;
+	unsigned long next_seq;
+} Logger;
+
+static struct netif loop_netif;
+static SysLog syslog;
+static Logger loggers[LOGGERS];
+static volatile bool loggers_stop;
+static volatile int loggers_left;
+
+static PROC_DEFINE_STACK(logger_stack[LOGGERS], KERN_MINSTACKSIZE * 2);
+
+static void logger(void)
+{
+	Logger *l = (Logger *)proc_currentUserData();
+	int id = l - loggers;
+
+	while (!loggers_stop)
+	{
+		hptime_t start = hptime_get();
+
+		syslog_printf("<182>%d-logger %d message %lu: the quick brown fox\n",
+			syslog_count(), id, l->calls);
+		start = hptime_get() - start;
+		l->busy += start;
+		l->max = MAX(l->max, start);
+		l->calls++;
+		/* Leave the CPU to the others, as a real process would do */
+		proc_yield();
+	}
+	loggers_left--;
+}
+
+/* Check that the messages of each logger are in order, return how many */
+static int check_datagram(char *data, u16_t len)
+{
+	char *line = data, *end = data + len;
+	int msgs = 0;
+
+	while (line < end)
+	{
+		char *nl = memchr(line, '\n', end - line);
+		unsigned long seq;
+		int id;
+
+		if (!nl)
+			return -1;
+		*nl = '\0';
+		if (sscanf(line, "<182>%*d-logger %d message %lu:", &id, &seq) != 2
+				|| id < 0 || id >= LOGGERS || seq < loggers[id].next_seq)
+			return -1;
+		loggers[id].next_seq = seq + 1;
+		msgs++;
+		line = nl + 1;
+	}
+	return msgs;
+}
+
+/*
+ * A burst larger than the queue, without releasing the CPU: the messages
+ * in excess are dropped and counted, the others are all delivered.
+ */
+static int test_burst(struct netconn *conn)
+{
+	struct netbuf *buf;
+	int queued = 0, msgs = 0;
+
+	for (int i = 0; i < BURST; i++)
+		if (syslog_printf("<182>%d-logger 0 message %d: burst\n", syslog_count(), i) > 0)
+			queued++;
+	if (queued == BURST || syslog_dropped() != (uint32_t)(BURST - queued))
+		return -1;
+
+	while (msgs < queued && (buf = netconn_recv(conn)) != NULL)
+	{
+		char *data;
+		u16_t len;
+		int n;
+
+		netbuf_data(buf, (void **)&data, &len);
+		n = check_datagram(data, len);
+		netbuf_delete(buf);
+		if (n < 0)
+			return -1;
+		msgs += n;
+	}
+	loggers[0].next_seq = 0;
+	return msgs == queued ? 0 : -1;
+}
+
+int syslog_testRun(void)
+{
+	struct netconn *conn;
+	struct netbuf *buf;
+	unsigned long msgs = 0, datagrams = 0, calls = 0;
+	hptime_t busy = 0, max = 0;
+	ticks_t start, elapsed;
+	uint32_t dropped;
+	struct ip_addr addr;
+
+	conn = netconn_new(NETCONN_UDP);
+	netconn_bind(conn, IP_ADDR_ANY, CONFIG_SYSLOG_PORT);
+	conn->recv_timeout = 200;
+
+	IP4_ADDR(&addr, 127, 0, 0, 1);
+	syslog_init(&syslog, addr);
+
+	if (test_burst(conn))
+	{
+		kprintf("Burst failed\n");
+		return -1;
+	}
+	dropped = syslog_dropped();
+
+	loggers_left = LOGGERS;
+	for (int i = 0; i < LOGGERS; i++)
+		proc_new(logger, &loggers[i], sizeof(logger_stack[i]), logger_stack[i]);
+
+	start = timer_clock();
+	while ((buf = netconn_recv(conn)) != NULL)
+	{
+		char *data;
+		u16_t len;
+		int n;
+
+		/* Stop logging and wait for the last datagrams */
+		if ((elapsed = timer_clock() - start) >= ms_to_ticks(BENCH_TIME))
+			loggers_stop = true;
+
+		netbuf_data(buf, (void **)&data, &len);
+		n = check_datagram(data, len);
+		netbuf_delete(buf);
+		if (n < 0)
+		{
+			kprintf("Bad datagram\n");
+			return -1;
+		}
+		msgs += n;
+		datagrams++;
+	}
+	netconn_delete(conn);
+
+	if (!loggers_stop || loggers_left)
+	{
+		kprintf("Logging stalled\n");
+		return -1;
+	}
+	for (int i = 0; i < LOGGERS; i++)
+	{
+		calls += loggers[i].calls;
+		busy += loggers[i].busy;
+		max = MAX(max, loggers[i].max);
+	}
+	dropped = syslog_dropped() - dropped;
+	if (msgs + dropped > calls || syslog_count() != calls + BURST)
+	{
+		kprintf("Lost messages\n");
+		return -1;
+	}
+
+	kprintf("syslog: %lu messages/s, %lu.%lu per datagram, %lu%% dropped\n",
+		msgs * 1000 / ticks_to_ms(elapsed), msgs / datagrams,
+		msgs * 10 / datagrams % 10, (unsigned long)dropped * 100 / calls);
+	kprintf("syslog_printf: %lu us on average, %lu us max\n",
+		(unsigned long)(busy / HPTIME_TICKS_PER_MICRO / calls),
+		(unsigned long)(max / HPTIME_TICKS_PER_MICRO));
+	return 0;
+}
+
+int syslog_testSetup(void)
+{
+	struct ip_addr addr, netmask, gw;
+
+	kdbg_init();
+	timer_init();
+	proc_init();
+
+	tcpip_init(NULL, NULL);
+	IP4_ADDR(&addr, 127, 0, 0, 1);
+	IP4_ADDR(&netmask, 255, 0, 0, 0);
+	IP4_ADDR(&gw, 127, 0, 0, 1);
+	netif_add(&loop_netif, &addr, &netmask, &gw, NULL, loopif_init, tcpip_input);
+	netif_set_up(&loop_netif);
+	return 0;
+}
+
+int syslog_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(syslog);
@@ -46,9 +46,16 @@
 //#include <lwip/in.h>
 #include <lwip/inet.h>
 #include <lwip/sockets.h>
+#include <stdio.h> // sprintf
+#include <stdlib.h> // strtoul
 #include <string.h> //memset
 
-#define TFTP_PACKET_SIZE 516
+/* Options to be acknowledged with an OACK */
+#define TFTP_OPT_BLKSIZE     BV(0)
+#define TFTP_OPT_WINDOWSIZE  BV(1)
+
+/* Number of times the last ACK is sent again before giving up */
+#define TFTP_RETRIES 3
 
 #define DECLARE_TIMEOUT(name, timeout) \
 	struct timeval name; \
@@ -63,30 +70,100 @@ INLINE TftpSession *TFTP_CAST(KFile *fd)
 }
 
 /*
- * Check if received data is correct and send ACK if ok.
+ * Append an option and its value to an OACK packet.
+ */
+static char *putOption(char *buf, const char *name, unsigned val)
+{
+	size_t len = strlen(name) + 1;
+
+	memcpy(buf, name, len);
+	return buf + len + sprintf(buf + len, "%u", val) + 1;
+}
+
+/*
+ * Acknowledge the last block received in order, or the accepted
+ * options if no block has been received yet.
+ */
+static int tftp_sendAck(TftpSession *ctx)
+{
+	char buf[sizeof(struct TftpHeader) + sizeof("blksize") + sizeof("windowsize") + 2 * sizeof("65535")];
+	struct TftpHeader *hdr = (struct TftpHeader *)buf;
+	char *end = hdr->th_u.stuff;
+
+	ctx->window_cnt = 0;
+	if (ctx->block == 0 && ctx->options)
+	{
+		hdr->opcode = TFTP_OACK;
+		if (ctx->options & TFTP_OPT_BLKSIZE)
+			end = putOption(end, "blksize", ctx->blksize);
+		if (ctx->options & TFTP_OPT_WINDOWSIZE)
+			end = putOption(end, "windowsize", ctx->windowsize);
+	}
+	else
+	{
+		// ACK is already in network order
+		hdr->opcode = TFTP_ACK;
+		hdr->th_u.block = htons(ctx->block);
+		end += sizeof(hdr->th_u.block);
+	}
+
+	ssize_t len = end - buf;
+	if (lwip_sendto(ctx->sock, buf, len, 0, (struct sockaddr *)&ctx->addr, ctx->addr_len) != len)
+		return TFTP_ERR;
+	return 0;
+}
+
+static void tftp_sendError(TftpSession *ctx, short code)
+{
+	struct errframe err;
+
+	err.opcode = TFTP_PROTOERR;
+	err.errcode = code;
+	err.str = '\0';
+	lwip_sendto(ctx->sock, &err, 5, 0, (struct sockaddr *)&ctx->addr, ctx->addr_len);
+}
+
+/*
+ * Check if received data is correct and send ACK if needed.
+ *
+ * With a window larger than one block the ACK is sent only for the last
+ * block of the window. A block out of order is discarded: the ACK of the
+ * last good block, sent only once, makes the client restart from there.
+ *
+ * \return 1 if the block is the next one, 0 if discarded, TFTP_ERR on errors
  */
-static int checkPacket(TftpSession *ctx, const Tftpframe *frame)
+static int checkPacket(TftpSession *ctx, const Tftpframe *frame, size_t len)
 {
-	LOG_INFO("Checking block %hd\n", ctx->block);
-	if (ntohs(frame->hdr.opcode) != TFTP_DATA)
+	LOG_INFO("Checking block %hu\n", ctx->block);
+	if (len < sizeof(struct TftpHeader) || ntohs(frame->hdr.opcode) != TFTP_DATA)
 	{
 		LOG_INFO("Opcode != TFTP_DATA (%hd != %d)\n", ntohs(frame->hdr.opcode), TFTP_DATA);
-		return -1;
+		return TFTP_ERR;
+	}
+	len -= sizeof(struct TftpHeader);
+	if (len > ctx->blksize)
+		return TFTP_ERR;
+
+	if (ntohs(frame->hdr.th_u.block) != (unsigned short)(ctx->block + 1))
+	{
+		LOG_INFO("Unexpected block %hu\n", ntohs(frame->hdr.th_u.block));
+		if (!ctx->nak_sent && tftp_sendAck(ctx) < 0)
+			return TFTP_ERR;
+		ctx->nak_sent = true;
+		return 0;
 	}
-	if (ntohs(frame->hdr.th_u.block) != ctx->block + 1)
-		return -1;
 
 	ctx->block++;
-	// if everything was ok, send ACK
-	// ACK is already in network order
-	struct ackframe ack;
-	ack.opcode = TFTP_ACK;
-	ack.block_num = htons(ctx->block);
-	ssize_t rc = lwip_sendto(ctx->sock, &ack, 4, 0, (struct sockaddr *)&ctx->addr, ctx->addr_len);
-	if (rc == 4)
-		return rc;
-	else
-		return -1;
+	ctx->nak_sent = false;
+	if (len < ctx->blksize)
+	{
+		ctx->is_xfer_end = true;
+		LOG_INFO("Received the last packet\n");
+	}
+
+	if (++ctx->window_cnt >= ctx->windowsize || ctx->is_xfer_end)
+		return tftp_sendAck(ctx) < 0 ? TFTP_ERR : 1;
+	return 1;
 }
 
 /*
@@ -102,27 +179,52 @@ static int tftp_waitEvent(TftpSession *ctx, struct timeval *timeout)
 }
 
 /*
- * Read a block from TFTP.
- * \param size Must be exactly 516 bytes
- * \param timeout Time to wait the network connection, may be NULL to wait forever
- * \return Number of bytes read if success, TFTP_ERR_TIMEOUT on timeout, TFTP_ERR otherwise
+ * Read the next block from TFTP into ctx->frame.
+ *
+ * If the client is silent for the session timeout, the last ACK is
+ * sent again up to TFTP_RETRIES times.
+ *
+ * \return Number of data bytes read if success, TFTP_ERR_TIMEOUT on timeout, TFTP_ERR otherwise
  */
-static ssize_t tftp_readPacket(TftpSession *ctx, Tftpframe *frame, mtime_t timeout)
+static ssize_t tftp_readPacket(TftpSession *ctx)
 {
-	DECLARE_TIMEOUT(wait_tm, timeout);
+	DECLARE_TIMEOUT(wait_tm, ctx->timeout);
+	int retries = 0;
 
-	int res = tftp_waitEvent(ctx, &wait_tm);
-	if (res == 0)
-		return TFTP_ERR_TIMEOUT;
-	if (res == -1)
-		return TFTP_ERR;
+	if (ctx->pending_ack)
+	{
+		ASSERT(ctx->block == 0);
+		ctx->pending_ack = false;
+		if (tftp_sendAck(ctx) < 0)
+			return TFTP_ERR;
+	}
 
-	ssize_t rlen = lwip_recvfrom(ctx->sock, frame, sizeof(Tftpframe), 0, NULL, NULL);
-	LOG_INFO("Received %zd bytes\n", rlen);
-	if (rlen > 0 && (checkPacket(ctx, frame) > 0))
-		return rlen;
-	else
-		return TFTP_ERR;
+	for (;;)
+	{
+		int res = tftp_waitEvent(ctx, &wait_tm);
+		if (res == 0)
+		{
+			if (retries++ == TFTP_RETRIES)
+				return TFTP_ERR_TIMEOUT;
+			LOG_INFO("Timeout, sending ACK %hu again\n", ctx->block);
+			if (tftp_sendAck(ctx) < 0)
+				return TFTP_ERR;
+			continue;
+		}
+		if (res == -1)
+			return TFTP_ERR;
+
+		ssize_t rlen = lwip_recvfrom(ctx->sock, &ctx->frame, sizeof(Tftpframe), 0, NULL, NULL);
+		LOG_INFO("Received %zd bytes\n", rlen);
+		if (rlen <= 0)
+			return TFTP_ERR;
+
+		res = checkPacket(ctx, &ctx->frame, rlen);
+		if (res < 0)
+			return TFTP_ERR;
+		if (res > 0)
+			return rlen - sizeof(struct TftpHeader);
+	}
 }
 
 static size_t tftp_read(struct KFile *fd, void *buf, size_t size)
@@ -132,16 +234,6 @@ static size_t tftp_read(struct KFile *fd, void *buf, size_t size)
 	size_t read_bytes = 0;
 	size_t offset = fds->valid_data - fds->bytes_available;
 
-	if (fds->pending_ack)
-	{
-		ASSERT(fds->block == 0);
-		struct ackframe ack;
-		ack.opcode = TFTP_ACK;
-		ack.block_num = fds->block;
-		lwip_sendto(fds->sock, &ack, 4, 0, (struct sockaddr *)&fds->addr, fds->addr_len);
-		fds->pending_ack = false;
-	}
-
 	if (fds->bytes_available < size)
 	{
 		/* check if we were called again after an error */
@@ -159,7 +251,7 @@ static size_t tftp_read(struct KFile *fd, void *buf, size_t size)
 		{
 			LOG_INFO("Waiting for new TFTP packet\n");
 			/* get more data, we can wait since the function is blocking */
-			ssize_t rd = tftp_readPacket(fds, &fds->frame, fds->timeout);
+			ssize_t rd = tftp_readPacket(fds);
 			if (rd < 0)
 			{
 				fds->bytes_available = 0;
@@ -168,12 +260,7 @@ static size_t tftp_read(struct KFile *fd, void *buf, size_t size)
 			}
 			else
 			{
-				if (rd < TFTP_PACKET_SIZE)
-				{
-					fds->is_xfer_end = true;
-					LOG_INFO("Received the last packet\n");
-				}
-				fds->bytes_available = (size_t)rd - sizeof(struct TftpHeader);
+				fds->bytes_available = (size_t)rd;
 				fds->valid_data = fds->bytes_available;
 				offset = 0;
 			}
@@ -211,13 +298,9 @@ static void tftp_clearerr(struct KFile *fd)
 static int tftp_close(struct KFile *fd)
 {
 	TftpSession *fds = TFTP_CAST(fd);
-	struct errframe err;
 	if (fds->pending_ack)
 	{
-		err.opcode = TFTP_PROTOERR;
-		err.errcode = TFTP_PROTOERR_ACCESS_VIOLATION;
-		err.str = '\0';
-		lwip_sendto(fds->sock, &err, 5, 0, (struct sockaddr *)&fds->addr, fds->addr_len);
+		tftp_sendError(fds, TFTP_PROTOERR_ACCESS_VIOLATION);
 		LOG_INFO("Closed connection upon user request\n");
 	}
 	return 0;
@@ -231,6 +314,68 @@ static void resetTftpState(TftpSession *ctx)
 	ctx->valid_data = 0;
 	ctx->is_xfer_end = false;
 	ctx->pending_ack = false;
+	ctx->nak_sent = false;
+	ctx->options = 0;
+	ctx->blksize = 512;
+	ctx->windowsize = 1;
+	ctx->window_cnt = 0;
+}
+
+/*
+ * Compare an option name, case insensitive, with a lowercase \a name.
+ */
+static bool optionIs(const char *opt, const char *name)
+{
+	for (;; opt++, name++)
+	{
+		char c = (*opt >= 'A' && *opt <= 'Z') ? *opt - 'A' + 'a' : *opt;
+
+		if (c != *name)
+			return false;
+		if (!c)
+			return true;
+	}
+}
+
+/*
+ * Negotiate the options appended to a request (RFC 2347).
+ * Unknown options and invalid values are ignored.
+ */
+static void parseOptions(TftpSession *ctx, size_t len)
+{
+	const char *p = ctx->frame.hdr.th_u.stuff;
+	const char *end = (const char *)&ctx->frame + len;
+	const char *opt = NULL;
+	int field = 0;
+
+	while (p < end)
+	{
+		const char *nul = (const char *)memchr(p, '\0', end - p);
+		if (!nul)
+			break;
+
+		/* Skip file name and mode, then read option and value pairs */
+		if (field >= 2 && !(field & 1))
+			opt = p;
+		else if (field >= 2)
+		{
+			unsigned long val = strtoul(p, NULL, 10);
+
+			if (optionIs(opt, "blksize") && val >= 8)
+			{
+				ctx->blksize = MIN(val, (unsigned long)CONFIG_TFTP_BLKSIZE);
+				ctx->options |= TFTP_OPT_BLKSIZE;
+			}
+			else if (optionIs(opt, "windowsize") && val >= 1)
+			{
+				ctx->windowsize = MIN(val, (unsigned long)CONFIG_TFTP_WINDOWSIZE);
+				ctx->options |= TFTP_OPT_WINDOWSIZE;
+			}
+		}
+		field++;
+		p = nul + 1;
+	}
+	LOG_INFO("Block size %hu, window %hu\n", ctx->blksize, ctx->windowsize);
 }
 
 /**
@@ -273,6 +418,7 @@ KFile *tftp_listen(TftpSession *ctx, char *filename, size_t len, TftpOpenMode *m
 			ctx->pending_ack = true;
 			strncpy(filename, (char *)&ctx->frame.hdr.th_u, len);
 			filename[len - 1] = '\0';
+			parseOptions(ctx, rd);
 			ctx->error = 0;
 			return &ctx->kfile_request;
 		}
@@ -283,6 +429,50 @@ KFile *tftp_listen(TftpSession *ctx, char *filename, size_t len, TftpOpenMode *m
 	return NULL;
 }
 
+/**
+ * Receive the file of a write request into \a dst.
+ *
+ * Every block is written to \a dst straight from the receive buffer of
+ * the session, without copying it through kfile_read(). Data already
+ * received but not read from the session KFile are written first.
+ *
+ * \param ctx Session returned by tftp_listen()
+ * \param dst KFile to store the file to
+ * \return Number of bytes written if success, TFTP_ERR_TIMEOUT on timeout, TFTP_ERR otherwise
+ */
+ssize_t tftp_receive(TftpSession *ctx, KFile *dst)
+{
+	const char *data = ctx->frame.data + ctx->valid_data - ctx->bytes_available;
+	size_t size = ctx->bytes_available;
+	ssize_t total = 0;
+
+	ctx->bytes_available = 0;
+	ctx->valid_data = 0;
+	for (;;)
+	{
+		if (size && kfile_write(dst, data, size) != size)
+		{
+			LOG_INFO("Error writing block %hu\n", ctx->block);
+			tftp_sendError(ctx, TFTP_PROTOERR_DISK_FULL);
+			ctx->error = TFTP_ERR;
+			return TFTP_ERR;
+		}
+		total += size;
+
+		if (ctx->is_xfer_end)
+			return total;
+
+		ssize_t rd = tftp_readPacket(ctx);
+		if (rd < 0)
+		{
+			ctx->error = rd;
+			return rd;
+		}
+		data = ctx->frame.data;
+		size = (size_t)rd;
+	}
+}
+
 /**
  * Init a server session
  *
@@ -40,6 +40,12 @@
  * call kfile_close().
  * Close the KFile when you're done.
  *
+ * Clients can ask for larger data blocks (RFC 2348) and for several blocks
+ * in flight for each ACK (RFC 7440), up to CONFIG_TFTP_BLKSIZE and
+ * CONFIG_TFTP_WINDOWSIZE. Instead of reading from the KFile, the whole
+ * transfer can be written by tftp_receive() to another KFile, straight
+ * from the receive buffer.
+ *
  * The usage pattern is as follows:
  * \code
  * // initialize a TFTP session
@@ -55,6 +61,14 @@
  * kfile_close(f);
  * \endcode
  *
+ * To store the file on a KFile \c dst (for example a KBlock opened
+ * through kfile_block):
+ * \code
+ * if (tftp_receive(&session, dst) < 0)
+ *     // the transfer failed
+ * kfile_close(f);
+ * \endcode
+ *
  *
  * \author Luca Ottaviano <lottaviano@develer.com>
  *
@@ -66,6 +80,8 @@
 #ifndef TFTP_H
 #define TFTP_H
 
+#include "cfg/cfg_tftp.h"
+
 #include <cfg/compiler.h>
 #include <lwip/sockets.h> // sockaddr_in, socklen_t
 #include <io/kfile.h>
@@ -75,9 +91,11 @@
 #define TFTP_DATA    03         /* TFTP data packet. */
 #define TFTP_ACK     0x0400     /* TFTP acknowledgement packet (already in net endianess). */
 #define TFTP_PROTOERR     0x0500     /* TFTP acknowledgement packet (already in net endianess). */
+#define TFTP_OACK    0x0600     /* TFTP option acknowledgement packet (already in net endianess). */
 
 /* TFTP protocol error codes */
 #define TFTP_PROTOERR_ACCESS_VIOLATION 0x0200
+#define TFTP_PROTOERR_DISK_FULL        0x0300
 
 #define TFTP_SERVER_PORT 69
 
@@ -98,7 +116,7 @@ struct PACKED TftpHeader
 
 typedef struct PACKED Tftpframe {
 	struct TftpHeader hdr;
-	char data[512];          /* data or error string */
+	char data[CONFIG_TFTP_BLKSIZE]; /* data or error string */
 } Tftpframe;
 
 struct PACKED ackframe
@@ -133,10 +151,16 @@ typedef struct TftpSession
 	size_t valid_data;
 	bool is_xfer_end;
 	bool pending_ack;
+	bool nak_sent;
+	uint8_t options;
+	unsigned short blksize;
+	unsigned short windowsize;
+	unsigned short window_cnt;
 	KFile kfile_request;
 } TftpSession;
 
 int tftp_init(TftpSession *ctx, unsigned short port, mtime_t timeout);
 KFile *tftp_listen(TftpSession *ctx, char *filename, size_t len, TftpOpenMode *mode);
+ssize_t tftp_receive(TftpSession *ctx, KFile *dst);
 
 #endif // TFTP_H
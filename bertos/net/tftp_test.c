@@ -0,0 +1,445 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief TFTP server test and transfer benchmark.
+ *
+ * A client stand-in sends a file to the server through a simulated link,
+ * which delays every packet by a fixed latency. The same file is sent in
+ * lock-step with 512 byte blocks, with larger blocks (RFC 2348) and with
+ * a window of blocks for each ACK (RFC 7440); the server stores it with
+ * tftp_receive() on a KFile checking its content. A last transfer drops
+ * some of the data blocks to exercise the recovery of the window.
+ *
+ * $test$: cp bertos/cfg/cfg_proc.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN" >> $cfgdir/cfg_proc.h
+ * $test$: echo "#define CONFIG_KERN 1" >> $cfgdir/cfg_proc.h
+ * $test$: cp bertos/cfg/cfg_signal.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_KERN_SIGNALS" >> $cfgdir/cfg_signal.h
+ * $test$: echo "#define CONFIG_KERN_SIGNALS 1" >> $cfgdir/cfg_signal.h
+ * $test$: cp bertos/cfg/cfg_tftp.h $cfgdir/
+ * $test$: echo  "#undef CONFIG_TFTP_WINDOWSIZE" >> $cfgdir/cfg_tftp.h
+ * $test$: echo "#define CONFIG_TFTP_WINDOWSIZE 16" >> $cfgdir/cfg_tftp.h
+ * $test$: cp bertos/cfg/cfg_lwip.h $cfgdir/
+ * $test$: echo  "#undef LWIP_SO_RCVTIMEO" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define LWIP_SO_RCVTIMEO 1" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEM_SIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEM_SIZE 65536" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_NETCONN" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_NETCONN 8" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_NETBUF" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_NETBUF 40" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_PBUF" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_PBUF 40" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef MEMP_NUM_TCPIP_MSG_INPKT" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define MEMP_NUM_TCPIP_MSG_INPKT 40" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef TCPIP_MBOX_SIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define TCPIP_MBOX_SIZE 32" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef SYS_MBOX_SIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define SYS_MBOX_SIZE 32" >> $cfgdir/cfg_lwip.h
+ * $test$: echo  "#undef DEFAULT_UDP_RECVMBOX_SIZE" >> $cfgdir/cfg_lwip.h
+ * $test$: echo "#define DEFAULT_UDP_RECVMBOX_SIZE 32" >> $cfgdir/cfg_lwip.h
+ *
+ * notest: avr
+ * notest: arm
+ */
+
+#include "tftp.h"
+
+#include <cfg/compiler.h>
+#include <cfg/test.h>
+#include <cfg/debug.h>
+
+#include <drv/timer.h>
+
+#include <kern/proc.h>
+
+#include <os/hptime.h>
+
+#include <lwip/tcpip.h>
+
+#include <string.h>
+
+/*
+ * lwIP and the TFTP server are not in the test sources list. The
+ * emulated Ethernet driver uses the host sockets, whose declarations
+ * clash with the lwIP ones: the Ethernet interface is not used here.
+ */
+#include "net/tftp.c"
+#undef LOG_LEVEL
+#undef LOG_FORMAT
+#include "net/lwip.c"
+
+#define FILE_SIZE    (64 * 1024L)
+#define LATENCY      5      /* ms, for each direction */
+#define WIRE_SIZE    64
+#define DROP_EVERY   7
+#define CLIENT_TMO   100    /* ms */
+#define CLIENT_TRIES 20
+
+typedef struct WirePacket
+{
+	struct pbuf *p;
+	ticks_t due;
+} WirePacket;
+
+static struct netif wire_netif;
+static WirePacket wire[WIRE_SIZE];
+static int wire_head, wire_cnt;
+static mtime_t wire_latency;
+static unsigned long wire_data, wire_drop;
+
+static TftpSession session;
+static volatile int rx_done;
+static ssize_t rx_len;
+static KFile check_fd;
+static unsigned long check_errors;
+
+static PROC_DEFINE_STACK(wire_stack, KERN_MINSTACKSIZE * 2);
+static PROC_DEFINE_STACK(server_stack, KERN_MINSTACKSIZE * 2);
+
+INLINE uint8_t pattern(kfile_off_t pos)
+{
+	return (uint8_t)(pos ^ (pos >> 8) ^ (pos >> 16));
+}
+
+/*
+ * Link output: every packet is delivered back to the same interface
+ * after the link latency. Data blocks sent to the server are dropped
+ * when wire_drop is set.
+ */
+static err_t wire_output(struct netif *netif, struct pbuf *p, struct ip_addr *ipaddr)
+{
+	struct pbuf *q;
+	(void)ipaddr;
+
+	if (wire_drop)
+	{
+		struct udp_hdr udp;
+		u16_t opcode;
+
+		if (pbuf_copy_partial(p, &udp, UDP_HLEN, IP_HLEN) == UDP_HLEN
+				&& pbuf_copy_partial(p, &opcode, 2, IP_HLEN + UDP_HLEN) == 2
+				&& ntohs(udp.dest) == TFTP_SERVER_PORT && ntohs(opcode) == TFTP_DATA
+				&& ++wire_data % wire_drop == 0)
+			return ERR_OK;
+	}
+
+	if (wire_cnt == WIRE_SIZE || !(q = pbuf_alloc(PBUF_RAW, p->tot_len, PBUF_RAM)))
+		return ERR_MEM;
+	pbuf_copy(q, p);
+
+	if (!wire_latency)
+	{
+		if (tcpip_input(q, netif) != ERR_OK)
+			pbuf_free(q);
+		return ERR_OK;
+	}
+
+	proc_forbid();
+	wire[(wire_head + wire_cnt) % WIRE_SIZE].p = q;
+	wire[(wire_head + wire_cnt) % WIRE_SIZE].due = timer_clock() + ms_to_ticks(wire_latency);
+	wire_cnt++;
+	proc_permit();
+	return ERR_OK;
+}
+
+static err_t wire_init(struct netif *netif)
+{
+	netif->name[0] = 'w';
+	netif->name[1] = 'r';
+	netif->output = wire_output;
+	netif->mtu = 1500;
+	return ERR_OK;
+}
+
+static void wire_proc(void)
+{
+	for (;;)
+	{
+		timer_delay(1);
+		while (wire_cnt && (long)(timer_clock() - wire[wire_head].due) >= 0)
+		{
+			struct pbuf *p = wire[wire_head].p;
+
+			proc_forbid();
+			wire_head = (wire_head + 1) % WIRE_SIZE;
+			wire_cnt--;
+			proc_permit();
+			if (tcpip_input(p, &wire_netif) != ERR_OK)
+				pbuf_free(p);
+		}
+	}
+}
+
+static size_t check_write(struct KFile *fd, const void *buf, size_t size)
+{
+	const uint8_t *data = (const uint8_t *)buf;
+
+	for (size_t i = 0; i < size; i++)
+		if (data[i] != pattern(fd->seek_pos + i))
+			check_errors++;
+	fd->seek_pos += size;
+	return size;
+}
+
+static void server(void)
+{
+	char name[16];
+	TftpOpenMode mode;
+
+	tftp_init(&session, TFTP_SERVER_PORT, 1000);
+	for (;;)
+	{
+		KFile *f = tftp_listen(&session, name, sizeof(name), &mode);
+
+		if (!f)
+			continue;
+		rx_len = tftp_receive(&session, &check_fd);
+		kfile_close(f);
+		rx_done = 1;
+	}
+}
+
+static char *putOpt(char *buf, const char *name, unsigned val)
+{
+	size_t len = strlen(name) + 1;
+
+	memcpy(buf, name, len);
+	return buf + len + sprintf(buf + len, "%u", val) + 1;
+}
+
+/*
+ * Wait for the (O)ACK of a block after \a acked, ignoring the stale ones.
+ * \return The block number acknowledged, -1 on timeout
+ */
+static long client_waitAck(struct netconn *conn, long acked, unsigned *blksize, unsigned *window)
+{
+	struct netbuf *buf;
+
+	while ((buf = netconn_recv(conn)) != NULL)
+	{
+		char pkt[64];
+		u16_t len = netbuf_copy(buf, pkt, sizeof(pkt) - 1);
+		struct TftpHeader *hdr = (struct TftpHeader *)pkt;
+		long block = -1;
+
+		netbuf_delete(buf);
+		pkt[len] = '\0';
+		if (len >= 4 && hdr->opcode == TFTP_ACK)
+			block = ntohs(hdr->th_u.block);
+		else if (len >= 2 && hdr->opcode == TFTP_OACK)
+		{
+			/* Take the values chosen by the server */
+			for (char *p = hdr->th_u.stuff; p < pkt + len; p += strlen(p) + 1)
+			{
+				char *val = p + strlen(p) + 1;
+
+				if (!strcmp(p, "blksize"))
+					*blksize = atoi(val);
+				else if (!strcmp(p, "windowsize"))
+					*window = atoi(val);
+				p = val;
+			}
+			block = 0;
+		}
+		if (block > acked || (block == 0 && acked < 0))
+			return block;
+	}
+	return -1;
+}
+
+/*
+ * Send FILE_SIZE bytes to the server, return the elapsed time in ms or
+ * -1 on errors.
+ */
+static long client_put(unsigned blksize, unsigned window)
+{
+	static uint8_t pkt[4 + CONFIG_TFTP_BLKSIZE];
+	struct TftpHeader *hdr = (struct TftpHeader *)pkt;
+	struct ip_addr addr;
+	struct netconn *conn;
+	struct netbuf *buf;
+	long blocks, acked = -1;
+	int tries = 0;
+	char *req;
+
+	IP4_ADDR(&addr, 10, 0, 0, 1);
+	conn = netconn_new(NETCONN_UDP);
+	netconn_bind(conn, IP_ADDR_ANY, 0);
+	conn->recv_timeout = CLIENT_TMO;
+	buf = netbuf_new();
+
+	hdr->opcode = TFTP_WRQ;
+	req = hdr->th_u.stuff;
+	req += sprintf(req, "bench.bin") + 1;
+	req += sprintf(req, "octet") + 1;
+	if (blksize != 512)
+		req = putOpt(req, "blksize", blksize);
+	if (window != 1)
+		req = putOpt(req, "windowsize", window);
+
+	rx_done = 0;
+	check_fd.seek_pos = 0;
+	check_errors = 0;
+	hptime_t start = hptime_get();
+
+	/* Without options the server answers with ACK 0, with an OACK otherwise */
+	unsigned req_len = req - (char *)pkt;
+	blksize = 512;
+	window = 1;
+	while (acked < 0)
+	{
+		if (tries++ == CLIENT_TRIES)
+			goto error;
+		netbuf_ref(buf, pkt, req_len);
+		netconn_sendto(conn, buf, &addr, TFTP_SERVER_PORT);
+		acked = client_waitAck(conn, acked, &blksize, &window);
+	}
+
+	/* The last block is shorter than blksize, even if empty */
+	blocks = FILE_SIZE / blksize + 1;
+	tries = 0;
+	while (acked < blocks)
+	{
+		for (long n = acked + 1; n <= MIN(acked + (long)window, blocks); n++)
+		{
+			long pos = (n - 1) * blksize;
+			size_t len = MIN((long)blksize, FILE_SIZE - pos);
+
+			hdr->opcode = htons(TFTP_DATA);
+			hdr->th_u.block = htons(n);
+			for (size_t i = 0; i < len; i++)
+				pkt[4 + i] = pattern(pos + i);
+			netbuf_ref(buf, pkt, 4 + len);
+			netconn_sendto(conn, buf, &addr, TFTP_SERVER_PORT);
+		}
+
+		long block = client_waitAck(conn, acked, &blksize, &window);
+		if (block < 0)
+		{
+			if (tries++ == CLIENT_TRIES)
+				goto error;
+			continue;
+		}
+		tries = 0;
+		acked = block;
+	}
+
+	while (!rx_done)
+		timer_delay(1);
+	netbuf_delete(buf);
+	netconn_delete(conn);
+	if (rx_len != FILE_SIZE || check_fd.seek_pos != FILE_SIZE || check_errors)
+	{
+		kprintf("Received %ld bytes, %lu errors\n", (long)rx_len, check_errors);
+		return -1;
+	}
+	return (hptime_get() - start) / (HPTIME_TICKS_PER_MICRO * 1000);
+
+error:
+	netbuf_delete(buf);
+	netconn_delete(conn);
+	kprintf("No answer from the server\n");
+	return -1;
+}
+
+static long bench(mtime_t latency, unsigned blksize, unsigned window)
+{
+	long ms;
+
+	wire_latency = latency;
+	ms = client_put(blksize, window);
+	if (ms >= 0)
+		kprintf("latency %2ld ms, blksize %4u, window %2u: %5ld ms, %6ld KiB/s\n",
+			(long)latency, blksize, window, ms, FILE_SIZE * 1000 / 1024 / MAX(ms, 1L));
+	return ms;
+}
+
+int tftp_testRun(void)
+{
+	long lockstep, windowed;
+
+	if (bench(0, 512, 1) < 0 || bench(0, 1428, 1) < 0 || bench(0, 1428, 16) < 0)
+		return -1;
+
+	lockstep = bench(LATENCY, 512, 1);
+	if (lockstep < 0 || bench(LATENCY, 1428, 1) < 0)
+		return -1;
+	windowed = bench(LATENCY, 1428, 16);
+	if (windowed < 0)
+		return -1;
+	/* Each window costs a round trip, instead of each block */
+	if (windowed * 4 > lockstep)
+	{
+		kprintf("Window not faster than lock-step\n");
+		return -1;
+	}
+
+	wire_drop = DROP_EVERY;
+	if (bench(LATENCY, 1428, 16) < 0)
+	{
+		kprintf("Recovery from lost blocks failed\n");
+		return -1;
+	}
+	kprintf("%lu data blocks dropped\n", wire_data / wire_drop);
+	return 0;
+}
+
+int tftp_testSetup(void)
+{
+	struct ip_addr addr, netmask, gw;
+
+	kdbg_init();
+	timer_init();
+	proc_init();
+
+	tcpip_init(NULL, NULL);
+	IP4_ADDR(&addr, 10, 0, 0, 1);
+	IP4_ADDR(&netmask, 255, 255, 255, 0);
+	IP4_ADDR(&gw, 10, 0, 0, 1);
+	netif_add(&wire_netif, &addr, &netmask, &gw, NULL, wire_init, tcpip_input);
+	netif_set_default(&wire_netif);
+	netif_set_up(&wire_netif);
+
+	DB(check_fd._type = 0);
+	check_fd.write = check_write;
+	proc_new(wire_proc, NULL, sizeof(wire_stack), wire_stack);
+	proc_new(server, NULL, sizeof(server_stack), server_stack);
+	return 0;
+}
+
+int tftp_testTearDown(void)
+{
+	return 0;
+}
+
+TEST_MAIN(tftp);
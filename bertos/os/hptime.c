@@ -61,15 +61,25 @@ hptime_t hptime_get(void)
 #elif defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
 
 #include <sys/time.h> /* for gettimeofday() */
+#include <time.h> /* for clock_gettime() */
 #include <stddef.h> /* for NULL */
 
 hptime_t hptime_get(void)
 {
+#ifdef CLOCK_MONOTONIC
+	/* Don't go backwards when the wall clock is adjusted */
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (hptime_t)ts.tv_sec * HPTIME_TICKS_PER_SECOND
+		+ (hptime_t)ts.tv_nsec / 1000;
+#else
 	struct timeval tv;
 
 	gettimeofday(&tv, NULL);
 	return (hptime_t)tv.tv_sec * HPTIME_TICKS_PER_SECOND
 		+ (hptime_t)tv.tv_usec;
+#endif
 }
 
 #else /* !__unix__ */
@@ -1,5 +1,6 @@
 #include "benchmarks.h"
 #include <drv/timer.h>
+#include <cpu/irq.h>
 #include <string.h>
 
 static uint8_t buf[512];
@@ -19,7 +20,34 @@ void hash_benchmark(Hash *h, const char *hname, int numk)
 	t = timer_clock() - t;
 
 	utime_t usec = ticks_to_us(t) / 64;
-	kprintf("%s @ %ldMhz: %s of %dKiB of data: %lu.%lu ms\n", CPU_CORE_NAME, CPU_FREQ/1000000, hname, numk, (usec/1000), (usec % 1000));
+	kprintf("%s @ %ldMhz: %s of %dKiB of data: %lu.%lu ms\n", CPU_CORE_NAME, CPU_FREQ/1000000, hname, numk, (unsigned long)(usec/1000), (unsigned long)(usec % 1000));
+}
+
+/*
+ * Measure the cost of a single call: applications drawing many small
+ * nonces pay the setup cost of the generator on each request.
+ */
+static void prng_call_benchmark(PRNG *prng, const char *hname, size_t drawlen)
+{
+	enum { CYCLES = 16384 };
+	ASSERT(drawlen <= sizeof(buf));
+
+	/* A single call is much shorter than a tick: time it in hpticks */
+	uint32_t t = 0;
+	for (int j=0;j<CYCLES;++j)
+	{
+		cpu_flags_t flags;
+		uint32_t start;
+
+		IRQ_SAVE_DISABLE(flags);
+		start = timer_hpclock();
+		prng_generate(prng, buf, drawlen);
+		t += timer_hpclock() - start;
+		IRQ_RESTORE(flags);
+	}
+
+	uint32_t nsec = (uint64_t)t * 1000000000 / TIMER_HW_HPTICKS_PER_SEC / CYCLES;
+	kprintf("%s @ %ldMhz: %s draw of %d bytes: %lu ns/call\n", CPU_CORE_NAME, CPU_FREQ/1000000, hname, (int)drawlen, (unsigned long)nsec);
 }
 
 void prng_benchmark(PRNG *prng, const char *hname, int numbytes)
@@ -43,9 +71,12 @@ void prng_benchmark(PRNG *prng, const char *hname, int numbytes)
 	t = timer_clock() - t;
 
 	utime_t usec = ticks_to_us(t) / CYCLES;
-	kprintf("%s @ %ldMhz: %s generation of %d random bytes: %lu.%lu ms\n", CPU_CORE_NAME, CPU_FREQ/1000000, hname, numbytes, (usec/1000), (usec % 1000));
+	kprintf("%s @ %ldMhz: %s generation of %d random bytes: %lu.%lu ms\n", CPU_CORE_NAME, CPU_FREQ/1000000, hname, numbytes, (unsigned long)(usec/1000), (unsigned long)(usec % 1000));
 	kprintf("Sample of random data:\n");
 	kdump(buf, MIN(numbytes, 64));
+
+	prng_call_benchmark(prng, hname, 4);
+	prng_call_benchmark(prng, hname, 512);
 }
 
 void cipher_benchmark(BlockCipher *c, const char *cname, int numbytes)
@@ -75,6 +106,6 @@ void cipher_benchmark(BlockCipher *c, const char *cname, int numbytes)
 	kprintf("%s @ %ldMhz: %s-CBC of %d bytes: %lu.%lu ms (%d KiB/s)\n",
 			CPU_CORE_NAME, CPU_FREQ/1000000,
 			cname, numbytes,
-			(usec/1000), (usec % 1000),
+			(unsigned long)(usec/1000), (unsigned long)(usec % 1000),
 			(uint32_t)(numbytes * (CYCLES * 1000000 / 1024) / ticks_to_us(t)));
 }
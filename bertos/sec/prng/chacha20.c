@@ -0,0 +1,154 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief ChaCha20 PRNG implementation
+ *
+ */
+
+#include "chacha20.h"
+#include <sec/util.h>
+#include <cfg/macros.h>
+#include <cpu/byteorder.h>
+#include <string.h>
+
+#define QR(a, b, c, d) \
+	do { \
+		a += b; d ^= a; d = ROTL(d, 16); \
+		c += d; b ^= c; b = ROTL(b, 12); \
+		a += b; d ^= a; d = ROTL(d, 8);  \
+		c += d; b ^= c; b = ROTL(b, 7);  \
+	} while (0)
+
+static void chacha20_core(const uint32_t key[8], uint32_t counter, const uint32_t nonce[3], uint32_t out[16])
+{
+	uint32_t x[16];
+
+	/* "expand 32-byte k" */
+	out[0] = 0x61707865;
+	out[1] = 0x3320646e;
+	out[2] = 0x79622d32;
+	out[3] = 0x6b206574;
+	memcpy(&out[4], key, 8 * sizeof(uint32_t));
+	out[12] = counter;
+	out[13] = nonce[0];
+	out[14] = nonce[1];
+	out[15] = nonce[2];
+
+	memcpy(x, out, sizeof(x));
+	for (int i = 0; i < 10; i++)
+	{
+		QR(x[0], x[4], x[8],  x[12]);
+		QR(x[1], x[5], x[9],  x[13]);
+		QR(x[2], x[6], x[10], x[14]);
+		QR(x[3], x[7], x[11], x[15]);
+		QR(x[0], x[5], x[10], x[15]);
+		QR(x[1], x[6], x[11], x[12]);
+		QR(x[2], x[7], x[8],  x[13]);
+		QR(x[3], x[4], x[9],  x[14]);
+	}
+
+	for (int i = 0; i < 16; i++)
+		out[i] = cpu_to_le32(out[i] + x[i]);
+
+	PURGE(x);
+}
+
+void chacha20_block(const uint32_t key[8], uint32_t counter, const uint32_t nonce[3], uint8_t *out)
+{
+	uint32_t block[16];
+
+	chacha20_core(key, counter, nonce, block);
+	memcpy(out, block, sizeof(block));
+	PURGE(block);
+}
+
+static void chacha20_generate(PRNG *ctx_, uint8_t *data, size_t len)
+{
+	Chacha20Context *ctx = (Chacha20Context *)ctx_;
+	static const uint32_t nonce[3] = { 0, 0, 0 };
+	uint32_t block[16];
+	uint32_t counter = 0;
+
+	ASSERT(len);
+
+	/* The first half of block 0 becomes the next key, the rest is output */
+	chacha20_core(ctx->key, counter++, nonce, block);
+
+	size_t L = MIN(len, sizeof(block) / 2);
+	memcpy(data, &block[8], L);
+	data += L;
+	len -= L;
+
+	/* Full blocks are written straight into the output buffer */
+	while (len >= sizeof(block))
+	{
+		chacha20_block(ctx->key, counter++, nonce, data);
+		data += sizeof(block);
+		len -= sizeof(block);
+	}
+
+	uint32_t next_key[8];
+	memcpy(next_key, block, sizeof(next_key));
+
+	if (len)
+	{
+		chacha20_core(ctx->key, counter, nonce, block);
+		memcpy(data, block, len);
+	}
+
+	for (int i = 0; i < 8; i++)
+		ctx->key[i] = le32_to_cpu(next_key[i]);
+
+	PURGE(next_key);
+	PURGE(block);
+}
+
+static void chacha20_reseed(PRNG *ctx_, const uint8_t *seed)
+{
+	Chacha20Context *ctx = (Chacha20Context *)ctx_;
+
+	// Mix the seed into the current key, so that the new state depends
+	// on the previous one too.
+	if (!ctx->prng.seeded)
+		memset(ctx->key, 0, sizeof(ctx->key));
+	xor_block(ctx->key, ctx->key, seed, sizeof(ctx->key));
+}
+
+/*********************************************************************/
+
+void chacha20_init(Chacha20Context *ctx)
+{
+	ctx->prng.reseed = chacha20_reseed;
+	ctx->prng.generate = chacha20_generate;
+	ctx->prng.seed_len = sizeof(ctx->key);
+	ctx->prng.seeded = 0;
+}
@@ -0,0 +1,71 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief ChaCha20 PRNG implementation
+ *
+ * The generator outputs the ChaCha20 keystream (RFC 7539) with an all-zero
+ * nonce, and applies fast key erasure: every call to prng_generate() first
+ * derives a new key from the keystream, and then outputs the bytes that
+ * follow it. The previous key is overwritten before returning, so a
+ * compromise of the state does not reveal any output already generated.
+ */
+
+#ifndef SEC_PRNG_CHACHA20_H
+#define SEC_PRNG_CHACHA20_H
+
+#include <sec/prng.h>
+
+/** Size in bytes of a ChaCha20 keystream block */
+#define CHACHA20_BLOCK_LEN  64
+
+typedef struct Chacha20Context
+{
+	PRNG prng;
+	uint32_t key[8];
+} Chacha20Context;
+
+void chacha20_init(Chacha20Context *ctx);
+
+/**
+ * Compute a single ChaCha20 keystream block.
+ *
+ * \param key     256 bit key, as eight little endian words.
+ * \param counter Block counter.
+ * \param nonce   96 bit nonce, as three little endian words.
+ * \param out     Output buffer of CHACHA20_BLOCK_LEN bytes.
+ */
+void chacha20_block(const uint32_t key[8], uint32_t counter, const uint32_t nonce[3], uint8_t *out);
+
+#define chacha20_stackinit(...) \
+	({ Chacha20Context *ctx = alloca(sizeof(Chacha20Context)); chacha20_init(ctx, ##__VA_ARGS__); &ctx->prng; })
+
+#endif /* SEC_PRNG_CHACHA20_H */
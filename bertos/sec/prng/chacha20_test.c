@@ -0,0 +1,157 @@
+/**
+ * \file
+ * <!--
+ * This file is part of BeRTOS.
+ *
+ * Bertos is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * As a special exception, you may use this file as part of a free software
+ * library without restriction.  Specifically, if other files instantiate
+ * templates or use macros or inline functions from this file, or you compile
+ * this file and link it with other files to produce an executable, this
+ * file does not by itself cause the resulting executable to be covered by
+ * the GNU General Public License.  This exception does not however
+ * invalidate any other reasons why the executable file might be covered by
+ * the GNU General Public License.
+ *
+ * Copyright 2026 Develer S.r.l. (http://www.develer.com/)
+ *
+ * -->
+ *
+ * \brief ChaCha20 PRNG and buffered random generator test.
+ *
+ * $test$: cp bertos/cfg/cfg_random.h $cfgdir/
+ * $test$: echo "#undef CONFIG_RANDOM_CHACHA20" >> $cfgdir/cfg_random.h
+ * $test$: echo "#define CONFIG_RANDOM_CHACHA20 1" >> $cfgdir/cfg_random.h
+ */
+
+#include "chacha20.h"
+
+#include <cfg/test.h>
+#include <cfg/debug.h>
+
+#include <cpu/irq.h>
+
+#include <drv/timer.h>
+
+#include <sec/benchmarks.h>
+#include <sec/random.h>
+#include <sec/random_p.h>
+
+#include <string.h>
+
+/* RFC 7539, 2.3.2 */
+static const uint32_t test_key[8] =
+{
+	0x03020100, 0x07060504, 0x0b0a0908, 0x0f0e0d0c,
+	0x13121110, 0x17161514, 0x1b1a1918, 0x1f1e1d1c,
+};
+static const uint32_t test_nonce[3] = { 0x09000000, 0x4a000000, 0x00000000 };
+static const uint8_t test_block[CHACHA20_BLOCK_LEN] =
+	"\x10\xf1\xe7\xe4\xd1\x3b\x59\x15\x50\x0f\xdd\x1f\xa3\x20\x71\xc4"
+	"\xc7\xd1\xf4\xc7\x33\xc0\x68\x03\x04\x22\xaa\x9a\xc3\xd4\x6c\x4e"
+	"\xd2\x82\x64\x46\x07\x9f\xaa\x09\x14\xc2\xd7\x05\xd9\x8b\x02\xa2"
+	"\xb5\x12\x9c\xd1\xde\x16\x4e\xb9\xcb\xd0\x83\xe8\xa2\x50\x3c\x4e";
+
+void random_pull_entropy(uint8_t *entropy, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+		entropy[i] = timer_clock() + i;
+}
+
+int chacha20_testSetup(void)
+{
+	kdbg_init();
+	timer_init();
+	return 0;
+}
+
+int chacha20_testTearDown(void)
+{
+	return 0;
+}
+
+static void random_benchmark(size_t drawlen)
+{
+	enum { CYCLES = 16384 };
+	uint8_t out[512];
+
+	uint32_t t = 0;
+	for (int j = 0; j < CYCLES; ++j)
+	{
+		cpu_flags_t flags;
+		uint32_t start;
+
+		IRQ_SAVE_DISABLE(flags);
+		start = timer_hpclock();
+		random_gen(out, drawlen);
+		t += timer_hpclock() - start;
+		IRQ_RESTORE(flags);
+	}
+
+	kprintf("random_gen() draw of %d bytes: %lu ns/call\n", (int)drawlen,
+		(unsigned long)((uint64_t)t * 1000000000 / TIMER_HW_HPTICKS_PER_SEC / CYCLES));
+}
+
+int chacha20_testRun(void)
+{
+	uint8_t block[CHACHA20_BLOCK_LEN];
+	uint8_t seed[32];
+	uint8_t out1[200], out2[200];
+	Chacha20Context a, b;
+
+	chacha20_block(test_key, 1, test_nonce, block);
+	ASSERT(memcmp(block, test_block, sizeof(block)) == 0);
+
+	memset(seed, 0x5a, sizeof(seed));
+	chacha20_init(&a);
+	chacha20_init(&b);
+	prng_reseed(&a.prng, seed);
+	prng_reseed(&b.prng, seed);
+
+	/* Same seed, same output; the key must change after each request */
+	for (size_t len = 1; len < sizeof(out1); len += 13)
+	{
+		uint32_t old_key[8];
+
+		memcpy(old_key, a.key, sizeof(old_key));
+		prng_generate(&a.prng, out1, len);
+		prng_generate(&b.prng, out2, len);
+		ASSERT(memcmp(out1, out2, len) == 0);
+		ASSERT(memcmp(old_key, a.key, sizeof(old_key)) != 0);
+	}
+
+	/* A successive request never repeats the previous output */
+	prng_generate(&a.prng, out1, sizeof(out1));
+	prng_generate(&a.prng, out2, sizeof(out2));
+	ASSERT(memcmp(out1, out2, sizeof(out1)) != 0);
+
+	prng_benchmark(&a.prng, "ChaCha20", 4096);
+
+	random_init();
+	random_gen(out1, sizeof(out1));
+	random_gen(out2, 4);
+	random_gen(out2 + 4, 4);
+	ASSERT(memcmp(out2, out2 + 4, 4) != 0);
+
+	random_benchmark(4);
+	random_benchmark(512);
+
+	return 0;
+}
+
+#include <sec/random.c>
+
+TEST_MAIN(chacha20);
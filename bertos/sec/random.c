@@ -48,6 +48,7 @@
 #include <sec/prng/isaac.h>
 #include <sec/prng/x917.h>
 #include <sec/prng/yarrow.h>
+#include <sec/prng/chacha20.h>
 #include <sec/entropy/yarrow_pool.h>
 
 /********************************************************************************/
@@ -77,6 +78,17 @@ static PRNG * const prng = (PRNG*)&prng_ctx;
 
 static bool initialized = 0;
 
+#if CONFIG_RANDOM_BUFFER_LEN
+/*
+ * Keystream buffer: small requests are served from here, so the cost of
+ * a PRNG invocation (and of the reseeding check) is paid only once per
+ * refill. Bytes are consumed from the end and wiped as soon as they are
+ * handed out, so that a later state compromise does not reveal them.
+ */
+static uint8_t random_buf[CONFIG_RANDOM_BUFFER_LEN];
+static size_t random_avail;
+#endif
+
 
 /********************************************************************************/
 /* Code                                                                         */
@@ -194,6 +206,40 @@ void random_init(void)
 	initial_seeding();
 }
 
+#if CONFIG_RANDOM_BUFFER_LEN
+
+void random_gen(uint8_t *out, size_t len)
+{
+	ASSERT(initialized);
+
+	// Large requests bypass the buffer, there is nothing to amortize.
+	if (len >= sizeof(random_buf))
+	{
+		optional_reseeding();
+		prng_generate(prng, out, len);
+		return;
+	}
+
+	while (len)
+	{
+		if (!random_avail)
+		{
+			optional_reseeding();
+			prng_generate(prng, random_buf, sizeof(random_buf));
+			random_avail = sizeof(random_buf);
+		}
+
+		size_t L = MIN(len, random_avail);
+		random_avail -= L;
+		memcpy(out, random_buf + random_avail, L);
+		memset(random_buf + random_avail, 0, L);
+		out += L;
+		len -= L;
+	}
+}
+
+#else
+
 void random_gen(uint8_t *out, size_t len)
 {
 	ASSERT(initialized);
@@ -202,6 +248,8 @@ void random_gen(uint8_t *out, size_t len)
 	prng_generate(prng, out, len);
 }
 
+#endif
+
 #if CONFIG_RANDOM_POOL != POOL_NONE
 
 void random_add_entropy(enum EntropySource source_idx,
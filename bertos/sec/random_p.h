@@ -53,12 +53,15 @@
 #define PRNG_ISAAC      1
 #define PRNG_X917       2
 #define PRNG_YARROW     3
+#define PRNG_CHACHA20   4
 #define PRNG_NAMEU1     Isaac
 #define PRNG_NAMEL1     isaac
 #define PRNG_NAMEU2     X917
 #define PRNG_NAMEL2     x917
 #define PRNG_NAMEU3     Yarrow
 #define PRNG_NAMEL3     yarrow
+#define PRNG_NAMEU4     Chacha20
+#define PRNG_NAMEL4     chacha20
 
 #define EXTRACTOR_NONE  0
 #define EXTRACTOR_SHA1  1
@@ -80,6 +83,11 @@
 	#error Unsupported random security level value
 #endif
 
+#if CONFIG_RANDOM_CHACHA20
+	#undef CONFIG_RANDOM_PRNG
+	#define CONFIG_RANDOM_PRNG          PRNG_CHACHA20
+#endif
+
 /***************************************************************************/
 /* Internal functions used by BeRTOS drivers to push data into             */
 /* the entropy pool                                                        */
@@ -20,6 +20,7 @@ arduino_aprs_HW_PATH = boards/arduino
 # Files automatically generated by the wizard. DO NOT EDIT, USE aprs_USER_CSRC INSTEAD!
 aprs_WIZARD_CSRC = \
 	aprs/hw/hw_afsk.c \
+	bertos/algo/crc_ccitt.c \
 	bertos/cpu/avr/drv/ser_avr.c \
 	bertos/cpu/avr/drv/ser_mega.c \
 	bertos/cpu/avr/drv/timer_avr.c \
@@ -19,6 +19,7 @@ arduino_kiss_g4xyw_HW_PATH = boards/arduino
 
 # Files automatically generated by the wizard. DO NOT EDIT, USE arduino_kiss_g4xyw_USER_CSRC INSTEAD!
 arduino_kiss_g4xyw_WIZARD_CSRC = \
+	bertos/algo/crc_ccitt.c \
 	bertos/cpu/avr/drv/ser_avr.c \
 	bertos/cpu/avr/drv/ser_mega.c \
 	bertos/cpu/avr/drv/timer_avr.c \
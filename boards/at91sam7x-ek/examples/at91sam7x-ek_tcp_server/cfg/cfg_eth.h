@@ -62,5 +62,34 @@
  */
 #define CONFIG_PHY_CHIP     DAVICOM_DM9161A
 
+/**
+ * Use the descriptor ring driver interface.
+ *
+ * The network stack hands its own buffers to the driver instead of copying
+ * every frame. Only drivers implementing eth_rxPost() and eth_txPost()
+ * support it, like the emulator one.
+ *
+ * $WIZ$ type = "boolean"
+ */
+#define CONFIG_ETH_RING     0
+
+/**
+ * Receive descriptors of the ring interface.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 2
+ */
+#define CONFIG_ETH_RXBUFS   8
+
+/**
+ * Transmit descriptors of the ring interface.
+ *
+ * A frame takes one descriptor for each buffer of its pbuf chain.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 2
+ */
+#define CONFIG_ETH_TXBUFS   16
+
 
 #endif /* CFG_ETH_H */
@@ -61,4 +61,42 @@
  */
 #define HTTP_DEFAULT_PAGE      "index.htm"
 
+/**
+ * Number of worker processes serving clients concurrently.
+ *
+ * With 0 every connection is served by the process calling http_poll(),
+ * one request at a time, and persistent connections are disabled.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 0
+ */
+#define CONFIG_HTTP_WORKERS      0
+
+/**
+ * Stack size of each worker process.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 0
+ */
+#define CONFIG_HTTP_WORKER_STACK (KERN_MINSTACKSIZE * 2)
+
+/**
+ * Size of the buffer holding the request headers and body of a client.
+ * Longer requests are truncated and the connection is closed after the
+ * response.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 64
+ */
+#define CONFIG_HTTP_REQ_LEN      512
+
+/**
+ * Time in ms an idle persistent connection is kept open.
+ * Needs LWIP_SO_RCVTIMEO, otherwise persistent connections are disabled.
+ *
+ * $WIZ$ type = "int"
+ * $WIZ$ min = 1
+ */
+#define CONFIG_HTTP_KEEPALIVE_TIMEOUT 5000
+
 #endif /* CFG_HTTP_H */
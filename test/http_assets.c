@@ -0,0 +1,148 @@
+/* Generated by http_mkassets.py from test/http_assets, do not edit. */
+#include <net/http.h>
+
+static const uint8_t asset0[] =
+{
+	0x3c, 0x21, 0x44, 0x4f, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20, 0x68, 0x74,
+	0x6d, 0x6c, 0x3e, 0x0a, 0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a, 0x3c,
+	0x68, 0x65, 0x61, 0x64, 0x3e, 0x0a, 0x3c, 0x74, 0x69, 0x74, 0x6c, 0x65,
+	0x3e, 0x42, 0x65, 0x52, 0x54, 0x4f, 0x53, 0x20, 0x64, 0x65, 0x76, 0x69,
+	0x63, 0x65, 0x20, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x3c, 0x2f, 0x74,
+	0x69, 0x74, 0x6c, 0x65, 0x3e, 0x0a, 0x3c, 0x6c, 0x69, 0x6e, 0x6b, 0x20,
+	0x72, 0x65, 0x6c, 0x3d, 0x22, 0x73, 0x74, 0x79, 0x6c, 0x65, 0x73, 0x68,
+	0x65, 0x65, 0x74, 0x22, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x74,
+	0x65, 0x78, 0x74, 0x2f, 0x63, 0x73, 0x73, 0x22, 0x20, 0x68, 0x72, 0x65,
+	0x66, 0x3d, 0x22, 0x63, 0x73, 0x73, 0x2f, 0x73, 0x74, 0x79, 0x6c, 0x65,
+	0x2e, 0x63, 0x73, 0x73, 0x22, 0x3e, 0x0a, 0x3c, 0x2f, 0x68, 0x65, 0x61,
+	0x64, 0x3e, 0x0a, 0x3c, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x0a, 0x3c, 0x68,
+	0x31, 0x3e, 0x42, 0x65, 0x52, 0x54, 0x4f, 0x53, 0x20, 0x64, 0x65, 0x76,
+	0x69, 0x63, 0x65, 0x20, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x3c, 0x2f,
+	0x68, 0x31, 0x3e, 0x0a, 0x3c, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x69,
+	0x64, 0x3d, 0x22, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x22, 0x3e, 0x0a,
+	0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x54, 0x65, 0x6d, 0x70,
+	0x65, 0x72, 0x61, 0x74, 0x75, 0x72, 0x65, 0x3c, 0x2f, 0x74, 0x68, 0x3e,
+	0x3c, 0x74, 0x64, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x74, 0x65, 0x6d, 0x70,
+	0x22, 0x3e, 0x2d, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72,
+	0x3e, 0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x55, 0x70,
+	0x20, 0x74, 0x69, 0x6d, 0x65, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74,
+	0x64, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x75, 0x70, 0x74, 0x69, 0x6d, 0x65,
+	0x22, 0x3e, 0x2d, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72,
+	0x3e, 0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x46, 0x72,
+	0x65, 0x65, 0x20, 0x6d, 0x65, 0x6d, 0x6f, 0x72, 0x79, 0x3c, 0x2f, 0x74,
+	0x68, 0x3e, 0x3c, 0x74, 0x64, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x6d, 0x65,
+	0x6d, 0x22, 0x3e, 0x2d, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74,
+	0x72, 0x3e, 0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x49,
+	0x50, 0x20, 0x61, 0x64, 0x64, 0x72, 0x65, 0x73, 0x73, 0x3c, 0x2f, 0x74,
+	0x68, 0x3e, 0x3c, 0x74, 0x64, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x69, 0x70,
+	0x22, 0x3e, 0x2d, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72,
+	0x3e, 0x0a, 0x3c, 0x2f, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x3e, 0x0a, 0x3c,
+	0x70, 0x3e, 0x54, 0x68, 0x65, 0x20, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20,
+	0x69, 0x73, 0x20, 0x72, 0x65, 0x66, 0x72, 0x65, 0x73, 0x68, 0x65, 0x64,
+	0x20, 0x65, 0x76, 0x65, 0x72, 0x79, 0x20, 0x73, 0x65, 0x63, 0x6f, 0x6e,
+	0x64, 0x20, 0x77, 0x69, 0x74, 0x68, 0x20, 0x74, 0x68, 0x65, 0x20, 0x64,
+	0x61, 0x74, 0x61, 0x20, 0x72, 0x65, 0x61, 0x64, 0x20, 0x66, 0x72, 0x6f,
+	0x6d, 0x20, 0x3c, 0x61, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x73,
+	0x74, 0x61, 0x74, 0x75, 0x73, 0x22, 0x3e, 0x2f, 0x73, 0x74, 0x61, 0x74,
+	0x75, 0x73, 0x3c, 0x2f, 0x61, 0x3e, 0x2e, 0x3c, 0x2f, 0x70, 0x3e, 0x0a,
+	0x3c, 0x2f, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x0a, 0x3c, 0x2f, 0x68, 0x74,
+	0x6d, 0x6c, 0x3e, 0x0a,
+};
+static const uint8_t asset0_gz[] =
+{
+	0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x75, 0x51,
+	0xcb, 0x6e, 0xc3, 0x20, 0x10, 0xbc, 0xe7, 0x2b, 0xb6, 0xdc, 0x1b, 0xd4,
+	0x3b, 0xe6, 0xd0, 0x97, 0xd4, 0x53, 0xa2, 0xd6, 0x3d, 0xf4, 0x48, 0xcc,
+	0x5a, 0xa0, 0x42, 0x8c, 0x60, 0x93, 0xd6, 0x7f, 0xdf, 0xc5, 0xb1, 0x55,
+	0xb9, 0x4a, 0x2f, 0x2c, 0x9a, 0x9d, 0x61, 0x76, 0x07, 0x75, 0xf3, 0xb8,
+	0x7b, 0x68, 0x3f, 0xf6, 0x4f, 0xe0, 0x28, 0x06, 0xbd, 0x51, 0x4b, 0x41,
+	0x63, 0xb9, 0x90, 0xa7, 0x80, 0xfa, 0x1e, 0x5f, 0xdb, 0xdd, 0x1b, 0x58,
+	0x3c, 0xfb, 0x0e, 0xa1, 0x90, 0xa1, 0x53, 0x51, 0xf2, 0xd2, 0xdb, 0xa8,
+	0xe0, 0x8f, 0x9f, 0x90, 0x31, 0x34, 0xa2, 0xd0, 0x18, 0xb0, 0x38, 0x44,
+	0x12, 0x40, 0x63, 0xc2, 0x46, 0x10, 0x7e, 0x93, 0xec, 0x4a, 0x11, 0xe0,
+	0x32, 0xf6, 0x8d, 0xe0, 0xab, 0x9c, 0x58, 0xdb, 0x0a, 0xb2, 0x58, 0xce,
+	0x46, 0x87, 0xc1, 0x8e, 0xd5, 0xf6, 0xee, 0x1f, 0x33, 0x6e, 0xf0, 0x34,
+	0xe6, 0x10, 0x10, 0xbc, 0xad, 0x4e, 0x15, 0xae, 0x0f, 0x50, 0xd6, 0x8a,
+	0x9c, 0x6e, 0x31, 0x26, 0xcc, 0x0c, 0x66, 0xe4, 0xc9, 0x1c, 0x63, 0x76,
+	0x22, 0x12, 0xe3, 0x42, 0xdf, 0x32, 0x66, 0x35, 0x1f, 0xf9, 0x57, 0xf1,
+	0x9e, 0x80, 0x7c, 0x5c, 0xb3, 0x4f, 0xa9, 0x42, 0xd7, 0xf9, 0xcf, 0x19,
+	0x11, 0x22, 0xc6, 0x21, 0x8f, 0x2b, 0x0d, 0x43, 0xd7, 0x05, 0x2f, 0x7b,
+	0x30, 0xd6, 0x66, 0x2c, 0x65, 0xc5, 0xf7, 0x7f, 0xe7, 0x91, 0xd3, 0x5a,
+	0x7c, 0x49, 0xba, 0x75, 0x08, 0xf3, 0x92, 0x85, 0x23, 0xed, 0x73, 0x4d,
+	0xd3, 0x02, 0x9e, 0x31, 0x8f, 0x50, 0xb0, 0x1b, 0x8e, 0x16, 0xbe, 0x3c,
+	0x39, 0x20, 0x26, 0x5a, 0x43, 0x86, 0x49, 0xc6, 0x42, 0x9f, 0x87, 0x08,
+	0xca, 0xcc, 0x19, 0x2f, 0xd9, 0xc8, 0x25, 0x3b, 0xa3, 0xb7, 0x4a, 0xa6,
+	0xea, 0x34, 0xa7, 0x2c, 0x2f, 0x9f, 0xfc, 0x03, 0xb4, 0x1c, 0xe9, 0x0c,
+	0xfc, 0x01, 0x00, 0x00,
+};
+static const uint8_t asset1[] =
+{
+	0x42, 0x65, 0x52, 0x54, 0x4f, 0x53,
+};
+static const uint8_t asset2[] =
+{
+	0x62, 0x6f, 0x64, 0x79, 0x20, 0x7b, 0x20, 0x66, 0x6f, 0x6e, 0x74, 0x2d,
+	0x66, 0x61, 0x6d, 0x69, 0x6c, 0x79, 0x3a, 0x20, 0x73, 0x61, 0x6e, 0x73,
+	0x2d, 0x73, 0x65, 0x72, 0x69, 0x66, 0x3b, 0x20, 0x6d, 0x61, 0x72, 0x67,
+	0x69, 0x6e, 0x3a, 0x20, 0x32, 0x65, 0x6d, 0x3b, 0x20, 0x62, 0x61, 0x63,
+	0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x3a, 0x20, 0x23, 0x66, 0x66,
+	0x66, 0x66, 0x66, 0x66, 0x3b, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a,
+	0x20, 0x23, 0x32, 0x30, 0x32, 0x30, 0x32, 0x30, 0x3b, 0x20, 0x7d, 0x0a,
+	0x68, 0x31, 0x20, 0x7b, 0x20, 0x66, 0x6f, 0x6e, 0x74, 0x2d, 0x73, 0x69,
+	0x7a, 0x65, 0x3a, 0x20, 0x31, 0x2e, 0x35, 0x65, 0x6d, 0x3b, 0x20, 0x62,
+	0x6f, 0x72, 0x64, 0x65, 0x72, 0x2d, 0x62, 0x6f, 0x74, 0x74, 0x6f, 0x6d,
+	0x3a, 0x20, 0x31, 0x70, 0x78, 0x20, 0x73, 0x6f, 0x6c, 0x69, 0x64, 0x20,
+	0x23, 0x63, 0x30, 0x63, 0x30, 0x63, 0x30, 0x3b, 0x20, 0x7d, 0x0a, 0x74,
+	0x61, 0x62, 0x6c, 0x65, 0x20, 0x7b, 0x20, 0x62, 0x6f, 0x72, 0x64, 0x65,
+	0x72, 0x2d, 0x63, 0x6f, 0x6c, 0x6c, 0x61, 0x70, 0x73, 0x65, 0x3a, 0x20,
+	0x63, 0x6f, 0x6c, 0x6c, 0x61, 0x70, 0x73, 0x65, 0x3b, 0x20, 0x7d, 0x0a,
+	0x74, 0x68, 0x2c, 0x20, 0x74, 0x64, 0x20, 0x7b, 0x20, 0x70, 0x61, 0x64,
+	0x64, 0x69, 0x6e, 0x67, 0x3a, 0x20, 0x30, 0x2e, 0x32, 0x35, 0x65, 0x6d,
+	0x20, 0x31, 0x65, 0x6d, 0x3b, 0x20, 0x62, 0x6f, 0x72, 0x64, 0x65, 0x72,
+	0x3a, 0x20, 0x31, 0x70, 0x78, 0x20, 0x73, 0x6f, 0x6c, 0x69, 0x64, 0x20,
+	0x23, 0x63, 0x30, 0x63, 0x30, 0x63, 0x30, 0x3b, 0x20, 0x74, 0x65, 0x78,
+	0x74, 0x2d, 0x61, 0x6c, 0x69, 0x67, 0x6e, 0x3a, 0x20, 0x6c, 0x65, 0x66,
+	0x74, 0x3b, 0x20, 0x7d, 0x0a,
+};
+static const uint8_t asset2_gz[] =
+{
+	0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x6d, 0x8f,
+	0xdd, 0x0a, 0xc3, 0x20, 0x0c, 0x85, 0xef, 0xf7, 0x14, 0x81, 0xde, 0xce,
+	0xd2, 0x16, 0x76, 0xa3, 0x4f, 0x13, 0xeb, 0x4f, 0x65, 0x6a, 0x8a, 0x3a,
+	0x68, 0x37, 0xf6, 0xee, 0xd3, 0xb2, 0xb2, 0x9b, 0x25, 0x37, 0x49, 0x38,
+	0xe7, 0x3b, 0x44, 0x92, 0xda, 0xe1, 0x05, 0x86, 0x62, 0x61, 0x06, 0x83,
+	0xf3, 0x3b, 0x87, 0x8c, 0x31, 0xb3, 0xac, 0x93, 0x33, 0x02, 0x02, 0x26,
+	0xeb, 0x22, 0x87, 0x49, 0x07, 0x01, 0x12, 0xe7, 0xbb, 0x4d, 0xf4, 0x88,
+	0x8a, 0x43, 0x67, 0x8e, 0x12, 0x30, 0x93, 0xa7, 0x54, 0xf7, 0x69, 0x68,
+	0x2d, 0xe0, 0x7d, 0x59, 0xc6, 0x93, 0x98, 0xdd, 0x53, 0x73, 0x18, 0xfb,
+	0xdb, 0xe1, 0xa6, 0xa4, 0x74, 0x62, 0x92, 0x4a, 0xa1, 0x50, 0xaf, 0xeb,
+	0x06, 0x99, 0xbc, 0x53, 0xd0, 0xcd, 0x43, 0xeb, 0x66, 0x2d, 0x28, 0xbd,
+	0xae, 0xee, 0xaf, 0xb6, 0xb2, 0x3d, 0xae, 0xb9, 0x32, 0xce, 0xe9, 0x10,
+	0x2d, 0x57, 0x28, 0xaa, 0xaa, 0x56, 0x54, 0xca, 0x45, 0xcb, 0x61, 0xe8,
+	0xa7, 0x1a, 0x01, 0xe3, 0x2f, 0xe6, 0x2f, 0xbf, 0xe8, 0xad, 0x30, 0xf4,
+	0xce, 0xd6, 0x87, 0xbc, 0x36, 0xa5, 0xc1, 0x3e, 0xf3, 0x2a, 0xf4, 0x47,
+	0x01, 0x01, 0x00, 0x00,
+};
+static const HttpAsset test_assets_list[] =
+{
+	{ "index.htm", 0x8bf993faUL,
+		{ "Content-type: text/html\r\nVary: Accept-Encoding\r\nContent-Length: 508\r\nETag: \"d6c639a01ff99cd0\"\r\n\r\n", "\"d6c639a01ff99cd0\"", asset0, 508 },
+		{ "Content-type: text/html\r\nContent-Encoding: gzip\r\nVary: Accept-Encoding\r\nContent-Length: 280\r\nETag: \"d6c639a01ff99cd0-gz\"\r\n\r\n", "\"d6c639a01ff99cd0-gz\"", asset0_gz, 280 } },
+	{ "robots.txt", 0x7f7caa12UL,
+		{ "Content-type: text/plain\r\nContent-Length: 6\r\nETag: \"5dd987d42cd57d97\"\r\n\r\n", "\"5dd987d42cd57d97\"", asset1, 6 },
+		{ NULL, NULL, NULL, 0 } },
+	{ "css/style.css", 0xc85db727UL,
+		{ "Content-type: text/css\r\nVary: Accept-Encoding\r\nContent-Length: 257\r\nETag: \"31d66f71591d7b68\"\r\n\r\n", "\"31d66f71591d7b68\"", asset2, 257 },
+		{ "Content-type: text/css\r\nContent-Encoding: gzip\r\nVary: Accept-Encoding\r\nContent-Length: 184\r\nETag: \"31d66f71591d7b68-gz\"\r\n\r\n", "\"31d66f71591d7b68-gz\"", asset2_gz, 184 } },
+};
+
+static const uint16_t test_assets_index[] =
+{
+	0, 0, 1, 2, 0, 0, 0, 3,
+};
+
+const HttpAssetTable test_assets =
+{
+	test_assets_list,
+	test_assets_index,
+	7,
+};
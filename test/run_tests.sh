@@ -33,7 +33,11 @@ SRC_LIST="
 	bertos/algo/ramp.c
 	bertos/algo/crc_ccitt.c
 	bertos/algo/crc.c
+	bertos/algo/crc8.c
+	bertos/algo/crc32.c
+	bertos/algo/crc_engine.c
 	bertos/algo/fletcher32.c
+	bertos/algo/adler32.c
 	bertos/drv/kdebug.c
 	bertos/drv/timer.c
 	bertos/kern/monitor.c
@@ -42,6 +46,11 @@ SRC_LIST="
 	bertos/kern/sem.c
 	bertos/kern/preempt.c
 	bertos/kern/rtask.c
+	bertos/kern/trace.c
+	bertos/kern/irqstat.c
+	bertos/kern/edf.c
+	bertos/kern/pt.c
+	bertos/mware/binlog.c
 	bertos/mware/event.c
 	bertos/mware/formatwr.c
 	bertos/mware/hex.c
@@ -61,6 +70,7 @@ SRC_LIST="
 	bertos/emul/kfile_posix.c
 	bertos/struct/kfile_mem.c
 	bertos/net/ax25.c
+	bertos/net/digipeater.c
 	bertos/net/afsk.c
 	bertos/net/hdlc.c
 	bertos/net/kiss.c
@@ -82,6 +92,8 @@ SRC_LIST="
 	bertos/sec/hash/ripemd.c
 	bertos/sec/mac/hmac.c
 	bertos/sec/mac/omac.c
+	bertos/sec/prng/chacha20.c
+	bertos/sec/benchmarks.c
 "
 
 buildout='/dev/null'